@@ -28,6 +28,7 @@
 #include "support/BRSet.h"
 #include "support/BRKey.h"
 #include "support/BRKeyECIES.h"
+#include "support/BRKeyEd25519.h"
 #include "support/BRAddress.h"
 #include "support/BRBase58.h"
 #include "support/BRBech32.h"
@@ -40,6 +41,8 @@
 #include "bsv/BRBSVParams.h"
 
 #include "bitcoin/BRBloomFilter.h"
+#include "bitcoin/BRCompactFilter.h"
+#include "bitcoin/BRHeaderSnapshot.h"
 #include "bitcoin/BRMerkleBlock.h"
 #include "bitcoin/BRWallet.h"
 #include "bitcoin/BRBIP38Key.h"
@@ -59,9 +62,11 @@
 #include <time.h>
 #include <unistd.h>
 #include <arpa/inet.h>
+#include <sys/socket.h>
 #include <pthread.h>
 
 #define SKIP_BIP38 1
+#define SKIP_BENCHMARKS 1
 
 #ifdef __ANDROID__
 #include <android/log.h>
@@ -476,6 +481,44 @@ int BRBCashAddrTests()
     return r;
 }
 
+// the loop based keccak-f[1600] that BRKeccakF1600() replaced, kept as a reference and benchmark baseline
+static void _BRKeccakF1600Ref(uint64_t *s)
+{
+    static const uint64_t k[] = {
+        0x0000000000000001, 0x0000000000008082, 0x800000000000808a, 0x8000000080008000, 0x000000000000808b,
+        0x0000000080000001, 0x8000000080008081, 0x8000000000008009, 0x000000000000008a, 0x0000000000000088,
+        0x0000000080008009, 0x000000008000000a, 0x000000008000808b, 0x800000000000008b, 0x8000000000008089,
+        0x8000000000008003, 0x8000000000008002, 0x8000000000000080, 0x000000000000800a, 0x800000008000000a,
+        0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008
+    };
+    static const int rho[] = { 1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14, 27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44 };
+    static const int pi[] = { 10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4, 15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1 };
+    uint64_t t, c[5];
+    int i, j, round;
+
+    for (round = 0; round < 24; round++) {
+        for (i = 0; i < 5; i++) c[i] = s[i] ^ s[i + 5] ^ s[i + 10] ^ s[i + 15] ^ s[i + 20];
+
+        for (i = 0; i < 5; i++) {
+            t = c[(i + 4) % 5] ^ (c[(i + 1) % 5] << 1 | c[(i + 1) % 5] >> 63);
+            for (j = 0; j < 25; j += 5) s[j + i] ^= t;
+        }
+
+        for (i = 0, t = s[1]; i < 24; i++) {
+            c[0] = s[pi[i]];
+            s[pi[i]] = t << rho[i] | t >> (64 - rho[i]);
+            t = c[0];
+        }
+
+        for (j = 0; j < 25; j += 5) {
+            for (i = 0; i < 5; i++) c[i] = s[j + i];
+            for (i = 0; i < 5; i++) s[j + i] ^= ~c[(i + 1) % 5] & c[(i + 2) % 5];
+        }
+
+        s[0] ^= k[round];
+    }
+}
+
 int BRHashTests()
 {
     // test sha1
@@ -701,6 +744,82 @@ int BRHashTests()
                     "\x82\x27\x3b\x7b\xfa\xd8\x04\x5d\x85\xa4\x70", *(UInt256 *)md))
         r = 0, fprintf(stderr, "***FAILED*** %s: Keccak-256() test 1\n", __func__);
 
+    s = "The quick brown fox jumps over the lazy dog";
+    BRKeccak256(md, s, strlen(s));
+    if (! UInt256Eq(*(UInt256 *)"\x4d\x74\x1b\x6f\x1e\xb2\x9c\xb2\xa9\xb9\x91\x1c\x82\xf5\x6f\xa8\xd7\x3b\x04\x95\x9d"
+                    "\x3d\x9d\x22\x28\x95\xdf\x6c\x0b\x28\xaa\x15", *(UInt256 *)md))
+        r = 0, fprintf(stderr, "***FAILED*** %s: Keccak-256() test 2\n", __func__);
+
+    // test keccak-f[1600]
+
+    uint64_t state[25] = { 0 }, refState[25];
+
+    BRKeccakF1600(state);
+    if (state[0] != 0xf1258f7940e1dde7 || state[24] != 0xeaf1ff7b5ceca249)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRKeccakF1600() test 1\n", __func__);
+
+    memcpy(refState, state, sizeof(state));
+    BRKeccakF1600(state);
+    _BRKeccakF1600Ref(refState);
+    if (memcmp(state, refState, sizeof(state)) != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRKeccakF1600() test 2\n", __func__);
+
+    // test keccak-256 batch
+
+    uint8_t batchData[200], batchMd[11*32];
+    const void *batch[11];
+    size_t batchLen[11];
+
+    for (size_t i = 0; i < sizeof(batchData); i++) batchData[i] = (uint8_t)i;
+
+    for (size_t i = 0; i < 11; i++) { // lengths on both sides of the 136 byte block size
+        batch[i] = &batchData[i];
+        batchLen[i] = i*17;
+    }
+
+    BRKeccak256Batch(batchMd, batch, batchLen, 11);
+
+    for (size_t i = 0; i < 11; i++) {
+        BRKeccak256(md, batch[i], batchLen[i]);
+        if (memcmp(md, &batchMd[i*32], 32) != 0)
+            r = 0, fprintf(stderr, "***FAILED*** %s: BRKeccak256Batch() test %zu\n", __func__, i + 1);
+    }
+
+    // test incremental hashing, fed in uneven pieces so updates straddle block boundaries
+    
+    void (*hashes[])(void *, const void *, size_t) = {
+        BRSHA1, BRSHA224, BRSHA256, BRSHA384, BRSHA512, BRRMD160, BRSHA3_256, BRKeccak256, BRMD5
+    };
+    const size_t hashLens[] = { 20, 28, 32, 48, 64, 20, 32, 32, 16 };
+    uint8_t msg[300], md1[64], md2[64];
+    BRHashContext hctx;
+    
+    for (size_t i = 0; i < sizeof(msg); i++) msg[i] = (uint8_t)(i*7 + 3);
+    
+    for (size_t i = 0; i < sizeof(hashes)/sizeof(*hashes); i++) {
+        for (size_t len = 0; len <= sizeof(msg); len += 23) {
+            hashes[i](md1, msg, len);
+            
+            if (! BRHashInit(&hctx, hashes[i])) {
+                r = 0, fprintf(stderr, "***FAILED*** %s: BRHashInit() test %zu\n", __func__, i + 1);
+                break;
+            }
+            
+            for (size_t off = 0, n; off < len; off += n) {
+                n = (off % 11) + 1;
+                if (n > len - off) n = len - off;
+                BRHashUpdate(&hctx, &msg[off], n);
+            }
+            
+            BRHashFinal(&hctx, md2);
+            if (memcmp(md1, md2, hashLens[i]) != 0)
+                r = 0, fprintf(stderr, "***FAILED*** %s: BRHashFinal() test %zu, len %zu\n", __func__, i + 1, len);
+        }
+    }
+    
+    if (BRHashInit(&hctx, BRHash160)) // no incremental context for composite hashes
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRHashInit() test 10\n", __func__);
+
     // test murmurHash3-x86_32
     
     if (BRMurmur3_32("", 0, 0) != 0)
@@ -732,6 +851,34 @@ int BRHashTests()
     return r;
 }
 
+// prints per call timings of the keccak permutation and of batched keccak-256, compared with the reference permutation
+// and with hashing one message at a time
+int BRHashBenchmarks()
+{
+    const size_t n = 100000;
+    uint64_t state[25] = { 0 };
+    uint8_t data[4][64], md[4*32];
+    const void *batch[4] = { data[0], data[1], data[2], data[3] };
+    size_t i, j, batchLen[4] = { sizeof(data[0]), sizeof(data[1]), sizeof(data[2]), sizeof(data[3]) };
+    clock_t start;
+
+    memset(data, 0x5a, sizeof(data));
+    start = clock();
+    for (i = 0; i < n; i++) BRKeccakF1600(state);
+    printf("\n    BRKeccakF1600:         %8.1f ns", (double)(clock() - start)*1e9/CLOCKS_PER_SEC/n);
+    start = clock();
+    for (i = 0; i < n; i++) _BRKeccakF1600Ref(state);
+    printf("\n    reference keccak-f:    %8.1f ns", (double)(clock() - start)*1e9/CLOCKS_PER_SEC/n);
+    start = clock();
+    for (i = 0; i < n; i++) BRKeccak256Batch(md, batch, batchLen, 4);
+    printf("\n    BRKeccak256Batch(4):   %8.1f ns", (double)(clock() - start)*1e9/CLOCKS_PER_SEC/n);
+    start = clock();
+    for (i = 0; i < n; i++) for (j = 0; j < 4; j++) BRKeccak256(&md[j*32], batch[j], batchLen[j]);
+    printf("\n    4 x BRKeccak256:       %8.1f ns\n                                    ",
+           (double)(clock() - start)*1e9/CLOCKS_PER_SEC/n);
+    return 1;
+}
+
 int BRMacTests()
 {
     int r = 1;
@@ -788,6 +935,22 @@ int BRMacTests()
                "\x27\x0c\xd7\xea\x25\x05\x54\x97\x58\xbf\x75\xc0\x5a\x99\x4a\x6d\x03\x4f\x65\xf8\xf0\xe6\xfd\xca\xea"
                "\xb1\xa3\x4d\x4a\x6b\x4b\x63\x6e\x07\x0a\x38\xbc\xe7\x37", mac, 64) != 0)
         r = 0, fprintf(stderr, "***FAILED*** %s: BRHMAC() sha512 test 2\n", __func__);
+
+    BRHMACContext hkey, hctx;
+    
+    BRHMACInit(&hkey, BRSHA512, 512/8, k2, sizeof(k2) - 1); // a keyed context is reusable for several messages
+    hctx = hkey;
+    BRHMACUpdate(&hctx, d1, sizeof(d1) - 1);
+    BRHMACFinal(&hctx, mac);
+    hctx = hkey;
+    BRHMACUpdate(&hctx, d2, 10);
+    BRHMACUpdate(&hctx, &d2[10], sizeof(d2) - 11);
+    BRHMACFinal(&hctx, mac);
+    if (memcmp("\x16\x4b\x7a\x7b\xfc\xf8\x19\xe2\xe3\x95\xfb\xe7\x3b\x56\xe0\xa3\x87\xbd\x64\x22\x2e\x83\x1f\xd6\x10"
+               "\x27\x0c\xd7\xea\x25\x05\x54\x97\x58\xbf\x75\xc0\x5a\x99\x4a\x6d\x03\x4f\x65\xf8\xf0\xe6\xfd\xca\xea"
+               "\xb1\xa3\x4d\x4a\x6b\x4b\x63\x6e\x07\x0a\x38\xbc\xe7\x37", mac, 64) != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRHMACFinal() sha512 test 1\n", __func__);
+    mem_clean(&hkey, sizeof(hkey));
     
     // test poly1305
 
@@ -1242,6 +1405,47 @@ int BRAesTests()
     return r;
 }
 
+int BRScryptTests()
+{
+    int r = 1;
+    uint8_t dk[64];
+    
+    // RFC 7914 test vectors: https://tools.ietf.org/html/rfc7914#section-12
+    const char dk1[] = "\x77\xd6\x57\x62\x38\x65\x7b\x20\x3b\x19\xca\x42\xc1\x8a\x04\x97\xf1\x6b\x48\x44\xe3\x07\x4a"
+    "\xe8\xdf\xdf\xfa\x3f\xed\xe2\x14\x42\xfc\xd0\x06\x9d\xed\x09\x48\xf8\x32\x6a\x75\x3a\x0f\xc8\x1f\x17\xe8\xd3\xe0"
+    "\xfb\x2e\x0d\x36\x28\xcf\x35\xe2\x0c\x38\xd1\x89\x06";
+    
+    BRScrypt(dk, 64, "", 0, "", 0, 16, 1, 1);
+    if (memcmp(dk, dk1, 64) != 0) r = 0, fprintf(stderr, "\n***FAILED*** %s: BRScrypt() test 1", __func__);
+    
+    const char dk2[] = "\xfd\xba\xbe\x1c\x9d\x34\x72\x00\x78\x56\xe7\x19\x0d\x01\xe9\xfe\x7c\x6a\xd7\xcb\xc8\x23\x78"
+    "\x30\xe7\x73\x76\x63\x4b\x37\x31\x62\x2e\xaf\x30\xd9\x2e\x22\xa3\x88\x6f\xf1\x09\x27\x9d\x98\x30\xda\xc7\x27\xaf"
+    "\xb9\x4a\x83\xee\x6d\x83\x60\xcb\xdf\xa2\xcc\x06\x40";
+    
+    BRScrypt(dk, 64, "password", 8, "NaCl", 4, 1024, 8, 16);
+    if (memcmp(dk, dk2, 64) != 0) r = 0, fprintf(stderr, "\n***FAILED*** %s: BRScrypt() test 2", __func__);
+    
+    // the 16 lanes on 4 threads, and on one per cpu
+    memset(dk, 0, sizeof(dk));
+    BRScryptParallel(dk, 64, "password", 8, "NaCl", 4, 1024, 8, 16, 4);
+    if (memcmp(dk, dk2, 64) != 0) r = 0, fprintf(stderr, "\n***FAILED*** %s: BRScryptParallel() test 2", __func__);
+    
+    memset(dk, 0, sizeof(dk));
+    BRScryptParallel(dk, 64, "password", 8, "NaCl", 4, 1024, 8, 16, 0);
+    if (memcmp(dk, dk2, 64) != 0) r = 0, fprintf(stderr, "\n***FAILED*** %s: BRScryptParallel() test 3", __func__);
+    
+    const char dk3[] = "\x70\x23\xbd\xcb\x3a\xfd\x73\x48\x46\x1c\x06\xcd\x81\xfd\x38\xeb\xfd\xa8\xfb\xba\x90\x4f\x8e"
+    "\x3e\xa9\xb5\x43\xf6\x54\x5d\xa1\xf2\xd5\x43\x29\x55\x61\x3f\x0f\xcf\x62\xd4\x97\x05\x24\x2a\x9a\xf9\xe6\x1e\x85"
+    "\xdc\x0d\x65\x1e\x40\xdf\xcf\x01\x7b\x45\x57\x58\x87";
+    
+    // the BIP38 parameters, n = 16384 and r = 8
+    BRScrypt(dk, 64, "pleaseletmein", 13, "SodiumChloride", 14, 16384, 8, 1);
+    if (memcmp(dk, dk3, 64) != 0) r = 0, fprintf(stderr, "\n***FAILED*** %s: BRScrypt() test 4", __func__);
+    
+    if (! r) fprintf(stderr, "\n                                    ");
+    return r;
+}
+
 int BRKeyTests()
 {
     int r = 1;
@@ -1681,6 +1885,39 @@ int BRKeyTests()
     if (pkLen5 != pkLen || memcmp(pubKey, pubKey5, pkLen) != 0)
         r = 0, fprintf(stderr, "***FAILED*** %s: BRPubKeyRecover() test 3\n", __func__);
 
+    // batch verification and recovery, with one bad signature of each kind
+    BRKey listKeys[16], recKeys[16];
+    UInt256 listMds[16];
+    uint8_t derSigs[16][72], compactSigs[16][65];
+    const void *derPtrs[16], *compactPtrs[16];
+    size_t derLens[16];
+    int results[16];
+
+    for (uint32_t i = 0; i < 16; i++) {
+        UInt256 secret = UINT256_ZERO;
+
+        UInt32SetBE(&secret.u8[28], i + 1);
+        BRKeySetSecret(&listKeys[i], &secret, i & 1);
+        BRSHA256(&listMds[i], &i, sizeof(i));
+        derLens[i] = BRKeySign(&listKeys[i], derSigs[i], sizeof(derSigs[i]), listMds[i]);
+        BRKeyCompactSign(&listKeys[i], compactSigs[i], sizeof(compactSigs[i]), listMds[i]);
+        derPtrs[i] = derSigs[i];
+        compactPtrs[i] = compactSigs[i];
+    }
+
+    listMds[5].u8[0] ^= 1;
+
+    if (BRKeyVerifyList(listKeys, results, listMds, derPtrs, derLens, 16, 4) != 15 || results[5] || ! results[6])
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRKeyVerifyList() test\n", __func__);
+
+    if (BRKeyRecoverPubKeyList(recKeys, results, listMds, compactPtrs, 16, 4) != 16)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRKeyRecoverPubKeyList() test 1\n", __func__);
+
+    for (size_t i = 0; i < 16; i++) {
+        if ((i != 5) != BRKeyPubKeyMatch(&recKeys[i], &listKeys[i]))
+            r = 0, fprintf(stderr, "***FAILED*** %s: BRKeyRecoverPubKeyList() test 2\n", __func__);
+    }
+
     printf("                                    ");
     return r;
 }
@@ -1787,6 +2024,17 @@ int BRBIP38KeyTests()
     if (BRKeySetBIP38Key(&key, "6PRW5o9FLp4gJDDVqJQKJFTpMvdsSGJxMYHtHaQBF3ooa8mwD69bapcDQn", "foobar", BRMainNetParams->addrParams))
         r = 0, fprintf(stderr, "***FAILED*** %s: BRKeySetBIP38Key() test 10\n", __func__);
 
+    // the scrypt lanes on 4 threads
+    if (! BRKeySetBIP38KeyParallel(&key, "6PRVWUbkzzsbcVac2qwfssoUJAN1Xhrg6bNk8J7Nzm5H7kxEbn2Nh2ZoGg",
+                                   "TestingOneTwoThree", BRMainNetParams->addrParams, 4) ||
+        ! BRKeyPrivKey(&key, privKey, sizeof(privKey), BRMainNetParams->addrParams) ||
+        strncmp(privKey, "5KN7MzqK5wt2TP1fQCYyHBtDrXdJuXbUzm4A9rKAteGu3Qi5CVR", sizeof(privKey)) != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRKeySetBIP38KeyParallel() test 1\n", __func__);
+
+    if (BRKeySetBIP38KeyParallel(&key, "6PRW5o9FLp4gJDDVqJQKJFTpMvdsSGJxMYHtHaQBF3ooa8mwD69bapcDQn", "foobar",
+                                 BRMainNetParams->addrParams, 0))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRKeySetBIP38KeyParallel() test 2\n", __func__);
+
     printf("                                    ");
     return r;
 }
@@ -1827,6 +2075,123 @@ int BRKeyECIESTests()
     return r;
 }
 
+int BREd25519Tests()
+{
+    int r = 1;
+    BREd25519Key key, key2;
+    uint8_t seed[32], sig[64];
+
+    // rfc8032 7.1 test 1
+    memcpy(seed, "\x9d\x61\xb1\x9d\xef\xfd\x5a\x60\xba\x84\x4a\xf4\x92\xec\x2c\xc4\x44\x49\xc5\x69\x7b\x32\x69\x19"
+           "\x70\x3b\xac\x03\x1c\xae\x7f\x60", sizeof(seed));
+    BREd25519KeySetSeed(&key, seed);
+    if (memcmp(key.pubKey, "\xd7\x5a\x98\x01\x82\xb1\x0a\xb7\xd5\x4b\xfe\xd3\xc9\x64\x07\x3a\x0e\xe1\x72\xf3\xda\xa6"
+               "\x23\x25\xaf\x02\x1a\x68\xf7\x07\x51\x1a", sizeof(key.pubKey)) != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BREd25519KeySetSeed() test\n", __func__);
+
+    BREd25519Sign(&key, sig, "", 0);
+    if (memcmp(sig, "\xe5\x56\x43\x00\xc3\x60\xac\x72\x90\x86\xe2\xcc\x80\x6e\x82\x8a\x84\x87\x7f\x1e\xb8\xe5\xd9\x74"
+               "\xd8\x73\xe0\x65\x22\x49\x01\x55\x5f\xb8\x82\x15\x90\xa3\x3b\xac\xc6\x1e\x39\x70\x1c\xf9\xb4\x6b\xd2"
+               "\x5b\xf5\xf0\x59\x5b\xbe\x24\x65\x51\x41\x43\x8e\x7a\x10\x0b", sizeof(sig)) != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BREd25519Sign() test\n", __func__);
+
+    if (! BREd25519Verify(key.pubKey, sig, "", 0))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BREd25519Verify() test 1\n", __func__);
+
+    sig[0] ^= 1;
+    if (BREd25519Verify(key.pubKey, sig, "", 0))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BREd25519Verify() test 2\n", __func__);
+
+    BREd25519KeySetSeedAndPubKey(&key2, seed, key.pubKey);
+    if (memcmp(&key, &key2, sizeof(key)) != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BREd25519KeySetSeedAndPubKey() test\n", __func__);
+
+    // batch verification must agree with verifying one at a time, including when some signatures are bad
+    const size_t n = 100;
+    uint8_t pubKeys[n][32], msgs[n][40], sigs[n][64];
+    const void *pubKeyList[n], *msgList[n], *sigList[n];
+    size_t i, msgLens[n], valid = 0;
+    int results[n];
+
+    for (i = 0; i < n; i++) {
+        memset(seed, (int)i + 1, sizeof(seed));
+        BREd25519KeySetSeed(&key, seed);
+        memcpy(pubKeys[i], key.pubKey, sizeof(pubKeys[i]));
+        memset(msgs[i], (int)i, sizeof(msgs[i]));
+        msgLens[i] = i % sizeof(msgs[i]);
+        BREd25519Sign(&key, sigs[i], msgs[i], msgLens[i]);
+        pubKeyList[i] = pubKeys[i], msgList[i] = msgs[i], sigList[i] = sigs[i];
+    }
+
+    if (BREd25519VerifyList(pubKeyList, results, msgList, msgLens, sigList, n) != n)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BREd25519VerifyList() test 1\n", __func__);
+
+    sigs[3][40] ^= 1;  // bad s
+    sigs[70][5] ^= 1;  // bad R
+    msgs[71][0] ^= 1;  // wrong message
+    sigs[99][63] |= 0x80; // s out of range
+    pubKeyList[72] = pubKeys[73]; // wrong key
+
+    for (i = 0; i < n; i++) {
+        if (BREd25519Verify(pubKeyList[i], sigList[i], msgList[i], msgLens[i])) valid++;
+    }
+
+    if (BREd25519VerifyList(pubKeyList, results, msgList, msgLens, sigList, n) != valid || valid != n - 5)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BREd25519VerifyList() test 2\n", __func__);
+
+    for (i = 0; i < n; i++) {
+        if (results[i] != BREd25519Verify(pubKeyList[i], sigList[i], msgList[i], msgLens[i]))
+            r = 0, fprintf(stderr, "***FAILED*** %s: BREd25519VerifyList() test 3 (%zu)\n", __func__, i);
+    }
+
+    BREd25519KeyClean(&key);
+    BREd25519KeyClean(&key2);
+    return r;
+}
+
+int BREd25519Benchmarks()
+{
+    const size_t n = 1000;
+    uint8_t seed[32] = { 1 }, msg[100], (*sigs)[64] = malloc(n*64);
+    const void **pubKeys = malloc(n*sizeof(*pubKeys)), **msgs = malloc(n*sizeof(*msgs)),
+               **sigList = malloc(n*sizeof(*sigList));
+    size_t i, *msgLens = malloc(n*sizeof(*msgLens));
+    int *results = malloc(n*sizeof(*results)), r = 1;
+    BREd25519Key key;
+    clock_t start;
+
+    memset(msg, 0x5a, sizeof(msg));
+    BREd25519KeySetSeed(&key, seed);
+    start = clock();
+    for (i = 0; i < n; i++) BREd25519Sign(&key, sigs[i], msg, sizeof(msg));
+    printf("\n    BREd25519Sign:         %8.1f us", (double)(clock() - start)*1e6/CLOCKS_PER_SEC/n);
+    start = clock();
+
+    for (i = 0; i < n; i++) {
+        BREd25519Key k;
+        BREd25519KeySetSeed(&k, seed);
+        BREd25519Sign(&k, sigs[i], msg, sizeof(msg));
+    }
+
+    printf("\n    set seed + sign:       %8.1f us", (double)(clock() - start)*1e6/CLOCKS_PER_SEC/n);
+    for (i = 0; i < n; i++) pubKeys[i] = key.pubKey, msgs[i] = msg, msgLens[i] = sizeof(msg), sigList[i] = sigs[i];
+    start = clock();
+    for (i = 0; i < n; i++) if (! BREd25519Verify(pubKeys[i], sigList[i], msgs[i], msgLens[i])) r = 0;
+    printf("\n    BREd25519Verify:       %8.1f us", (double)(clock() - start)*1e6/CLOCKS_PER_SEC/n);
+    start = clock();
+    if (BREd25519VerifyList(pubKeys, results, msgs, msgLens, sigList, n) != n) r = 0;
+    printf("\n    BREd25519VerifyList:   %8.1f us\n                                    ",
+           (double)(clock() - start)*1e6/CLOCKS_PER_SEC/n);
+    BREd25519KeyClean(&key);
+    free(results);
+    free(msgLens);
+    free(sigList);
+    free(msgs);
+    free(pubKeys);
+    free(sigs);
+    return r;
+}
+
 int BRAddressTests()
 {
     int r = 1;
@@ -2078,6 +2443,24 @@ int BRBIP32SequenceTests()
                     uint256("7b6a7dd645507d775215a9035be06700e1ed8c541da9351b4bd14bd50ab61428")))
         r = 0, fprintf(stderr, "***FAILED*** %s: BRBIP32PubKey() test\n", __func__);
 
+    BRBIP32ChainKey chainKey = BRBIP32ChainPubKey(mpk, SEQUENCE_INTERNAL_CHAIN);
+    BRECPoint pubKeys[40];
+
+    if (BRBIP32PubKeyList(pubKeys, 40, chainKey, 5, 4) != 40)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRBIP32PubKeyList() test 1\n", __func__);
+
+    for (uint32_t i = 0; i < 40; i++) {
+        BRBIP32PubKey(pubKey, sizeof(pubKey), mpk, SEQUENCE_INTERNAL_CHAIN, 5 + i);
+        if (memcmp(pubKey, pubKeys[i].p, sizeof(pubKey)) != 0)
+            r = 0, fprintf(stderr, "***FAILED*** %s: BRBIP32PubKeyList() test 2\n", __func__);
+    }
+
+    if (BRBIP32PubKeyList(pubKeys, 1, BRBIP32ChainPubKey(mpk, SEQUENCE_EXTERNAL_CHAIN), 0, 0) != 1 ||
+        pubKeys[0].p[0] != 0x02 ||
+        ! UInt256Eq(*(UInt256 *)&pubKeys[0].p[1],
+                    uint256("7b6a7dd645507d775215a9035be06700e1ed8c541da9351b4bd14bd50ab61428")))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRBIP32PubKeyList() test 3\n", __func__);
+
     UInt512 dk;
     BRAddress addr;
 
@@ -2277,6 +2660,9 @@ int BRTransactionTests()
     BRTransactionAddOutput(tx, 1000000, script, scriptLen);
     BRTransactionAddOutput(tx, 1000000, script, scriptLen);
     BRTransactionAddOutput(tx, 1000000, script, scriptLen);
+    
+    BRTransaction *ptx = BRTransactionCopy(tx);
+    
     BRTransactionSign(tx, 0, k, 2);
     BRAddressFromScriptSig(addr.s, sizeof(addr), BRMainNetParams->addrParams,
                            tx->inputs[tx->inCount - 1].signature, tx->inputs[tx->inCount - 1].sigLen);
@@ -2285,12 +2671,25 @@ int BRTransactionTests()
     
     uint8_t buf6[BRTransactionSerialize(tx, NULL, 0)];
     size_t len6 = BRTransactionSerialize(tx, buf6, sizeof(buf6));
+    UInt256 txHash = tx->txHash, wtxHash = tx->wtxHash;
+    
+    BRTransactionSignParallel(ptx, 0, k, 2, 4);
+    
+    uint8_t pbuf[BRTransactionSerialize(ptx, NULL, 0)];
+    size_t plen = BRTransactionSerialize(ptx, pbuf, sizeof(pbuf));
+    
+    if (plen != len6 || memcmp(pbuf, buf6, len6) != 0 || ! UInt256Eq(ptx->txHash, txHash) ||
+        ! UInt256Eq(ptx->wtxHash, wtxHash))
+        r = 0, fprintf(stderr, "\n***FAILED*** %s: BRTransactionSignParallel() test 1", __func__);
+    BRTransactionFree(ptx);
     
     BRTransactionFree(tx);
     tx = BRTransactionParse(buf6, len6);
     if (! tx || ! BRTransactionIsSigned(tx))
         r = 0, fprintf(stderr, "\n***FAILED*** %s: BRTransactionParse() test 3", __func__);
     if (! tx) return r;
+    if (! UInt256Eq(tx->txHash, txHash) || ! UInt256Eq(tx->wtxHash, wtxHash) || UInt256Eq(txHash, wtxHash))
+        r = 0, fprintf(stderr, "\n***FAILED*** %s: BRTransactionSign() test 5", __func__);
     
     uint8_t buf7[BRTransactionSerialize(tx, NULL, 0)];
     size_t len7 = BRTransactionSerialize(tx, buf7, sizeof(buf7));
@@ -2388,7 +2787,94 @@ int BRTransactionTests()
         r = 0, fprintf(stderr, "\n***FAILED*** %s: BRTransactionCopy() test 3", __func__);
     BRTransactionFree(tgt);
     BRTransactionFree(src);
+
+    src = BRTransactionParse(buf6, len6); // a parsed signed tx keeps its serialization
+    tgt = BRTransactionCopy(src);
+    
+    uint8_t *abuf;
+    size_t size = BRTransactionSize(src), vsize = BRTransactionVSize(src);
+    
+    array_new(abuf, 1);
+    array_add(abuf, 0xff);
+    if (! src->bytes || ! tgt->bytes || tgt->bytes == src->bytes || BRTransactionSerializeAppend(tgt, &abuf) != len6 ||
+        array_count(abuf) != len6 + 1 || abuf[0] != 0xff || memcmp(&abuf[1], buf6, len6) != 0)
+        r = 0, fprintf(stderr, "\n***FAILED*** %s: BRTransactionSerializeAppend() test", __func__);
+    array_free(abuf);
+    
+    BRTransactionClearCache(src);
+    if (src->bytes || BRTransactionSize(src) != size || BRTransactionVSize(src) != vsize ||
+        BRTransactionSerialize(src, NULL, 0) != len6)
+        r = 0, fprintf(stderr, "\n***FAILED*** %s: BRTransactionClearCache() test", __func__);
     
+    BRTransactionAddOutput(tgt, 1000000, script, scriptLen);
+    if (tgt->bytes || BRTransactionSerialize(tgt, NULL, 0) != len6 + 8 + 1 + scriptLen)
+        r = 0, fprintf(stderr, "\n***FAILED*** %s: BRTransactionAddOutput() cache test", __func__);
+    BRTransactionFree(tgt);
+    BRTransactionFree(src);
+
+    BRTransactionView view;
+    BRTxViewCursor cur = { 0 };
+    BRTxInputView vin;
+    BRTxOutputView vout;
+    size_t i;
+
+    if (BRTransactionViewParse(&view, buf, len) != 0) // unsigned tx are not viewed
+        r = 0, fprintf(stderr, "\n***FAILED*** %s: BRTransactionViewParse() test 1", __func__);
+    if (BRTransactionViewParse(&view, buf6, len6 - 1) != 0)
+        r = 0, fprintf(stderr, "\n***FAILED*** %s: BRTransactionViewParse() test 2", __func__);
+
+    src = BRTransactionParse(buf6, len6);
+    if (BRTransactionViewParse(&view, buf6, len6) != len6 || ! UInt256Eq(view.txHash, src->txHash) ||
+        ! UInt256Eq(view.wtxHash, src->wtxHash) || view.inCount != src->inCount || view.outCount != src->outCount ||
+        view.lockTime != src->lockTime)
+        r = 0, fprintf(stderr, "\n***FAILED*** %s: BRTransactionViewParse() test 3", __func__);
+
+    for (i = 0; BRTransactionViewNextInput(&view, &cur, &vin); i++) {
+        if (i >= src->inCount || ! UInt256Eq(vin.txHash, src->inputs[i].txHash) ||
+            vin.index != src->inputs[i].index || vin.sequence != src->inputs[i].sequence ||
+            vin.sigLen != src->inputs[i].sigLen || memcmp(vin.signature, src->inputs[i].signature, vin.sigLen) != 0 ||
+            vin.witLen != src->inputs[i].witLen || memcmp(vin.witness, src->inputs[i].witness, vin.witLen) != 0) break;
+    }
+
+    if (i != src->inCount) r = 0, fprintf(stderr, "\n***FAILED*** %s: BRTransactionViewNextInput() test", __func__);
+
+    for (i = 0, cur = (BRTxViewCursor) { 0 }; BRTransactionViewNextOutput(&view, &cur, &vout); i++) {
+        if (i >= src->outCount || vout.amount != src->outputs[i].amount ||
+            vout.scriptLen != src->outputs[i].scriptLen ||
+            memcmp(vout.script, src->outputs[i].script, vout.scriptLen) != 0) break;
+    }
+
+    if (i != src->outCount) r = 0, fprintf(stderr, "\n***FAILED*** %s: BRTransactionViewNextOutput() test", __func__);
+    BRTransactionFree(src);
+
+    UInt160 pkh1, pkh2;
+    const uint8_t *pkh;
+
+    for (size_t t = 0; t < 2; t++) { // classified inputs and outputs give the same hashes as parsing their scripts
+        src = (t == 0) ? BRTransactionParse(buf6, len6) : BRTransactionParse((uint8_t *)buf0, sizeof(buf0) - 1);
+
+        for (i = 0; i < src->inCount; i++) {
+            BRTxInput *in = &src->inputs[i];
+            size_t l = (in->witLen > 0) ? BRWitnessPKH(pkh2.u8, in->witness, in->witLen) :
+                                          BRSignaturePKH(pkh2.u8, in->signature, in->sigLen);
+
+            if (in->sigType == BRScriptTypeUnclassified || BRTxInputPKH(in, pkh1.u8) != l ||
+                (l > 0 && ! UInt160Eq(pkh1, pkh2)))
+                r = 0, fprintf(stderr, "\n***FAILED*** %s: BRTxInputPKH() test %zu", __func__, t);
+        }
+
+        for (i = 0; i < src->outCount; i++) {
+            pkh = BRScriptPKH(src->outputs[i].script, src->outputs[i].scriptLen);
+
+            if (src->outputs[i].scriptType == BRScriptTypeUnclassified || ! pkh ||
+                BRTxOutputPKH(&src->outputs[i]) != src->outputs[i].scriptHash ||
+                memcmp(pkh, src->outputs[i].scriptHash, 20) != 0)
+                r = 0, fprintf(stderr, "\n***FAILED*** %s: BRTxOutputPKH() test %zu", __func__, t);
+        }
+
+        BRTransactionFree(src);
+    }
+
     if (! r) fprintf(stderr, "\n                                    ");
     return r;
 }
@@ -3206,6 +3692,476 @@ int BRPaymentProtocolEncryptionTests()
 
 void BRPeerAcceptMessageTest(BRPeer *peer, const uint8_t *msg, size_t len, const char *type);
 
+static void _testRelayedFilterHeaders(void *info, UInt256 stopHash, UInt256 prevHeader, const UInt256 filterHashes[],
+                                      size_t hashesCount)
+{
+    if (hashesCount == 1 && UInt256Eq(filterHashes[0], stopHash) && UInt256IsZero(prevHeader)) (*(int *)info)++;
+}
+
+static void _testRelayedFilter(void *info, BRCompactFilter *filter)
+{
+    uint8_t script[] = "\x41\x04\x67\x8a\xfd\xb0\xfe\x55\x48\x27\x19\x67\xf1\xa6\x71\x30\xb7\x10\x5c\xd6\xa8\x28"
+    "\xe0\x39\x09\xa6\x79\x62\xe0\xea\x1f\x61\xde\xb6\x49\xf6\xbc\x3f\x4c\xef\x38\xc4\xf3\x55\x04\xe5\x1e\xc1"
+    "\x12\xde\x5c\x38\x4d\xf7\xba\x0b\x8d\x57\x8a\x4c\x70\x2b\x6b\xf1\x1d\x5f\xac";
+
+    if (filter->n == 1 && BRCompactFilterContainsData(filter, script, sizeof(script) - 1)) (*(int *)info)++;
+    BRCompactFilterFree(filter);
+}
+
+int BRCompactFilterTests()
+{
+    int r = 1, count = 0;
+    // BIP158 test vector, testnet genesis block, which has a single output script
+    UInt256 blockHash = UInt256Reverse(uint256("000000000933ea01ad0ee984209779baaec3ced90fa3f408719526f8d77f4943"));
+    uint8_t script[] = "\x41\x04\x67\x8a\xfd\xb0\xfe\x55\x48\x27\x19\x67\xf1\xa6\x71\x30\xb7\x10\x5c\xd6\xa8\x28"
+    "\xe0\x39\x09\xa6\x79\x62\xe0\xea\x1f\x61\xde\xb6\x49\xf6\xbc\x3f\x4c\xef\x38\xc4\xf3\x55\x04\xe5\x1e\xc1"
+    "\x12\xde\x5c\x38\x4d\xf7\xba\x0b\x8d\x57\x8a\x4c\x70\x2b\x6b\xf1\x1d\x5f\xac";
+    const uint8_t *items[200] = { script };
+    size_t itemLens[200] = { sizeof(script) - 1 };
+    uint8_t buf[1024], data[200][sizeof(uint32_t)];
+    size_t len;
+    BRCompactFilter *f, *f2;
+
+    f = BRCompactFilterNew(COMPACT_FILTER_TYPE_BASIC, blockHash, items, itemLens, 1);
+    len = BRCompactFilterSerialize(f, buf, sizeof(buf));
+
+    if (len != 4 || memcmp(buf, "\x01\x9d\xfc\xa8", 4) != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRCompactFilterNew() test\n", __func__);
+
+    if (! UInt256Eq(BRCompactFilterHeader(BRCompactFilterHash(f), UINT256_ZERO),
+                    UInt256Reverse(uint256("21584579b7eb08997773e5aeff3a7f932700042d0ed2a6129012b7d7ae81b750"))))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRCompactFilterHeader() test\n", __func__);
+
+    if (! BRCompactFilterContainsData(f, script, sizeof(script) - 1))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRCompactFilterContainsData() test 1\n", __func__);
+
+    if (BRCompactFilterContainsData(f, script, sizeof(script) - 2))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRCompactFilterContainsData() test 2\n", __func__);
+
+    BRCompactFilterFree(f);
+
+    for (uint32_t i = 0; i < 200; i++) {
+        UInt32SetLE(data[i], i);
+        items[i] = data[i];
+        itemLens[i] = sizeof(data[i]);
+    }
+
+    f = BRCompactFilterNew(COMPACT_FILTER_TYPE_BASIC, blockHash, items, itemLens, 100);
+    len = BRCompactFilterSerialize(f, buf, sizeof(buf));
+    f2 = BRCompactFilterParse(COMPACT_FILTER_TYPE_BASIC, blockHash, buf, len);
+
+    if (! f2 || f2->n != 100 || ! UInt256Eq(BRCompactFilterHash(f), BRCompactFilterHash(f2)))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRCompactFilterParse() test\n", __func__);
+
+    for (size_t i = 0; f2 && i < 100; i++) {
+        if (! BRCompactFilterContainsData(f2, items[i], itemLens[i]))
+            r = 0, fprintf(stderr, "***FAILED*** %s: BRCompactFilterContainsData() test 3\n", __func__);
+    }
+
+    if (f2 && BRCompactFilterMatchAny(f2, &items[100], &itemLens[100], 100))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRCompactFilterMatchAny() test 1\n", __func__);
+
+    if (f2 && ! BRCompactFilterMatchAny(f2, &items[50], &itemLens[50], 100))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRCompactFilterMatchAny() test 2\n", __func__);
+
+    if (f2) BRCompactFilterFree(f2);
+    BRCompactFilterFree(f);
+
+    // partial merkle tree of 5 tx matching tx 1 and 4
+    UInt256 txHashes[5], h[2], level1[3], level2[2], root, matched[2];
+    uint8_t matches[5] = { 0, 1, 0, 0, 1 };
+    BRMerkleBlock *b = BRMerkleBlockNew();
+
+    for (uint32_t i = 0; i < 5; i++) BRSHA256_2(&txHashes[i], data[i], sizeof(data[i]));
+    for (int i = 0; i < 3; i++) {
+        h[0] = txHashes[i*2], h[1] = (i*2 + 1 < 5) ? txHashes[i*2 + 1] : txHashes[i*2];
+        BRSHA256_2(&level1[i], h, sizeof(h));
+    }
+    h[0] = level1[0], h[1] = level1[1];
+    BRSHA256_2(&level2[0], h, sizeof(h));
+    h[0] = level1[2], h[1] = level1[2];
+    BRSHA256_2(&level2[1], h, sizeof(h));
+    BRSHA256_2(&root, level2, sizeof(level2));
+    BRMerkleBlockSetPartialTree(b, txHashes, (const uint8_t[5]) { 0 }, 5);
+
+    if (b->totalTx != 5 || b->hashesCount != 1 || ! UInt256Eq(b->hashes[0], root))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRMerkleBlockSetPartialTree() test 1\n", __func__);
+
+    BRMerkleBlockSetPartialTree(b, txHashes, matches, 5);
+
+    if (BRMerkleBlockTxHashes(b, matched, 2) != 2 || ! UInt256Eq(matched[0], txHashes[1]) ||
+        ! UInt256Eq(matched[1], txHashes[4]) || BRMerkleBlockContainsTxHash(b, txHashes[2]))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRMerkleBlockSetPartialTree() test 2\n", __func__);
+
+    BRMerkleBlockFree(b);
+
+    // cfilter and cfheaders messages from a fake peer
+    BRPeer *p = BRPeerNew(BRTestNetParams->magicNumber);
+    uint8_t msg[1 + sizeof(UInt256) + sizeof(UInt256) + 1 + sizeof(UInt256)];
+
+    BRPeerSetCallbacks(p, &count, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    BRPeerSetCompactFilterCallbacks(p, _testRelayedFilterHeaders, _testRelayedFilter, NULL);
+    msg[0] = COMPACT_FILTER_TYPE_BASIC;
+    UInt256Set(&msg[1], blockHash);
+    msg[1 + sizeof(UInt256)] = 4;
+    memcpy(&msg[1 + sizeof(UInt256) + 1], "\x01\x9d\xfc\xa8", 4);
+    BRPeerAcceptMessageTest(p, msg, 1 + sizeof(UInt256) + 1 + 4, MSG_CFILTER);
+
+    if (count != 1) r = 0, fprintf(stderr, "***FAILED*** %s: cfilter message test\n", __func__);
+
+    UInt256Set(&msg[1], blockHash);
+    UInt256Set(&msg[1 + sizeof(UInt256)], UINT256_ZERO);
+    msg[1 + sizeof(UInt256) + sizeof(UInt256)] = 1;
+    UInt256Set(&msg[1 + sizeof(UInt256) + sizeof(UInt256) + 1], blockHash);
+    BRPeerAcceptMessageTest(p, msg, sizeof(msg), MSG_CFHEADERS);
+
+    if (count != 2) r = 0, fprintf(stderr, "***FAILED*** %s: cfheaders message test\n", __func__);
+
+    BRPeerFree(p);
+    return r;
+}
+
+// a fake peer listening on a loopback socket, serving the first two mainnet block headers, and compact filters for them
+// that are built from salt, so fake peers with different salts disagree on filter headers, it announces a relayed tx
+// and counts the getdata requests for it
+typedef struct {
+    int sock, salt, cfheaders, cfilters, getdataTx;
+    uint16_t port;
+    pthread_t thread;
+} _BRFakePeer;
+
+static const uint8_t _fakeHeaders[2][80] = {
+    "\x01\x00\x00\x00\x6f\xe2\x8c\x0a\xb6\xf1\xb3\x72\xc1\xa6\xa2\x46\xae\x63\xf7\x4f"
+    "\x93\x1e\x83\x65\xe1\x5a\x08\x9c\x68\xd6\x19\x00\x00\x00\x00\x00\x98\x20\x51\xfd"
+    "\x1e\x4b\xa7\x44\xbb\xbe\x68\x0e\x1f\xee\x14\x67\x7b\xa1\xa3\xc3\x54\x0b\xf7\xb1"
+    "\xcd\xb6\x06\xe8\x57\x23\x3e\x0e\x61\xbc\x66\x49\xff\xff\x00\x1d\x01\xe3\x62\x99",
+    "\x01\x00\x00\x00\x48\x60\xeb\x18\xbf\x1b\x16\x20\xe3\x7e\x94\x90\xfc\x8a\x42\x75"
+    "\x14\x41\x6f\xd7\x51\x59\xab\x86\x68\x8e\x9a\x83\x00\x00\x00\x00\xd5\xfd\xcc\x54"
+    "\x1e\x25\xde\x1c\x7a\x5a\xdd\xed\xf2\x48\x58\xb8\xbb\x66\x5c\x9f\x36\xef\x74\x4e"
+    "\xe4\x2c\x31\x60\x22\xc9\x0f\x9b\xb0\xbc\x66\x49\xff\xff\x00\x1d\x08\xd2\xbd\x61"
+};
+
+static void _fakePeerSend(int sock, const char *type, const uint8_t *payload, size_t len)
+{
+    uint8_t header[24] = { 0 };
+    UInt256 hash;
+
+    UInt32SetLE(header, BRMainNetParams->magicNumber);
+    strncpy((char *)&header[4], type, 12);
+    UInt32SetLE(&header[16], (uint32_t)len);
+    BRSHA256_2(&hash, payload, len);
+    memcpy(&header[20], &hash, sizeof(uint32_t));
+    send(sock, header, sizeof(header), MSG_NOSIGNAL);
+    if (len > 0) send(sock, payload, len, MSG_NOSIGNAL);
+}
+
+static int _fakePeerRead(int sock, uint8_t *buf, size_t len)
+{
+    ssize_t n = 0;
+
+    for (size_t off = 0; off < len; off += n) {
+        n = read(sock, &buf[off], len - off);
+        if (n <= 0) return 0;
+    }
+
+    return 1;
+}
+
+// serializes the compact filter for block height 1 or 2 to buf, and returns its length
+static size_t _fakePeerFilter(_BRFakePeer *fp, uint32_t height, uint8_t *buf, size_t bufLen)
+{
+    uint8_t item[] = { (uint8_t)fp->salt, (uint8_t)height };
+    const uint8_t *items[] = { item };
+    size_t itemLens[] = { sizeof(item) }, len;
+    UInt256 blockHash;
+    BRCompactFilter *f;
+
+    BRSHA256_2(&blockHash, _fakeHeaders[height - 1], 80);
+    f = BRCompactFilterNew(COMPACT_FILTER_TYPE_BASIC, blockHash, items, itemLens, 1);
+    len = BRCompactFilterSerialize(f, buf, bufLen);
+    BRCompactFilterFree(f);
+    return len;
+}
+
+// handles a message from the peer manager, returns false if it's one that the fake peer doesn't expect
+static int _fakePeerAccept(_BRFakePeer *fp, int sock, const char *type, const uint8_t *msg, size_t len)
+{
+    uint8_t buf[1 + 32 + 32 + 1 + 2*32], filter[64];
+    uint32_t startHeight, stopHeight;
+    UInt256 blockHash, header = UINT256_ZERO;
+    size_t off = 0, filterLen;
+
+    if (strcmp(type, MSG_VERSION) == 0) {
+        memset(buf, 0, sizeof(buf));
+        UInt32SetLE(&buf[off], 70015), off += sizeof(uint32_t);
+        UInt64SetLE(&buf[off], SERVICES_NODE_NETWORK | SERVICES_NODE_WITNESS | SERVICES_NODE_COMPACT_FILTERS);
+        off += sizeof(uint64_t);
+        UInt64SetLE(&buf[off], (uint64_t)time(NULL)), off += sizeof(uint64_t);
+        off += 2*(sizeof(uint64_t) + sizeof(UInt128) + sizeof(uint16_t)); // recv and from addresses
+        UInt64SetLE(&buf[off], (uint64_t)fp->port), off += sizeof(uint64_t); // nonce
+        buf[off++] = 0; // empty useragent
+        UInt32SetLE(&buf[off], 2), off += sizeof(uint32_t); // lastblock
+        buf[off++] = 1; // relay
+        _fakePeerSend(sock, MSG_VERSION, buf, off);
+        _fakePeerSend(sock, MSG_VERACK, NULL, 0);
+    }
+    else if (strcmp(type, MSG_PING) == 0) {
+        _fakePeerSend(sock, MSG_PONG, msg, len);
+    }
+    else if (strcmp(type, MSG_GETHEADERS) == 0) {
+        uint8_t headers[1 + 2*81] = { 0 };
+
+        // reply with both headers unless the first block locator is already the last block
+        BRSHA256_2(&blockHash, _fakeHeaders[1], 80);
+        headers[0] = (len >= 5 + 32 && UInt256Eq(UInt256Get(&msg[5]), blockHash)) ? 0 : 2;
+        memcpy(&headers[1], _fakeHeaders[0], 80);
+        memcpy(&headers[1 + 81], _fakeHeaders[1], 80);
+        _fakePeerSend(sock, MSG_HEADERS, headers, 1 + headers[0]*81);
+
+        // announce a relayed tx that isn't in any block
+        buf[off++] = 1;
+        UInt32SetLE(&buf[off], 1), off += sizeof(uint32_t); // inv type 1 is a tx
+        memset(&buf[off], fp->salt, 32), off += 32;
+        _fakePeerSend(sock, MSG_INV, buf, off);
+    }
+    else if (strcmp(type, MSG_GETDATA) == 0) {
+        for (off = 1; off + 36 <= len; off += 36) { // tx may be requested with the witness flag set
+            if ((UInt32GetLE(&msg[off]) & ~0x40000000) == 1 && msg[off + sizeof(uint32_t)] == (uint8_t)fp->salt) {
+                fp->getdataTx++;
+            }
+        }
+    }
+    else if (strcmp(type, MSG_GETCFHEADERS) == 0 || strcmp(type, MSG_GETCFILTERS) == 0) {
+        if (len != 1 + sizeof(uint32_t) + 32) return 0;
+        startHeight = UInt32GetLE(&msg[1]);
+        BRSHA256_2(&blockHash, _fakeHeaders[0], 80);
+        stopHeight = (UInt256Eq(UInt256Get(&msg[1 + sizeof(uint32_t)]), blockHash)) ? 1 : 2;
+        if (startHeight < 1 || startHeight > stopHeight) return 0;
+
+        if (strcmp(type, MSG_GETCFHEADERS) == 0) {
+            fp->cfheaders++;
+            buf[off++] = COMPACT_FILTER_TYPE_BASIC;
+            memcpy(&buf[off], &msg[1 + sizeof(uint32_t)], 32), off += 32;
+            UInt256Set(&buf[off], header), off += 32; // the first batch of filters has no previous filter header
+            buf[off++] = (uint8_t)(stopHeight + 1 - startHeight);
+
+            for (uint32_t h = startHeight; h <= stopHeight; h++) {
+                filterLen = _fakePeerFilter(fp, h, filter, sizeof(filter));
+                BRSHA256_2(&blockHash, filter, filterLen);
+                UInt256Set(&buf[off], blockHash), off += 32;
+            }
+
+            _fakePeerSend(sock, MSG_CFHEADERS, buf, off);
+        }
+        else fp->cfilters++;
+
+        for (uint32_t h = startHeight; strcmp(type, MSG_GETCFILTERS) == 0 && h <= stopHeight; h++) {
+            off = 0;
+            buf[off++] = COMPACT_FILTER_TYPE_BASIC;
+            BRSHA256_2(&blockHash, _fakeHeaders[h - 1], 80);
+            UInt256Set(&buf[off], blockHash), off += 32;
+            filterLen = _fakePeerFilter(fp, h, filter, sizeof(filter));
+            buf[off++] = (uint8_t)filterLen;
+            memcpy(&buf[off], filter, filterLen), off += filterLen;
+            _fakePeerSend(sock, MSG_CFILTER, buf, off);
+        }
+    }
+
+    return 1;
+}
+
+static void *_fakePeerThreadRoutine(void *arg)
+{
+    _BRFakePeer *fp = arg;
+    uint8_t header[24], msg[4096];
+    char type[13] = { 0 }; // message types are NULL padded to 12 bytes, but not NULL terminated if they're 12 long
+    uint32_t len;
+    int sock;
+
+    // the peer manager may reconnect after dropping a peer, so keep accepting until the listening socket is shut down
+    while ((sock = accept(fp->sock, NULL, NULL)) >= 0) {
+        while (_fakePeerRead(sock, header, sizeof(header)) && (len = UInt32GetLE(&header[16])) <= sizeof(msg) &&
+               _fakePeerRead(sock, msg, len) && memcpy(type, &header[4], 12) &&
+               _fakePeerAccept(fp, sock, type, msg, len));
+        close(sock);
+    }
+
+    return NULL;
+}
+
+static int _fakePeerStart(_BRFakePeer *fp, int salt)
+{
+    struct sockaddr_in addr;
+    socklen_t addrLen = sizeof(addr);
+
+    memset(fp, 0, sizeof(*fp));
+    memset(&addr, 0, sizeof(addr));
+    fp->salt = salt;
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    fp->sock = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (fp->sock < 0 || bind(fp->sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fp->sock, 4) != 0 ||
+        getsockname(fp->sock, (struct sockaddr *)&addr, &addrLen) != 0) return 0;
+    fp->port = ntohs(addr.sin_port);
+    return (pthread_create(&fp->thread, NULL, _fakePeerThreadRoutine, fp) == 0);
+}
+
+static void _fakePeerStop(_BRFakePeer *fp)
+{
+    shutdown(fp->sock, SHUT_RDWR);
+    pthread_join(fp->thread, NULL);
+    close(fp->sock);
+}
+
+static void _testSyncStopped(void *info, int error)
+{
+    if (error == 0) *(int *)info = 1;
+}
+
+// syncs with three fake peers in compact filter mode, returns the number of fake peers that were sent getcfheaders,
+// getcfilters and getdata for their relayed tx, and sets synced to true if the sync succeeded within timeout seconds
+static void _BRPeerManagerCompactFilterSync(int salts[3], int timeout, int *synced, int *cfheaders, int *cfilters,
+                                            int *getdataTx)
+{
+    UInt512 seed = UINT512_ZERO;
+    BRMasterPubKey mpk = BRBIP32MasterPubKey(&seed, sizeof(seed));
+    BRWallet *w = BRWalletNew(BRMainNetParams->addrParams, NULL, 0, mpk);
+    _BRFakePeer fp[3];
+    BRPeer peers[3];
+    BRPeerManager *manager;
+    size_t started = 0;
+
+    *synced = *cfheaders = *cfilters = *getdataTx = 0;
+
+    for (; started < 3 && _fakePeerStart(&fp[started], salts[started]); started++) {
+        peers[started] = BR_PEER_NONE;
+        peers[started].address = (UInt128) { .u16 = { 0, 0, 0, 0, 0, 0xffff, 0, 0 } };
+        peers[started].address.u32[3] = htonl(INADDR_LOOPBACK);
+        peers[started].port = fp[started].port;
+        peers[started].timestamp = (uint64_t)time(NULL);
+    }
+
+    if (started == 3) {
+        // earliestKeyTime at the genesis block, so the chain starts there and filters for blocks 1 and 2 are checked
+        manager = BRPeerManagerNew(BRMainNetParams, w, 1231006505, NULL, 0, peers, 3);
+        BRPeerManagerSetCallbacks(manager, synced, NULL, _testSyncStopped, NULL, NULL, NULL, NULL, NULL);
+        BRPeerManagerSetCompactFilterMode(manager, 1);
+        BRPeerManagerConnect(manager);
+        for (int i = 0; ! *synced && i < timeout*10; i++) usleep(100000);
+        BRPeerManagerDisconnect(manager);
+        BRPeerManagerFree(manager);
+    }
+
+    for (size_t i = 0; i < started; i++) {
+        _fakePeerStop(&fp[i]);
+        if (fp[i].cfheaders > 0) (*cfheaders)++;
+        if (fp[i].cfilters > 0) (*cfilters)++;
+        if (fp[i].getdataTx > 0) (*getdataTx)++;
+    }
+
+    BRWalletFree(w);
+}
+
+int BRPeerManagerTests()
+{
+    int r = 1, synced, cfheaders, cfilters, getdataTx;
+
+    // fake peers that agree on filter headers, which are cross-checked with a second peer before filters are requested
+    _BRPeerManagerCompactFilterSync((int []) { 1, 1, 1 }, 10, &synced, &cfheaders, &cfilters, &getdataTx);
+
+    if (! synced || cfheaders < 2 || cfilters != 1)
+        r = 0, fprintf(stderr, "***FAILED*** %s: compact filter sync test 1\n", __func__);
+
+    // without a bloom filter, relayed tx must be fetched so they can be matched against the wallet locally
+    if (getdataTx < 1)
+        r = 0, fprintf(stderr, "***FAILED*** %s: compact filter relayed tx test\n", __func__);
+
+    // fake peers that each serve different filters, filters must not be requested when filter headers disagree
+    _BRPeerManagerCompactFilterSync((int []) { 1, 2, 3 }, 3, &synced, &cfheaders, &cfilters, &getdataTx);
+
+    if (synced || cfheaders < 2 || cfilters != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: compact filter sync test 2\n", __func__);
+
+    return r;
+}
+
+int BRHeaderSnapshotTests()
+{
+    int r = 1;
+    BRKey key, other;
+    BRMerkleBlock *blocks[3], *b;
+    BRHeaderSnapshot *snapshot;
+    uint8_t hdr[80], buf[1024];
+    size_t i, len;
+    UInt256 md;
+
+    BRKeySetSecret(&key, &uint256("0000000000000000000000000000000000000000000000000000000000000001"), 1);
+    BRKeySetSecret(&other, &uint256("0000000000000000000000000000000000000000000000000000000000000002"), 1);
+
+    for (i = 0; i < 3; i++) { // a short chain of header-only blocks starting at height 4032
+        blocks[i] = BRMerkleBlockNew();
+        blocks[i]->version = 2;
+        blocks[i]->prevBlock = (i > 0) ? blocks[i - 1]->blockHash : UINT256_ZERO;
+        blocks[i]->timestamp = 1231006505 + (uint32_t)i*600;
+        blocks[i]->target = 0x1d00ffff;
+        blocks[i]->nonce = (uint32_t)i;
+        blocks[i]->height = 2*BLOCK_DIFFICULTY_INTERVAL + (uint32_t)i;
+        BRMerkleBlockSerialize(blocks[i], hdr, sizeof(hdr));
+        BRSHA256_2(&blocks[i]->blockHash, hdr, sizeof(hdr));
+    }
+
+    len = BRHeaderSnapshotSerialize(buf, sizeof(buf), BRMainNetParams->magicNumber, blocks, 3, &key);
+    if (len != 16 + 3*80 + 65 ||
+        len != BRHeaderSnapshotSerialize(NULL, 0, BRMainNetParams->magicNumber, blocks, 3, &key))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRHeaderSnapshotSerialize() test 1\n", __func__);
+
+    snapshot = BRHeaderSnapshotParse(buf, len, BRMainNetParams->magicNumber, &key);
+
+    if (! snapshot || BRHeaderSnapshotStartHeight(snapshot) != 2*BLOCK_DIFFICULTY_INTERVAL ||
+        BRHeaderSnapshotCount(snapshot) != 3)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRHeaderSnapshotParse() test 1\n", __func__);
+
+    for (i = 0; snapshot && i < 3; i++) {
+        b = BRHeaderSnapshotBlock(snapshot, i);
+
+        if (! b || ! UInt256Eq(b->blockHash, blocks[i]->blockHash) || b->height != blocks[i]->height ||
+            b->timestamp != blocks[i]->timestamp || b->target != blocks[i]->target)
+            r = 0, fprintf(stderr, "***FAILED*** %s: BRHeaderSnapshotBlock() test %zu\n", __func__, i + 1);
+
+        if (b) BRMerkleBlockFree(b);
+    }
+
+    if (snapshot) BRHeaderSnapshotFree(snapshot);
+
+    if (BRHeaderSnapshotParse(buf, len, BRMainNetParams->magicNumber, &other)) // wrong signer
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRHeaderSnapshotParse() test 2\n", __func__);
+
+    if (BRHeaderSnapshotParse(buf, len, BRTestNetParams->magicNumber, &key)) // wrong network
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRHeaderSnapshotParse() test 3\n", __func__);
+
+    UInt32SetLE(&buf[12], 0x03333334); // signed count whose size in bytes wraps to 64 in 32bits
+    BRSHA256_2(&md, buf, 16 + 64);
+    BRKeyCompactSign(&key, &buf[16 + 64], 65, md);
+
+    if (BRHeaderSnapshotParse(buf, 16 + 64 + 65, BRMainNetParams->magicNumber, &key))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRHeaderSnapshotParse() test 5\n", __func__);
+
+    len = BRHeaderSnapshotSerialize(buf, sizeof(buf), BRMainNetParams->magicNumber, blocks, 3, &key);
+    buf[16 + 80 + 76] ^= 0x01; // tampered nonce
+
+    if (BRHeaderSnapshotParse(buf, len, BRMainNetParams->magicNumber, &key))
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRHeaderSnapshotParse() test 4\n", __func__);
+
+    blocks[2]->prevBlock = blocks[0]->blockHash; // broken linkage
+
+    if (BRHeaderSnapshotSerialize(buf, sizeof(buf), BRMainNetParams->magicNumber, blocks, 3, &key) != 0)
+        r = 0, fprintf(stderr, "***FAILED*** %s: BRHeaderSnapshotSerialize() test 2\n", __func__);
+
+    for (i = 0; i < 3; i++) BRMerkleBlockFree(blocks[i]);
+    return r;
+}
+
 int BRPeerTests()
 {
     int r = 1;
@@ -3234,6 +4190,12 @@ int BRRunTests()
     printf("%s\n", (BRBCashAddrTests()) ? "success" : (fail++, "***FAIL***"));
     printf("BRHashTests...                      ");
     printf("%s\n", (BRHashTests()) ? "success" : (fail++, "***FAIL***"));
+    printf("BRHashBenchmarks...                 ");
+#if SKIP_BENCHMARKS
+    printf("SKIPPED\n");
+#else
+    printf("%s\n", (BRHashBenchmarks()) ? "success" : (fail++, "***FAIL***"));
+#endif
     printf("BRMacTests...                       ");
     printf("%s\n", (BRMacTests()) ? "success" : (fail++, "***FAIL***"));
     printf("BRDrbgTests...                      ");
@@ -3244,6 +4206,8 @@ int BRRunTests()
     printf("%s\n", (BRAuthEncryptTests()) ? "success" : (fail++, "***FAIL***"));
     printf("BRAesTests...                       ");
     printf("%s\n", (BRAesTests()) ? "success" : (fail++, "***FAIL***"));
+    printf("BRScryptTests...                    ");
+    printf("%s\n", (BRScryptTests()) ? "success" : (fail++, "***FAIL***"));
     printf("BRKeyTests...                       ");
     printf("%s\n", (BRKeyTests()) ? "success" : (fail++, "***FAIL***"));
     printf("BRBIP38KeyTests...                  ");
@@ -3254,6 +4218,14 @@ int BRRunTests()
 #endif
     printf("BRKeyECIESTests...                  ");
     printf("%s\n", (BRKeyECIESTests()) ? "success" : (fail++, "***FAIL***"));
+    printf("BREd25519Tests...                   ");
+    printf("%s\n", (BREd25519Tests()) ? "success" : (fail++, "***FAIL***"));
+    printf("BREd25519Benchmarks...              ");
+#if SKIP_BENCHMARKS
+    printf("SKIPPED\n");
+#else
+    printf("%s\n", (BREd25519Benchmarks()) ? "success" : (fail++, "***FAIL***"));
+#endif
     printf("BRAddressTests...                   ");
     printf("%s\n", (BRAddressTests()) ? "success" : (fail++, "***FAIL***"));
     printf("BRBIP39MnemonicTests...             ");
@@ -3268,6 +4240,12 @@ int BRRunTests()
     printf("%s\n", (BRBloomFilterTests()) ? "success" : (fail++, "***FAIL***"));
     printf("BRMerkleBlockTests...               ");
     printf("%s\n", (BRMerkleBlockTests()) ? "success" : (fail++, "***FAIL***"));
+    printf("BRCompactFilterTests...             ");
+    printf("%s\n", (BRCompactFilterTests()) ? "success" : (fail++, "***FAIL***"));
+    printf("BRPeerManagerTests...               ");
+    printf("%s\n", (BRPeerManagerTests()) ? "success" : (fail++, "***FAIL***"));
+    printf("BRHeaderSnapshotTests...            ");
+    printf("%s\n", (BRHeaderSnapshotTests()) ? "success" : (fail++, "***FAIL***"));
     printf("BRPaymentProtocolTests...           ");
     printf("%s\n", (BRPaymentProtocolTests()) ? "success" : (fail++, "***FAIL***"));
     printf("BRPaymentProtocolEncryptionTests... ");
@@ -18,6 +18,7 @@
 
 #include "BRCryptoAmount.h"
 #include "BRCryptoWallet.h"
+#include "crypto/BRCryptoAccountP.h"
 #include "crypto/BRCryptoNetworkP.h"
 #include "crypto/BRCryptoTransferP.h"
 #include "crypto/BRCryptoWalletManagerP.h"
@@ -30,6 +31,7 @@
 #include "bitcoin/BRWallet.h"
 
 #include "crypto/handlers/btc/BRCryptoBTC.h"
+#include "crypto/handlers/eth/BRCryptoETH.h"
 
 #ifdef __ANDROID__
 #include <android/log.h>
@@ -308,6 +310,172 @@ runCryptoTransferTests (void) {
     transferTestsAddress();
 }
 
+///
+/// Mark: BRCryptoSigningSession Tests
+///
+
+static void
+runCryptoSigningSessionTests (void) {
+    const char *paperKey = "ginger settle marine tissue robot crane night number ramp coast roast critic";
+
+    UInt512 expected = cryptoAccountDeriveSeed (paperKey);
+    const BRCryptoSigningKeys *keys;
+
+    BRBIP32PrivChainKey expectedInternal, expectedExternal;
+    BRBIP32PrivChainKeyPath (&expectedInternal, &expected, sizeof (UInt512), 2, 0 | BIP32_HARD, SEQUENCE_INTERNAL_CHAIN);
+    BRBIP32PrivChainKeyPath (&expectedExternal, &expected, sizeof (UInt512), 2, 0 | BIP32_HARD, SEQUENCE_EXTERNAL_CHAIN);
+
+    BRCryptoSigningSession session = cryptoSigningSessionCreate (paperKey);
+    assert (NULL != session);
+    assert (CRYPTO_FALSE == cryptoSigningSessionIsClosed (session));
+
+    // The session's seed and chain keys match a fresh derivation, on every use
+    for (size_t index = 0; index < 3; index++) {
+        keys = cryptoSigningSessionLockKeys (session);
+        assert (NULL != keys);
+        assert (0 == memcmp (keys->seed.u8, expected.u8, sizeof (UInt512)));
+        assert (0 == memcmp (&keys->btcInternal, &expectedInternal, sizeof (BRBIP32PrivChainKey)));
+        assert (0 == memcmp (&keys->btcExternal, &expectedExternal, sizeof (BRBIP32PrivChainKey)));
+        cryptoSigningSessionUnlockKeys (session);
+    }
+
+    // The ETH key derived from the session's chain key is the one derived from the seed
+    keys = cryptoSigningSessionLockKeys (session);
+    BRKey ethSessionKey = derivePrivateKeyFromChainKey (&keys->eth, 0);
+    cryptoSigningSessionUnlockKeys (session);
+
+    BRKey ethSeedKey = derivePrivateKeyFromSeed (expected, 0);
+    assert (0 == memcmp (ethSessionKey.secret.u8, ethSeedKey.secret.u8, sizeof (UInt256)));
+    assert (ethSessionKey.compressed == ethSeedKey.compressed);
+    BRKeyClean (&ethSessionKey);
+    BRKeyClean (&ethSeedKey);
+
+    // A transfer signed through the session is the one signed with the paper key's seed; the
+    // chain keys are used in place, just as cryptoWalletManagerSignWithSession() uses them.
+    BRTransaction *transactions[numberOfTransferTests];
+    for (size_t index = 0; index < numberOfTransferTests; index++) {
+        BRCryptoTransferTest *test = &transferTests[index];
+
+        size_t   testRawSize;
+        uint8_t *testRawBytes = hexDecodeCreate(&testRawSize, test->rawChars, strlen (test->rawChars));
+
+        transactions[index] = BRTransactionParse (testRawBytes, testRawSize);
+        transactions[index]->blockHeight = test->blockHeight;
+        transactions[index]->timestamp   = test->timestamp;
+        free (testRawBytes);
+    }
+
+    BRWallet *wallet = BRWalletNew (BRTestNetParams->addrParams, transactions, numberOfTransferTests, transferTestsGetMPK());
+
+    BRTransaction *sessionTx = BRWalletCreateTransaction (wallet, 100000, "mvdGvbpCxedu5sHrFr1n515aQxfRRRy6xo");
+    assert (NULL != sessionTx);
+    BRTransaction *seedTx = BRTransactionCopy (sessionTx);
+
+    // An extra reference given back leaves the session open
+    cryptoSigningSessionGive (cryptoSigningSessionTake (session));
+
+    keys = cryptoSigningSessionLockKeys (session);
+    assert (NULL != keys);
+    assert (1 == BRWalletSignTransactionWithChainKeys (wallet, sessionTx, BRTestNetParams->forkId,
+                                                       &keys->btcInternal, &keys->btcExternal));
+    cryptoSigningSessionUnlockKeys (session);
+
+    assert (1 == BRWalletSignTransaction (wallet, seedTx, BRTestNetParams->forkId, expected.u8, sizeof (UInt512)));
+    assert (BRTransactionIsSigned (sessionTx));
+
+    size_t sessionTxSize = BRTransactionSerialize (sessionTx, NULL, 0);
+    uint8_t sessionTxBytes[sessionTxSize], seedTxBytes[sessionTxSize];
+    assert (sessionTxSize == BRTransactionSerialize (seedTx, NULL, 0));
+    BRTransactionSerialize (sessionTx, sessionTxBytes, sessionTxSize);
+    BRTransactionSerialize (seedTx, seedTxBytes, sessionTxSize);
+    assert (0 == memcmp (sessionTxBytes, seedTxBytes, sessionTxSize));
+
+    BRTransactionFree (seedTx);
+    BRTransactionFree (sessionTx);
+    BRWalletFree (wallet);
+
+    // Once closed the keys' memory reads back as zero and no keys are handed out.  Releasing
+    // the last reference closes the session before its keys page is freed.
+    cryptoSigningSessionClose (session);
+    assert (CRYPTO_TRUE == cryptoSigningSessionIsClosed (session));
+    assert (NULL == cryptoSigningSessionLockKeys (session));
+
+    mem_clean (&expected, sizeof (UInt512));
+    var_clean (&expectedInternal, &expectedExternal);
+
+    cryptoSigningSessionGive (session);
+}
+
+///
+/// Mark: BRCryptoNetwork Tests
+///
+
+static void
+runCryptoNetworkCurrencyIndexTests (void) {
+    BRCryptoNetwork network = cryptoNetworkFindBuiltin ("ethereum-mainnet", true);
+    assert (NULL != network);
+
+    const char *issuer = "0xAbCdEf0123456789aBcDeF0123456789AbCdEf01";
+    BRCryptoCurrency currency = cryptoCurrencyCreate ("ethereum-mainnet:0xAbCdEf0123456789aBcDeF0123456789AbCdEf01",
+                                                      "Test Token", "tst", "erc20", issuer);
+    BRCryptoUnit baseUnit    = cryptoUnitCreateAsBase (currency, "tsti", "TST Token INT", "TSTI");
+    BRCryptoUnit defaultUnit = cryptoUnitCreate (currency, "tst", "TST Token", "TST", baseUnit, 18);
+
+    // Not yet associated
+    assert (NULL == cryptoNetworkGetCurrencyForUids   (network, cryptoCurrencyGetUids (currency)));
+    assert (NULL == cryptoNetworkGetCurrencyForIssuer (network, issuer));
+
+    cryptoNetworkAddCurrency (network, currency, baseUnit, defaultUnit);
+
+    // Found by uids and by issuer, without regard to case
+    BRCryptoCurrency found = cryptoNetworkGetCurrencyForUids (network, "ETHEREUM-MAINNET:0xabcdef0123456789abcdef0123456789abcdef01");
+    assert (found == currency);
+    cryptoCurrencyGive (found);
+
+    found = cryptoNetworkGetCurrencyForIssuer (network, "0xabcdef0123456789abcdef0123456789abcdef01");
+    assert (found == currency);
+    cryptoCurrencyGive (found);
+
+    // A second association with the same keys does not displace the first
+    BRCryptoCurrency duplicate = cryptoCurrencyCreate (cryptoCurrencyGetUids (currency), "Duplicate", "dup", "erc20", issuer);
+    BRCryptoUnit duplicateBaseUnit = cryptoUnitCreateAsBase (duplicate, "dupi", "DUP Token INT", "DUPI");
+    cryptoNetworkAddCurrency (network, duplicate, duplicateBaseUnit, duplicateBaseUnit);
+
+    found = cryptoNetworkGetCurrencyForIssuer (network, issuer);
+    assert (found == currency);
+    cryptoCurrencyGive (found);
+
+    // The units are found through the index too
+    BRCryptoUnit unit = cryptoNetworkGetUnitAsDefault (network, currency);
+    assert (unit == defaultUnit);
+    cryptoUnitGive (unit);
+
+    unit = cryptoNetworkGetUnitAsBase (network, duplicate);
+    assert (unit == duplicateBaseUnit);
+    cryptoUnitGive (unit);
+
+    // The builtin currencies are indexed as well
+    BRCryptoCurrency native = cryptoNetworkGetCurrency (network);
+    found = cryptoNetworkGetCurrencyForUids (network, cryptoCurrencyGetUids (native));
+    assert (found == native);
+    cryptoCurrencyGive (found);
+    cryptoCurrencyGive (native);
+
+    found = cryptoNetworkGetCurrencyForIssuer (network, "0x558EC3152E2EB2174905CD19AEA4E34A23DE9AD6");
+    assert (NULL != found && 0 == strcmp ("brd", cryptoCurrencyGetCode (found)));
+    cryptoCurrencyGive (found);
+
+    assert (NULL == cryptoNetworkGetCurrencyForUids   (network, "ethereum-mainnet:0x0000000000000000000000000000000000000000"));
+    assert (NULL == cryptoNetworkGetCurrencyForIssuer (network, "0x0000000000000000000000000000000000000000"));
+
+    cryptoUnitGive (duplicateBaseUnit);
+    cryptoCurrencyGive (duplicate);
+    cryptoUnitGive (defaultUnit);
+    cryptoUnitGive (baseUnit);
+    cryptoCurrencyGive (currency);
+    cryptoNetworkGive (network);
+}
+
 ///
 /// Mark: BRCryptoWalletManager Tests
 ///
@@ -1532,6 +1700,69 @@ runCryptoWalletManagerLifecycleWithSetModeTest (BRCryptoAccount account,
     return success;
 }
 
+///
+/// Mark: ETH Token Wallet Index Test
+///
+
+static int
+runCryptoWalletManagerTokenIndexTest (BRCryptoAccount account,
+                                      BRCryptoNetwork network,
+                                      BRCryptoAddressScheme scheme,
+                                      const char *storagePath) {
+    printf("Testing BRCryptoWalletManager token wallets for network=\"%s\"...\n",
+           cryptoNetworkGetName (network));
+
+    CWMEventRecordingState state = {0};
+    CWMEventRecordingStateNewDefault (&state);
+
+    BRCryptoWalletManager manager = BRCryptoWalletManagerSetupForLifecycleTest (&state, account, network, CRYPTO_SYNC_MODE_API_ONLY, scheme, storagePath);
+    BRCryptoWalletManagerETH managerETH = cryptoWalletManagerCoerceETH (manager);
+
+    // Any token currency on the network
+    BRCryptoCurrency currency = NULL;
+    for (size_t index = 0; NULL == currency && index < cryptoNetworkGetCurrencyCount (network); index++) {
+        BRCryptoCurrency c = cryptoNetworkGetCurrencyAt (network, index);
+        if (NULL != cryptoCurrencyGetIssuer (c)) currency = c;
+        else cryptoCurrencyGive (c);
+    }
+    if (NULL == currency) {
+        printf("%s: no token currency; skipped\n", __func__);
+        cryptoWalletManagerStop (manager);
+        cryptoWalletManagerGive (manager);
+        CWMEventRecordingStateFree (&state);
+        return 1;
+    }
+
+    BREthereumAddress issuer = ethAddressCreate (cryptoCurrencyGetIssuer (currency));
+    BREthereumToken   token  = BRSetGet (managerETH->tokens, &issuer);
+    assert (NULL != token);
+
+    // A created token wallet is found for its token
+    BRCryptoWallet wallet = cryptoWalletManagerCreateWallet (manager, currency);
+    assert (wallet == (BRCryptoWallet) cryptoWalletManagerEnsureWalletForToken (managerETH, token));
+
+    // Once removed, the wallet is not found; ensure creates, and indexes, another
+    cryptoWalletManagerRemWallet (manager, wallet);
+    assert (CRYPTO_FALSE == cryptoWalletManagerHasWallet (manager, wallet));
+
+    BRCryptoWallet ensured = (BRCryptoWallet) cryptoWalletManagerEnsureWalletForToken (managerETH, token);
+    assert (NULL != ensured && ensured != wallet);
+    assert (CRYPTO_TRUE == cryptoWalletManagerHasWallet (manager, ensured));
+    assert (ensured == (BRCryptoWallet) cryptoWalletManagerEnsureWalletForToken (managerETH, token));
+
+    // Adding the removed wallet back does not displace the indexed wallet
+    cryptoWalletManagerAddWallet (manager, wallet);
+    assert (ensured == (BRCryptoWallet) cryptoWalletManagerEnsureWalletForToken (managerETH, token));
+
+    cryptoWalletManagerStop (manager);
+    cryptoWalletGive (wallet);
+    cryptoCurrencyGive (currency);
+    cryptoWalletManagerGive (manager);
+    CWMEventRecordingStateFree (&state);
+
+    return 1;
+}
+
 ///
 /// Mark: Entrypoints
 ///
@@ -1581,6 +1812,17 @@ runCryptoTestsWithAccountAndNetwork (BRCryptoAccount account,
         }
     }
 
+    if (isEth) {
+        success = AS_CRYPTO_BOOLEAN(runCryptoWalletManagerTokenIndexTest (account,
+                                                                          network,
+                                                                          scheme,
+                                                                          storagePath));
+        if (!success) {
+            fprintf(stderr, "***FAILED*** %s:%d: failed\n", __func__, __LINE__);
+            return success;
+        }
+    }
+
     if (isEth) {
         success = AS_CRYPTO_BOOLEAN(runCryptoWalletManagerLifecycleTest (account,
                                                                          network,
@@ -1648,5 +1890,7 @@ extern void
 runCryptoTests (void) {
     runCryptoAmountTests ();
     runCryptoTransferTests();
+    runCryptoSigningSessionTests();
+    runCryptoNetworkCurrencyIndexTests();
     return;
 }
@@ -11,7 +11,10 @@
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
+#include <unistd.h>
 #include "ethereum/blockchain/BREthereumBlockChain.h"
+#include "ethereum/mpt/BREthereumMPT.h"
+#include "ethereum/bcs/BREthereumBCSPrivate.h"
 
 //
 // Bloom Test
@@ -268,6 +271,40 @@ runBlockTest1 () {
         assert (ETHEREUM_BOOLEAN_IS_FALSE (bloomFilterMatch(filter, bloomFilterCreateAddress(addressSource))));
         assert (ETHEREUM_BOOLEAN_IS_FALSE (bloomFilterMatch(filter, bloomFilterCreateAddress(addressTarget))));
     }
+
+    // BLOCK_1 and BLOCK_2, matched with Bloom Filter Bits
+    {
+        BREthereumBloomFilter filter1 = bloomFilterCreateString(BLOCK_1_BLOOM);
+        BREthereumBloomFilter filter2 = bloomFilterCreateString(BLOCK_2_BLOOM);
+        const BREthereumBloomFilter *filters[] = { &filter1, &filter2 };
+
+        BREthereumBloomFilterBits bitsSource1 = bloomFilterBitsCreate (logTopicGetBloomFilterAddress(ethAddressCreate(BLOCK_1_TX_132_SOURCE)));
+        BREthereumBloomFilterBits bitsSource2 = bloomFilterBitsCreate (logTopicGetBloomFilterAddress(ethAddressCreate(BLOCK_2_TX_53_SOURCE)));
+        BREthereumBloomFilterBits bitsTarget1 = bloomFilterBitsCreate (bloomFilterCreateAddress(ethAddressCreate(BLOCK_1_TX_132_TARGET)));
+
+        // A hash sets at most three bits
+        assert (bitsSource1.count > 0 && bitsSource1.count <= 3);
+
+        assert (ETHEREUM_BOOLEAN_IS_TRUE  (bloomFilterBitsMatch (&bitsSource1, &filter1)));
+        assert (ETHEREUM_BOOLEAN_IS_TRUE  (bloomFilterBitsMatch (&bitsSource2, &filter2)));
+        assert (ETHEREUM_BOOLEAN_IS_FALSE (bloomFilterBitsMatch (&bitsTarget1, &filter1)));
+
+        // Matches accumulate.
+        BREthereumBoolean matches[2] = { ETHEREUM_BOOLEAN_FALSE, ETHEREUM_BOOLEAN_FALSE };
+        assert (0 == bloomFilterBitsMatchMany (&bitsTarget1, filters, 2, matches));
+        assert (ETHEREUM_BOOLEAN_IS_FALSE (matches[0]) && ETHEREUM_BOOLEAN_IS_FALSE (matches[1]));
+        assert (1 <= bloomFilterBitsMatchMany (&bitsSource1, filters, 2, matches));
+        assert (ETHEREUM_BOOLEAN_IS_TRUE (matches[0]));
+        assert (1 <= bloomFilterBitsMatchMany (&bitsSource2, filters, 2, matches));
+        assert (ETHEREUM_BOOLEAN_IS_TRUE (matches[0]) && ETHEREUM_BOOLEAN_IS_TRUE (matches[1]));
+
+        // Or in place
+        BREthereumBloomFilter filter = bloomFilterCreateEmpty();
+        bloomFilterOrInPlace (&filter, &filter1);
+        bloomFilterOrInPlace (&filter, &filter2);
+        assert (ETHEREUM_BOOLEAN_IS_TRUE (bloomFilterEqual (filter, bloomFilterOr (filter1, filter2))));
+        assert (ETHEREUM_BOOLEAN_IS_TRUE (bloomFilterMatch (filter, filter1)));
+    }
 }
 
 static void
@@ -468,6 +505,221 @@ runTransactionReceiptTests (void) {
      */
 }
 
+//
+// Bloom Index
+//
+extern void
+runBloomIndexTests (void) {
+    printf ("==== Bloom Index\n");
+
+    BREthereumAddress address = ethAddressCreate (BLOOM_ADDR_1);
+    BREthereumBloomIndex index = bloomIndexCreate (address);
+
+    // Out of order, with a gap at [106, 199] and with repeats; even numbers match, except 104.
+    uint64_t numbers[] = { 100, 102, 101, 105, 99, 104, 103, 200, 103, 50 };
+    size_t numbersCount = sizeof (numbers) / sizeof (uint64_t);
+    for (size_t i = 0; i < numbersCount; i++)
+        bloomIndexAddBlock (index, numbers[i],
+                            AS_ETHEREUM_BOOLEAN (0 == numbers[i] % 2 && 104 != numbers[i]));
+
+    assert (9 == bloomIndexGetCheckedCount (index));
+    assert (ETHEREUM_BOOLEAN_IS_TRUE  (bloomIndexHasChecked (index, 99)));
+    assert (ETHEREUM_BOOLEAN_IS_TRUE  (bloomIndexHasChecked (index, 105)));
+    assert (ETHEREUM_BOOLEAN_IS_FALSE (bloomIndexHasChecked (index, 106)));
+    assert (ETHEREUM_BOOLEAN_IS_FALSE (bloomIndexHasChecked (index, 98)));
+    assert (ETHEREUM_BOOLEAN_IS_TRUE  (bloomIndexHasChecked (index, 50)));
+
+    assert (4 == bloomIndexGetMatchCount (index));
+    assert (ETHEREUM_BOOLEAN_IS_TRUE  (bloomIndexHasMatch (index, 102)));
+    assert (ETHEREUM_BOOLEAN_IS_FALSE (bloomIndexHasMatch (index, 104)));
+    assert (ETHEREUM_BOOLEAN_IS_FALSE (bloomIndexHasMatch (index, 101)));
+
+    BRRlpCoder coder = rlpCoderCreate();
+    BRRlpItem item = bloomIndexRlpEncode (index, coder);
+    BREthereumBloomIndex decoded = bloomIndexRlpDecode (item, coder);
+    rlpItemRelease (coder, item);
+
+    assert (bloomIndexHashEqual (index, decoded));
+    assert (9 == bloomIndexGetCheckedCount (decoded));
+    assert (4 == bloomIndexGetMatchCount (decoded));
+    assert (ETHEREUM_BOOLEAN_IS_TRUE  (bloomIndexHasMatch   (decoded, 200)));
+    assert (ETHEREUM_BOOLEAN_IS_FALSE (bloomIndexHasChecked (decoded, 150)));
+
+    bloomIndexRelease (decoded);
+    bloomIndexRelease (index);
+    rlpCoderRelease(coder);
+}
+
+//
+// MPT Proofs
+//
+static BRRlpData
+mptTestLeaf (BRRlpCoder coder, uint8_t nibble, uint8_t *value, size_t valueCount) {
+    uint8_t path = 0x30 | nibble;   // leaf, odd length: one nibble
+    BRRlpItem item = rlpEncodeList2 (coder,
+                                     rlpEncodeBytes (coder, &path, 1),
+                                     rlpEncodeBytes (coder, value, valueCount));
+    BRRlpData data = rlpItemGetData (coder, item);
+    rlpItemRelease (coder, item);
+    return data;
+}
+
+// A branch with one child, at `nibble`, referenced by hash or, if `embed`, embedded.
+static BRRlpData
+mptTestBranch (BRRlpCoder coder, uint8_t nibble, BRRlpData child, int embed) {
+    BRRlpItem items[17];
+    for (size_t index = 0; index < 17; index++)
+        items[index] = (index != nibble
+                        ? rlpEncodeBytes (coder, NULL, 0)
+                        : (embed
+                           ? rlpDataGetItem (coder, child)
+                           : ethHashRlpEncode (ethHashCreateFromData (child), coder)));
+    BRRlpItem item = rlpEncodeListItems (coder, items, 17);
+    BRRlpData data = rlpItemGetData (coder, item);
+    rlpItemRelease (coder, item);
+    return data;
+}
+
+static BREthereumMPTNodePath
+mptTestPath (BRRlpCoder coder, BRRlpData node1, BRRlpData node2) {
+    BRRlpItem item = (NULL == node2.bytes
+                      ? rlpEncodeList1 (coder, rlpDataGetItem (coder, node1))
+                      : rlpEncodeList2 (coder, rlpDataGetItem (coder, node1), rlpDataGetItem (coder, node2)));
+    BREthereumMPTNodePath path = mptNodePathDecode (item, coder);
+    rlpItemRelease (coder, item);
+    return path;
+}
+
+static void
+runMPTTests (void) {
+    printf ("==== MPT\n");
+    BRRlpCoder coder = rlpCoderCreate();
+
+    uint8_t keyBytes[] = { 0x12 };
+    BREthereumData key = { 1, keyBytes };
+
+    uint8_t value[40], forgedValue[40], shortValue[] = { 0xde, 0xad };
+    memset (value, 0xaa, sizeof (value));
+    memset (forgedValue, 0xbb, sizeof (forgedValue));
+
+    BRRlpData leaf   = mptTestLeaf (coder, 0x2, value, sizeof (value));
+    BRRlpData branch = mptTestBranch (coder, 0x1, leaf, 0);
+    BREthereumHash root = ethHashCreateFromData (branch);
+
+    // Valid proof
+    BREthereumMPTNodePath path = mptTestPath (coder, branch, leaf);
+    assert (ETHEREUM_BOOLEAN_IS_TRUE (mptNodePathIsValidForRoot (path, key, root)));
+
+    BREthereumBoolean found = ETHEREUM_BOOLEAN_FALSE;
+    BRRlpData data = mptNodePathGetValue (path, key, &found);
+    assert (ETHEREUM_BOOLEAN_IS_TRUE (found));
+    assert (sizeof (value) == data.bytesCount && 0 == memcmp (value, data.bytes, data.bytesCount));
+    rlpDataRelease (data);
+
+    // ... but not for another root
+    assert (ETHEREUM_BOOLEAN_IS_FALSE (mptNodePathIsValidForRoot (path, key, ethHashCreateFromData (leaf))));
+    mptNodePathRelease (path);
+
+    // Tampered node: the leaf no longer hashes to the branch's reference
+    BRRlpData tampered = mptTestLeaf (coder, 0x2, forgedValue, sizeof (forgedValue));
+    path = mptTestPath (coder, branch, tampered);
+    assert (ETHEREUM_BOOLEAN_IS_FALSE (mptNodePathIsValidForRoot (path, key, root)));
+    assert (ETHEREUM_BOOLEAN_IS_FALSE (mptNodePathIsValid (path, key)));
+    mptNodePathRelease (path);
+    rlpDataRelease (tampered);
+
+    // Short forged node: under 32 bytes, yet reached through a 32 byte reference
+    BRRlpData forged = mptTestLeaf (coder, 0x2, shortValue, sizeof (shortValue));
+    assert (forged.bytesCount < ETHEREUM_HASH_BYTES);
+    path = mptTestPath (coder, branch, forged);
+    assert (ETHEREUM_BOOLEAN_IS_FALSE (mptNodePathIsValidForRoot (path, key, root)));
+    mptNodePathRelease (path);
+
+    // ... nor is a short forged root accepted
+    BRRlpData forgedRoot = mptTestLeaf (coder, 0x1, shortValue, sizeof (shortValue));
+    uint8_t forgedKeyBytes[] = { 0x01 };
+    BREthereumData forgedKey = { 1, forgedKeyBytes };
+    path = mptTestPath (coder, forgedRoot, (BRRlpData) { 0, NULL });
+    assert (ETHEREUM_BOOLEAN_IS_FALSE (mptNodePathIsValidForRoot (path, forgedKey, root)));
+    mptNodePathRelease (path);
+    rlpDataRelease (forgedRoot);
+
+    // Embedded node: a short leaf held in its parent, with or without a repeat in the path
+    BRRlpData embedding = mptTestBranch (coder, 0x1, forged, 1);
+    BREthereumHash embeddingRoot = ethHashCreateFromData (embedding);
+
+    path = mptTestPath (coder, embedding, (BRRlpData) { 0, NULL });
+    data = mptNodePathGetValue (path, key, &found);
+    assert (ETHEREUM_BOOLEAN_IS_TRUE (mptNodePathIsValidForRoot (path, key, embeddingRoot)));
+    assert (ETHEREUM_BOOLEAN_IS_TRUE (found));
+    assert (sizeof (shortValue) == data.bytesCount && 0 == memcmp (shortValue, data.bytes, data.bytesCount));
+    rlpDataRelease (data);
+    mptNodePathRelease (path);
+
+    path = mptTestPath (coder, embedding, forged);
+    assert (ETHEREUM_BOOLEAN_IS_TRUE (mptNodePathIsValidForRoot (path, key, embeddingRoot)));
+    mptNodePathRelease (path);
+
+    rlpDataRelease (embedding);
+    rlpDataRelease (forged);
+    rlpDataRelease (branch);
+    rlpDataRelease (leaf);
+    rlpCoderRelease (coder);
+
+    mptNodeCacheClear ();
+}
+
+//
+// BCS Addresses
+//
+#define BCS_ADDR_1 "0xb0F225defEc7625C6B5E43126bdDE398bD90eF62"
+#define BCS_ADDR_2 "0x8fB4CB96F7C15F9C39B3854595733F728E1963Bc"
+
+static void
+runBCSAddressTests (void) {
+    printf ("==== BCS Addresses\n");
+
+    BREthereumAddress address1 = ethAddressCreate (BCS_ADDR_1);
+    BREthereumAddress address2 = ethAddressCreate (BCS_ADDR_2);
+
+    BREthereumBCSListener listener;
+    memset (&listener, 0, sizeof (BREthereumBCSListener));
+
+    BREthereumBCS bcs = bcsCreate (ethNetworkMainnet, address1, listener, CRYPTO_SYNC_MODE_API_ONLY,
+                                   NULL, NULL, NULL, NULL, NULL);
+
+    // Adding is an event; nothing changes until the BCS thread handles it.
+    bcsAddAddress (bcs, address2);
+    bcsAddAddress (bcs, address1);
+    bcsAddAddress (bcs, address2);
+    assert (1 == array_count (bcs->addresses));
+    assert (0 == bcs->bloomIndexesUpdated);
+
+    eventHandlerStart (bcs->handler);
+    sleep (1);
+    eventHandlerStop (bcs->handler);
+
+    assert (2 == array_count (bcs->addresses));
+    assert (ETHEREUM_BOOLEAN_IS_TRUE (ethAddressEqual (address2, bcs->addresses[1])));
+    assert (2 == array_count (bcs->bitsForAddressesOnTransactions));
+    assert (2 == array_count (bcs->bitsForAddressesOnLogs));
+    assert (2 == BRSetCount (bcs->bloomIndexes));
+    assert (1 == bcs->bloomIndexesUpdated);
+
+    // A logsBloom for a block with a log for address2 alone matches address2's bits, but not
+    // the union of both addresses' filters.
+    BREthereumBloomFilter filter1 = logTopicGetBloomFilterAddress (address1);
+    BREthereumBloomFilter filter2 = logTopicGetBloomFilterAddress (address2);
+    assert (ETHEREUM_BOOLEAN_IS_FALSE (bloomFilterMatch (filter2, bloomFilterOr (filter1, filter2))));
+    assert (ETHEREUM_BOOLEAN_IS_FALSE (bloomFilterBitsMatch (&bcs->bitsForAddressesOnLogs[0], &filter2)));
+    assert (ETHEREUM_BOOLEAN_IS_TRUE  (bloomFilterBitsMatch (&bcs->bitsForAddressesOnLogs[1], &filter2)));
+
+    BREthereumBloomFilter filter = bloomFilterCreateAddress (address2);
+    assert (ETHEREUM_BOOLEAN_IS_FALSE (bloomFilterBitsMatch (&bcs->bitsForAddressesOnTransactions[0], &filter)));
+    assert (ETHEREUM_BOOLEAN_IS_TRUE  (bloomFilterBitsMatch (&bcs->bitsForAddressesOnTransactions[1], &filter)));
+
+    bcsDestroy (bcs);
+}
 
 static void
 runBlockTests (void) {
@@ -483,7 +735,10 @@ runBcTests (void) {
     runBlockHeaderTests ();
     runBlockTests();
     runLogTests();
+    runBloomIndexTests();
     runAccountStateTests();
+    runMPTTests();
+    runBCSAddressTests();
     runTransactionStatusTests();
     runTransactionReceiptTests();
 }
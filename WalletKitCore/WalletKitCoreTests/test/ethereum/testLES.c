@@ -1209,6 +1209,72 @@ runLESTests (const char *paperKey) {
     printf ("Done\n");
 }
 
+/// MARK: - Provision Split/Join Test
+
+static void
+run_ProvisionSplitJoin_Tests (void) {
+    // Headers: a part, of reversed headers with a skip, starts `offset * (skip + 1)` blocks back.
+    BREthereumProvision headers = {
+        PROVISION_IDENTIFIER_UNDEFINED,
+        PROVISION_BLOCK_HEADERS,
+        { .headers = { 1000, 9, 25, ETHEREUM_BOOLEAN_TRUE, NULL }}
+    };
+    assert (ETHEREUM_BOOLEAN_IS_TRUE (provisionIsSplittable (&headers)));
+    assert (25 == provisionGetCount (&headers));
+
+    BREthereumProvision headersPart = provisionSplit (&headers, 10, 5);
+    assert (900 == headersPart.u.headers.start);
+    assert (9   == headersPart.u.headers.skip);
+    assert (5   == headersPart.u.headers.limit);
+    assert (ETHEREUM_BOOLEAN_IS_TRUE (headersPart.u.headers.reverse));
+    provisionRelease (&headersPart, ETHEREUM_BOOLEAN_TRUE);
+
+    // Proofs: split into parts, provide each part's results and join them, out of order.
+    BRArrayOf(uint64_t) numbers;
+    array_new (numbers, 10);
+    for (uint64_t number = 100; number < 110; number++)
+        array_add (numbers, number);
+
+    BREthereumProvision proofs = {
+        PROVISION_IDENTIFIER_UNDEFINED,
+        PROVISION_BLOCK_PROOFS,
+        { .proofs = { numbers, NULL }}
+    };
+
+    for (ssize_t offset = 8; offset >= 0; offset -= 4) {
+        size_t count = (10 - offset < 4 ? 10 - offset : 4);
+
+        BREthereumProvision part = provisionSplit (&proofs, offset, count);
+        assert (count == provisionGetCount (&part));
+        assert (numbers[offset] == part.u.proofs.numbers[0]);
+
+        array_new (part.u.proofs.proofs, count);
+        for (size_t index = 0; index < count; index++)
+            array_add (part.u.proofs.proofs, ((BREthereumBlockHeaderProof) {
+                .totalDifficulty = uint256Create (part.u.proofs.numbers[index])
+            }));
+
+        provisionJoin (&proofs, offset, &part);
+        assert (NULL == part.u.proofs.proofs);
+        provisionRelease (&part, ETHEREUM_BOOLEAN_TRUE);
+    }
+
+    assert (10 == array_count (proofs.u.proofs.proofs));
+    for (size_t index = 0; index < 10; index++)
+        assert (numbers[index] == proofs.u.proofs.proofs[index].totalDifficulty.u64[0]);
+
+    provisionRelease (&proofs, ETHEREUM_BOOLEAN_TRUE);
+
+    // Accounts are not split.
+    BREthereumProvision accounts = {
+        PROVISION_IDENTIFIER_UNDEFINED,
+        PROVISION_ACCOUNTS,
+        { .accounts = { .addresses = NULL }}
+    };
+    assert (ETHEREUM_BOOLEAN_IS_FALSE (provisionIsSplittable (&accounts)));
+}
+
 extern void
 runNodeTests (void) {
+    run_ProvisionSplitJoin_Tests ();
 }
@@ -179,8 +179,7 @@ static BRHederaTransaction createSignedTransaction (const char * source, const c
     if (memo) hederaTransactionSetMemo(transaction, memo);
 
     // Sign the transaction
-    BRKey publicKey = hederaAccountGetPublicKey(account);
-    hederaTransactionSignTransaction (transaction, publicKey, seed);
+    hederaTransactionSignTransaction (transaction, account, seed);
 
     // Cleaup
     hederaAddressFree (sourceAddress);
@@ -335,6 +334,50 @@ static void hederaAccountCheckSerialize(const char * userName)
     hederaAccountFree(account2);
 }
 
+static void hederaAccountCheckSigningKey(const char * userName, const char * otherUserName)
+{
+    struct account_info accountInfo = find_account (userName);
+    struct account_info otherAccountInfo = find_account (otherUserName);
+    UInt512 seed = UINT512_ZERO, otherSeed = UINT512_ZERO;
+    BRBIP39DeriveKey(seed.u8, accountInfo.paper_key, NULL); // no passphrase
+    BRBIP39DeriveKey(otherSeed.u8, otherAccountInfo.paper_key, NULL);
+    BRHederaAccount account = hederaAccountCreateWithSeed(seed);
+    BRKey publicKey = hederaAccountGetPublicKey(account);
+
+    // The signing key is expanded once and then returned from the account
+    BREd25519Key key1, key2, key3;
+    assert(hederaAccountGetSigningKey(account, seed, &key1));
+    assert(0 == memcmp(key1.pubKey, publicKey.pubKey, 32));
+    assert(hederaAccountGetSigningKey(account, seed, &key2));
+    assert(0 == memcmp(&key1, &key2, sizeof(BREd25519Key)));
+
+    // Another account's seed is refused and does not replace the cached key
+    assert(!hederaAccountGetSigningKey(account, otherSeed, &key3));
+    assert(hederaAccountGetSigningKey(account, seed, &key3));
+    assert(0 == memcmp(&key1, &key3, sizeof(BREd25519Key)));
+
+    // Nothing is signed with the wrong seed
+    BRHederaAddress source = hederaAddressCreateFromString(accountInfo.account_string, true);
+    BRHederaAddress target = hederaAddressCreateFromString(otherAccountInfo.account_string, true);
+    BRHederaAddress node = hederaAddressCreateFromString("0.0.3", true);
+    BRHederaTimeStamp timeStamp = { 25, 4 };
+    BRHederaFeeBasis feeBasis = { 500000, 1 };
+    BRHederaTransaction transaction = hederaTransactionCreateNew(source, target, 100000000, feeBasis, node, &timeStamp);
+    size_t serializedSize = 0;
+    assert(0 == hederaTransactionSignTransaction(transaction, account, otherSeed));
+    assert(NULL == hederaTransactionSerialize(transaction, &serializedSize));
+    assert(0 != hederaTransactionSignTransaction(transaction, account, seed));
+
+    BREd25519KeyClean(&key1);
+    BREd25519KeyClean(&key2);
+    BREd25519KeyClean(&key3);
+    hederaTransactionFree(transaction);
+    hederaAddressFree(source);
+    hederaAddressFree(target);
+    hederaAddressFree(node);
+    hederaAccountFree(account);
+}
+
 static void accountStringTest(const char * userName) {
     struct account_info accountInfo = find_account (userName);
     UInt512 seed = UINT512_ZERO;
@@ -519,6 +562,8 @@ static void account_tests() {
     hederaAccountCheckSerialize("patient");
     hederaAccountCheckSerialize("none");
 
+    hederaAccountCheckSigningKey("patient", "choose");
+
     accountStringTest("patient");
 }
 
@@ -16,10 +16,12 @@
 #include <unistd.h>
 #include <assert.h>
 #include <string.h>
+#include <math.h>
 
 #include "support/BRFileService.h"
 #include "support/BRAssert.h"
 #include "support/BROSCompat.h"
+#include "support/BRPeerQuality.h"
 
 /// MARK: - File Service Tests
 
@@ -228,6 +230,213 @@ static int runSupFileServiceMultiTests (void) {
     return fileServiceTestDone(path, success);
 }
 
+typedef struct {
+    UInt256 hash;
+    uint32_t value;
+} SupFileServiceEntity;
+
+static UInt256
+supFileServiceEntityIdentifier (BRFileServiceContext context,
+                                BRFileService fs,
+                                const void *entity) {
+    return ((const SupFileServiceEntity *) entity)->hash;
+}
+
+static uint8_t *
+supFileServiceEntityWriter (BRFileServiceContext context,
+                            BRFileService fs,
+                            const void* entity,
+                            uint32_t *bytesCount) {
+    const SupFileServiceEntity *e = entity;
+    uint8_t *bytes = malloc (sizeof (UInt256) + sizeof (uint32_t));
+
+    memcpy (bytes, e->hash.u8, sizeof (UInt256));
+    UInt32SetBE (&bytes[sizeof (UInt256)], e->value);
+
+    *bytesCount = sizeof (UInt256) + sizeof (uint32_t);
+    return bytes;
+}
+
+static void *
+supFileServiceEntityReader (BRFileServiceContext context,
+                            BRFileService fs,
+                            uint8_t *bytes,
+                            uint32_t bytesCount) {
+    if (sizeof (UInt256) + sizeof (uint32_t) != bytesCount) return NULL;
+
+    SupFileServiceEntity *e = malloc (sizeof (SupFileServiceEntity));
+    memcpy (e->hash.u8, bytes, sizeof (UInt256));
+    e->value = UInt32GetBE (&bytes[sizeof (UInt256)]);
+    return e;
+}
+
+static size_t
+supFileServiceEntityHash (const void *entity) {
+    return (size_t) ((const SupFileServiceEntity *) entity)->hash.u32[0];
+}
+
+static int
+supFileServiceEntityEq (const void *e1, const void *e2) {
+    return UInt256Eq (((const SupFileServiceEntity *) e1)->hash, ((const SupFileServiceEntity *) e2)->hash);
+}
+
+// Load all of `type` and return true if it is exactly `entities`
+static int
+supFileServiceLoadMatches (BRFileService fs, const char *type, SupFileServiceEntity *entities, size_t count) {
+    BRSet *results = BRSetNew (supFileServiceEntityHash, supFileServiceEntityEq, 10);
+    int success = fileServiceLoad (fs, results, type, 1);
+
+    success &= (count == BRSetCount (results));
+    for (size_t index = 0; index < count; index++) {
+        SupFileServiceEntity *e = BRSetGet (results, &entities[index]);
+        success &= (NULL != e && e->value == entities[index].value);
+    }
+
+    BRSetFreeAll (results, free);
+    return success;
+}
+
+static BRFileService
+supFileServiceEntitySetup (const char *path, const char *currency, const char *network, const char *type1) {
+    BRFileService fs = fileServiceCreate(path, currency, network, NULL, fileServiceErrorHandler);
+    if (NULL == fs) return NULL;
+
+    if (1 != fileServiceDefineType (fs, type1, 0, NULL,
+                                    supFileServiceEntityIdentifier,
+                                    supFileServiceEntityReader,
+                                    supFileServiceEntityWriter) ||
+        1 != fileServiceDefineCurrentVersion(fs, type1, 0)) {
+        fileServiceRelease (fs);
+        return NULL;
+    }
+
+    return fs;
+}
+
+static int runSupFileServiceReplaceTests (void) {
+    printf ("==== SUP:FileServiceReplace\n");
+
+    struct stat dirStat;
+
+    char *path = "private";
+    char *currency = "btc", *network = "mainnet";
+    char *type1 = "foo";
+
+    if (0 == stat  (path, &dirStat)) _rmdir (path);
+    if (0 != mkdir (path, 0700)) return 0;
+
+    BRFileService fs = supFileServiceEntitySetup (path, currency, network, type1);
+    if (NULL == fs) return fileServiceTestDone(path, 0);
+
+    SupFileServiceEntity entities[5];
+    for (size_t index = 0; index < 5; index++) {
+        entities[index].hash  = UINT256_ZERO;
+        entities[index].hash.u8[0] = (uint8_t) (index + 1);
+        entities[index].value = (uint32_t) index;
+    }
+
+    const void *refs[5];
+    int success = 1;
+
+    // {0, 1, 2}
+    for (size_t index = 0; index < 3; index++) refs[index] = &entities[index];
+    success &= fileServiceReplace (fs, type1, refs, 3);
+    success &= supFileServiceLoadMatches (fs, type1, entities, 3);
+
+    // {1, 2', 3, 4}: remove 0, keep 1, update 2, add 3 and 4
+    entities[2].value = 20;
+    for (size_t index = 1; index < 5; index++) refs[index - 1] = &entities[index];
+    success &= fileServiceReplace (fs, type1, refs, 4);
+    success &= supFileServiceLoadMatches (fs, type1, &entities[1], 4);
+
+    // {4, 3', 3}: the last of a repeated identifier is the one kept
+    SupFileServiceEntity entity3 = entities[3];
+    entity3.value = 30;
+    refs[0] = &entities[4]; refs[1] = &entity3; refs[2] = &entities[3];
+    success &= fileServiceReplace (fs, type1, refs, 3);
+    success &= supFileServiceLoadMatches (fs, type1, &entities[3], 2);
+
+    // {}
+    success &= fileServiceReplace (fs, type1, NULL, 0);
+    success &= supFileServiceLoadMatches (fs, type1, NULL, 0);
+
+    fileServiceRelease (fs);
+    return fileServiceTestDone (path, success);
+}
+
+#define SUP_WRITE_BEHIND_COUNT      (1000)
+
+static int runSupFileServiceWriteBehindTests (void) {
+    printf ("==== SUP:FileServiceWriteBehind\n");
+
+    struct stat dirStat;
+
+    char *path = "private";
+    char *currency = "btc", *network = "mainnet";
+    char *type1 = "foo";
+
+    if (0 == stat  (path, &dirStat)) _rmdir (path);
+    if (0 != mkdir (path, 0700)) return 0;
+
+    BRFileService fs = supFileServiceEntitySetup (path, currency, network, type1);
+    if (NULL == fs) return fileServiceTestDone(path, 0);
+
+    int success = fileServiceSetWriteBehind (fs, true);
+
+    SupFileServiceEntity *entities = calloc (SUP_WRITE_BEHIND_COUNT, sizeof (SupFileServiceEntity));
+    for (size_t index = 0; index < SUP_WRITE_BEHIND_COUNT; index++) {
+        entities[index].hash = UINT256_ZERO;
+        UInt32SetLE (entities[index].hash.u8, (uint32_t) index + 1);
+        entities[index].value = (uint32_t) index;
+    }
+
+    // Save everything twice, the second time with a new value; the last save of each wins.
+    for (size_t index = 0; index < SUP_WRITE_BEHIND_COUNT; index++)
+        success &= fileServiceSave (fs, type1, &entities[index]);
+    for (size_t index = 0; index < SUP_WRITE_BEHIND_COUNT; index++) {
+        entities[index].value += SUP_WRITE_BEHIND_COUNT;
+        success &= fileServiceSave (fs, type1, &entities[index]);
+    }
+
+    // Remove the last, then save it again; remove the one before it.
+    success &= fileServiceRemove (fs, type1, &entities[SUP_WRITE_BEHIND_COUNT - 1]);
+    success &= fileServiceSave   (fs, type1, &entities[SUP_WRITE_BEHIND_COUNT - 1]);
+    success &= fileServiceRemove (fs, type1, &entities[SUP_WRITE_BEHIND_COUNT - 2]);
+    entities[SUP_WRITE_BEHIND_COUNT - 2] = entities[SUP_WRITE_BEHIND_COUNT - 1];
+
+    // Load flushes
+    success &= supFileServiceLoadMatches (fs, type1, entities, SUP_WRITE_BEHIND_COUNT - 1);
+
+    // A replace supersedes the queued writes of its type
+    for (size_t index = 0; index < 10; index++)
+        success &= fileServiceSave (fs, type1, &entities[index]);
+
+    const void *refs[2] = { &entities[0], &entities[1] };
+    success &= fileServiceReplace (fs, type1, refs, 2);
+    success &= fileServiceSave (fs, type1, &entities[2]);
+
+    fileServiceFlush (fs);
+    success &= supFileServiceLoadMatches (fs, type1, entities, 3);
+
+    // Queued writes are committed when write-behind stops
+    success &= fileServiceRemove (fs, type1, &entities[2]);
+    success &= fileServiceSetWriteBehind (fs, false);
+    success &= supFileServiceLoadMatches (fs, type1, entities, 2);
+
+    // ... and on release
+    success &= fileServiceSetWriteBehind (fs, true);
+    success &= fileServiceClear (fs, type1);
+    success &= fileServiceSave  (fs, type1, &entities[3]);
+    fileServiceRelease (fs);
+
+    fs = supFileServiceEntitySetup (path, currency, network, type1);
+    success &= (NULL != fs && supFileServiceLoadMatches (fs, type1, &entities[3], 1));
+    if (NULL != fs) fileServiceRelease (fs);
+
+    free (entities);
+    return fileServiceTestDone (path, success);
+}
+
 /// MARK: - Assert Tests
 
 #define DEFAULT_WORKERS     (5)
@@ -517,6 +726,77 @@ runSupAssertTests (void) {
     return success;
 }
 
+/// MARK: - Peer Quality
+
+#define SUP_PEER_COUNT      (5)
+
+static int
+runSupPeerQualityTests (void) {
+    printf ("==== SUP: Peer Quality\n");
+    int success = 1;
+
+    // Fake peers: their response time, in milliseconds, their download rate, in items per second,
+    // and whether a connection succeeds.  Peer 2 is the one to prefer.
+    double latencies[SUP_PEER_COUNT]  = { 900.0, 2500.0,  40.0, 150.0,  60.0 };
+    double bandwidths[SUP_PEER_COUNT] = { 100.0,    5.0, 800.0, 300.0, 900.0 };
+    int connects[SUP_PEER_COUNT]      = {     1,      1,     1,     0,     1 };
+
+    BRPeerQuality qualities[SUP_PEER_COUNT];
+    for (size_t index = 0; index < SUP_PEER_COUNT; index++)
+        qualities[index] = BR_PEER_QUALITY_NONE;
+
+    // With no history every peer is the same; the ordering is left to the caller.
+    success &= (0 == BRPeerQualityCompare (&qualities[0], &qualities[1]));
+
+    // A session with every peer
+    for (size_t round = 0; round < 10; round++)
+        for (size_t index = 0; index < SUP_PEER_COUNT; index++) {
+            BRPeerQualityAddOutcome (&qualities[index], connects[index]);
+            if (connects[index]) {
+                BRPeerQualityAddLatency   (&qualities[index], latencies[index]);
+                BRPeerQualityAddBandwidth (&qualities[index], bandwidths[index]);
+            }
+        }
+
+    // ... in which peer 4 misbehaves
+    BRPeerQualityAddMisbehavior (&qualities[4]);
+
+    // The next session prefers the historically fast peer; the time to first response is that of
+    // the best peer, not that of whichever peer was tried first.
+    size_t best = 0;
+    for (size_t index = 1; index < SUP_PEER_COUNT; index++)
+        if (-1 == BRPeerQualityCompare (&qualities[index], &qualities[best])) best = index;
+    success &= (2 == best);
+
+    // An unknown peer ranks ahead of a slow, or failing, peer but behind a fast one.
+    BRPeerQuality unknown = BR_PEER_QUALITY_NONE;
+    success &= (-1 == BRPeerQualityCompare (&qualities[2], &unknown));
+    success &= (+1 == BRPeerQualityCompare (&qualities[1], &unknown));
+    success &= (+1 == BRPeerQualityCompare (&qualities[3], &unknown));
+
+    // Misbehavior is forgiven with successes
+    double misbehavingScore = BRPeerQualityScore (&qualities[4]);
+    BRPeerQualityAddOutcome (&qualities[4], 1);
+    success &= (0 == qualities[4].misbehavior && BRPeerQualityScore (&qualities[4]) > misbehavingScore);
+
+    // Serialize and parse
+    uint8_t bytes[BR_PEER_QUALITY_SERIALIZED_SIZE];
+    success &= (BR_PEER_QUALITY_SERIALIZED_SIZE == BRPeerQualitySerialize (&qualities[2], NULL, 0));
+    success &= (BR_PEER_QUALITY_SERIALIZED_SIZE == BRPeerQualitySerialize (&qualities[2], bytes, sizeof (bytes)));
+
+    BRPeerQuality parsed = BRPeerQualityParse (bytes, sizeof (bytes));
+    success &= (parsed.outcomes    == qualities[2].outcomes &&
+                parsed.misbehavior == qualities[2].misbehavior &&
+                fabs (parsed.latency      - qualities[2].latency)      < 0.001 &&
+                fabs (parsed.bandwidth    - qualities[2].bandwidth)    < 0.001 &&
+                fabs (parsed.successRatio - qualities[2].successRatio) < 0.000001);
+
+    parsed = BRPeerQualityParse (bytes, sizeof (bytes) - 1);
+    success &= (0 == parsed.outcomes && 0.0 == parsed.latency);
+
+    return success;
+}
+
 ///
 /// Support Tests
 ///
@@ -526,6 +806,9 @@ int BRRunSupTests (void) {
 
     success &= runSupFileServiceTests();
     success &= runSupFileServiceMultiTests ();
+    success &= runSupFileServiceReplaceTests ();
+    success &= runSupFileServiceWriteBehindTests ();
+    success &= runSupPeerQualityTests ();
     success &= runSupAssertTests();
 
     return success;
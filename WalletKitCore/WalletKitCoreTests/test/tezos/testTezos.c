@@ -26,6 +26,7 @@
 #include "tezos/BRTezosTransfer.h"
 #include "tezos/BRTezosAccount.h"
 #include "tezos/BRTezosEncoder.h"
+#include "blake2/blake2b.h"
 
 static int debug_log = 0;
 
@@ -333,6 +334,41 @@ testEncodeZarith() {
     testZarithNumberEncode(0x20000000000002, "8280808080808010");
 }
 
+static void
+testBlake2b() {
+    uint8_t bytes[1000], hash1[64], hash2[64];
+    for (size_t i = 0; i < sizeof(bytes); i++) bytes[i] = (uint8_t) (i * 7 + 3);
+    
+    // rfc7693 appendix A
+    uint8_t abc[] = { 'a', 'b', 'c' };
+    blake2b(hash1, sizeof(hash1), NULL, 0, abc, sizeof(abc));
+    char hashHex[129] = {0};
+    bin2HexString(hash1, sizeof(hash1), hashHex);
+    assert (0 == strcasecmp("ba80a53f981c4d0d6a2797b69f12f6e94c212f14685ac4b74b12bb6fdbffa2d17d87c5392aab792dc252d5de4533cc9518d38aa8dbf1925ab92386edd4009923", hashHex));
+    
+    // streamed in uneven pieces, across and on block boundaries
+    size_t pieces[] = { 1, 127, 128, 129, 256, 0, 359 };
+    blake2b_ctx ctx;
+    blake2b_init(&ctx, 32, NULL, 0);
+    for (size_t i = 0, offset = 0; i < sizeof(pieces) / sizeof(pieces[0]); offset += pieces[i++]) {
+        blake2b_update(&ctx, &bytes[offset], pieces[i]);
+    }
+    blake2b_final(&ctx, hash1);
+    blake2b(hash2, 32, NULL, 0, bytes, sizeof(bytes));
+    assert (0 == memcmp(hash1, hash2, 32));
+    
+    // the writer hashes what it writes, and grows past its initial capacity
+    BRTezosWriter writer;
+    blake2b_init(&ctx, 32, NULL, 0);
+    tezosWriterInit(&writer, 0, &ctx, NULL);
+    for (size_t i = 0; i < sizeof(bytes); i += 100) tezosWriterAppend(&writer, &bytes[i], 100);
+    BRCryptoData written = tezosWriterTake(&writer);
+    blake2b_final(&ctx, hash1);
+    assert (written.size == sizeof(bytes) && 0 == memcmp(written.bytes, bytes, sizeof(bytes)));
+    assert (0 == memcmp(hash1, hash2, 32));
+    cryptoDataFree(written);
+}
+
 // MARK: - Transaction Tests
 
 static void
@@ -530,6 +566,33 @@ testTransactionSign() {
     BRBase58CheckEncode(hashString, sizeof(hashString), hash.bytes, sizeof(hash.bytes));
     assert (0 == strcmp ("ooRC21UA17amABZekMapQJkn1cZEiqcffGNtZXtBeUW5rMiJBGR", hashString));
     
+    // a seed that isn't the account's signs nothing
+    UInt512 otherSeed = getSeed(testAccount2);
+    assert(0 == tezosTransactionSerializeAndSign(tx, account, otherSeed, lastBlockHash, 0));
+    assert(NULL == tezosTransactionGetSignedBytes(tx, &signedSize2));
+    
+    // the account keeps the key it expanded from its own seed
+    BREd25519Key key1, key2;
+    assert(tezosAccountGetSigningKey(account, seed, &key1));
+    assert(tezosAccountGetSigningKey(account, seed, &key2));
+    assert(0 == memcmp(&key1, &key2, sizeof(BREd25519Key)));
+    assert(!tezosAccountGetSigningKey(account, otherSeed, &key2));
+    BREd25519KeyClean(&key1);
+    BREd25519KeyClean(&key2);
+    assert(tezosTransactionSerializeAndSign(tx, account, seed, lastBlockHash, 0) > 0);
+    
+    // fee estimation writes the operation with an empty signature, and hashes it as it is written
+    size_t estimateSize = tezosTransactionSerializeForFeeEstimation(tx, account, lastBlockHash, 0);
+    signedBytes = tezosTransactionGetSignedBytes(tx, &signedSize2);
+    assert(estimateSize == signedSize2);
+    uint8_t emptySignature[64] = {0};
+    assert(0 == memcmp(&signedBytes[signedSize2 - 64], emptySignature, 64));
+    
+    uint8_t digest[32];
+    blake2b(digest, sizeof(digest), NULL, 0, signedBytes, signedSize2);
+    hash = tezosTransactionGetHash(tx);
+    assert(0 == memcmp(&hash.bytes[2], digest, sizeof(digest)));
+    
     tezosAddressFree(targetAddress);
     tezosAddressFree(sourceAddress);
     tezosTransferFree(transfer);
@@ -624,6 +687,7 @@ tezosWalletTests() {
 static void
 tezosEncoderTests() {
     testEncodeZarith();
+    testBlake2b();
 }
 
 // MARK: -
@@ -121,6 +121,49 @@ extern "C" {
 
     DECLARE_CRYPTO_GIVE_TAKE (BRCryptoAccount, cryptoAccount);
 
+    /**
+     * A Signing Session holds the seed derived from a paperKey so that many transfers can be
+     * signed, with `cryptoWalletManagerSignWithSession()`, while paying for the PBKDF2 seed
+     * derivation once.  The BTC and ETH BIP32 chain keys are derived from the seed up front as
+     * well.  The seed and keys are held in their own page of memory, locked against swapping when
+     * the platform allows it, and zeroed by `cryptoSigningSessionClose()` or when the last
+     * reference is given.
+     */
+    typedef struct BRCryptoSigningSessionRecord *BRCryptoSigningSession;
+
+    /**
+     * Create a Signing Session from a paperKey.  As with `cryptoAccountCreate()` there is no
+     * check on the paperKey.
+     *
+     * @param paperKey the paper key
+     *
+     * @return The Signing Session, or NULL if memory for the seed could not be allocated.
+     */
+    extern BRCryptoSigningSession
+    cryptoSigningSessionCreate (const char *paperKey);
+
+    /**
+     * Zero the session's seed and keys.  Any subsequent signing with the session fails.
+     */
+    extern void
+    cryptoSigningSessionClose (BRCryptoSigningSession session);
+
+    /**
+     * Check if the session is closed by reading back the memory of the seed and keys and
+     * confirming that it is entirely zero.
+     */
+    extern BRCryptoBoolean
+    cryptoSigningSessionIsClosed (BRCryptoSigningSession session);
+
+    /**
+     * Check if the memory of the seed and keys is locked against being swapped to disk.  Locking may fail when,
+     * for example, the process exceeds its locked memory limit; the session remains usable.
+     */
+    extern BRCryptoBoolean
+    cryptoSigningSessionIsLocked (BRCryptoSigningSession session);
+
+    DECLARE_CRYPTO_GIVE_TAKE (BRCryptoSigningSession, cryptoSigningSession);
+
 #ifdef __cplusplus
 }
 #endif
@@ -169,6 +169,16 @@ extern "C" {
                              BRCryptoTransfer transfer,
                              const char *paperKey);
 
+    /**
+     * Sign `transfer` with the keys held by `session`, avoiding the seed derivation that
+     * `cryptoWalletManagerSign()` performs on every call.  Fails if `session` is closed.
+     */
+    extern BRCryptoBoolean
+    cryptoWalletManagerSignWithSession (BRCryptoWalletManager cwm,
+                                        BRCryptoWallet wallet,
+                                        BRCryptoTransfer transfer,
+                                        BRCryptoSigningSession session);
+
     extern void
     cryptoWalletManagerSubmit (BRCryptoWalletManager cwm,
                                BRCryptoWallet wid,
@@ -47,13 +47,14 @@
 // BIP38 is a method for encrypting private keys with a passphrase
 // https://github.com/bitcoin/bips/blob/master/bip-0038.mediawiki
 
-static UInt256 _BRBIP38DerivePassfactor(uint8_t flag, const uint8_t *entropy, const char *passphrase)
+static UInt256 _BRBIP38DerivePassfactor(uint8_t flag, const uint8_t *entropy, const char *passphrase,
+                                        size_t threadCount)
 {
     size_t len = strlen(passphrase);
     UInt256 prefactor, passfactor;
     
-    BRScrypt(&prefactor, sizeof(prefactor), passphrase, len, entropy, (flag & BIP38_LOTSEQUENCE_FLAG) ? 4 : 8,
-             BIP38_SCRYPT_N, BIP38_SCRYPT_R, BIP38_SCRYPT_P);
+    BRScryptParallel(&prefactor, sizeof(prefactor), passphrase, len, entropy, (flag & BIP38_LOTSEQUENCE_FLAG) ? 4 : 8,
+                     BIP38_SCRYPT_N, BIP38_SCRYPT_R, BIP38_SCRYPT_P, threadCount);
     
     if (flag & BIP38_LOTSEQUENCE_FLAG) { // passfactor = SHA256(SHA256(prefactor + entropy))
         uint8_t d[sizeof(prefactor) + sizeof(uint64_t)];
@@ -104,9 +105,9 @@ int BRBIP38KeyIsValid(const char *bip38Key)
     else return 0; // invalid prefix
 }
 
-// decrypts a BIP38 key using the given passphrase and returns false if passphrase is incorrect
-// passphrase must be unicode NFC normalized: http://www.unicode.org/reports/tr15/#Norm_Forms
-int BRKeySetBIP38Key(BRKey *key, const char *bip38Key, const char *passphrase, BRAddressParams params)
+// same as BRKeySetBIP38Key(), with the scrypt lanes computed on up to threadCount threads at once
+int BRKeySetBIP38KeyParallel(BRKey *key, const char *bip38Key, const char *passphrase, BRAddressParams params,
+                             size_t threadCount)
 {
     int r = 1;
     uint8_t data[39];
@@ -129,8 +130,8 @@ int BRKeySetBIP38Key(BRKey *key, const char *bip38Key, const char *passphrase, B
         // data = prefix + flag + addresshash + encrypted1 + encrypted2
         UInt128 encrypted1 = UInt128Get(&data[7]), encrypted2 = UInt128Get(&data[23]);
 
-        BRScrypt(&derived, sizeof(derived), passphrase, pwLen, addresshash, sizeof(uint32_t),
-                 BIP38_SCRYPT_N, BIP38_SCRYPT_R, BIP38_SCRYPT_P);
+        BRScryptParallel(&derived, sizeof(derived), passphrase, pwLen, addresshash, sizeof(uint32_t),
+                         BIP38_SCRYPT_N, BIP38_SCRYPT_R, BIP38_SCRYPT_P, threadCount);
         derived1 = *(UInt256 *)&derived, derived2 = *(UInt256 *)&derived.u8[sizeof(UInt256)];
         var_clean(&derived);
         
@@ -148,7 +149,7 @@ int BRKeySetBIP38Key(BRKey *key, const char *bip38Key, const char *passphrase, B
         // data = prefix + flag + addresshash + entropy + encrypted1[0...7] + encrypted2
         const uint8_t *entropy = &data[7];
         UInt128 encrypted1 = UINT128_ZERO, encrypted2 = UInt128Get(&data[23]);
-        UInt256 passfactor = _BRBIP38DerivePassfactor(flag, entropy, passphrase), factorb;
+        UInt256 passfactor = _BRBIP38DerivePassfactor(flag, entropy, passphrase, threadCount), factorb;
         BRECPoint passpoint;
         uint64_t seedb[3];
         
@@ -186,6 +187,13 @@ int BRKeySetBIP38Key(BRKey *key, const char *bip38Key, const char *passphrase, B
     return r;
 }
 
+// decrypts a BIP38 key using the given passphrase and returns false if passphrase is incorrect
+// passphrase must be unicode NFC normalized: http://www.unicode.org/reports/tr15/#Norm_Forms
+int BRKeySetBIP38Key(BRKey *key, const char *bip38Key, const char *passphrase, BRAddressParams params)
+{
+    return BRKeySetBIP38KeyParallel(key, bip38Key, passphrase, params, 1);
+}
+
 // generates an "intermediate code" for an EC multiply mode key
 // salt should be 64bits of random data
 // passphrase must be unicode NFC normalized
@@ -40,6 +40,11 @@ int BRBIP38KeyIsValid(const char *bip38Key);
 // passphrase must be unicode NFC normalized: http://www.unicode.org/reports/tr15/#Norm_Forms
 int BRKeySetBIP38Key(BRKey *key, const char *bip38Key, const char *passphrase, BRAddressParams params);
 
+// same as BRKeySetBIP38Key(), with the scrypt lanes computed on up to threadCount threads at once, or one per cpu if
+// threadCount is 0, each thread needs its own 16MB of memory
+int BRKeySetBIP38KeyParallel(BRKey *key, const char *bip38Key, const char *passphrase, BRAddressParams params,
+                             size_t threadCount);
+
 // generates an "intermediate code" for an EC multiply mode key
 // salt should be 64bits of random data
 // passphrase must be unicode NFC normalized
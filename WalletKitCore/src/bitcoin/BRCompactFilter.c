@@ -0,0 +1,259 @@
+//
+//  BRCompactFilter.c
+//  BRCore
+//
+//  Copyright © 2020 Breadwinner AG.  All rights reserved.
+//
+//  See the LICENSE file at the project root for license information.
+//  See the CONTRIBUTORS file at the project root for a list of contributors.
+
+#include "BRCompactFilter.h"
+#include "support/BRCrypto.h"
+#include "support/BRAddress.h"
+#include "support/BRInt.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// A golomb-coded set (GCS) holds N items hashed to the range [0, N*M). The hashed values are sorted, and the
+// differences between successive values are golomb-rice coded with parameter P: the quotient (delta >> P) is written in
+// unary as that many 1 bits followed by a 0 bit, and the remainder is written as the P least significant bits. Bits are
+// packed most significant bit first.
+
+// returns the high 64 bits of the 128 bit product a*b (portable to targets without a native 128 bit integer type)
+inline static uint64_t _BRMulHigh64(uint64_t a, uint64_t b)
+{
+    uint64_t aLo = (uint32_t)a, aHi = a >> 32, bLo = (uint32_t)b, bHi = b >> 32,
+             lo = aLo*bLo, mid1 = aHi*bLo, mid2 = aLo*bHi, hi = aHi*bHi,
+             carry = ((lo >> 32) + (uint32_t)mid1 + (uint32_t)mid2) >> 32;
+
+    return hi + (mid1 >> 32) + (mid2 >> 32) + carry;
+}
+
+// maps a siphash of data uniformly onto the range [0, f)
+inline static uint64_t _BRCompactFilterHashToRange(const uint8_t *key16, const uint8_t *data, size_t dataLen,
+                                                   uint64_t f)
+{
+    return _BRMulHigh64(BRSip64(key16, data, dataLen), f);
+}
+
+static int _uint64Compare(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return (x < y) ? -1 : (x > y) ? 1 : 0;
+}
+
+typedef struct {
+    uint8_t *data;
+    size_t len, bitPos;
+} BRBitWriter;
+
+inline static void _BRBitWriterWrite(BRBitWriter *w, uint64_t value, unsigned bits)
+{
+    while (bits > 0) {
+        if (w->bitPos/8 >= w->len) {
+            w->len = (w->len + 1)*2;
+            w->data = realloc(w->data, w->len);
+            assert(w->data != NULL);
+            memset(&w->data[w->bitPos/8], 0, w->len - w->bitPos/8);
+        }
+
+        bits--;
+        if ((value >> bits) & 1) w->data[w->bitPos/8] |= (uint8_t)(0x80 >> (w->bitPos % 8));
+        w->bitPos++;
+    }
+}
+
+typedef struct {
+    const uint8_t *data;
+    size_t len, bitPos;
+} BRBitReader;
+
+// returns the next golomb-rice coded delta, or UINT64_MAX if the data is exhausted
+inline static uint64_t _BRBitReaderReadDelta(BRBitReader *r, unsigned p)
+{
+    uint64_t q = 0, rem = 0;
+    uint8_t bit;
+
+    for (;;) { // unary coded quotient
+        if (r->bitPos >= r->len*8) return UINT64_MAX;
+        bit = (r->data[r->bitPos/8] >> (7 - r->bitPos % 8)) & 1;
+        r->bitPos++;
+        if (! bit) break;
+        q++;
+    }
+
+    if (r->bitPos + p > r->len*8) return UINT64_MAX;
+
+    for (unsigned i = 0; i < p; i++) {
+        rem = (rem << 1) | ((r->data[r->bitPos/8] >> (7 - r->bitPos % 8)) & 1);
+        r->bitPos++;
+    }
+
+    return (q << p) | rem;
+}
+
+// returns a newly allocated basic filter for the given items (output scripts) of the block with blockHash
+// items is an array of itemsCount pointers to data of the corresponding length in itemLens
+// duplicate items are only encoded once
+// returns a filter struct that must be freed by calling BRCompactFilterFree()
+BRCompactFilter *BRCompactFilterNew(uint8_t type, UInt256 blockHash, const uint8_t *items[], const size_t itemLens[],
+                                    size_t itemsCount)
+{
+    BRCompactFilter *filter = calloc(1, sizeof(*filter));
+    uint64_t *values = (itemsCount > 0) ? malloc(itemsCount*sizeof(*values)) : NULL, last = 0, q;
+    BRBitWriter w = { NULL, 0, 0 };
+    size_t i, n = 0;
+
+    assert(filter != NULL);
+    assert(values != NULL || itemsCount == 0);
+    assert(items != NULL || itemsCount == 0);
+    filter->type = type;
+    filter->blockHash = blockHash;
+
+    // the range depends on the number of distinct items, so the raw siphash values are sorted and deduplicated first,
+    // for distinct items a siphash collision is vanishingly unlikely, so this is equivalent to deduplicating the items
+    for (i = 0; i < itemsCount; i++) values[i] = BRSip64(blockHash.u8, items[i], itemLens[i]);
+    if (values) qsort(values, itemsCount, sizeof(*values), _uint64Compare);
+
+    for (i = 0; i < itemsCount; i++) {
+        if (i == 0 || values[i] != values[i - 1]) values[n++] = values[i];
+    }
+
+    for (i = 0; i < n; i++) values[i] = _BRMulHigh64(values[i], n*COMPACT_FILTER_BASIC_M);
+
+    for (i = 0; i < n; i++) { // hashing to the range preserves order
+        for (q = (values[i] - last) >> COMPACT_FILTER_BASIC_P; q > 0; q--) _BRBitWriterWrite(&w, 1, 1);
+        _BRBitWriterWrite(&w, 0, 1);
+        _BRBitWriterWrite(&w, (values[i] - last) & ((1ULL << COMPACT_FILTER_BASIC_P) - 1), COMPACT_FILTER_BASIC_P);
+        last = values[i];
+    }
+
+    if (values) free(values);
+    filter->n = n;
+    filter->dataLen = (w.bitPos + 7)/8;
+    filter->data = w.data;
+    return filter;
+}
+
+// buf must contain a serialized filter as found in a "cfilter" message, not including the filter type and block hash
+// returns a filter struct that must be freed by calling BRCompactFilterFree()
+BRCompactFilter *BRCompactFilterParse(uint8_t type, UInt256 blockHash, const uint8_t *buf, size_t bufLen)
+{
+    BRCompactFilter *filter = NULL;
+    size_t len = 0;
+    uint64_t n;
+
+    assert(buf != NULL || bufLen == 0);
+    n = BRVarInt(buf, bufLen, &len);
+
+    if (buf && len > 0 && bufLen <= COMPACT_FILTER_MAX_LENGTH && n <= (bufLen - len)*8) {
+        filter = calloc(1, sizeof(*filter));
+        assert(filter != NULL);
+        filter->type = type;
+        filter->blockHash = blockHash;
+        filter->n = n;
+        filter->dataLen = bufLen - len;
+        filter->data = (filter->dataLen > 0) ? malloc(filter->dataLen) : NULL;
+        assert(filter->data != NULL || filter->dataLen == 0);
+        if (filter->data) memcpy(filter->data, &buf[len], filter->dataLen);
+    }
+
+    return filter;
+}
+
+// returns number of bytes written to buf, or total bufLen needed if buf is NULL
+size_t BRCompactFilterSerialize(const BRCompactFilter *filter, uint8_t *buf, size_t bufLen)
+{
+    size_t off = 0, len;
+
+    assert(filter != NULL);
+    len = BRVarIntSize(filter->n) + filter->dataLen;
+
+    if (buf && len <= bufLen) {
+        off += BRVarIntSet(&buf[off], bufLen - off, filter->n);
+        if (filter->data) memcpy(&buf[off], filter->data, filter->dataLen);
+    }
+
+    return (! buf || len <= bufLen) ? len : 0;
+}
+
+// double-SHA256 of the serialized filter
+UInt256 BRCompactFilterHash(const BRCompactFilter *filter)
+{
+    UInt256 hash;
+    size_t len = BRCompactFilterSerialize(filter, NULL, 0);
+    uint8_t _buf[0x1000], *buf = (len <= sizeof(_buf)) ? _buf : malloc(len);
+
+    assert(buf != NULL);
+    len = BRCompactFilterSerialize(filter, buf, len);
+    BRSHA256_2(&hash, buf, len);
+    if (buf != _buf) free(buf);
+    return hash;
+}
+
+// the filter header that commits to filterHash and all previous filters in the chain
+UInt256 BRCompactFilterHeader(UInt256 filterHash, UInt256 prevHeader)
+{
+    UInt256 hash, data[2] = { filterHash, prevHeader };
+
+    BRSHA256_2(&hash, data, sizeof(data));
+    return hash;
+}
+
+// true if data is matched by filter
+int BRCompactFilterContainsData(const BRCompactFilter *filter, const uint8_t *data, size_t dataLen)
+{
+    const uint8_t *items[] = { data };
+    const size_t itemLens[] = { dataLen };
+
+    assert(data != NULL || dataLen == 0);
+    return BRCompactFilterMatchAny(filter, items, itemLens, 1);
+}
+
+// true if any of the given items is matched by filter
+int BRCompactFilterMatchAny(const BRCompactFilter *filter, const uint8_t *items[], const size_t itemLens[],
+                            size_t itemsCount)
+{
+    BRBitReader r;
+    uint64_t _values[256], *values, f, value = 0, delta;
+    size_t i = 0, j;
+    int match = 0;
+
+    assert(filter != NULL);
+    assert(items != NULL || itemsCount == 0);
+    if (filter->n == 0 || itemsCount == 0) return 0;
+
+    r.data = filter->data;
+    r.len = filter->dataLen;
+    r.bitPos = 0;
+    values = (itemsCount <= sizeof(_values)/sizeof(*_values)) ? _values : malloc(itemsCount*sizeof(*values));
+    assert(values != NULL);
+    f = filter->n*COMPACT_FILTER_BASIC_M;
+    for (j = 0; j < itemsCount; j++) values[j] = _BRCompactFilterHashToRange(filter->blockHash.u8, items[j],
+                                                                             itemLens[j], f);
+    qsort(values, itemsCount, sizeof(*values), _uint64Compare);
+
+    // walk the sorted item hashes and the sorted filter set in step
+    for (j = 0; ! match && j < filter->n; j++) {
+        delta = _BRBitReaderReadDelta(&r, COMPACT_FILTER_BASIC_P);
+        if (delta == UINT64_MAX) break; // truncated filter
+        value += delta;
+
+        while (i < itemsCount && values[i] < value) i++;
+        if (i == itemsCount) break;
+        if (values[i] == value) match = 1;
+    }
+
+    if (values != _values) free(values);
+    return match;
+}
+
+// frees memory allocated for filter
+void BRCompactFilterFree(BRCompactFilter *filter)
+{
+    assert(filter != NULL);
+    if (filter->data) free(filter->data);
+    free(filter);
+}
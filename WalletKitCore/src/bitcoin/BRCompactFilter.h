@@ -0,0 +1,73 @@
+//
+//  BRCompactFilter.h
+//  BRCore
+//
+//  Copyright © 2020 Breadwinner AG.  All rights reserved.
+//
+//  See the LICENSE file at the project root for license information.
+//  See the CONTRIBUTORS file at the project root for a list of contributors.
+
+#ifndef BRCompactFilter_h
+#define BRCompactFilter_h
+
+#include "support/BRInt.h"
+#include <stddef.h>
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// compact block filters are explained in BIP158: https://github.com/bitcoin/bips/blob/master/bip-0158.mediawiki
+// and are served by full nodes as described in BIP157: https://github.com/bitcoin/bips/blob/master/bip-0157.mediawiki
+
+#define COMPACT_FILTER_TYPE_BASIC 0x00
+#define COMPACT_FILTER_BASIC_P    19      // golomb-rice coding parameter
+#define COMPACT_FILTER_BASIC_M    784931  // inverse false positive rate
+#define COMPACT_FILTER_MAX_LENGTH 0x02000000
+
+typedef struct {
+    uint8_t type;
+    UInt256 blockHash; // the first 16 bytes of the block hash are the siphash key
+    uint64_t n; // number of items in the filter
+    uint8_t *data; // golomb-rice coded set, not including the leading item count
+    size_t dataLen;
+} BRCompactFilter;
+
+// returns a newly allocated basic filter for the given items (output scripts) of the block with blockHash
+// items is an array of itemsCount pointers to data of the corresponding length in itemLens
+// duplicate items are only encoded once
+// returns a filter struct that must be freed by calling BRCompactFilterFree()
+BRCompactFilter *BRCompactFilterNew(uint8_t type, UInt256 blockHash, const uint8_t *items[], const size_t itemLens[],
+                                    size_t itemsCount);
+
+// buf must contain a serialized filter as found in a "cfilter" message, not including the filter type and block hash
+// returns a filter struct that must be freed by calling BRCompactFilterFree()
+BRCompactFilter *BRCompactFilterParse(uint8_t type, UInt256 blockHash, const uint8_t *buf, size_t bufLen);
+
+// returns number of bytes written to buf, or total bufLen needed if buf is NULL
+size_t BRCompactFilterSerialize(const BRCompactFilter *filter, uint8_t *buf, size_t bufLen);
+
+// double-SHA256 of the serialized filter
+UInt256 BRCompactFilterHash(const BRCompactFilter *filter);
+
+// the filter header that commits to filterHash and all previous filters in the chain
+UInt256 BRCompactFilterHeader(UInt256 filterHash, UInt256 prevHeader);
+
+// true if data is matched by filter
+int BRCompactFilterContainsData(const BRCompactFilter *filter, const uint8_t *data, size_t dataLen);
+
+// true if any of the given items is matched by filter
+// all items are hashed and sorted, then matched against the filter in a single pass over the coded set, so the cost is
+// linear in the size of the filter plus the number of items instead of their product
+int BRCompactFilterMatchAny(const BRCompactFilter *filter, const uint8_t *items[], const size_t itemLens[],
+                            size_t itemsCount);
+
+// frees memory allocated for filter
+void BRCompactFilterFree(BRCompactFilter *filter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BRCompactFilter_h
@@ -0,0 +1,189 @@
+//
+//  BRHeaderSnapshot.c
+//  BRCore
+//
+//  Copyright © 2020 Breadwinner AG.  All rights reserved.
+//
+//  See the LICENSE file at the project root for license information.
+//  See the CONTRIBUTORS file at the project root for a list of contributors.
+
+#include "BRHeaderSnapshot.h"
+#include "support/BRCrypto.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define HEADER_SNAPSHOT_PREAMBLE_SIZE (4*sizeof(uint32_t))
+#define HEADER_SNAPSHOT_SIG_SIZE      65
+
+struct BRHeaderSnapshotStruct {
+    const uint8_t *headers;
+    uint32_t startHeight;
+    size_t count;
+    void *map; // non-NULL if the snapshot was mapped from a file
+    size_t mapLen;
+};
+
+// returns a newly allocated snapshot referencing buf if it is well formed and signed by signerKey, otherwise NULL
+static BRHeaderSnapshot *_BRHeaderSnapshotVerify(const uint8_t *buf, size_t bufLen, uint32_t magicNumber,
+                                                 BRKey *signerKey)
+{
+    BRHeaderSnapshot *snapshot = NULL;
+    BRKey key;
+    UInt256 md;
+    size_t count, len;
+
+    if (! buf || bufLen < HEADER_SNAPSHOT_PREAMBLE_SIZE + HEADER_SNAPSHOT_SIG_SIZE) return NULL;
+    if (UInt32GetLE(&buf[0]) != HEADER_SNAPSHOT_VERSION || UInt32GetLE(&buf[4]) != magicNumber) return NULL;
+    count = UInt32GetLE(&buf[12]);
+    // bound count by the buffer first, so count*HEADER_SNAPSHOT_HEADER_SIZE can't overflow a 32bit size_t
+    if (count > (bufLen - HEADER_SNAPSHOT_PREAMBLE_SIZE - HEADER_SNAPSHOT_SIG_SIZE)/HEADER_SNAPSHOT_HEADER_SIZE) return NULL;
+    len = HEADER_SNAPSHOT_PREAMBLE_SIZE + count*HEADER_SNAPSHOT_HEADER_SIZE;
+    if (bufLen != len + HEADER_SNAPSHOT_SIG_SIZE) return NULL;
+
+    BRSHA256_2(&md, buf, len);
+
+    if (BRKeyRecoverPubKey(&key, md, &buf[len], HEADER_SNAPSHOT_SIG_SIZE) && BRKeyPubKeyMatch(&key, signerKey)) {
+        snapshot = calloc(1, sizeof(*snapshot));
+        assert(snapshot != NULL);
+        snapshot->headers = &buf[HEADER_SNAPSHOT_PREAMBLE_SIZE];
+        snapshot->startHeight = UInt32GetLE(&buf[8]);
+        snapshot->count = count;
+    }
+
+    BRKeyClean(&key);
+    return snapshot;
+}
+
+// maps the snapshot file at path into memory and verifies it was signed by signerKey for the network with magicNumber
+// returns NULL if the file can't be mapped, is malformed, or the signature doesn't match
+// returns a snapshot that must be freed by calling BRHeaderSnapshotFree()
+BRHeaderSnapshot *BRHeaderSnapshotOpen(const char *path, uint32_t magicNumber, BRKey *signerKey)
+{
+    BRHeaderSnapshot *snapshot = NULL;
+    struct stat st;
+    void *map = MAP_FAILED;
+    int fd;
+
+    assert(path != NULL);
+    assert(signerKey != NULL);
+    fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    close(fd); // the mapping remains valid after the descriptor is closed
+    if (map == MAP_FAILED) return NULL;
+    snapshot = _BRHeaderSnapshotVerify(map, (size_t)st.st_size, magicNumber, signerKey);
+
+    if (snapshot) {
+        snapshot->map = map;
+        snapshot->mapLen = (size_t)st.st_size;
+    }
+    else munmap(map, (size_t)st.st_size);
+
+    return snapshot;
+}
+
+// same as BRHeaderSnapshotOpen() for a snapshot already in memory, buf is not copied and must remain valid until the
+// snapshot is freed
+BRHeaderSnapshot *BRHeaderSnapshotParse(const uint8_t *buf, size_t bufLen, uint32_t magicNumber, BRKey *signerKey)
+{
+    assert(buf != NULL || bufLen == 0);
+    assert(signerKey != NULL);
+    return _BRHeaderSnapshotVerify(buf, bufLen, magicNumber, signerKey);
+}
+
+// serializes the headers of the given contiguous chain of blocks, ordered by height, and signs them with signerKey
+// returns number of bytes written to buf, or total bufLen needed if buf is NULL
+size_t BRHeaderSnapshotSerialize(uint8_t *buf, size_t bufLen, uint32_t magicNumber, BRMerkleBlock *blocks[],
+                                 size_t blocksCount, const BRKey *signerKey)
+{
+    size_t i, off = 0, len;
+    UInt256 md;
+
+    assert(blocks != NULL || blocksCount == 0);
+    assert(signerKey != NULL);
+    if (blocksCount > (SIZE_MAX - HEADER_SNAPSHOT_PREAMBLE_SIZE - HEADER_SNAPSHOT_SIG_SIZE)/HEADER_SNAPSHOT_HEADER_SIZE) {
+        return 0;
+    }
+
+    len = HEADER_SNAPSHOT_PREAMBLE_SIZE + blocksCount*HEADER_SNAPSHOT_HEADER_SIZE;
+    if (! buf) return len + HEADER_SNAPSHOT_SIG_SIZE;
+    if (blocksCount == 0 || blocksCount > UINT32_MAX || bufLen < HEADER_SNAPSHOT_PREAMBLE_SIZE + HEADER_SNAPSHOT_SIG_SIZE ||
+        blocksCount > (bufLen - HEADER_SNAPSHOT_PREAMBLE_SIZE - HEADER_SNAPSHOT_SIG_SIZE)/HEADER_SNAPSHOT_HEADER_SIZE) return 0;
+
+    for (i = 1; i < blocksCount; i++) { // blocks must form a chain
+        if (! UInt256Eq(blocks[i]->prevBlock, blocks[i - 1]->blockHash)) return 0;
+    }
+
+    UInt32SetLE(&buf[off], HEADER_SNAPSHOT_VERSION);
+    off += sizeof(uint32_t);
+    UInt32SetLE(&buf[off], magicNumber);
+    off += sizeof(uint32_t);
+    UInt32SetLE(&buf[off], blocks[0]->height);
+    off += sizeof(uint32_t);
+    UInt32SetLE(&buf[off], (uint32_t)blocksCount);
+    off += sizeof(uint32_t);
+
+    for (i = 0; i < blocksCount; i++) {
+        UInt32SetLE(&buf[off], blocks[i]->version);
+        off += sizeof(uint32_t);
+        UInt256Set(&buf[off], blocks[i]->prevBlock);
+        off += sizeof(UInt256);
+        UInt256Set(&buf[off], blocks[i]->merkleRoot);
+        off += sizeof(UInt256);
+        UInt32SetLE(&buf[off], blocks[i]->timestamp);
+        off += sizeof(uint32_t);
+        UInt32SetLE(&buf[off], blocks[i]->target);
+        off += sizeof(uint32_t);
+        UInt32SetLE(&buf[off], blocks[i]->nonce);
+        off += sizeof(uint32_t);
+    }
+
+    BRSHA256_2(&md, buf, off);
+    if (BRKeyCompactSign(signerKey, &buf[off], bufLen - off, md) != HEADER_SNAPSHOT_SIG_SIZE) return 0;
+    return off + HEADER_SNAPSHOT_SIG_SIZE;
+}
+
+// height of the first header in the snapshot
+uint32_t BRHeaderSnapshotStartHeight(const BRHeaderSnapshot *snapshot)
+{
+    assert(snapshot != NULL);
+    return snapshot->startHeight;
+}
+
+// number of headers in the snapshot
+size_t BRHeaderSnapshotCount(const BRHeaderSnapshot *snapshot)
+{
+    assert(snapshot != NULL);
+    return snapshot->count;
+}
+
+// returns a newly allocated header-only block for the header at idx, with its height set
+// result must be freed by calling BRMerkleBlockFree()
+BRMerkleBlock *BRHeaderSnapshotBlock(const BRHeaderSnapshot *snapshot, size_t idx)
+{
+    BRMerkleBlock *block;
+
+    assert(snapshot != NULL);
+    assert(idx < snapshot->count);
+    block = BRMerkleBlockParse(&snapshot->headers[idx*HEADER_SNAPSHOT_HEADER_SIZE], HEADER_SNAPSHOT_HEADER_SIZE);
+    if (block) block->height = snapshot->startHeight + (uint32_t)idx;
+    return block;
+}
+
+// unmaps the snapshot file, if any, and frees memory allocated for snapshot
+void BRHeaderSnapshotFree(BRHeaderSnapshot *snapshot)
+{
+    assert(snapshot != NULL);
+    if (snapshot->map) munmap(snapshot->map, snapshot->mapLen);
+    free(snapshot);
+}
@@ -0,0 +1,67 @@
+//
+//  BRHeaderSnapshot.h
+//  BRCore
+//
+//  Copyright © 2020 Breadwinner AG.  All rights reserved.
+//
+//  See the LICENSE file at the project root for license information.
+//  See the CONTRIBUTORS file at the project root for a list of contributors.
+
+#ifndef BRHeaderSnapshot_h
+#define BRHeaderSnapshot_h
+
+#include "BRMerkleBlock.h"
+#include "support/BRKey.h"
+#include <stddef.h>
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A header snapshot is a signed, contiguous run of block headers that can be memory mapped and used to bootstrap the
+// chain past the hardcoded checkpoints. All fields are little endian:
+//
+// uint32_t version | uint32_t magicNumber | uint32_t startHeight | uint32_t count | count*80 byte headers | signature
+//
+// The header at index i has height startHeight + i. The signature is a 65 byte compact signature of the double-SHA256
+// of everything preceding it. The signature only authenticates the publisher, linkage and proof-of-work are verified
+// separately when the headers are loaded.
+
+#define HEADER_SNAPSHOT_VERSION     1
+#define HEADER_SNAPSHOT_HEADER_SIZE 80
+
+typedef struct BRHeaderSnapshotStruct BRHeaderSnapshot;
+
+// maps the snapshot file at path into memory and verifies it was signed by signerKey for the network with magicNumber
+// returns NULL if the file can't be mapped, is malformed, or the signature doesn't match
+// returns a snapshot that must be freed by calling BRHeaderSnapshotFree()
+BRHeaderSnapshot *BRHeaderSnapshotOpen(const char *path, uint32_t magicNumber, BRKey *signerKey);
+
+// same as BRHeaderSnapshotOpen() for a snapshot already in memory, buf is not copied and must remain valid until the
+// snapshot is freed
+BRHeaderSnapshot *BRHeaderSnapshotParse(const uint8_t *buf, size_t bufLen, uint32_t magicNumber, BRKey *signerKey);
+
+// serializes the headers of the given contiguous chain of blocks, ordered by height, and signs them with signerKey
+// returns number of bytes written to buf, or total bufLen needed if buf is NULL
+size_t BRHeaderSnapshotSerialize(uint8_t *buf, size_t bufLen, uint32_t magicNumber, BRMerkleBlock *blocks[],
+                                 size_t blocksCount, const BRKey *signerKey);
+
+// height of the first header in the snapshot
+uint32_t BRHeaderSnapshotStartHeight(const BRHeaderSnapshot *snapshot);
+
+// number of headers in the snapshot
+size_t BRHeaderSnapshotCount(const BRHeaderSnapshot *snapshot);
+
+// returns a newly allocated header-only block for the header at idx, with its height set
+// result must be freed by calling BRMerkleBlockFree()
+BRMerkleBlock *BRHeaderSnapshotBlock(const BRHeaderSnapshot *snapshot, size_t idx);
+
+// unmaps the snapshot file, if any, and frees memory allocated for snapshot
+void BRHeaderSnapshotFree(BRHeaderSnapshot *snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BRHeaderSnapshot_h
@@ -237,9 +237,80 @@ void BRMerkleBlockSetTxHashes(BRMerkleBlock *block, const UInt256 hashes[], size
     if (block->hashes) free(block->hashes);
     block->hashes = (hashesCount > 0) ? malloc(hashesCount*sizeof(UInt256)) : NULL;
     if (block->hashes) memcpy(block->hashes, hashes, hashesCount*sizeof(UInt256));
+    block->hashesCount = (block->hashes) ? hashesCount : 0;
     if (block->flags) free(block->flags);
     block->flags = (flagsLen > 0) ? malloc(flagsLen) : NULL;
     if (block->flags) memcpy(block->flags, flags, flagsLen);
+    block->flagsLen = (block->flags) ? flagsLen : 0;
+}
+
+// number of nodes at the given height in a merkle tree with txCount leaves
+inline static size_t _BRMerkleTreeWidth(size_t txCount, int height)
+{
+    return (txCount + ((size_t)1 << height) - 1) >> height;
+}
+
+// calculates the hash of the node at the given height and position in a merkle tree of txHashes
+static UInt256 _BRMerkleTreeHashR(const UInt256 txHashes[], size_t txCount, int height, size_t pos)
+{
+    UInt256 hashes[2], md;
+    
+    if (height == 0) return txHashes[pos];
+    hashes[0] = _BRMerkleTreeHashR(txHashes, txCount, height - 1, pos*2);
+    hashes[1] = (pos*2 + 1 < _BRMerkleTreeWidth(txCount, height - 1)) ?
+                _BRMerkleTreeHashR(txHashes, txCount, height - 1, pos*2 + 1) : hashes[0];
+    BRSHA256_2(&md, hashes, sizeof(hashes));
+    return md;
+}
+
+// depth first traversal that appends a flag bit for each visited node, and the hash of each node that is either a leaf
+// or has no matched descendants, as described in BIP37
+static void _BRMerkleTreeBuildR(const UInt256 txHashes[], const uint8_t matches[], size_t txCount, int height,
+                                size_t pos, UInt256 *hashes, size_t *hashIdx, uint8_t *flags, size_t *flagIdx)
+{
+    size_t i, end = (pos + 1) << height;
+    uint8_t parentOfMatch = 0;
+    
+    for (i = pos << height; ! parentOfMatch && i < end && i < txCount; i++) parentOfMatch = (matches[i]) ? 1 : 0;
+    if (parentOfMatch) flags[*flagIdx/8] |= (uint8_t)(1 << (*flagIdx % 8));
+    (*flagIdx)++;
+    
+    if (height == 0 || ! parentOfMatch) {
+        hashes[(*hashIdx)++] = _BRMerkleTreeHashR(txHashes, txCount, height, pos);
+    }
+    else {
+        _BRMerkleTreeBuildR(txHashes, matches, txCount, height - 1, pos*2, hashes, hashIdx, flags, flagIdx);
+        
+        if (pos*2 + 1 < _BRMerkleTreeWidth(txCount, height - 1)) {
+            _BRMerkleTreeBuildR(txHashes, matches, txCount, height - 1, pos*2 + 1, hashes, hashIdx, flags, flagIdx);
+        }
+    }
+}
+
+// sets the totalTx, hashes and flags fields of block to the partial merkle tree of the full list of txHashes in the
+// block, matching the txHashes for which the corresponding entry in matches is non-zero
+void BRMerkleBlockSetPartialTree(BRMerkleBlock *block, const UInt256 txHashes[], const uint8_t matches[],
+                                 size_t txCount)
+{
+    int height = _ceil_log2((int)txCount);
+    size_t hashIdx = 0, flagIdx = 0, nodeCount = 0;
+    
+    assert(block != NULL);
+    assert(txHashes != NULL || txCount == 0);
+    assert(matches != NULL || txCount == 0);
+    
+    for (int h = 0; h <= height; h++) nodeCount += _BRMerkleTreeWidth(txCount, h);
+    
+    UInt256 *hashes = (nodeCount > 0) ? malloc(nodeCount*sizeof(*hashes)) : NULL;
+    uint8_t *flags = (nodeCount > 0) ? calloc((nodeCount + 7)/8, sizeof(*flags)) : NULL;
+    
+    assert(hashes != NULL || nodeCount == 0);
+    assert(flags != NULL || nodeCount == 0);
+    if (txCount > 0) _BRMerkleTreeBuildR(txHashes, matches, txCount, height, 0, hashes, &hashIdx, flags, &flagIdx);
+    block->totalTx = (uint32_t)txCount;
+    BRMerkleBlockSetTxHashes(block, hashes, hashIdx, flags, (flagIdx + 7)/8);
+    if (hashes) free(hashes);
+    if (flags) free(flags);
 }
 
 // recursively walks the merkle tree to calculate the merkle root
@@ -77,6 +77,11 @@ size_t BRMerkleBlockTxHashes(const BRMerkleBlock *block, UInt256 *txHashes, size
 void BRMerkleBlockSetTxHashes(BRMerkleBlock *block, const UInt256 hashes[], size_t hashesCount,
                               const uint8_t *flags, size_t flagsLen);
 
+// sets the totalTx, hashes and flags fields of block to the partial merkle tree of the full list of txHashes in the
+// block, matching the txHashes for which the corresponding entry in matches is non-zero
+void BRMerkleBlockSetPartialTree(BRMerkleBlock *block, const UInt256 txHashes[], const uint8_t matches[],
+                                 size_t txCount);
+
 // true if merkle tree and timestamp are valid, and proof-of-work matches the stated difficulty target
 // NOTE: this only checks if the block difficulty matches the difficulty target in the header, it does not check if the
 // target is correct for the block's height in the chain - use BRMerkleBlockVerifyDifficulty() for that
@@ -84,6 +84,14 @@
 // - if at any point tx messages consume enough wallet addresses to drop below the bip32 chain gap limit, more addresses
 //   are generated and local peer sends filterload with an updated bloom filter
 // - after filterload is sent, getdata is sent to re-request recent blocks that may contain new tx matching the filter
+//
+// in compact filter mode (BIP157) no bloom filter is sent to the remote peer, and only headers are synced by the peer:
+// - local peer sends getheaders, and immediately sends getheaders again each time 2000 headers are received
+// - peer manager sends getcfheaders and getcfilters for batches of blocks after earliestKeyTime
+// - remote peer responds with cfheaders, and a cfilter message for each block in the batch
+// - peer manager matches each filter against wallet scripts, and sends getdata for the full block when one matches
+// - remote peer responds with a block message, containing all tx in the block
+// - a block inv from the remote peer is answered with getheaders from the last known header
 
 typedef enum {
     inv_undefined = 0,
@@ -107,8 +115,8 @@ typedef struct {
     uint32_t version, lastblock, earliestKeyTime, currentBlockHeight;
     double startTime, pingTime;
     volatile double disconnectTime, mempoolTime;
-    int sentVerack, gotVerack, sentGetaddr, sentFilter, sentGetdata, sentMempool, sentGetblocks;
-    UInt256 lastBlockHash;
+    int sentVerack, gotVerack, sentGetaddr, sentFilter, sentGetdata, sentMempool, sentGetblocks, compactFilterMode;
+    UInt256 lastBlockHash, lastHeaderHash;
     BRMerkleBlock *currentBlock;
     UInt256 *currentBlockTxHashes, *knownBlockHashes, *knownTxHashes;
     BRSet *knownTxHashSet;
@@ -121,6 +129,12 @@ typedef struct {
     void (*hasTx)(void *info, UInt256 txHash);
     void (*rejectedTx)(void *info, UInt256 txHash, uint8_t code);
     void (*relayedBlock)(void *info, BRMerkleBlock *block);
+    void (*relayedFilterHeaders)(void *info, UInt256 stopHash, UInt256 prevHeader, const UInt256 filterHashes[],
+                                 size_t hashesCount);
+    void (*relayedFilter)(void *info, BRCompactFilter *filter);
+    void (*relayedFullBlock)(void *info, BRMerkleBlock *block, const UInt256 txHashes[], BRTransaction *txs[],
+                             size_t txCount);
+    int (*wantsTx)(void *info, const BRTransactionView *tx);
     void (*notfound)(void *info, const UInt256 txHashes[], size_t txCount, const UInt256 blockHashes[],
                      size_t blockCount);
     void (*setFeePerKb)(void *info, uint64_t feePerKb);
@@ -345,7 +359,8 @@ static int _BRPeerAcceptInvMessage(BRPeer *peer, const uint8_t *msg, size_t msgL
             off += 36;
         }
 
-        if (txCount > 0 && ! ctx->sentFilter && ! ctx->sentMempool && ! ctx->sentGetblocks) {
+        if (txCount > 0 && ! ctx->sentFilter && ! ctx->sentMempool && ! ctx->sentGetblocks &&
+            ! ctx->compactFilterMode) {
             peer_log(peer, "got inv message before loading a filter");
             r = 0;
         }
@@ -359,7 +374,11 @@ static int _BRPeerAcceptInvMessage(BRPeer *peer, const uint8_t *msg, size_t msgL
             r = 0;
         }
         else {
-            if (! ctx->sentFilter && ! ctx->sentGetblocks) blockCount = 0;
+            if (ctx->compactFilterMode && blockCount > 0 && ! UInt256IsZero(ctx->lastHeaderHash)) {
+                BRPeerSendGetheaders(peer, &ctx->lastHeaderHash, 1, UINT256_ZERO); // new blocks are synced as headers
+            }
+
+            if (ctx->compactFilterMode || (! ctx->sentFilter && ! ctx->sentGetblocks)) blockCount = 0;
             if (blockCount == 1 && UInt256Eq(ctx->lastBlockHash, UInt256Get(blocks[0]))) blockCount = 0;
             if (blockCount == 1) ctx->lastBlockHash = UInt256Get(blocks[0]);
 
@@ -383,10 +402,20 @@ static int _BRPeerAcceptInvMessage(BRPeer *peer, const uint8_t *msg, size_t msgL
                 if (BRSetContains(ctx->knownTxHashSet, &hash)) {
                     if (ctx->hasTx) ctx->hasTx(ctx->info, hash);
                 }
-                else txHashes[j++] = hash;
+                else txHashes[j++] = hash; // in compact filter mode every relayed tx is fetched and matched locally
             }
             
             _BRPeerAddKnownTxHashes(peer, txHashes, j);
+
+            if (ctx->compactFilterMode && array_count(ctx->knownTxHashes) > MAX_GETDATA_HASHES) {
+                // without a filter every relayed tx becomes known, so forget the oldest ones
+                array_rm_range(ctx->knownTxHashes, 0, array_count(ctx->knownTxHashes)/3);
+                BRSetClear(ctx->knownTxHashSet);
+                
+                for (i = array_count(ctx->knownTxHashes); i > 0; i--) {
+                    BRSetAdd(ctx->knownTxHashSet, &ctx->knownTxHashes[i - 1]);
+                }
+            }
             if (j > 0 || blockCount > 0) BRPeerSendGetdata(peer, txHashes, j, blockHashes, blockCount);
     
             // to improve chain download performance, if we received 500 block hashes, request the next 500 block hashes
@@ -415,27 +444,31 @@ static int _BRPeerAcceptInvMessage(BRPeer *peer, const uint8_t *msg, size_t msgL
 static int _BRPeerAcceptTxMessage(BRPeer *peer, const uint8_t *msg, size_t msgLen)
 {
     BRPeerContext *ctx = (BRPeerContext *)peer;
-    BRTransaction *tx = BRTransactionParse(msg, msgLen);
+    BRTransactionView view;
+    BRTransaction *tx = NULL;
     UInt256 txHash;
-    int r = 1;
+    int r = 1, isViewed = (BRTransactionViewParse(&view, msg, msgLen) > 0);
 
-    if (! tx) {
+    // most relayed tx are bloom filter false positives, so a tx is only parsed if the wallet wants it
+    if (! isViewed || ! ctx->wantsTx || ctx->wantsTx(ctx->info, &view)) tx = BRTransactionParse(msg, msgLen);
+
+    if (! isViewed && ! tx) {
         peer_log(peer, "malformed tx message with length: %zu", msgLen);
         r = 0;
     }
     else if (! ctx->sentFilter && ! ctx->sentGetdata) {
         peer_log(peer, "got tx message before loading filter");
-        BRTransactionFree(tx);
+        if (tx) BRTransactionFree(tx);
         r = 0;
     }
     else {
-        txHash = tx->txHash;
+        txHash = (tx) ? tx->txHash : view.txHash;
         peer_log(peer, "got tx: %s", u256hex(txHash));
 
-        if (ctx->relayedTx) {
+        if (tx && ctx->relayedTx) {
             ctx->relayedTx(ctx->info, tx);
         }
-        else BRTransactionFree(tx);
+        else if (tx) BRTransactionFree(tx);
 
         if (ctx->currentBlock) { // we're collecting tx messages for a merkleblock
             for (size_t i = array_count(ctx->currentBlockTxHashes); i > 0; i--) {
@@ -474,15 +507,22 @@ static int _BRPeerAcceptHeadersMessage(BRPeer *peer, const uint8_t *msg, size_t
         // headers immediately, and switch to requesting blocks when we receive a header newer than earliestKeyTime
         uint32_t timestamp = (count > 0) ? UInt32GetLE(&msg[off + 81*(count - 1) + 68]) : 0;
     
-        if (count >= 2000 || (timestamp > 0 && timestamp + 7*24*60*60 + BLOCK_MAX_TIME_DRIFT >= ctx->earliestKeyTime)) {
+        if (count >= 2000 || ctx->compactFilterMode ||
+            (timestamp > 0 && timestamp + 7*24*60*60 + BLOCK_MAX_TIME_DRIFT >= ctx->earliestKeyTime)) {
             size_t last = 0;
             time_t now = time(NULL);
             UInt256 locators[2];
             
-            BRSHA256_2(&locators[0], &msg[off + 81*(count - 1)], 80);
-            BRSHA256_2(&locators[1], &msg[off], 80);
+            if (count > 0) {
+                BRSHA256_2(&locators[0], &msg[off + 81*(count - 1)], 80);
+                BRSHA256_2(&locators[1], &msg[off], 80);
+            }
 
-            if (timestamp > 0 && timestamp + 7*24*60*60 + BLOCK_MAX_TIME_DRIFT >= ctx->earliestKeyTime) {
+            if (ctx->compactFilterMode) { // only headers are synced, fewer than 2000 means we're caught up
+                if (count > 0) ctx->lastHeaderHash = locators[0];
+                if (count >= 2000) BRPeerSendGetheaders(peer, locators, 2, UINT256_ZERO);
+            }
+            else if (timestamp > 0 && timestamp + 7*24*60*60 + BLOCK_MAX_TIME_DRIFT >= ctx->earliestKeyTime) {
                 // request blocks for the remainder of the chain
                 timestamp = (++last < count) ? UInt32GetLE(&msg[off + 81*last + 68]) : 0;
 
@@ -559,9 +599,15 @@ static int _BRPeerAcceptGetdataMessage(BRPeer *peer, const uint8_t *msg, size_t
                     if (ctx->requestedTx) tx = ctx->requestedTx(ctx->info, hash);
 
                     if (tx && BRTransactionVSize(tx) < TX_MAX_SIZE) {
-                        uint8_t buf[BRTransactionSerialize(tx, NULL, 0)];
-                        size_t bufLen = BRTransactionSerialize(tx, buf, sizeof(buf));
-                        char txHex[bufLen*2 + 1];
+                        uint8_t *buf;
+                        char *txHex;
+                        size_t bufLen;
+                        
+                        array_new(buf, BRTransactionSize(tx)); // on the heap, a tx can be up to TX_MAX_SIZE
+                        bufLen = BRTransactionSerializeAppend(tx, &buf);
+                        txHex = malloc(bufLen*2 + 1);
+                        assert(txHex != NULL);
+                        txHex[0] = '\0';
                         
                         for (size_t j = 0; j < bufLen; j++) {
                             sprintf(&txHex[j*2], "%02x", buf[j]);
@@ -569,6 +615,8 @@ static int _BRPeerAcceptGetdataMessage(BRPeer *peer, const uint8_t *msg, size_t
                         
                         peer_log(peer, "publishing tx: %s", txHex);
                         BRPeerSendMessage(peer, buf, bufLen, MSG_TX);
+                        free(txHex);
+                        array_free(buf);
                         break;
                     }
                     
@@ -762,6 +810,179 @@ static int _BRPeerAcceptMerkleblockMessage(BRPeer *peer, const uint8_t *msg, siz
     return r;
 }
 
+// described in BIP157: https://github.com/bitcoin/bips/blob/master/bip-0157.mediawiki
+static int _BRPeerAcceptCfheadersMessage(BRPeer *peer, const uint8_t *msg, size_t msgLen)
+{
+    BRPeerContext *ctx = (BRPeerContext *)peer;
+    size_t off = 1 + sizeof(UInt256) + sizeof(UInt256), len = 0, count;
+    int r = 1;
+
+    count = (off <= msgLen) ? (size_t)BRVarInt(&msg[off], msgLen - off, &len) : 0;
+
+    if (len == 0 || off + len + sizeof(UInt256)*count > msgLen) {
+        peer_log(peer, "malformed cfheaders message, length is %zu, should be %zu for %zu filter hash(es)", msgLen,
+                 off + BRVarIntSize(count) + sizeof(UInt256)*count, count);
+        r = 0;
+    }
+    else if (! ctx->compactFilterMode) {
+        peer_log(peer, "got cfheaders message before requesting compact filters");
+    }
+    else if (msg[0] != COMPACT_FILTER_TYPE_BASIC) {
+        peer_log(peer, "dropping cfheaders message with unknown filter type %"PRIu8, msg[0]);
+    }
+    else {
+        UInt256 stopHash = UInt256Get(&msg[1]), prevHeader = UInt256Get(&msg[1 + sizeof(UInt256)]),
+                _hashes[128], *hashes = (count <= 128) ? _hashes : malloc(count*sizeof(UInt256));
+
+        assert(hashes != NULL);
+        peer_log(peer, "got cfheaders with %zu filter hash(es)", count);
+        off += len;
+
+        for (size_t i = 0; i < count; i++) {
+            hashes[i] = UInt256Get(&msg[off]);
+            off += sizeof(UInt256);
+        }
+
+        if (ctx->relayedFilterHeaders) ctx->relayedFilterHeaders(ctx->info, stopHash, prevHeader, hashes, count);
+        if (hashes != _hashes) free(hashes);
+    }
+
+    return r;
+}
+
+// described in BIP157: https://github.com/bitcoin/bips/blob/master/bip-0157.mediawiki
+static int _BRPeerAcceptCfilterMessage(BRPeer *peer, const uint8_t *msg, size_t msgLen)
+{
+    BRPeerContext *ctx = (BRPeerContext *)peer;
+    size_t off = 1 + sizeof(UInt256), len = 0, filterLen;
+    BRCompactFilter *filter = NULL;
+    int r = 1;
+
+    filterLen = (off <= msgLen) ? (size_t)BRVarInt(&msg[off], msgLen - off, &len) : 0;
+    if (len > 0 && off + len + filterLen <= msgLen) {
+        filter = BRCompactFilterParse(msg[0], UInt256Get(&msg[1]), &msg[off + len], filterLen);
+    }
+
+    if (! filter) {
+        peer_log(peer, "malformed cfilter message with length: %zu", msgLen);
+        r = 0;
+    }
+    else if (! ctx->compactFilterMode) {
+        peer_log(peer, "got cfilter message before requesting compact filters");
+        BRCompactFilterFree(filter);
+    }
+    else if (filter->type != COMPACT_FILTER_TYPE_BASIC) {
+        peer_log(peer, "dropping cfilter message with unknown filter type %"PRIu8, filter->type);
+        BRCompactFilterFree(filter);
+    }
+    else if (ctx->relayedFilter) {
+        ctx->relayedFilter(ctx->info, filter);
+    }
+    else BRCompactFilterFree(filter);
+
+    return r;
+}
+
+// true if the wallet wants the tx viewed at index in a full block, or if it spends an earlier wanted tx in the block
+static int _BRPeerWantsBlockTx(BRPeerContext *ctx, const BRTransactionView *view, const UInt256 txHashes[],
+                               BRTransaction *txs[], size_t index)
+{
+    BRTxViewCursor cur = { 0 };
+    BRTxInputView in;
+    int r = (! ctx->wantsTx || ctx->wantsTx(ctx->info, view));
+
+    // the wallet doesn't have the earlier tx until the block is relayed, so wanting a tx can't depend on it
+    while (! r && BRTransactionViewNextInput(view, &cur, &in)) {
+        for (size_t i = index; ! r && i > 0; i--) {
+            if (txs[i - 1] && UInt256Eq(in.txHash, txHashes[i - 1])) r = 1;
+        }
+    }
+
+    return r;
+}
+
+static int _BRPeerAcceptBlockMessage(BRPeer *peer, const uint8_t *msg, size_t msgLen)
+{
+    BRPeerContext *ctx = (BRPeerContext *)peer;
+    BRTransactionView view;
+    BRMerkleBlock *block = NULL;
+    size_t i, off = 80, len = 0, count = 0;
+    int r = 1;
+
+    if (! ctx->compactFilterMode) { // full blocks are only requested in compact filter mode
+        peer_log(peer, "dropping block, length %zu, not requested", msgLen);
+        return r;
+    }
+
+    block = BRMerkleBlockParse(msg, (msgLen < 80) ? msgLen : 80);
+    if (block) count = (size_t)BRVarInt(&msg[off], msgLen - off, &len);
+    off += len;
+
+    // a serialized tx is at least 60 bytes, so this limits allocation for a malformed tx count
+    if (! block || len == 0 || count == 0 || count > (msgLen - off)/60) {
+        peer_log(peer, "malformed block message with length: %zu", msgLen);
+        if (block) BRMerkleBlockFree(block);
+        r = 0;
+    }
+    else if (! ctx->sentGetdata) {
+        peer_log(peer, "got block message before requesting full blocks");
+        BRMerkleBlockFree(block);
+        r = 0;
+    }
+    else {
+        BRTransaction **txs = calloc(count, sizeof(*txs));
+        UInt256 *txHashes = malloc(count*sizeof(*txHashes));
+        uint8_t *matches = calloc(count, sizeof(*matches));
+
+        assert(txs != NULL);
+        assert(txHashes != NULL);
+        assert(matches != NULL);
+
+        for (i = 0; r && i < count; i++) {
+            len = (off < msgLen) ? BRTransactionViewParse(&view, &msg[off], msgLen - off) : 0;
+
+            if (len > 0) { // only tx the wallet wants are parsed, the rest are only needed for the merkle root
+                txHashes[i] = view.txHash;
+                if (_BRPeerWantsBlockTx(ctx, &view, txHashes, txs, i)) txs[i] = BRTransactionParse(&msg[off], len);
+                off += len;
+            }
+            else {
+                txs[i] = (off < msgLen) ? BRTransactionParse(&msg[off], msgLen - off) : NULL;
+                if (txs[i]) off += BRTransactionSerialize(txs[i], NULL, 0);
+                if (! txs[i] || off > msgLen) r = 0;
+                else txHashes[i] = txs[i]->txHash;
+            }
+        }
+
+        if (r) BRMerkleBlockSetPartialTree(block, txHashes, matches, count); // tree with only the merkle root
+
+        if (! r) {
+            peer_log(peer, "malformed block message with length: %zu", msgLen);
+        }
+        else if (! BRMerkleBlockIsValid(block, (uint32_t)time(NULL))) {
+            peer_log(peer, "invalid block: %s", u256hex(block->blockHash));
+            r = 0;
+        }
+        else {
+            peer_log(peer, "got block %s with %zu tx", u256hex(block->blockHash), count);
+        }
+
+        if (r && ctx->relayedFullBlock) {
+            ctx->relayedFullBlock(ctx->info, block, txHashes, txs, count);
+        }
+        else {
+            for (i = 0; i < count; i++) if (txs[i]) BRTransactionFree(txs[i]);
+            BRMerkleBlockFree(block);
+        }
+
+        free(matches);
+        free(txHashes);
+        free(txs);
+    }
+
+    return r;
+}
+
 // described in BIP61: https://github.com/bitcoin/bips/blob/master/bip-0061.mediawiki
 static int _BRPeerAcceptRejectMessage(BRPeer *peer, const uint8_t *msg, size_t msgLen)
 {
@@ -860,6 +1081,9 @@ static int _BRPeerAcceptMessage(BRPeer *peer, const uint8_t *msg, size_t msgLen,
     else if (strncmp(MSG_MERKLEBLOCK, type, 12) == 0) r = _BRPeerAcceptMerkleblockMessage(peer, msg, msgLen);
     else if (strncmp(MSG_REJECT, type, 12) == 0) r = _BRPeerAcceptRejectMessage(peer, msg, msgLen);
     else if (strncmp(MSG_FEEFILTER, type, 12) == 0) r = _BRPeerAcceptFeeFilterMessage(peer, msg, msgLen);
+    else if (strncmp(MSG_CFHEADERS, type, 12) == 0) r = _BRPeerAcceptCfheadersMessage(peer, msg, msgLen);
+    else if (strncmp(MSG_CFILTER, type, 12) == 0) r = _BRPeerAcceptCfilterMessage(peer, msg, msgLen);
+    else if (strncmp(MSG_BLOCK, type, 12) == 0) r = _BRPeerAcceptBlockMessage(peer, msg, msgLen);
     else peer_log(peer, "dropping %s, length %zu, not implemented", type, msgLen);
 
     return r;
@@ -1198,6 +1422,38 @@ void BRPeerSetCallbacks(BRPeer *peer, void *info,
     ctx->threadCleanup = (threadCleanup) ? threadCleanup : _dummyThreadCleanup;
 }
 
+// sets callbacks for syncing with BIP157 compact block filters instead of bloom filtered merkleblocks, the peer syncs
+// using only getheaders, and requests full blocks with getdata (a NULL relayedFilter restores bloom filter mode)
+// void relayedFilterHeaders(void *, UInt256, UInt256, const UInt256[], size_t) - called when a "cfheaders" message is
+//     received from peer with the stop hash, the previous filter header, and the filter hashes
+// void relayedFilter(void *, BRCompactFilter *) - called when a "cfilter" message is received from peer
+// void relayedFullBlock(void *, BRMerkleBlock *, const UInt256[], BRTransaction *[], size_t) - called when a "block"
+//     message is received from peer with the hash of every tx, and each tx that was parsed (NULL if the tx filter
+//     callback didn't want it), the callee is responsible for freeing block and each tx
+void BRPeerSetCompactFilterCallbacks(BRPeer *peer,
+                                     void (*relayedFilterHeaders)(void *info, UInt256 stopHash, UInt256 prevHeader,
+                                                                  const UInt256 filterHashes[], size_t hashesCount),
+                                     void (*relayedFilter)(void *info, BRCompactFilter *filter),
+                                     void (*relayedFullBlock)(void *info, BRMerkleBlock *block,
+                                                              const UInt256 txHashes[], BRTransaction *txs[],
+                                                              size_t txCount))
+{
+    BRPeerContext *ctx = (BRPeerContext *)peer;
+
+    ctx->relayedFilterHeaders = relayedFilterHeaders;
+    ctx->relayedFilter = relayedFilter;
+    ctx->relayedFullBlock = relayedFullBlock;
+    ctx->compactFilterMode = (relayedFilter != NULL);
+}
+
+// sets a callback to filter relayed tx before they're parsed, a tx that isn't wanted is never allocated
+// int wantsTx(void *, const BRTransactionView *) - called with the tx viewed in place when a "tx" or "block" message is
+//     received from peer, a tx is only parsed and relayed if it returns true (a NULL wantsTx parses every tx)
+void BRPeerSetTxFilterCallback(BRPeer *peer, int (*wantsTx)(void *info, const BRTransactionView *tx))
+{
+    ((BRPeerContext *)peer)->wantsTx = wantsTx;
+}
+
 // set earliestKeyTime to wallet creation time in order to speed up initial sync
 void BRPeerSetEarliestKeyTime(BRPeer *peer, uint32_t earliestKeyTime)
 {
@@ -1433,7 +1689,7 @@ void BRPeerSendVersionMessage(BRPeer *peer)
     off += userAgentLen;
     UInt32SetLE(&msg[off], 0); // last block received
     off += sizeof(uint32_t);
-    msg[off++] = 0; // relay transactions (0 for SPV bloom filter mode)
+    msg[off++] = (ctx->compactFilterMode) ? 1 : 0; // relay transactions (0 for SPV bloom filter mode)
     BRPeerSendMessage(peer, msg, sizeof(msg), MSG_VERSION);
 }
 
@@ -1509,6 +1765,8 @@ void BRPeerSendGetheaders(BRPeer *peer, const UInt256 locators[], size_t locator
     off += sizeof(UInt256);
 
     if (locatorsCount > 0) {
+        // in compact filter mode, the first locator is the header to continue from when a new block is announced
+        if (((BRPeerContext *)peer)->compactFilterMode) ((BRPeerContext *)peer)->lastHeaderHash = locators[0];
         peer_log(peer, "calling getheaders with %zu locators: [%s,%s %s]", locatorsCount, u256hex(locators[0]),
                  (locatorsCount > 2 ? " ...," : ""), (locatorsCount > 1 ? u256hex(locators[locatorsCount - 1]) : ""));
         BRPeerSendMessage(peer, msg, off, MSG_GETHEADERS);
@@ -1586,8 +1844,9 @@ void BRPeerSendGetdata(BRPeer *peer, const UInt256 txHashes[], size_t txCount, c
             off += sizeof(UInt256);
         }
         
-        for (i = 0; i < blockCount; i++) {
-            UInt32SetLE(&msg[off], inv_filtered_block);
+        for (i = 0; i < blockCount; i++) { // full blocks are requested in compact filter mode
+            UInt32SetLE(&msg[off], (((BRPeerContext *)peer)->compactFilterMode) ? inv_witness_block :
+                                   inv_filtered_block);
             off += sizeof(uint32_t);
             UInt256Set(&msg[off], blockHashes[i]);
             off += sizeof(UInt256);
@@ -1604,6 +1863,28 @@ void BRPeerSendGetaddr(BRPeer *peer)
     BRPeerSendMessage(peer, NULL, 0, MSG_GETADDR);
 }
 
+void BRPeerSendGetcfheaders(BRPeer *peer, uint8_t filterType, uint32_t startHeight, UInt256 stopHash)
+{
+    uint8_t msg[1 + sizeof(uint32_t) + sizeof(UInt256)];
+
+    msg[0] = filterType;
+    UInt32SetLE(&msg[1], startHeight);
+    UInt256Set(&msg[1 + sizeof(uint32_t)], stopHash);
+    peer_log(peer, "calling getcfheaders with start height %"PRIu32", stop hash %s", startHeight, u256hex(stopHash));
+    BRPeerSendMessage(peer, msg, sizeof(msg), MSG_GETCFHEADERS);
+}
+
+void BRPeerSendGetcfilters(BRPeer *peer, uint8_t filterType, uint32_t startHeight, UInt256 stopHash)
+{
+    uint8_t msg[1 + sizeof(uint32_t) + sizeof(UInt256)];
+
+    msg[0] = filterType;
+    UInt32SetLE(&msg[1], startHeight);
+    UInt256Set(&msg[1 + sizeof(uint32_t)], stopHash);
+    peer_log(peer, "calling getcfilters with start height %"PRIu32", stop hash %s", startHeight, u256hex(stopHash));
+    BRPeerSendMessage(peer, msg, sizeof(msg), MSG_GETCFILTERS);
+}
+
 void BRPeerSendPing(BRPeer *peer, void *info, void (*pongCallback)(void *info, int success))
 {
     BRPeerContext *ctx = (BRPeerContext *)peer;
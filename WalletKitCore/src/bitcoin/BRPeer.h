@@ -27,6 +27,7 @@
 
 #include "BRTransaction.h"
 #include "BRMerkleBlock.h"
+#include "BRCompactFilter.h"
 #include "support/BRAddress.h"
 #include "support/BRInt.h"
 #include <stddef.h>
@@ -56,6 +57,7 @@ extern "C" {
 #define SERVICES_NODE_BLOOM   0x04 // BIP111: https://github.com/bitcoin/bips/blob/master/bip-0111.mediawiki
 #define SERVICES_NODE_WITNESS 0x08 // BIP144: https://github.com/bitcoin/bips/blob/master/bip-0144.mediawiki
 #define SERVICES_NODE_BCASH   0x20 // https://github.com/Bitcoin-UAHF/spec/blob/master/uahf-technical-spec.md
+#define SERVICES_NODE_COMPACT_FILTERS 0x40 // BIP157: https://github.com/bitcoin/bips/blob/master/bip-0157.mediawiki
     
 #define BR_VERSION "2.1"
 #define USER_AGENT "/bread:" BR_VERSION "/"
@@ -83,6 +85,10 @@ extern "C" {
 #define MSG_ALERT       "alert"
 #define MSG_REJECT      "reject"   // described in BIP61: https://github.com/bitcoin/bips/blob/master/bip-0061.mediawiki
 #define MSG_FEEFILTER   "feefilter"// described in BIP133 https://github.com/bitcoin/bips/blob/master/bip-0133.mediawiki
+#define MSG_GETCFILTERS "getcfilters" // BIP157: https://github.com/bitcoin/bips/blob/master/bip-0157.mediawiki
+#define MSG_CFILTER     "cfilter"
+#define MSG_GETCFHEADERS "getcfheaders"
+#define MSG_CFHEADERS   "cfheaders"
 
 #define REJECT_INVALID     0x10 // transaction is invalid for some reason (invalid signature, output value > input, etc)
 #define REJECT_SPENT       0x12 // an input is already spent
@@ -138,6 +144,27 @@ void BRPeerSetCallbacks(BRPeer *peer, void *info,
                         int (*networkIsReachable)(void *info),
                         void (*threadCleanup)(void *info));
 
+// sets callbacks for syncing with BIP157 compact block filters instead of bloom filtered merkleblocks, the peer syncs
+// using only getheaders, and requests full blocks with getdata (a NULL relayedFilter restores bloom filter mode)
+// void relayedFilterHeaders(void *, UInt256, UInt256, const UInt256[], size_t) - called when a "cfheaders" message is
+//     received from peer with the stop hash, the previous filter header, and the filter hashes
+// void relayedFilter(void *, BRCompactFilter *) - called when a "cfilter" message is received from peer
+// void relayedFullBlock(void *, BRMerkleBlock *, const UInt256[], BRTransaction *[], size_t) - called when a "block"
+//     message is received from peer with the hash of every tx, and each tx that was parsed (NULL if the tx filter
+//     callback didn't want it), the callee is responsible for freeing block and each tx
+void BRPeerSetCompactFilterCallbacks(BRPeer *peer,
+                                     void (*relayedFilterHeaders)(void *info, UInt256 stopHash, UInt256 prevHeader,
+                                                                  const UInt256 filterHashes[], size_t hashesCount),
+                                     void (*relayedFilter)(void *info, BRCompactFilter *filter),
+                                     void (*relayedFullBlock)(void *info, BRMerkleBlock *block,
+                                                              const UInt256 txHashes[], BRTransaction *txs[],
+                                                              size_t txCount));
+
+// sets a callback to filter relayed tx before they're parsed, a tx that isn't wanted is never allocated
+// int wantsTx(void *, const BRTransactionView *) - called with the tx viewed in place when a "tx" or "block" message is
+//     received from peer, a tx is only parsed and relayed if it returns true (a NULL wantsTx parses every tx)
+void BRPeerSetTxFilterCallback(BRPeer *peer, int (*wantsTx)(void *info, const BRTransactionView *tx));
+
 // set earliestKeyTime to wallet creation time in order to speed up initial sync
 void BRPeerSetEarliestKeyTime(BRPeer *peer, uint32_t earliestKeyTime);
 
@@ -188,6 +215,8 @@ void BRPeerSendInv(BRPeer *peer, const UInt256 txHashes[], size_t txCount);
 void BRPeerSendGetdata(BRPeer *peer, const UInt256 txHashes[], size_t txCount, const UInt256 blockHashes[],
                        size_t blockCount);
 void BRPeerSendGetaddr(BRPeer *peer);
+void BRPeerSendGetcfheaders(BRPeer *peer, uint8_t filterType, uint32_t startHeight, UInt256 stopHash);
+void BRPeerSendGetcfilters(BRPeer *peer, uint8_t filterType, uint32_t startHeight, UInt256 stopHash);
 void BRPeerSendPing(BRPeer *peer, void *info, void (*pongCallback)(void *info, int success));
 
 // useful to get additional tx after a bloom filter update
@@ -24,6 +24,7 @@
 
 #include "BRPeerManager.h"
 #include "BRBloomFilter.h"
+#include "BRCompactFilter.h"
 #include "support/BRSet.h"
 #include "support/BRArray.h"
 #include "support/BRInt.h"
@@ -32,17 +33,21 @@
 #include <inttypes.h>
 #include <limits.h>
 #include <time.h>
+#include <float.h>
 #include <assert.h>
 #include <pthread.h>
 #include <errno.h>
 #include <netdb.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <sys/time.h>
 
 #define PROTOCOL_TIMEOUT      20.0
 #define MAX_CONNECT_FAILURES  20 // notify user of network problems after this many connect failures in a row
 #define PEER_FLAG_SYNCED      0x01
 #define PEER_FLAG_NEEDSUPDATE 0x02
+#define COMPACT_FILTER_BATCH  500 // number of compact filters requested at a time, BIP157 allows at most 1000
+#define PEER_QUALITY_MAX_COUNT 500 // number of peer qualities kept, those with the least history are dropped first
 
 #define genesis_block_hash(params) UInt256Reverse((params)->checkpoints[0].hash)
 
@@ -175,24 +180,145 @@ struct BRPeerManagerStruct {
     uint32_t earliestKeyTime, syncStartHeight, filterUpdateHeight, estimatedHeight;
     BRBloomFilter *bloomFilter;
     double fpRate, averageTxPerBlock;
+    int compactFilterMode;
+    uint32_t filterHeight, filterStartHeight; // filterHeight is the last block checked against its compact filter
+    UInt256 filterHeader, filterStopHash, fullBlockHash;
+    UInt256 *filterBlockHashes, *filterHashes; // block hashes and filter hashes for the requested batch of filters
+    BRPeer *filterCheckPeer; // a second peer that the batch of filter hashes is cross-checked with
+    UInt256 filterPrevHeader, filterCheckHeader; // download peer's prevHeader, and check peer's last filter header
+    int filterHashesChecked; // true once filterHashes agree with the check peer, filters are only requested after
+    BRCompactFilter **filters; // received filters waiting to be checked
+    uint8_t *walletScriptData;
+    const uint8_t **walletScripts;
+    size_t *walletScriptLens, walletAddrsCount;
     BRSet *blocks, *orphans, *checkpoints;
     BRMerkleBlock *lastBlock, *lastOrphan;
     BRTxPeerList *txRelays, *txRequests;
     BRPublishedTx *publishedTx;
     UInt256 *publishedTxHashes;
+    BRPeerQualityEntry *qualities;
+    double downloadStartTime; // time the download peer started the chain download, zero if not downloading
+    uint32_t downloadStartHeight;
     void *info;
     void (*syncStarted)(void *info);
     void (*syncStopped)(void *info, int error);
     void (*txStatusUpdate)(void *info);
     void (*saveBlocks)(void *info, int replace, BRMerkleBlock *blocks[], size_t blocksCount);
     void (*savePeers)(void *info, int replace, const BRPeer peers[], size_t peersCount);
+    void (*savePeerQualities)(void *info, const BRPeerQualityEntry qualities[], size_t qualitiesCount);
     int (*networkIsReachable)(void *info);
     void (*threadCleanup)(void *info);
     pthread_mutex_t lock;
 };
 
+static double _BRPeerManagerTime(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + (double)tv.tv_usec/1000000;
+}
+
+// returns the quality entry for peer, or NULL if there is none
+static BRPeerQualityEntry *_BRPeerManagerFindPeerQuality(BRPeerManager *manager, const BRPeer *peer)
+{
+    for (size_t i = array_count(manager->qualities); i > 0; i--) {
+        BRPeerQualityEntry *entry = &manager->qualities[i - 1];
+
+        if (UInt128Eq(entry->address, peer->address) && entry->port == peer->port) return entry;
+    }
+
+    return NULL;
+}
+
+// returns the quality of peer, adding a new one if needed
+static BRPeerQuality *_BRPeerManagerPeerQuality(BRPeerManager *manager, const BRPeer *peer)
+{
+    BRPeerQualityEntry *entry = _BRPeerManagerFindPeerQuality(manager, peer), newEntry;
+    size_t evict = 0;
+
+    if (entry) return &entry->quality;
+
+    if (array_count(manager->qualities) >= PEER_QUALITY_MAX_COUNT) { // drop the quality with the least history
+        for (size_t i = 1; i < array_count(manager->qualities); i++) {
+            if (manager->qualities[i].quality.outcomes < manager->qualities[evict].quality.outcomes) evict = i;
+        }
+
+        array_rm(manager->qualities, evict);
+    }
+
+    newEntry = (BRPeerQualityEntry) { peer->address, peer->port, BR_PEER_QUALITY_NONE };
+    array_add(manager->qualities, newEntry);
+    return &manager->qualities[array_count(manager->qualities) - 1].quality;
+}
+
+static double _BRPeerManagerPeerScore(BRPeerManager *manager, const BRPeer *peer)
+{
+    BRPeerQualityEntry *entry = _BRPeerManagerFindPeerQuality(manager, peer);
+
+    return BRPeerQualityScore((entry) ? &entry->quality : &BR_PEER_QUALITY_NONE);
+}
+
+// sorts peers by quality score, highest first, peers with equal scores are kept in their existing order
+static void _BRPeerManagerSortPeersByQuality(BRPeerManager *manager, BRPeer peers[], size_t peersCount)
+{
+    double scores[peersCount + 1], score;
+    BRPeer peer;
+    size_t i, j;
+
+    for (i = 0; i < peersCount; i++) scores[i] = _BRPeerManagerPeerScore(manager, &peers[i]);
+
+    for (i = 1; i < peersCount; i++) { // insertion sort is stable, and there are at most a few hundred peers
+        peer = peers[i];
+        score = scores[i];
+
+        for (j = i; j > 0 && scores[j - 1] < score; j--) {
+            peers[j] = peers[j - 1];
+            scores[j] = scores[j - 1];
+        }
+
+        peers[j] = peer;
+        scores[j] = score;
+    }
+}
+
+// adds the blocks per second downloaded from the download peer since it started the chain download to its quality
+static void _BRPeerManagerUpdateDownloadQuality(BRPeerManager *manager)
+{
+    double elapsed = _BRPeerManagerTime() - manager->downloadStartTime;
+
+    if (manager->downloadPeer && manager->downloadStartTime > 0 &&
+        manager->lastBlock->height > manager->downloadStartHeight) {
+        BRPeerQualityAddBandwidth(_BRPeerManagerPeerQuality(manager, manager->downloadPeer),
+                                  (manager->lastBlock->height - manager->downloadStartHeight)/
+                                  ((elapsed > 0.001) ? elapsed : 0.001));
+    }
+
+    manager->downloadStartTime = 0;
+}
+
+// must not be called with the manager lock held
+static void _BRPeerManagerSavePeerQualities(BRPeerManager *manager)
+{
+    BRPeerQualityEntry *qualities;
+    size_t qualitiesCount;
+
+    if (! manager->savePeerQualities) return;
+    pthread_mutex_lock(&manager->lock);
+    qualitiesCount = array_count(manager->qualities);
+    qualities = malloc((qualitiesCount + 1)*sizeof(*qualities));
+    assert(qualities != NULL);
+    if (qualitiesCount > 0) memcpy(qualities, manager->qualities, qualitiesCount*sizeof(*qualities));
+    pthread_mutex_unlock(&manager->lock);
+
+    manager->savePeerQualities(manager->info, qualities, qualitiesCount);
+    free(qualities);
+}
+
 static void _BRPeerManagerPeerMisbehavin(BRPeerManager *manager, BRPeer *peer)
 {
+    BRPeerQualityAddMisbehavior(_BRPeerManagerPeerQuality(manager, peer));
+
     for (size_t i = array_count(manager->peers); i > 0; i--) {
         if (BRPeerEq(&manager->peers[i - 1], peer)) array_rm(manager->peers, i - 1);
     }
@@ -208,6 +334,7 @@ static void _BRPeerManagerPeerMisbehavin(BRPeerManager *manager, BRPeer *peer)
 static void _BRPeerManagerSyncStopped(BRPeerManager *manager)
 {
     manager->syncStartHeight = 0;
+    _BRPeerManagerUpdateDownloadQuality(manager);
 
     if (manager->downloadPeer) {
         // don't cancel timeout if there's a pending tx publish callback
@@ -265,6 +392,8 @@ static void _setApplyFreeBlock(void *info, void *block)
 
 static void _BRPeerManagerLoadBloomFilter(BRPeerManager *manager, BRPeer *peer)
 {
+    if (manager->compactFilterMode) return; // compact filters are matched locally, nothing is sent to the peer
+
     // every time a new wallet address is added, the bloom filter has to be rebuilt, and each address is only used
     // for one transaction, so here we generate some spare addresses to avoid rebuilding the filter each time a
     // wallet transaction is encountered during the chain sync
@@ -557,6 +686,7 @@ static void _mempoolDone(void *info, int success)
         BRPeerSendGetaddr(peer); // request a list of other bitcoin peers
         pthread_mutex_unlock(&manager->lock);
         if (manager->txStatusUpdate) manager->txStatusUpdate(manager->info);
+        if (syncFinished) _BRPeerManagerSavePeerQualities(manager);
         if (syncFinished && manager->syncStopped) manager->syncStopped(manager->info, 0);
     }
     else peer_log(peer, "mempool request failed");
@@ -569,7 +699,19 @@ static void _loadBloomFilterDone(void *info, int success)
 
     pthread_mutex_lock(&manager->lock);
     
-    if (success) {
+    // no mempool without a bloom filter, it would be the whole mempool, unconfirmed tx are instead fetched as they are
+    // relayed and matched locally, so a payment broadcast while disconnected is seen when it's mined
+    if (success && manager->compactFilterMode) {
+        if (manager->filterHeight < manager->lastBlock->height) {
+            free(info); // mempools are loaded when the compact filter sync is done
+            pthread_mutex_unlock(&manager->lock);
+        }
+        else {
+            pthread_mutex_unlock(&manager->lock);
+            _mempoolDone(info, success);
+        }
+    }
+    else if (success) {
         BRPeerSendMempool(peer, manager->publishedTxHashes, array_count(manager->publishedTxHashes), info,
                           _mempoolDone);
         pthread_mutex_unlock(&manager->lock);
@@ -581,6 +723,7 @@ static void _loadBloomFilterDone(void *info, int success)
             peer_log(peer, "sync succeeded");
             _BRPeerManagerSyncStopped(manager);
             pthread_mutex_unlock(&manager->lock);
+            _BRPeerManagerSavePeerQualities(manager);
             if (manager->syncStopped) manager->syncStopped(manager->info, 0);
         }
         else pthread_mutex_unlock(&manager->lock);
@@ -610,6 +753,184 @@ static void _BRPeerManagerLoadMempools(BRPeerManager *manager)
     }
 }
 
+// in compact filter mode there is no bloom filter or mempool request, only pending tx are published
+static void _BRPeerManagerCompactFilterSyncDone(BRPeerManager *manager)
+{
+    size_t i, saveCount = (manager->lastBlock->height % BLOCK_DIFFICULTY_INTERVAL) + BLOCK_DIFFICULTY_INTERVAL + 1;
+    BRMerkleBlock *b, *saveBlocks[saveCount];
+
+    // blocks are only saved once their filters are checked, so a restart won't skip unchecked blocks
+    for (i = 0, b = manager->lastBlock; b && i < saveCount; i++) {
+        saveBlocks[i] = b;
+        b = BRSetGet(manager->blocks, &b->prevBlock);
+    }
+
+    while (i > 0 && (saveBlocks[i - 1]->height % BLOCK_DIFFICULTY_INTERVAL) != 0) i--;
+    if (i > 0 && manager->saveBlocks) manager->saveBlocks(manager->info, (i > 1 ? 1 : 0), saveBlocks, i);
+
+    for (i = array_count(manager->connectedPeers); i > 0; i--) {
+        BRPeer *peer = manager->connectedPeers[i - 1];
+        BRPeerCallbackInfo *info;
+
+        if (BRPeerConnectStatus(peer) != BRPeerStatusConnected) continue;
+        info = calloc(1, sizeof(*info));
+        assert(info != NULL);
+        info->peer = peer;
+        info->manager = manager;
+        _BRPeerManagerPublishPendingTx(manager, peer);
+        BRPeerSendPing(peer, info, _mempoolDone);
+    }
+}
+
+// rebuilds the cached wallet scriptPubKeys that compact filters are matched against when wallet addresses are added
+static void _BRPeerManagerUpdateWalletScripts(BRPeerManager *manager)
+{
+    BRWalletUnusedAddrs(manager->wallet, NULL, SEQUENCE_GAP_LIMIT_EXTERNAL_EXTENDED, SEQUENCE_EXTERNAL_CHAIN);
+    BRWalletUnusedAddrs(manager->wallet, NULL, SEQUENCE_GAP_LIMIT_INTERNAL_EXTENDED, SEQUENCE_INTERNAL_CHAIN);
+
+    size_t i, off, len, addrsCount = BRWalletAllAddrs(manager->wallet, NULL, 0);
+    BRAddress *addrs;
+    uint8_t script[64];
+
+    if (addrsCount == manager->walletAddrsCount) return;
+    addrs = malloc(addrsCount*sizeof(*addrs));
+    assert(addrs != NULL);
+    addrsCount = BRWalletAllAddrs(manager->wallet, addrs, addrsCount);
+    array_clear(manager->walletScriptData);
+    array_clear(manager->walletScriptLens);
+
+    for (i = 0; i < addrsCount; i++) {
+        len = BRAddressScriptPubKey(script, sizeof(script), manager->params->addrParams, addrs[i].s);
+        if (len == 0) continue;
+        array_add_array(manager->walletScriptData, script, len);
+        array_add(manager->walletScriptLens, len);
+    }
+
+    free(addrs);
+    array_set_count(manager->walletScripts, array_count(manager->walletScriptLens));
+
+    for (i = 0, off = 0; i < array_count(manager->walletScriptLens); i++) {
+        manager->walletScripts[i] = &manager->walletScriptData[off];
+        off += manager->walletScriptLens[i];
+    }
+
+    manager->walletAddrsCount = addrsCount;
+}
+
+// discards any requested batch of compact filters, and any requested full block
+static void _BRPeerManagerResetCompactFilters(BRPeerManager *manager)
+{
+    for (size_t i = array_count(manager->filters); i > 0; i--) BRCompactFilterFree(manager->filters[i - 1]);
+    array_clear(manager->filters);
+    array_clear(manager->filterHashes);
+    array_clear(manager->filterBlockHashes);
+    manager->filterStopHash = UINT256_ZERO;
+    manager->fullBlockHash = UINT256_ZERO;
+    manager->filterCheckPeer = NULL;
+    manager->filterPrevHeader = UINT256_ZERO;
+    manager->filterCheckHeader = UINT256_ZERO;
+    manager->filterHashesChecked = 0;
+}
+
+// returns a connected peer other than the download peer that serves compact filters up to stopHeight, or NULL if none
+static BRPeer *_BRPeerManagerFilterCheckPeer(BRPeerManager *manager, uint32_t stopHeight)
+{
+    for (size_t i = array_count(manager->connectedPeers); i > 0; i--) {
+        BRPeer *p = manager->connectedPeers[i - 1];
+
+        if (p == manager->downloadPeer || BRPeerConnectStatus(p) != BRPeerStatusConnected) continue;
+        if ((p->services & SERVICES_NODE_COMPACT_FILTERS) != SERVICES_NODE_COMPACT_FILTERS) continue;
+        if (BRPeerLastBlock(p) >= stopHeight) return p;
+    }
+
+    return NULL;
+}
+
+// requests the next batch of compact filters, or finishes syncing when filters are checked up to the last block
+static void _BRPeerManagerSyncCompactFilters(BRPeerManager *manager)
+{
+    BRMerkleBlock *block = manager->lastBlock;
+    uint32_t stopHeight;
+    size_t i;
+
+    if (! manager->downloadPeer || ! UInt256IsZero(manager->filterStopHash)) return; // a batch is already requested
+
+    if (manager->filterHeight >= manager->lastBlock->height) {
+        if (manager->lastBlock->height >= manager->estimatedHeight && manager->syncStartHeight > 0) {
+            peer_log(manager->downloadPeer, "compact filters checked up to block #%"PRIu32, manager->filterHeight);
+            _BRPeerManagerCompactFilterSyncDone(manager);
+        }
+    }
+    // request filters in full batches while headers are syncing, and the remainder when caught up
+    else if (manager->filterHeight + COMPACT_FILTER_BATCH <= manager->lastBlock->height ||
+             manager->lastBlock->height >= manager->estimatedHeight) {
+        stopHeight = manager->filterHeight + COMPACT_FILTER_BATCH;
+        if (stopHeight > manager->lastBlock->height) stopHeight = manager->lastBlock->height;
+        array_set_count(manager->filterBlockHashes, stopHeight - manager->filterHeight);
+        while (block && block->height > stopHeight) block = BRSetGet(manager->blocks, &block->prevBlock);
+
+        for (i = array_count(manager->filterBlockHashes); block && i > 0; i--) {
+            manager->filterBlockHashes[i - 1] = block->blockHash;
+            block = BRSetGet(manager->blocks, &block->prevBlock);
+        }
+
+        if (i > 0) { // shouldn't happen, blocks after the last saved transition block are kept in memory
+            peer_log(manager->downloadPeer, "missing block headers for compact filters after #%"PRIu32,
+                     manager->filterHeight);
+            array_clear(manager->filterBlockHashes);
+        }
+        else if (manager->maxConnectCount > 1 &&
+                 ! (manager->filterCheckPeer = _BRPeerManagerFilterCheckPeer(manager, stopHeight))) {
+            // filter headers aren't trusted from a single peer, wait for another peer that serves filters to connect
+            array_clear(manager->filterBlockHashes);
+        }
+        else {
+            manager->filterStartHeight = manager->filterHeight;
+            manager->filterStopHash = manager->filterBlockHashes[array_count(manager->filterBlockHashes) - 1];
+            BRPeerSendGetcfheaders(manager->downloadPeer, COMPACT_FILTER_TYPE_BASIC, manager->filterHeight + 1,
+                                   manager->filterStopHash);
+
+            if (manager->filterCheckPeer) {
+                BRPeerSendGetcfheaders(manager->filterCheckPeer, COMPACT_FILTER_TYPE_BASIC, manager->filterHeight + 1,
+                                       manager->filterStopHash);
+            }
+        }
+    }
+}
+
+// checks received compact filters in order against wallet scripts, stopping to download the full block on a match
+static void _BRPeerManagerCheckCompactFilters(BRPeerManager *manager)
+{
+    BRCompactFilter *filter;
+
+    _BRPeerManagerUpdateWalletScripts(manager);
+
+    while (array_count(manager->filters) > 0 && UInt256IsZero(manager->fullBlockHash)) {
+        filter = manager->filters[0];
+
+        if (BRCompactFilterMatchAny(filter, manager->walletScripts, manager->walletScriptLens,
+                                    array_count(manager->walletScripts))) {
+            manager->fullBlockHash = filter->blockHash;
+            BRPeerSendGetdata(manager->downloadPeer, NULL, 0, &manager->fullBlockHash, 1);
+            break;
+        }
+
+        // the filter header chain commits to all previous filters, verifying the batch with the previous batch
+        manager->filterHeader = BRCompactFilterHeader(manager->filterHashes[manager->filterHeight -
+                                                                            manager->filterStartHeight],
+                                                      manager->filterHeader);
+        manager->filterHeight++;
+        array_rm(manager->filters, 0);
+        BRCompactFilterFree(filter);
+    }
+
+    if (array_count(manager->filters) == 0 && UInt256IsZero(manager->fullBlockHash) &&
+        manager->filterHeight == manager->filterStartHeight + array_count(manager->filterBlockHashes)) {
+        _BRPeerManagerResetCompactFilters(manager); // batch is complete
+        _BRPeerManagerSyncCompactFilters(manager);
+    }
+}
+
 // returns a UINT128_ZERO terminated array of addresses for hostname that must be freed, or NULL if lookup failed
 static UInt128 *_addressLookup(const char *hostname)
 {
@@ -715,10 +1036,15 @@ static void _peerConnected(void *info)
     BRPeer *peer = ((BRPeerCallbackInfo *)info)->peer;
     BRPeerManager *manager = ((BRPeerCallbackInfo *)info)->manager;
     BRPeerCallbackInfo *peerInfo;
+    BRPeerQuality *quality;
     time_t now = time(NULL);
     
     pthread_mutex_lock(&manager->lock);
     if (peer->timestamp > now + 2*60*60 || peer->timestamp < now - 2*60*60) peer->timestamp = now; // sanity check
+
+    quality = _BRPeerManagerPeerQuality(manager, peer);
+    BRPeerQualityAddOutcome(quality, 1);
+    if (BRPeerPingTime(peer) < DBL_MAX) BRPeerQualityAddLatency(quality, BRPeerPingTime(peer)*1000);
     
     // TODO: XXX does this work with 0.11 pruned nodes?
     if ((peer->services & manager->params->services) != manager->params->services) {
@@ -733,7 +1059,13 @@ static void _peerConnected(void *info)
         peer_log(peer, "node isn't synced");
         BRPeerDisconnect(peer);
     }
-    else if (BRPeerVersion(peer) >= 70011 && (peer->services & SERVICES_NODE_BLOOM) != SERVICES_NODE_BLOOM) {
+    else if (manager->compactFilterMode &&
+             (peer->services & SERVICES_NODE_COMPACT_FILTERS) != SERVICES_NODE_COMPACT_FILTERS) {
+        peer_log(peer, "node doesn't serve compact filters");
+        BRPeerDisconnect(peer);
+    }
+    else if (! manager->compactFilterMode && BRPeerVersion(peer) >= 70011 &&
+             (peer->services & SERVICES_NODE_BLOOM) != SERVICES_NODE_BLOOM) {
         peer_log(peer, "node doesn't support SPV mode");
         BRPeerDisconnect(peer);
     }
@@ -750,15 +1082,25 @@ static void _peerConnected(void *info)
             peerInfo->manager = manager;
             BRPeerSendPing(peer, peerInfo, _loadBloomFilterDone);
         }
+
+        if (manager->compactFilterMode) { // sync headers so the peer can follow new block announcements
+            UInt256 locators[_BRPeerManagerBlockLocators(manager, NULL, 0)];
+            size_t count = _BRPeerManagerBlockLocators(manager, locators, sizeof(locators)/sizeof(*locators));
+
+            BRPeerSendGetheaders(peer, locators, count, UINT256_ZERO);
+            _BRPeerManagerSyncCompactFilters(manager); // a batch of filters may be waiting for a check peer
+        }
     }
-    else { // select the peer with the lowest ping time to download the chain from if we're behind
+    else { // select the peer with the best quality (ping time, download speed and reliability) to download the chain
+        // from if we're behind
         // BUG: XXX a malicious peer can report a higher lastblock to make us select them as the download peer, if
         // two peers agree on lastblock, use one of those two instead
         for (size_t i = array_count(manager->connectedPeers); i > 0; i--) {
             BRPeer *p = manager->connectedPeers[i - 1];
             
             if (BRPeerConnectStatus(p) != BRPeerStatusConnected) continue;
-            if ((BRPeerPingTime(p) < BRPeerPingTime(peer) && BRPeerLastBlock(p) >= BRPeerLastBlock(peer)) ||
+            if ((_BRPeerManagerPeerScore(manager, p) > _BRPeerManagerPeerScore(manager, peer) &&
+                 BRPeerLastBlock(p) >= BRPeerLastBlock(peer)) ||
                 BRPeerLastBlock(p) > BRPeerLastBlock(peer)) peer = p;
         }
         
@@ -779,17 +1121,29 @@ static void _peerConnected(void *info)
             size_t count = _BRPeerManagerBlockLocators(manager, locators, sizeof(locators)/sizeof(*locators));
             
             BRPeerScheduleDisconnect(peer, PROTOCOL_TIMEOUT); // schedule sync timeout
+            manager->downloadStartTime = _BRPeerManagerTime();
+            manager->downloadStartHeight = manager->lastBlock->height;
 
             // request just block headers up to a week before earliestKeyTime, and then merkleblocks after that
+            // (in compact filter mode only headers are requested, filters are requested as headers arrive)
             // we do not reset connect failure count yet incase this request times out
-            if (manager->lastBlock->timestamp + 7*24*60*60 >= manager->earliestKeyTime) {
+            if (! manager->compactFilterMode &&
+                manager->lastBlock->timestamp + 7*24*60*60 >= manager->earliestKeyTime) {
                 BRPeerSendGetblocks(peer, locators, count, UINT256_ZERO);
             }
             else BRPeerSendGetheaders(peer, locators, count, UINT256_ZERO);
         }
         else { // we're already synced
             manager->connectFailureCount = 0; // reset connect failure count
-            _BRPeerManagerLoadMempools(manager);
+
+            if (manager->compactFilterMode) {
+                UInt256 locators[_BRPeerManagerBlockLocators(manager, NULL, 0)];
+                size_t count = _BRPeerManagerBlockLocators(manager, locators, sizeof(locators)/sizeof(*locators));
+
+                BRPeerSendGetheaders(peer, locators, count, UINT256_ZERO);
+                _BRPeerManagerSyncCompactFilters(manager);
+            }
+            else _BRPeerManagerLoadMempools(manager);
         }
     }
 
@@ -813,6 +1167,8 @@ static void _peerDisconnected(void *info, int error)
         _BRPeerManagerPeerMisbehavin(manager, peer);
     }
     else if (error) { // timeout or some non-protocol related network error
+        BRPeerQualityAddOutcome(_BRPeerManagerPeerQuality(manager, peer), 0);
+
         for (size_t i = array_count(manager->peers); i > 0; i--) {
             if (BRPeerEq(&manager->peers[i - 1], peer)) array_rm(manager->peers, i - 1);
         }
@@ -834,8 +1190,10 @@ static void _peerDisconnected(void *info, int error)
     }
 
     if (peer == manager->downloadPeer) { // download peer disconnected
+        _BRPeerManagerUpdateDownloadQuality(manager);
         manager->isConnected = 0;
         manager->downloadPeer = NULL;
+        _BRPeerManagerResetCompactFilters(manager); // filters are re-requested from the next download peer
         if (manager->connectFailureCount > MAX_CONNECT_FAILURES) manager->connectFailureCount = MAX_CONNECT_FAILURES;
     }
 
@@ -866,6 +1224,11 @@ static void _peerDisconnected(void *info, int error)
         break;
     }
 
+    if (peer == manager->filterCheckPeer) { // re-request the batch's filter headers with another check peer
+        _BRPeerManagerResetCompactFilters(manager);
+        _BRPeerManagerSyncCompactFilters(manager);
+    }
+
     BRPeerFree(peer);
     pthread_mutex_unlock(&manager->lock);
     
@@ -874,6 +1237,7 @@ static void _peerDisconnected(void *info, int error)
     }
     
     if (willSave && manager->savePeers) manager->savePeers(manager->info, 1, NULL, 0);
+    if (willSave) _BRPeerManagerSavePeerQualities(manager);
     if (willSave && manager->syncStopped) manager->syncStopped(manager->info, error);
     if (willReconnect) BRPeerManagerConnect(manager); // try connecting to another peer
     if (manager->txStatusUpdate) manager->txStatusUpdate(manager->info);
@@ -991,6 +1355,30 @@ static void _peerRelayedTx(void *info, BRTransaction *tx)
     if (txCallback) txCallback(txInfo, 0);
 }
 
+// while syncing, only wallet tx and published tx are parsed, after syncing every tx is registered with the wallet
+// in compact filter mode every relayed tx reaches here unfiltered, so only wallet tx and published tx are ever parsed
+static int _peerWantsTx(void *info, const BRTransactionView *tx)
+{
+    BRPeer *peer = ((BRPeerCallbackInfo *)info)->peer;
+    BRPeerManager *manager = ((BRPeerCallbackInfo *)info)->manager;
+    int r, hasPendingCallbacks = 0;
+
+    pthread_mutex_lock(&manager->lock);
+    r = (manager->syncStartHeight == 0 && ! manager->compactFilterMode);
+
+    for (size_t i = array_count(manager->publishedTx); ! r && i > 0; i--) {
+        if (UInt256Eq(manager->publishedTxHashes[i - 1], tx->txHash)) r = 1;
+        else if (manager->publishedTx[i - 1].callback != NULL) hasPendingCallbacks = 1;
+    }
+
+    if (! r) r = BRWalletContainsTransactionView(manager->wallet, tx);
+
+    // an unwanted tx is never relayed, so cancel the tx publish timeout here as _peerRelayedTx() would have
+    if (! r && ! hasPendingCallbacks && peer != manager->downloadPeer) BRPeerScheduleDisconnect(peer, -1);
+    pthread_mutex_unlock(&manager->lock);
+    return r;
+}
+
 static void _peerHasTx(void *info, UInt256 txHash)
 {
     BRPeer *peer = ((BRPeerCallbackInfo *)info)->peer;
@@ -1152,7 +1540,7 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
     BRPeerManager *manager = ((BRPeerCallbackInfo *)info)->manager;
     size_t i, j, fpCount = 0, saveCount = 0;
     BRMerkleBlock orphan, *b, *b2, *prev, *next = NULL;
-    uint32_t txTime = 0;
+    uint32_t txTime = 0, height;
 
     if (NULL == peer || NULL == manager) {
         _peerRelayedBlockFailed (block, peer, "missed 'peer' or 'manager'");
@@ -1190,7 +1578,7 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
     }
     
     // track the observed bloom filter false positive rate using a low pass filter to smooth out variance
-    if (peer == manager->downloadPeer && block->totalTx > 0) {
+    if (peer == manager->downloadPeer && block->totalTx > 0 && ! manager->compactFilterMode) {
         for (i = 0; i < txCount; i++) { // wallet tx are not false-positives
             if (! BRWalletTransactionForHash(manager->wallet, txHashes[i])) fpCount++;
         }
@@ -1216,11 +1604,14 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
     }
 
     // ignore block headers that are newer than one week before earliestKeyTime (it's a header if it has 0 totalTx)
-    if (block->totalTx == 0 && block->timestamp + 7*24*60*60 - 2*60*60 > manager->earliestKeyTime) {
+    // in compact filter mode all headers are kept, and matching blocks are found with filters
+    if (! manager->compactFilterMode && block->totalTx == 0 &&
+        block->timestamp + 7*24*60*60 - 2*60*60 > manager->earliestKeyTime) {
         BRMerkleBlockFree(block);
         block = NULL;
     }
-    else if (manager->bloomFilter == NULL) { // ingore potentially incomplete blocks when a filter update is pending
+    else if (! manager->compactFilterMode && manager->bloomFilter == NULL) {
+        // ingore potentially incomplete blocks when a filter update is pending
         BRMerkleBlockFree(block);
         block = NULL;
 
@@ -1246,8 +1637,14 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
                 size_t locatorsCount = _BRPeerManagerBlockLocators(manager, locators,
                                                                    sizeof(locators)/sizeof(*locators));
                 
-                peer_log(peer, "calling getblocks");
-                BRPeerSendGetblocks(peer, locators, locatorsCount, UINT256_ZERO);
+                if (manager->compactFilterMode) {
+                    peer_log(peer, "calling getheaders");
+                    BRPeerSendGetheaders(peer, locators, locatorsCount, UINT256_ZERO);
+                }
+                else {
+                    peer_log(peer, "calling getblocks");
+                    BRPeerSendGetblocks(peer, locators, locatorsCount, UINT256_ZERO);
+                }
             }
             
             BRSetAdd(manager->orphans, block); // BUG: limit total orphans to avoid memory exhaustion attack
@@ -1268,6 +1665,12 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
         BRSetAdd(manager->blocks, block);
         manager->lastBlock = block;
         if (txCount > 0) BRWalletUpdateTransactions(manager->wallet, txHashes, txCount, block->height, txTime);
+
+        // blocks older than a week before earliestKeyTime can't contain wallet tx, so their filters are skipped
+        if (manager->compactFilterMode && manager->filterHeight + 1 == block->height &&
+            block->timestamp + 7*24*60*60 + BLOCK_MAX_TIME_DRIFT < manager->earliestKeyTime) {
+            manager->filterHeight = block->height;
+        }
         if (manager->downloadPeer) BRPeerSetCurrentBlockHeight(manager->downloadPeer, block->height);
             
         if (block->height < manager->estimatedHeight && peer == manager->downloadPeer) {
@@ -1281,7 +1684,7 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
         
         if (block->height == manager->estimatedHeight) { // chain download is complete
             saveCount = (block->height % BLOCK_DIFFICULTY_INTERVAL) + BLOCK_DIFFICULTY_INTERVAL + 1;
-            _BRPeerManagerLoadMempools(manager);
+            if (! manager->compactFilterMode) _BRPeerManagerLoadMempools(manager);
         }
     }
     else if (BRSetContains(manager->blocks, block)) { // we already have the block (or at least the header)
@@ -1345,6 +1748,12 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
         
             BRWalletSetTxUnconfirmedAfter(manager->wallet, b->height); // mark tx after the join point as unconfirmed
 
+            if (manager->compactFilterMode && manager->filterHeight > b->height) { // re-check filters on new chain
+                _BRPeerManagerResetCompactFilters(manager);
+                manager->filterHeight = b->height;
+                manager->filterHeader = UINT256_ZERO;
+            }
+
             b = block;
         
             while (b && b2 && b->height > b2->height) { // set transaction heights for new main chain
@@ -1371,7 +1780,7 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
             
             if (block->height == manager->estimatedHeight) { // chain download is complete
                 saveCount = (block->height % BLOCK_DIFFICULTY_INTERVAL) + BLOCK_DIFFICULTY_INTERVAL + 1;
-                _BRPeerManagerLoadMempools(manager);
+                if (! manager->compactFilterMode) _BRPeerManagerLoadMempools(manager);
             }
         }
     }
@@ -1386,6 +1795,9 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
         next = BRSetRemove(manager->orphans, &orphan);
     }
     
+    // in compact filter mode, blocks are saved once their filters are checked
+    if (manager->compactFilterMode && block && block->height > manager->filterHeight) saveCount = 0;
+
     BRMerkleBlock *saveBlocks[saveCount];
     
     for (i = 0, b = block; b && i < saveCount; i++) {
@@ -1405,16 +1817,168 @@ static void _peerRelayedBlock(void *info, BRMerkleBlock *block)
         return;
     }
     if (i > 0 && manager->saveBlocks) manager->saveBlocks(manager->info, (i > 1 ? 1 : 0), saveBlocks, i);
+    if (manager->compactFilterMode) _BRPeerManagerSyncCompactFilters(manager);
+    height = (block) ? block->height : BLOCK_UNKNOWN_HEIGHT; // block may be replaced and freed once unlocked
     pthread_mutex_unlock(&manager->lock);
     
-    if (block && block->height != BLOCK_UNKNOWN_HEIGHT && block->height >= BRPeerLastBlock(peer) &&
-        manager->txStatusUpdate) {
+    if (height != BLOCK_UNKNOWN_HEIGHT && height >= BRPeerLastBlock(peer) && manager->txStatusUpdate) {
         manager->txStatusUpdate(manager->info); // notify that transaction confirmations may have changed
     }
     
     if (next) _peerRelayedBlock(info, next);
 }
 
+// requests the batch of filters once the download peer's filter hashes agree with the check peer's filter headers
+static void _BRPeerManagerCheckFilterHeaders(BRPeerManager *manager)
+{
+    BRPeer *checkPeer = manager->filterCheckPeer;
+    UInt256 header = manager->filterPrevHeader;
+
+    if (array_count(manager->filterHashes) == 0 || (checkPeer && UInt256IsZero(manager->filterCheckHeader))) return;
+
+    for (size_t i = 0; checkPeer && i < array_count(manager->filterHashes); i++) {
+        header = BRCompactFilterHeader(manager->filterHashes[i], header);
+    }
+
+    if (checkPeer && ! UInt256Eq(header, manager->filterCheckHeader)) {
+        // one of the two peers is serving wrong filter headers, but which one isn't known, so drop both
+        peer_log(manager->downloadPeer, "cfheaders disagree with %s, stop hash %s", BRPeerHost(checkPeer),
+                 u256hex(manager->filterStopHash));
+        BRPeerDisconnect(checkPeer);
+        BRPeerDisconnect(manager->downloadPeer);
+        _BRPeerManagerResetCompactFilters(manager);
+    }
+    else {
+        // the first filter header is trusted once two peers agree on it, later batches must connect to it
+        if (UInt256IsZero(manager->filterHeader)) manager->filterHeader = manager->filterPrevHeader;
+        manager->filterCheckPeer = NULL;
+        manager->filterHashesChecked = 1;
+        BRPeerSendGetcfilters(manager->downloadPeer, COMPACT_FILTER_TYPE_BASIC, manager->filterStartHeight + 1,
+                              manager->filterStopHash);
+    }
+}
+
+static void _peerRelayedFilterHeaders(void *info, UInt256 stopHash, UInt256 prevHeader, const UInt256 filterHashes[],
+                                      size_t hashesCount)
+{
+    BRPeer *peer = ((BRPeerCallbackInfo *)info)->peer;
+    BRPeerManager *manager = ((BRPeerCallbackInfo *)info)->manager;
+    UInt256 header = prevHeader;
+
+    pthread_mutex_lock(&manager->lock);
+
+    if (UInt256IsZero(manager->filterStopHash) || ! UInt256Eq(stopHash, manager->filterStopHash) ||
+        (peer == manager->downloadPeer && array_count(manager->filterHashes) > 0) ||
+        (peer != manager->downloadPeer &&
+         (peer != manager->filterCheckPeer || ! UInt256IsZero(manager->filterCheckHeader)))) {
+        peer_log(peer, "ignoring unrequested cfheaders, stop hash %s", u256hex(stopHash));
+    }
+    else if (hashesCount != array_count(manager->filterBlockHashes) ||
+             (! UInt256IsZero(manager->filterHeader) && ! UInt256Eq(prevHeader, manager->filterHeader))) {
+        peer_log(peer, "cfheaders don't connect to the previous filter header");
+        _BRPeerManagerResetCompactFilters(manager);
+        _BRPeerManagerPeerMisbehavin(manager, peer);
+    }
+    else if (peer == manager->downloadPeer) {
+        manager->filterPrevHeader = prevHeader;
+        array_add_array(manager->filterHashes, filterHashes, hashesCount);
+        _BRPeerManagerCheckFilterHeaders(manager);
+    }
+    else {
+        for (size_t i = 0; i < hashesCount; i++) header = BRCompactFilterHeader(filterHashes[i], header);
+        manager->filterCheckHeader = header;
+        _BRPeerManagerCheckFilterHeaders(manager);
+    }
+
+    pthread_mutex_unlock(&manager->lock);
+}
+
+static void _peerRelayedFilter(void *info, BRCompactFilter *filter)
+{
+    BRPeer *peer = ((BRPeerCallbackInfo *)info)->peer;
+    BRPeerManager *manager = ((BRPeerCallbackInfo *)info)->manager;
+    size_t idx;
+
+    pthread_mutex_lock(&manager->lock);
+    idx = manager->filterHeight - manager->filterStartHeight + array_count(manager->filters);
+
+    if (peer != manager->downloadPeer || ! manager->filterHashesChecked || idx >= array_count(manager->filterHashes) ||
+        ! UInt256Eq(filter->blockHash, manager->filterBlockHashes[idx])) {
+        peer_log(peer, "ignoring unrequested cfilter for block %s", u256hex(filter->blockHash));
+        BRCompactFilterFree(filter);
+    }
+    else if (! UInt256Eq(BRCompactFilterHash(filter), manager->filterHashes[idx])) {
+        peer_log(peer, "cfilter for block %s doesn't match its filter header", u256hex(filter->blockHash));
+        BRCompactFilterFree(filter);
+        _BRPeerManagerResetCompactFilters(manager);
+        _BRPeerManagerPeerMisbehavin(manager, peer);
+    }
+    else {
+        if (manager->syncStartHeight > 0) {
+            BRPeerScheduleDisconnect(peer, PROTOCOL_TIMEOUT); // reschedule sync timeout
+            manager->connectFailureCount = 0;
+        }
+
+        array_add(manager->filters, filter);
+        _BRPeerManagerCheckCompactFilters(manager);
+    }
+
+    pthread_mutex_unlock(&manager->lock);
+}
+
+static void _peerRelayedFullBlock(void *info, BRMerkleBlock *block, const UInt256 txHashes[], BRTransaction *txs[],
+                                  size_t txCount)
+{
+    BRPeer *peer = ((BRPeerCallbackInfo *)info)->peer;
+    BRPeerManager *manager = ((BRPeerCallbackInfo *)info)->manager;
+    UInt256 blockHash = block->blockHash;
+    uint8_t *matches = calloc(txCount, sizeof(*matches));
+    int requested;
+
+    assert(matches != NULL);
+    pthread_mutex_lock(&manager->lock);
+    requested = (peer == manager->downloadPeer && UInt256Eq(blockHash, manager->fullBlockHash));
+    pthread_mutex_unlock(&manager->lock);
+
+    for (size_t i = 0; i < txCount; i++) {
+        if (! txs[i]) continue; // not wanted by _peerWantsTx()
+
+        // tx are checked in order, so a wallet tx spending an earlier wallet tx in the same block is found
+        if (requested && BRWalletContainsTransaction(manager->wallet, txs[i])) {
+            matches[i] = 1;
+            _peerRelayedTx(info, txs[i]); // registers the tx with the wallet
+        }
+        else BRTransactionFree(txs[i]);
+    }
+
+    if (requested) {
+        peer_log(peer, "checking %zu tx in matched block %s", txCount, u256hex(blockHash));
+        BRMerkleBlockSetPartialTree(block, txHashes, matches, txCount);
+        _peerRelayedBlock(info, block); // sets the block height for matched tx
+
+        pthread_mutex_lock(&manager->lock);
+
+        if (UInt256Eq(blockHash, manager->fullBlockHash) && array_count(manager->filters) > 0) {
+            BRCompactFilterFree(manager->filters[0]);
+            array_rm(manager->filters, 0);
+            manager->filterHeader = BRCompactFilterHeader(manager->filterHashes[manager->filterHeight -
+                                                                                manager->filterStartHeight],
+                                                          manager->filterHeader);
+            manager->filterHeight++;
+            manager->fullBlockHash = UINT256_ZERO;
+            _BRPeerManagerCheckCompactFilters(manager);
+        }
+
+        pthread_mutex_unlock(&manager->lock);
+    }
+    else {
+        peer_log(peer, "ignoring unrequested block %s", u256hex(blockHash));
+        BRMerkleBlockFree(block);
+    }
+
+    free(matches);
+}
+
 static void _peerDataNotfound(void *info, const UInt256 txHashes[], size_t txCount,
                              const UInt256 blockHashes[], size_t blockCount)
 {
@@ -1529,6 +2093,7 @@ BRPeerManager *BRPeerManagerNew(const BRChainParams *params, BRWallet *wallet, u
     if (peers) array_add_array(manager->peers, peers, peersCount);
     qsort(manager->peers, array_count(manager->peers), sizeof(*manager->peers), _peerTimestampCompare);
     array_new(manager->connectedPeers, PEER_MAX_CONNECTIONS);
+    array_new(manager->qualities, 100);
     manager->blocks = BRSetNew(BRMerkleBlockHash, BRMerkleBlockEq, blocksCount);
     manager->orphans = BRSetNew(_BRPrevBlockHash, _BRPrevBlockEq, blocksCount); // orphans are indexed by prevBlock
     manager->checkpoints = BRSetNew(_BRBlockHeightHash, _BRBlockHeightEq, 100); // checkpoints are indexed by height
@@ -1572,6 +2137,12 @@ BRPeerManager *BRPeerManagerNew(const BRChainParams *params, BRWallet *wallet, u
     array_new(manager->txRequests, 10);
     array_new(manager->publishedTx, 10);
     array_new(manager->publishedTxHashes, 10);
+    array_new(manager->filterBlockHashes, COMPACT_FILTER_BATCH);
+    array_new(manager->filterHashes, COMPACT_FILTER_BATCH);
+    array_new(manager->filters, COMPACT_FILTER_BATCH);
+    array_new(manager->walletScriptData, 100*25);
+    array_new(manager->walletScripts, 100);
+    array_new(manager->walletScriptLens, 100);
     pthread_mutex_init(&manager->lock, NULL);
     manager->threadCleanup = _dummyThreadCleanup;
     return manager;
@@ -1608,6 +2179,30 @@ void BRPeerManagerSetCallbacks(BRPeerManager *manager, void *info,
     manager->threadCleanup = (threadCleanup) ? threadCleanup : _dummyThreadCleanup;
 }
 
+// not thread-safe, set callback once before calling BRPeerManagerConnect()
+// void savePeerQualities(void *, const BRPeerQualityEntry[], size_t) - called, with the info given to
+// BRPeerManagerSetCallbacks(), when peer qualities should be saved to the persistent store, replacing any previously saved
+void BRPeerManagerSetPeerQualityCallback(BRPeerManager *manager,
+                                         void (*savePeerQualities)(void *info, const BRPeerQualityEntry qualities[],
+                                                                   size_t qualitiesCount))
+{
+    assert(manager != NULL);
+    manager->savePeerQualities = savePeerQualities;
+}
+
+// sets the peer qualities, as previously saved, so that connections are biased toward peers that were fast and reliable
+// not thread-safe, call once before calling BRPeerManagerConnect()
+void BRPeerManagerSetPeerQualities(BRPeerManager *manager, const BRPeerQualityEntry qualities[], size_t qualitiesCount)
+{
+    assert(manager != NULL);
+    assert(qualities != NULL || qualitiesCount == 0);
+    pthread_mutex_lock(&manager->lock);
+    array_clear(manager->qualities);
+    if (qualitiesCount > PEER_QUALITY_MAX_COUNT) qualitiesCount = PEER_QUALITY_MAX_COUNT;
+    if (qualities) array_add_array(manager->qualities, qualities, qualitiesCount);
+    pthread_mutex_unlock(&manager->lock);
+}
+
 // specifies a single fixed peer to use when connecting to the bitcoin network
 // set address to UINT128_ZERO to revert to default behavior
 void BRPeerManagerSetFixedPeer(BRPeerManager *manager, UInt128 address, uint16_t port)
@@ -1629,6 +2224,145 @@ void BRPeerManagerSetFixedPeer(BRPeerManager *manager, UInt128 address, uint16_t
     }
 }
 
+// set to true to sync using BIP157/158 compact block filters instead of BIP37 bloom filters, only peers that serve
+// compact filters are used, and full blocks are downloaded for filters that match wallet scripts
+// not thread-safe, call once before calling BRPeerManagerConnect()
+void BRPeerManagerSetCompactFilterMode(BRPeerManager *manager, int compactFilterMode)
+{
+    assert(manager != NULL);
+    pthread_mutex_lock(&manager->lock);
+
+    if ((manager->compactFilterMode != 0) == (compactFilterMode != 0)) { // keep the filter sync progress
+        pthread_mutex_unlock(&manager->lock);
+        return;
+    }
+
+    manager->compactFilterMode = compactFilterMode;
+    manager->filterHeight = manager->lastBlock->height; // blocks restored from the persistent store are checked
+    manager->filterHeader = UINT256_ZERO;
+    _BRPeerManagerResetCompactFilters(manager);
+    pthread_mutex_unlock(&manager->lock);
+}
+
+// extends the chain with headers from a signed header snapshot so the chain download can start after it rather than at
+// the most recent checkpoint, the snapshot must start at a known difficulty transition block, and only linkage,
+// proof-of-work and difficulty are verified, headers less than a week older than earliestKeyTime are not used since
+// blocks that may contain wallet transactions still have to be downloaded
+// returns the number of blocks the chain was extended by
+// not thread-safe, call before calling BRPeerManagerConnect()
+size_t BRPeerManagerLoadHeaderSnapshot(BRPeerManager *manager, const BRHeaderSnapshot *snapshot)
+{
+    BRSet *blocks;
+    BRMerkleBlock *block, *prev, *b, **chain;
+    uint32_t startHeight, now = (uint32_t)time(NULL);
+    size_t i, count, r = 0;
+    int valid = 1;
+
+    assert(manager != NULL);
+    assert(snapshot != NULL);
+    startHeight = BRHeaderSnapshotStartHeight(snapshot);
+    count = BRHeaderSnapshotCount(snapshot);
+    if (count < 2 || (startHeight % BLOCK_DIFFICULTY_INTERVAL) != 0) return 0;
+
+    pthread_mutex_lock(&manager->lock);
+    prev = BRHeaderSnapshotBlock(snapshot, 0);
+    b = (prev) ? BRSetGet(manager->blocks, prev) : NULL;
+
+    // the snapshot must start at a transition block we already trust, and must extend the current chain
+    if (! b || b->height != startHeight || startHeight + count - 1 <= manager->lastBlock->height) {
+        if (prev) BRMerkleBlockFree(prev);
+        pthread_mutex_unlock(&manager->lock);
+        return 0;
+    }
+
+    blocks = BRSetNew(BRMerkleBlockHash, BRMerkleBlockEq, BLOCK_DIFFICULTY_INTERVAL + 1);
+    array_new(chain, BLOCK_DIFFICULTY_INTERVAL + 1); // blocks since the last transition block
+    BRSetAdd(blocks, prev);
+    array_add(chain, prev);
+
+    for (i = 1; valid && i < count; i++) {
+        block = BRHeaderSnapshotBlock(snapshot, i);
+        if (! block) valid = 0;
+        if (! block) break;
+
+        if (block->timestamp + 7*24*60*60 >= manager->earliestKeyTime) { // block may contain wallet transactions
+            BRMerkleBlockFree(block);
+            break;
+        }
+
+        b = BRSetGet(manager->checkpoints, block);
+
+        if (! UInt256Eq(block->prevBlock, prev->blockHash) || ! BRMerkleBlockIsValid(block, now) ||
+            ! manager->params->verifyDifficulty(block, blocks) || (b && ! BRMerkleBlockEq(block, b))) {
+            _peer_log("BPM: header snapshot has invalid block #%"PRIu32", blockHash: %s\n", block->height,
+                      u256hex(block->blockHash));
+            BRMerkleBlockFree(block);
+            valid = 0;
+            break;
+        }
+
+        if ((block->height % BLOCK_DIFFICULTY_INTERVAL) == 0) { // only blocks since the last transition are needed
+            for (size_t j = 0; j < array_count(chain); j++) {
+                BRSetRemove(blocks, chain[j]);
+                BRMerkleBlockFree(chain[j]);
+            }
+
+            array_clear(chain);
+        }
+
+        BRSetAdd(blocks, block);
+        array_add(chain, block);
+        prev = block;
+    }
+
+    if (valid && prev->height > manager->lastBlock->height) {
+        UInt256 lastHash = prev->blockHash;
+
+        r = prev->height - manager->lastBlock->height;
+
+        for (i = 0; i < array_count(chain); i++) {
+            b = BRSetGet(manager->blocks, chain[i]);
+
+            if (b && BRSetGet(manager->checkpoints, b) == b) { // replace the checkpoint with its full header
+                BRSetAdd(manager->checkpoints, chain[i]);
+                BRSetAdd(manager->blocks, chain[i]);
+                BRMerkleBlockFree(b);
+            }
+            else if (b) BRMerkleBlockFree(chain[i]); // keep blocks we already have
+            else BRSetAdd(manager->blocks, chain[i]);
+        }
+
+        manager->lastBlock = BRSetGet(manager->blocks, &lastHash);
+        if (manager->compactFilterMode && manager->filterHeight < manager->lastBlock->height) {
+            manager->filterHeight = manager->lastBlock->height; // snapshot blocks are older than earliestKeyTime
+        }
+
+        _peer_log("BPM: header snapshot loaded with %u last block height\n", manager->lastBlock->height);
+    }
+    else {
+        for (i = 0; i < array_count(chain); i++) BRMerkleBlockFree(chain[i]);
+    }
+
+    array_free(chain);
+    BRSetFree(blocks);
+
+    if (r > 0) {
+        size_t saveCount = (manager->lastBlock->height % BLOCK_DIFFICULTY_INTERVAL) + 1;
+        BRMerkleBlock *saveBlocks[saveCount];
+
+        for (i = 0, b = manager->lastBlock; b && i < saveCount; i++) {
+            saveBlocks[i] = b;
+            b = BRSetGet(manager->blocks, &b->prevBlock);
+        }
+
+        // replace saved blocks, since the snapshot chain may not connect to them
+        if (i > 0 && manager->saveBlocks) manager->saveBlocks(manager->info, 1, saveBlocks, i);
+    }
+
+    pthread_mutex_unlock(&manager->lock);
+    return r;
+}
+
 // current connect status
 BRPeerStatus BRPeerManagerConnectStatus(BRPeerManager *manager)
 {
@@ -1680,12 +2414,13 @@ void BRPeerManagerConnect(BRPeerManager *manager)
         array_new(peers, 100);
         array_add_array(peers, manager->peers,
                         (array_count(manager->peers) < 100) ? array_count(manager->peers) : 100);
+        _BRPeerManagerSortPeersByQuality(manager, peers, array_count(peers));
 
         while (array_count(peers) > 0 && array_count(manager->connectedPeers) < manager->maxConnectCount) {
             size_t i = BRRand((uint32_t)array_count(peers)); // index of random peer
             BRPeerCallbackInfo *info;
             
-            i = i*i/array_count(peers); // bias random peer selection toward peers with more recent timestamp
+            i = i*i/array_count(peers); // bias random peer selection toward peers with better quality
         
             for (size_t j = array_count(manager->connectedPeers); i != SIZE_MAX && j > 0; j--) {
                 if (! BRPeerEq(&peers[i], manager->connectedPeers[j - 1])) continue;
@@ -1705,6 +2440,13 @@ void BRPeerManagerConnect(BRPeerManager *manager)
                 BRPeerSetCallbacks(info->peer, info, _peerConnected, _peerDisconnected, _peerRelayedPeers,
                                    _peerRelayedTx, _peerHasTx, _peerRejectedTx, _peerRelayedBlock, _peerDataNotfound,
                                    _peerSetFeePerKb, _peerRequestedTx, _peerNetworkIsReachable, _peerThreadCleanup);
+                if (manager->compactFilterMode) {
+                    BRPeerSetCompactFilterCallbacks(info->peer, _peerRelayedFilterHeaders, _peerRelayedFilter,
+                                                    _peerRelayedFullBlock);
+                }
+
+                BRPeerSetTxFilterCallback(info->peer, _peerWantsTx);
+
                 BRPeerSetEarliestKeyTime(info->peer, manager->earliestKeyTime);
                 BRPeerConnect(info->peer);
 
@@ -1765,6 +2507,7 @@ void BRPeerManagerDisconnect(BRPeerManager *manager)
     pthread_mutex_lock(&manager->lock);
     manager->maxConnectCount = maxConnectCount;
     pthread_mutex_unlock(&manager->lock);
+    _BRPeerManagerSavePeerQualities(manager);
 }
 
 static int _BRPeerManagerRescan(BRPeerManager *manager, BRMerkleBlock *newLastBlock) {
@@ -1772,6 +2515,9 @@ static int _BRPeerManagerRescan(BRPeerManager *manager, BRMerkleBlock *newLastBl
 
     manager->lastBlock = newLastBlock;
     _peer_log("BPM: rescanning with %u last block height", manager->lastBlock->height);
+    _BRPeerManagerResetCompactFilters(manager);
+    manager->filterHeight = newLastBlock->height;
+    manager->filterHeader = UINT256_ZERO;
 
     if (manager->downloadPeer) { // disconnect the current download peer so a new random one will be selected
         for (size_t i = array_count(manager->peers); i > 0; i--) {
@@ -2073,6 +2819,7 @@ void BRPeerManagerFree(BRPeerManager *manager)
     array_free(manager->peers);
     for (size_t i = array_count(manager->connectedPeers); i > 0; i--) BRPeerFree(manager->connectedPeers[i - 1]);
     array_free(manager->connectedPeers);
+    array_free(manager->qualities);
     BRSetApply(manager->blocks, NULL, _setApplyFreeBlock);
     BRSetFree(manager->blocks);
     BRSetApply(manager->orphans, NULL, _setApplyFreeBlock);
@@ -2089,6 +2836,13 @@ void BRPeerManagerFree(BRPeerManager *manager)
     }
 
     if (manager->bloomFilter) BRBloomFilterFree(manager->bloomFilter);
+    _BRPeerManagerResetCompactFilters(manager);
+    array_free(manager->filterBlockHashes);
+    array_free(manager->filterHashes);
+    array_free(manager->filters);
+    array_free(manager->walletScriptData);
+    array_free(manager->walletScripts);
+    array_free(manager->walletScriptLens);
 
     array_free(manager->publishedTx);
     array_free(manager->publishedTxHashes);
@@ -27,9 +27,11 @@
 
 #include "BRPeer.h"
 #include "BRMerkleBlock.h"
+#include "BRHeaderSnapshot.h"
 #include "BRTransaction.h"
 #include "BRWallet.h"
 #include "BRChainParams.h"
+#include "support/BRPeerQuality.h"
 #include <stddef.h>
 #include <inttypes.h>
 
@@ -41,6 +43,13 @@ extern "C" {
 
 typedef struct BRPeerManagerStruct BRPeerManager;
 
+// the quality of the peer with the given address and port, see BRPeerQuality.h
+typedef struct {
+    UInt128 address; // IPv6 address of peer
+    uint16_t port; // port number for peer connection
+    BRPeerQuality quality;
+} BRPeerQualityEntry;
+
 // returns a newly allocated BRPeerManager struct that must be freed by calling BRPeerManagerFree()
 BRPeerManager *BRPeerManagerNew(const BRChainParams *params, BRWallet *wallet, uint32_t earliestKeyTime,
                                 BRMerkleBlock *blocks[], size_t blocksCount, const BRPeer peers[], size_t peersCount);
@@ -65,10 +74,36 @@ void BRPeerManagerSetCallbacks(BRPeerManager *manager, void *info,
                                int (*networkIsReachable)(void *info),
                                void (*threadCleanup)(void *info));
 
+// not thread-safe, set callback once before calling BRPeerManagerConnect()
+// void savePeerQualities(void *, const BRPeerQualityEntry[], size_t) - called, with the info given to
+// BRPeerManagerSetCallbacks(), when peer qualities should be saved to the persistent store, replacing any previously saved
+void BRPeerManagerSetPeerQualityCallback(BRPeerManager *manager,
+                                         void (*savePeerQualities)(void *info, const BRPeerQualityEntry qualities[],
+                                                                   size_t qualitiesCount));
+
+// sets the peer qualities, as previously saved, so that connections are biased toward peers that were fast and reliable
+// not thread-safe, call once before calling BRPeerManagerConnect()
+void BRPeerManagerSetPeerQualities(BRPeerManager *manager, const BRPeerQualityEntry qualities[], size_t qualitiesCount);
+
 // specifies a single fixed peer to use when connecting to the bitcoin network
 // set address to UINT128_ZERO to revert to default behavior
 void BRPeerManagerSetFixedPeer(BRPeerManager *manager, UInt128 address, uint16_t port);
 
+// set to true to sync using BIP157/158 compact block filters instead of BIP37 bloom filters, only peers that serve
+// compact filters are used, and full blocks are downloaded for filters that match wallet scripts
+// filter headers are only trusted once a second peer agrees on them, unless a fixed peer is set
+// peers relay every tx, which is matched against the wallet locally, there is no mempool request
+// call before BRPeerManagerConnect(), setting the mode that's already set has no effect
+void BRPeerManagerSetCompactFilterMode(BRPeerManager *manager, int compactFilterMode);
+
+// extends the chain with headers from a signed header snapshot so the chain download can start after it rather than at
+// the most recent checkpoint, the snapshot must start at a known difficulty transition block, and only linkage,
+// proof-of-work and difficulty are verified, headers less than a week older than earliestKeyTime are not used since
+// blocks that may contain wallet transactions still have to be downloaded
+// returns the number of blocks the chain was extended by
+// not thread-safe, call before calling BRPeerManagerConnect()
+size_t BRPeerManagerLoadHeaderSnapshot(BRPeerManager *manager, const BRHeaderSnapshot *snapshot);
+
 // current connect status
 BRPeerStatus BRPeerManagerConnectStatus(BRPeerManager *manager);
 
@@ -27,6 +27,8 @@
 #include <stdlib.h>
 #include <limits.h>
 #include <time.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #define TX_VERSION           0x00000001
 #define TX_LOCKTIME          0x00000000
@@ -35,6 +37,7 @@
 #define SIGHASH_SINGLE       0x03 // sign one of the outputs, I don't care where the other outputs go
 #define SIGHASH_ANYONECANPAY 0x80 // let other people add inputs, I don't care where the rest of the bitcoins come from
 #define SIGHASH_FORKID       0x40 // use BIP143 digest method (for b-cash/b-gold signatures)
+#define TX_SIGN_MAX_THREADS  64
 
 size_t BRTxInputAddress(const BRTxInput *input, char *address, size_t addrLen, BRAddressParams params)
 {
@@ -89,12 +92,17 @@ void BRTxInputSetSignature(BRTxInput *input, const uint8_t *signature, size_t si
         array_new(input->signature, sigLen);
         array_add_array(input->signature, signature, sigLen);
     }
+
+    input->sigType = BRSignatureClassify(input->sigPKH, input->signature, input->sigLen, input->witness, input->witLen);
 }
 
 void BRTxInputSetWitness(BRTxInput *input, const uint8_t *witness, size_t witLen)
 {
     assert(input != NULL);
     assert(witness != NULL || witLen == 0);
+
+    int hadWitness = (input->witLen > 0);
+
     if (input->witness) array_free(input->witness);
     input->witness = NULL;
     input->witLen = 0;
@@ -104,6 +112,30 @@ void BRTxInputSetWitness(BRTxInput *input, const uint8_t *witness, size_t witLen
         array_new(input->witness, witLen);
         array_add_array(input->witness, witness, witLen);
     }
+
+    // an empty witness leaves the spend classified by signature, so there's no need to classify it again
+    if (hadWitness || input->witLen > 0 || input->sigType == BRScriptTypeUnclassified) {
+        input->sigType = BRSignatureClassify(input->sigPKH, input->signature, input->sigLen,
+                                             input->witness, input->witLen);
+    }
+}
+
+// writes the 20byte hash of the pubkey or redeem script that signs input to pkh20 and returns the number of bytes
+// written, the same as BRWitnessPKH() or BRSignaturePKH() but without parsing the witness or signature again
+size_t BRTxInputPKH(const BRTxInput *input, uint8_t *pkh20)
+{
+    BRScriptType type;
+
+    assert(input != NULL);
+    assert(pkh20 != NULL);
+    type = input->sigType;
+
+    if (type == BRScriptTypeUnclassified) { // an input that wasn't set with BRTxInputSetSignature/Witness()
+        type = BRSignatureClassify(pkh20, input->signature, input->sigLen, input->witness, input->witLen);
+    }
+    else if (type != BRScriptTypeNonStandard) memcpy(pkh20, input->sigPKH, 20);
+
+    return (type != BRScriptTypeNonStandard) ? 20 : 0;
 }
 
 // serializes a tx input for a signature pre-image
@@ -149,6 +181,8 @@ void BRTxOutputSetAddress(BRTxOutput *output, BRAddressParams params, const char
         array_set_count(output->script, output->scriptLen);
         BRAddressScriptPubKey(output->script, output->scriptLen, params, address);
     }
+
+    output->scriptType = BRScriptClassify(output->scriptHash, output->script, output->scriptLen);
 }
 
 void BRTxOutputSetScript(BRTxOutput *output, const uint8_t *script, size_t scriptLen)
@@ -163,6 +197,26 @@ void BRTxOutputSetScript(BRTxOutput *output, const uint8_t *script, size_t scrip
         array_new(output->script, scriptLen);
         array_add_array(output->script, script, scriptLen);
     }
+
+    output->scriptType = BRScriptClassify(output->scriptHash, output->script, output->scriptLen);
+}
+
+// returns a pointer to the 20byte pubkey-hash that output pays to, or NULL if none, the same as BRScriptPKH() but
+// without parsing the script again
+const uint8_t *BRTxOutputPKH(const BRTxOutput *output)
+{
+    assert(output != NULL);
+
+    switch (output->scriptType) {
+        case BRScriptTypeUnclassified: // an output that wasn't set with BRTxOutputSetScript/Address()
+            return BRScriptPKH(output->script, output->scriptLen);
+        case BRScriptTypeP2PKH:
+        case BRScriptTypeP2SH:
+        case BRScriptTypeP2WPKH:
+            return output->scriptHash;
+        default:
+            return NULL;
+    }
 }
 
 // serializes the tx output at index for a signature pre-image
@@ -184,44 +238,66 @@ static size_t _BRTransactionOutputData(const BRTransaction *tx, uint8_t *data, s
     return (! data || off <= dataLen) ? off : 0;
 }
 
+// BIP143 hashes shared by the signature pre-images of all the inputs of a tx, computed once per tx so that each
+// input's pre-image takes constant time rather than time linear in the size of the tx
+typedef struct {
+    UInt256 hashPrevouts;
+    UInt256 hashSequence;
+    UInt256 hashOutputs;
+} BRTxSigHashCache;
+
+static void _BRTxSigHashCacheInit(BRTxSigHashCache *cache, const BRTransaction *tx)
+{
+    size_t i, len = (sizeof(UInt256) + sizeof(uint32_t))*tx->inCount,
+           outLen = _BRTransactionOutputData(tx, NULL, 0, SIZE_MAX);
+    uint8_t _buf[0x1000], *buf = (len < outLen ? outLen : len) <= sizeof(_buf) ? _buf :
+                                 malloc(len < outLen ? outLen : len);
+
+    assert(buf != NULL);
+
+    for (i = 0; i < tx->inCount; i++) {
+        UInt256Set(&buf[(sizeof(UInt256) + sizeof(uint32_t))*i], tx->inputs[i].txHash);
+        UInt32SetLE(&buf[(sizeof(UInt256) + sizeof(uint32_t))*i + sizeof(UInt256)], tx->inputs[i].index);
+    }
+
+    BRSHA256_2(&cache->hashPrevouts, buf, (sizeof(UInt256) + sizeof(uint32_t))*tx->inCount); // inputs hash
+    for (i = 0; i < tx->inCount; i++) UInt32SetLE(&buf[sizeof(uint32_t)*i], tx->inputs[i].sequence);
+    BRSHA256_2(&cache->hashSequence, buf, sizeof(uint32_t)*tx->inCount); // sequence hash
+    outLen = _BRTransactionOutputData(tx, buf, outLen, SIZE_MAX);
+    BRSHA256_2(&cache->hashOutputs, buf, outLen); // SIGHASH_ALL outputs hash
+    if (buf != _buf) free(buf);
+}
+
 // writes the BIP143 witness program data that needs to be hashed and signed for the tx input at index
 // https://github.com/bitcoin/bips/blob/master/bip-0143.mediawiki
+// cache may be NULL, in which case the shared hashes are computed for this input alone
 // returns number of bytes written, or total len needed if data is NULL
-static size_t _BRTransactionWitnessData(const BRTransaction *tx, uint8_t *data, size_t dataLen, size_t index,
-                                        int hashType)
+static size_t _BRTransactionWitnessData(const BRTransaction *tx, const BRTxSigHashCache *cache, uint8_t *data,
+                                        size_t dataLen, size_t index, int hashType)
 {
+    BRTxSigHashCache _cache;
     BRTxInput input;
     int anyoneCanPay = (hashType & SIGHASH_ANYONECANPAY), sigHash = (hashType & 0x1f);
-    size_t i, off = 0;
+    size_t off = 0;
     uint8_t scriptCode[] = { OP_DUP, OP_HASH160, 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
                              0, 0, 0, 0, 0, 0, 0, 0, 0, OP_EQUALVERIFY, OP_CHECKSIG };
 
     if (index >= tx->inCount) return 0;
+    if (data && ! cache) _BRTxSigHashCacheInit(&_cache, tx), cache = &_cache;
     if (data && off + sizeof(uint32_t) <= dataLen) UInt32SetLE(&data[off], tx->version); // tx version
     off += sizeof(uint32_t);
     
-    if (! anyoneCanPay) {
-        uint8_t buf[(sizeof(UInt256) + sizeof(uint32_t))*tx->inCount];
-        
-        for (i = 0; i < tx->inCount; i++) {
-            UInt256Set(&buf[(sizeof(UInt256) + sizeof(uint32_t))*i], tx->inputs[i].txHash);
-            UInt32SetLE(&buf[(sizeof(UInt256) + sizeof(uint32_t))*i + sizeof(UInt256)], tx->inputs[i].index);
-        }
-        
-        if (data && off + sizeof(UInt256) <= dataLen) BRSHA256_2(&data[off], buf, sizeof(buf)); // inputs hash
+    if (data && off + sizeof(UInt256) <= dataLen) { // inputs hash, or zero for anyone-can-pay
+        UInt256Set(&data[off], (! anyoneCanPay) ? cache->hashPrevouts : UINT256_ZERO);
     }
-    else if (data && off + sizeof(UInt256) <= dataLen) UInt256Set(&data[off], UINT256_ZERO); // anyone-can-pay
-    
+
     off += sizeof(UInt256);
-    
-    if (! anyoneCanPay && sigHash != SIGHASH_SINGLE && sigHash != SIGHASH_NONE) {
-        uint8_t buf[sizeof(uint32_t)*tx->inCount];
-        
-        for (i = 0; i < tx->inCount; i++) UInt32SetLE(&buf[sizeof(uint32_t)*i], tx->inputs[i].sequence);
-        if (data && off + sizeof(UInt256) <= dataLen) BRSHA256_2(&data[off], buf, sizeof(buf)); // sequence hash
+
+    if (data && off + sizeof(UInt256) <= dataLen) { // sequence hash
+        UInt256Set(&data[off], (! anyoneCanPay && sigHash != SIGHASH_SINGLE && sigHash != SIGHASH_NONE) ?
+                   cache->hashSequence : UINT256_ZERO);
     }
-    else if (data && off + sizeof(UInt256) <= dataLen) UInt256Set(&data[off], UINT256_ZERO);
-    
+
     off += sizeof(UInt256);
     input = tx->inputs[index];
     input.signature = input.script; // TODO: handle OP_CODESEPARATOR
@@ -236,12 +312,7 @@ static size_t _BRTransactionWitnessData(const BRTransaction *tx, uint8_t *data,
     off += _BRTxInputData(&input, (data ? &data[off] : NULL), (off <= dataLen ? dataLen - off : 0));
     
     if (sigHash != SIGHASH_SINGLE && sigHash != SIGHASH_NONE) {
-        size_t bufLen = _BRTransactionOutputData(tx, NULL, 0, SIZE_MAX);
-        uint8_t _buf[0x1000], *buf = (bufLen <= 0x1000) ? _buf : malloc(bufLen);
-        
-        bufLen = _BRTransactionOutputData(tx, buf, bufLen, SIZE_MAX);
-        if (data && off + sizeof(UInt256) <= dataLen) BRSHA256_2(&data[off], buf, bufLen); // SIGHASH_ALL outputs hash
-        if (buf != _buf) free(buf);
+        if (data && off + sizeof(UInt256) <= dataLen) UInt256Set(&data[off], cache->hashOutputs); // SIGHASH_ALL
     }
     else if (sigHash == SIGHASH_SINGLE && index < tx->outCount) {
         uint8_t buf[_BRTransactionOutputData(tx, NULL, 0, index)];
@@ -268,7 +339,7 @@ static size_t _BRTransactionData(const BRTransaction *tx, uint8_t *data, size_t
     int anyoneCanPay = (hashType & SIGHASH_ANYONECANPAY), sigHash = (hashType & 0x1f), witnessFlag = 0;
     size_t i, count, len, woff, off = 0;
     
-    if (hashType & SIGHASH_FORKID) return _BRTransactionWitnessData(tx, data, dataLen, index, hashType);
+    if (hashType & SIGHASH_FORKID) return _BRTransactionWitnessData(tx, NULL, data, dataLen, index, hashType);
     if (anyoneCanPay && index >= tx->inCount) return 0;
     
     for (i = 0; index == SIZE_MAX && ! witnessFlag && i < tx->inCount; i++) {
@@ -351,6 +422,112 @@ static size_t _BRTransactionData(const BRTransaction *tx, uint8_t *data, size_t
     return (! data || off <= dataLen) ? off : 0;
 }
 
+// returns the hash that is signed for the tx input at index, using the BIP143 digest for witness inputs and when
+// hashType includes SIGHASH_FORKID, cache must hold the BIP143 hashes for tx when either applies
+static UInt256 _BRTransactionSigHash(const BRTransaction *tx, const BRTxSigHashCache *cache, size_t index,
+                                     int hashType, int witness)
+{
+    int bip143 = (witness || (hashType & SIGHASH_FORKID));
+    size_t len = (bip143) ? _BRTransactionWitnessData(tx, cache, NULL, 0, index, hashType) :
+                 _BRTransactionData(tx, NULL, 0, index, hashType);
+    uint8_t _buf[0x1000], *buf = (len <= sizeof(_buf)) ? _buf : malloc(len);
+    UInt256 md;
+
+    assert(buf != NULL);
+    len = (bip143) ? _BRTransactionWitnessData(tx, cache, buf, len, index, hashType) :
+          _BRTransactionData(tx, buf, len, index, hashType);
+    BRSHA256_2(&md, buf, len);
+    if (buf != _buf) free(buf);
+    return md;
+}
+
+// size and virtual size of tx if signed, or estimated assuming compact pubkey sigs
+static size_t _BRTransactionSize(const BRTransaction *tx, size_t *vsize)
+{
+    BRTxInput *input;
+    size_t size = 8 + BRVarIntSize(tx->inCount) + BRVarIntSize(tx->outCount), witSize = 0;
+    
+    for (size_t i = 0; i < tx->inCount; i++) {
+        input = &tx->inputs[i];
+        
+        if (input->signature && input->witness) {
+            size += sizeof(UInt256) + sizeof(uint32_t) + BRVarIntSize(input->sigLen) + input->sigLen + sizeof(uint32_t);
+            witSize += input->witLen;
+        }
+        else if (input->script && input->scriptLen > 0 && input->script[0] == OP_0) { // estimated P2WPKH input size
+            size += sizeof(UInt256) + sizeof(uint32_t) + BRVarIntSize(0) + sizeof(uint32_t);
+            witSize += TX_INPUT_SIZE - (sizeof(UInt256) + sizeof(uint32_t) + BRVarIntSize(0) + sizeof(uint32_t));
+        }
+        else size += TX_INPUT_SIZE; // estimated P2PKH input size
+    }
+    
+    for (size_t i = 0; i < tx->outCount; i++) {
+        size += sizeof(uint64_t) + BRVarIntSize(tx->outputs[i].scriptLen) + tx->outputs[i].scriptLen;
+    }
+    
+    if (witSize > 0) witSize += 2 + tx->inCount;
+    if (vsize) *vsize = (size*4 + witSize + 3)/4;
+    return size + witSize;
+}
+
+// takes ownership of the serialized signed tx in buf as the tx serialization cache
+static void _BRTransactionSetCache(BRTransaction *tx, uint8_t *buf, size_t bufLen)
+{
+    BRTransactionClearCache(tx);
+    tx->size = _BRTransactionSize(tx, &tx->vsize);
+    tx->bytes = buf;
+    tx->bytesLen = bufLen;
+}
+
+// writes the txHash of the serialized witness tx in buf to md, which excludes the marker, flag and the witnesses that
+// start at witnessOff
+static void _BRTransactionStrippedHash(UInt256 *md, const uint8_t *buf, size_t bufLen, size_t witnessOff)
+{
+    BRSHA256Context ctx;
+    UInt256 h;
+    
+    BRSHA256Init(&ctx);
+    BRSHA256Update(&ctx, buf, sizeof(uint32_t)); // version
+    BRSHA256Update(&ctx, &buf[sizeof(uint32_t) + 2], witnessOff - (sizeof(uint32_t) + 2)); // inputs and outputs
+    BRSHA256Update(&ctx, &buf[bufLen - sizeof(uint32_t)], sizeof(uint32_t)); // locktime
+    BRSHA256Final(&ctx, &h);
+    BRSHA256(md, &h, sizeof(h));
+}
+
+// sets tx->txHash and tx->wtxHash from a single serialization of the signed tx, which is kept as the tx cache
+static void _BRTransactionSetHashes(BRTransaction *tx)
+{
+    size_t i, count, wlen, woff, witnessLen = 0, bufLen;
+    uint8_t *buf;
+    int witnessFlag = 0;
+
+    BRTransactionClearCache(tx);
+    bufLen = BRTransactionSerialize(tx, NULL, 0);
+    buf = malloc(bufLen);
+    assert(buf != NULL);
+    bufLen = BRTransactionSerialize(tx, buf, bufLen);
+
+    for (i = 0; i < tx->inCount; i++) {
+        if (tx->inputs[i].witLen > 0) witnessFlag = 1;
+
+        for (count = 0, woff = 0; woff < tx->inputs[i].witLen; count++) {
+            woff += BRVarInt(&tx->inputs[i].witness[woff], tx->inputs[i].witLen - woff, &wlen);
+            woff += wlen;
+        }
+
+        witnessLen += BRVarIntSize(count) + tx->inputs[i].witLen;
+    }
+
+    BRSHA256_2(&tx->wtxHash, buf, bufLen);
+
+    if (witnessFlag) { // txHash excludes the marker, flag and witnesses
+        _BRTransactionStrippedHash(&tx->txHash, buf, bufLen, bufLen - sizeof(uint32_t) - witnessLen);
+    }
+    else tx->txHash = tx->wtxHash;
+
+    _BRTransactionSetCache(tx, buf, bufLen);
+}
+
 // returns a newly allocated empty transaction that must be freed by calling BRTransactionFree()
 BRTransaction *BRTransactionNew(void)
 {
@@ -377,6 +554,8 @@ BRTransaction *BRTransactionCopy(const BRTransaction *tx)
     cpy->inputs = inputs;
     cpy->outputs = outputs;
     cpy->inCount = cpy->outCount = 0;
+    cpy->bytes = NULL;
+    cpy->bytesLen = 0;
 
     for (size_t i = 0; i < tx->inCount; i++) {
         BRTransactionAddInput(cpy, tx->inputs[i].txHash, tx->inputs[i].index, tx->inputs[i].amount,
@@ -389,6 +568,15 @@ BRTransaction *BRTransactionCopy(const BRTransaction *tx)
         BRTransactionAddOutput(cpy, tx->outputs[i].amount, tx->outputs[i].script, tx->outputs[i].scriptLen);
     }
 
+    if (tx->bytes) {
+        cpy->bytes = malloc(tx->bytesLen);
+        assert(cpy->bytes != NULL);
+        memcpy(cpy->bytes, tx->bytes, tx->bytesLen);
+        cpy->bytesLen = tx->bytesLen;
+        cpy->size = tx->size;
+        cpy->vsize = tx->vsize;
+    }
+
     return cpy;
 }
 
@@ -400,7 +588,7 @@ BRTransaction *BRTransactionParse(const uint8_t *buf, size_t bufLen)
     if (! buf) return NULL;
     
     int isSigned = 1, witnessFlag = 0;
-    uint8_t *sBuf;
+    uint8_t *bytes;
     size_t i, j, off = 0, witnessOff = 0, sLen = 0, len = 0, count;
     BRTransaction *tx = BRTransactionNew();
     BRTxInput *input;
@@ -477,31 +665,199 @@ BRTransaction *BRTransactionParse(const uint8_t *buf, size_t bufLen)
         BRTransactionFree(tx);
         tx = NULL;
     }
-    else if (isSigned && witnessFlag) {
-        BRSHA256_2(&tx->wtxHash, buf, off);
-        sBuf = malloc((witnessOff - 2) + sizeof(uint32_t));
-        UInt32SetLE(sBuf, tx->version);
-        memcpy(&sBuf[sizeof(uint32_t)], &buf[sizeof(uint32_t) + 2], witnessOff - (sizeof(uint32_t) + 2));
-        UInt32SetLE(&sBuf[witnessOff - 2], tx->lockTime);
-        BRSHA256_2(&tx->txHash, sBuf, (witnessOff - 2) + sizeof(uint32_t));
-        free(sBuf);
-    }
     else if (isSigned) {
-        BRSHA256_2(&tx->txHash, buf, off);
-        tx->wtxHash = tx->txHash;
+        BRSHA256_2(&tx->wtxHash, buf, off);
+        
+        if (witnessFlag) _BRTransactionStrippedHash(&tx->txHash, buf, off, witnessOff);
+        else tx->txHash = tx->wtxHash;
+        
+        bytes = malloc(off);
+        assert(bytes != NULL);
+        memcpy(bytes, buf, off);
+        _BRTransactionSetCache(tx, bytes, off);
     }
     
     return tx;
 }
 
+// buf must contain a serialized tx, which is validated exactly as BRTransactionParse() would
+// returns the length of the serialized tx viewed, or 0 if it's malformed or unsigned (use BRTransactionParse() instead)
+size_t BRTransactionViewParse(BRTransactionView *view, const uint8_t *buf, size_t bufLen)
+{
+    assert(view != NULL);
+    assert(buf != NULL || bufLen == 0);
+    if (! buf) return 0;
+
+    int witnessFlag = 0;
+    size_t i, j, off = 0, sLen = 0, len = 0, count;
+
+    memset(view, 0, sizeof(*view));
+    view->version = (off + sizeof(uint32_t) <= bufLen) ? UInt32GetLE(&buf[off]) : 0;
+    off += sizeof(uint32_t);
+    view->inCount = (size_t)BRVarInt(&buf[off], (off <= bufLen ? bufLen - off : 0), &len);
+    off += len;
+    if (view->inCount == 0 && off + 1 <= bufLen) witnessFlag = buf[off++];
+
+    if (witnessFlag) {
+        view->inCount = (size_t)BRVarInt(&buf[off], (off <= bufLen ? bufLen - off : 0), &len);
+        off += len;
+    }
+
+    view->inOff = off;
+
+    for (i = 0; off <= bufLen && i < view->inCount; i++) {
+        off += sizeof(UInt256) + sizeof(uint32_t);
+        sLen = (size_t)BRVarInt(&buf[off], (off <= bufLen ? bufLen - off : 0), &len);
+        off += len;
+        if (off + sLen <= bufLen && BRScriptPubKeyIsValid(&buf[off], sLen)) return 0; // unsigned
+        off += sLen + sizeof(uint32_t);
+    }
+
+    view->outCount = (size_t)BRVarInt(&buf[off], (off <= bufLen ? bufLen - off : 0), &len);
+    off += len;
+    view->outOff = off;
+
+    for (i = 0; off <= bufLen && i < view->outCount; i++) {
+        off += sizeof(uint64_t);
+        sLen = (size_t)BRVarInt(&buf[off], (off <= bufLen ? bufLen - off : 0), &len);
+        off += len + sLen;
+    }
+
+    if (witnessFlag) view->witnessOff = off;
+
+    for (i = 0; witnessFlag && off <= bufLen && i < view->inCount; i++) {
+        count = (size_t)BRVarInt(&buf[off], (off <= bufLen ? bufLen - off : 0), &len);
+        off += len;
+
+        for (j = 0, sLen = 0; j < count; j++) {
+            sLen += (size_t)BRVarInt(&buf[off + sLen], (off + sLen <= bufLen ? bufLen - (off + sLen) : 0), &len);
+            sLen += len;
+        }
+
+        off += sLen;
+    }
+
+    view->lockTime = (off + sizeof(uint32_t) <= bufLen) ? UInt32GetLE(&buf[off]) : 0;
+    off += sizeof(uint32_t);
+    if (view->inCount == 0 || off > bufLen) return 0;
+
+    view->bytes = buf;
+    view->bytesLen = off;
+    BRSHA256_2(&view->wtxHash, buf, off);
+
+    if (witnessFlag) _BRTransactionStrippedHash(&view->txHash, buf, off, view->witnessOff);
+    else view->txHash = view->wtxHash;
+
+    return off;
+}
+
+// sets input to the input at cursor and advances cursor, returns false when there are no more inputs
+int BRTransactionViewNextInput(const BRTransactionView *view, BRTxViewCursor *cursor, BRTxInputView *input)
+{
+    const uint8_t *buf = view->bytes;
+    size_t j, len = 0, count, wLen;
+
+    assert(view != NULL);
+    assert(cursor != NULL);
+    assert(input != NULL);
+    if (cursor->index >= view->inCount) return 0;
+
+    if (cursor->index == 0) {
+        cursor->off = view->inOff;
+        cursor->witnessOff = view->witnessOff;
+    }
+
+    // the view was validated when parsed, so there's no need to check bounds again
+    input->txHash = UInt256Get(&buf[cursor->off]);
+    cursor->off += sizeof(UInt256);
+    input->index = UInt32GetLE(&buf[cursor->off]);
+    cursor->off += sizeof(uint32_t);
+    input->sigLen = (size_t)BRVarInt(&buf[cursor->off], view->bytesLen - cursor->off, &len);
+    cursor->off += len;
+    input->signature = &buf[cursor->off];
+    cursor->off += input->sigLen;
+    input->sequence = UInt32GetLE(&buf[cursor->off]);
+    cursor->off += sizeof(uint32_t);
+    input->witness = NULL;
+    input->witLen = 0;
+
+    if (cursor->witnessOff > 0) {
+        count = (size_t)BRVarInt(&buf[cursor->witnessOff], view->bytesLen - cursor->witnessOff, &len);
+        cursor->witnessOff += len;
+
+        for (j = 0, wLen = 0; j < count; j++) {
+            wLen += (size_t)BRVarInt(&buf[cursor->witnessOff + wLen], view->bytesLen - (cursor->witnessOff + wLen),
+                                     &len);
+            wLen += len;
+        }
+
+        input->witness = &buf[cursor->witnessOff];
+        input->witLen = wLen;
+        cursor->witnessOff += wLen;
+    }
+
+    cursor->index++;
+    return 1;
+}
+
+// sets output to the output at cursor and advances cursor, returns false when there are no more outputs
+int BRTransactionViewNextOutput(const BRTransactionView *view, BRTxViewCursor *cursor, BRTxOutputView *output)
+{
+    const uint8_t *buf = view->bytes;
+    size_t len = 0;
+
+    assert(view != NULL);
+    assert(cursor != NULL);
+    assert(output != NULL);
+    if (cursor->index >= view->outCount) return 0;
+    if (cursor->index == 0) cursor->off = view->outOff;
+
+    output->amount = UInt64GetLE(&buf[cursor->off]);
+    cursor->off += sizeof(uint64_t);
+    output->scriptLen = (size_t)BRVarInt(&buf[cursor->off], view->bytesLen - cursor->off, &len);
+    cursor->off += len;
+    output->script = &buf[cursor->off];
+    cursor->off += output->scriptLen;
+    cursor->index++;
+    return 1;
+}
+
 // returns number of bytes written to buf, or total bufLen needed if buf is NULL
 // (tx->blockHeight and tx->timestamp are not serialized)
 size_t BRTransactionSerialize(const BRTransaction *tx, uint8_t *buf, size_t bufLen)
 {
     assert(tx != NULL);
+    if (tx && tx->bytes && buf && bufLen >= tx->bytesLen) memcpy(buf, tx->bytes, tx->bytesLen);
+    if (tx && tx->bytes) return (! buf || bufLen >= tx->bytesLen) ? tx->bytesLen : 0;
     return (tx) ? _BRTransactionData(tx, buf, bufLen, SIZE_MAX, SIGHASH_ALL) : 0;
 }
 
+// appends the serialized tx to buf, a byte array created with array_new() that is grown as needed
+// returns the number of bytes appended
+size_t BRTransactionSerializeAppend(const BRTransaction *tx, uint8_t **buf)
+{
+    size_t off, len;
+    
+    assert(tx != NULL);
+    assert(buf != NULL && *buf != NULL);
+    off = array_count(*buf);
+    len = BRTransactionSerialize(tx, NULL, 0);
+    array_set_count(*buf, off + len);
+    len = BRTransactionSerialize(tx, &(*buf)[off], len);
+    array_set_count(*buf, off + len);
+    return len;
+}
+
+// the serialization of a signed tx is cached, and the functions here that modify tx clear the cache
+// call this after modifying the inputs, outputs, version or lockTime of a signed tx directly
+void BRTransactionClearCache(BRTransaction *tx)
+{
+    assert(tx != NULL);
+    if (tx->bytes) free(tx->bytes);
+    tx->bytes = NULL;
+    tx->bytesLen = tx->size = tx->vsize = 0;
+}
+
 // adds an input to tx
 void BRTransactionAddInput(BRTransaction *tx, UInt256 txHash, uint32_t index, uint64_t amount,
                            const uint8_t *script, size_t scriptLen, const uint8_t *signature, size_t sigLen,
@@ -521,6 +877,7 @@ void BRTransactionAddInput(BRTransaction *tx, UInt256 txHash, uint32_t index, ui
         if (witness) BRTxInputSetWitness(&input, witness, witLen);
         array_add(tx->inputs, input);
         tx->inCount = array_count(tx->inputs);
+        BRTransactionClearCache(tx);
     }
 }
 
@@ -536,6 +893,7 @@ void BRTransactionAddOutput(BRTransaction *tx, uint64_t amount, const uint8_t *s
         BRTxOutputSetScript(&output, script, scriptLen);
         array_add(tx->outputs, output);
         tx->outCount = array_count(tx->outputs);
+        BRTransactionClearCache(tx);
     }
 }
 
@@ -543,6 +901,7 @@ void BRTransactionAddOutput(BRTransaction *tx, uint64_t amount, const uint8_t *s
 void BRTransactionShuffleOutputs(BRTransaction *tx)
 {
     assert(tx != NULL);
+    if (tx) BRTransactionClearCache(tx);
     
     for (uint32_t i = 0; tx && i + 1 < tx->outCount; i++) { // fischer-yates shuffle
         uint32_t j = i + BRRand((uint32_t)tx->outCount - i);
@@ -559,63 +918,21 @@ void BRTransactionShuffleOutputs(BRTransaction *tx)
 // size in bytes if signed, or estimated size assuming compact pubkey sigs
 size_t BRTransactionSize(const BRTransaction *tx)
 {
-    BRTxInput *input;
-    size_t size, witSize = 0;
-
     assert(tx != NULL);
-    size = (tx) ? 8 + BRVarIntSize(tx->inCount) + BRVarIntSize(tx->outCount) : 0;
-    
-    for (size_t i = 0; tx && i < tx->inCount; i++) {
-        input = &tx->inputs[i];
-        
-        if (input->signature && input->witness) {
-            size += sizeof(UInt256) + sizeof(uint32_t) + BRVarIntSize(input->sigLen) + input->sigLen + sizeof(uint32_t);
-            witSize += input->witLen;
-        }
-        else if (input->script && input->scriptLen > 0 && input->script[0] == OP_0) { // estimated P2WPKH input size
-            size += sizeof(UInt256) + sizeof(uint32_t) + BRVarIntSize(0) + sizeof(uint32_t);
-            witSize += TX_INPUT_SIZE - (sizeof(UInt256) + sizeof(uint32_t) + BRVarIntSize(0) + sizeof(uint32_t));
-        }
-        else size += TX_INPUT_SIZE; // estimated P2PKH input size
-    }
-    
-    for (size_t i = 0; tx && i < tx->outCount; i++) {
-        size += sizeof(uint64_t) + BRVarIntSize(tx->outputs[i].scriptLen) + tx->outputs[i].scriptLen;
-    }
-    
-    if (witSize > 0) witSize += 2 + tx->inCount;
-    return size + witSize;
+    if (! tx) return 0;
+    return (tx->bytes) ? tx->size : _BRTransactionSize(tx, NULL);
 }
 
 // virtual transaction size as defined by BIP141: https://github.com/bitcoin/bips/blob/master/bip-0141.mediawiki
 size_t BRTransactionVSize(const BRTransaction *tx)
 {
-    BRTxInput *input;
-    size_t size, witSize = 0;
+    size_t vsize = 0;
     
     assert(tx != NULL);
-    size = (tx) ? 8 + BRVarIntSize(tx->inCount) + BRVarIntSize(tx->outCount) : 0;
-    
-    for (size_t i = 0; i < tx->inCount; i++) {
-        input = &tx->inputs[i];
-        
-        if (input->signature && input->witness) {
-            size += sizeof(UInt256) + sizeof(uint32_t) + BRVarIntSize(input->sigLen) + input->sigLen + sizeof(uint32_t);
-            witSize += tx->inputs[i].witLen;
-        }
-        else if (input->script && input->scriptLen > 0 && input->script[0] == OP_0) { // estimated P2WPKH input size
-            size += sizeof(UInt256) + sizeof(uint32_t) + BRVarIntSize(0) + sizeof(uint32_t);
-            witSize += TX_INPUT_SIZE - (sizeof(UInt256) + sizeof(uint32_t) + BRVarIntSize(0) + sizeof(uint32_t));
-        }
-        else size += TX_INPUT_SIZE; // estimated P2PKH input size
-    }
-    
-    for (size_t i = 0; i < tx->outCount; i++) {
-        size += sizeof(uint64_t) + BRVarIntSize(tx->outputs[i].scriptLen) + tx->outputs[i].scriptLen;
-    }
-    
-    if (witSize > 0) witSize += 2 + tx->inCount;
-    return (size*4 + witSize + 3)/4;
+    if (! tx) return 0;
+    if (tx->bytes) return tx->vsize;
+    _BRTransactionSize(tx, &vsize);
+    return vsize;
 }
 
 // minimum transaction fee needed for tx to relay across the bitcoin network (bitcoind 0.12 default min-relay fee-rate)
@@ -637,84 +954,179 @@ int BRTransactionIsSigned(const BRTransaction *tx)
     return (tx) ? 1 : 0;
 }
 
+typedef struct {
+    void (*work)(void *, size_t);
+    void *info;
+    size_t count, next;
+    pthread_mutex_t lock;
+} BRTxParallelJob;
+
+static void *_BRTransactionParallelThread(void *arg)
+{
+    BRTxParallelJob *job = arg;
+    size_t i;
+
+    for (;;) {
+        pthread_mutex_lock(&job->lock);
+        i = job->next++;
+        pthread_mutex_unlock(&job->lock);
+        if (i >= job->count) break;
+        job->work(job->info, i);
+    }
+
+    return NULL;
+}
+
+// calls work(info, i) for each i from 0 to count - 1, spread over at most threadCount threads including the caller
+static void _BRTransactionParallelFor(size_t count, size_t threadCount, void (*work)(void *, size_t), void *info)
+{
+    BRTxParallelJob job = { work, info, count, 0, PTHREAD_MUTEX_INITIALIZER };
+    pthread_t threads[TX_SIGN_MAX_THREADS];
+    size_t i, n = 0;
+
+    if (threadCount == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        
+        threadCount = (cpus > 0) ? (size_t)cpus : 1;
+    }
+    
+    if (threadCount > count) threadCount = count;
+    if (threadCount > TX_SIGN_MAX_THREADS) threadCount = TX_SIGN_MAX_THREADS;
+
+    // work items are claimed in any order, but each one writes only to its own slot, so the result is deterministic
+    while (n + 1 < threadCount && pthread_create(&threads[n], NULL, _BRTransactionParallelThread, &job) == 0) n++;
+    _BRTransactionParallelThread(&job);
+    for (i = 0; i < n; i++) pthread_join(threads[i], NULL);
+    pthread_mutex_destroy(&job.lock);
+}
+
+#define TX_SIGN_P2PKH  0
+#define TX_SIGN_P2WPKH 1
+#define TX_SIGN_P2PK   2
+
+typedef struct {
+    size_t keyIdx; // index of the signing key in keys, or SIZE_MAX if the input can't be signed
+    int type; // one of TX_SIGN_P2PKH, TX_SIGN_P2WPKH or TX_SIGN_P2PK
+    uint8_t script[1 + 73 + 1 + 65]; // signature script, or witness for TX_SIGN_P2WPKH
+    size_t scriptLen;
+} BRTxInputSig;
+
+typedef struct {
+    const BRTransaction *tx;
+    BRTxSigHashCache cache;
+    int forkId;
+    BRKey *keys;
+    UInt160 *pkh;
+    BRTxInputSig *sigs;
+} BRTxSignContext;
+
+static void _BRTransactionKeyHashWork(void *info, size_t i)
+{
+    BRTxSignContext *ctx = info;
+    
+    ctx->pkh[i] = BRKeyHash160(&ctx->keys[i]); // also caches the public key, so keys are only read while signing
+}
+
+static void _BRTransactionSignWork(void *info, size_t i)
+{
+    BRTxSignContext *ctx = info;
+    BRTxInputSig *s = &ctx->sigs[i];
+    uint8_t sig[73], pubKey[65];
+    size_t sigLen, pkLen;
+    UInt256 md;
+    
+    if (s->keyIdx == SIZE_MAX) return;
+    md = _BRTransactionSigHash(ctx->tx, &ctx->cache, i, ctx->forkId | SIGHASH_ALL, (s->type == TX_SIGN_P2WPKH));
+    sigLen = BRKeySign(&ctx->keys[s->keyIdx], sig, sizeof(sig) - 1, md);
+    sig[sigLen++] = ctx->forkId | SIGHASH_ALL;
+    s->scriptLen = BRScriptPushData(s->script, sizeof(s->script), sig, sigLen);
+
+    if (s->type != TX_SIGN_P2PK) {
+        pkLen = BRKeyPubKey(&ctx->keys[s->keyIdx], pubKey, sizeof(pubKey));
+        s->scriptLen += BRScriptPushData(&s->script[s->scriptLen], sizeof(s->script) - s->scriptLen, pubKey, pkLen);
+    }
+}
+
 // adds signatures to any inputs with NULL signatures that can be signed with any keys
 // forkId is 0 for bitcoin, 0x40 for b-cash, 0x4f for b-gold
 // returns true if tx is signed
 int BRTransactionSign(BRTransaction *tx, int forkId, BRKey keys[], size_t keysCount)
 {
-    UInt160 pkh[keysCount];
+    return BRTransactionSignParallel(tx, forkId, keys, keysCount, 1);
+}
+
+// same as BRTransactionSign(), but hashes keys and signs inputs using up to threadCount threads, or one per cpu if
+// threadCount is 0
+// signatures are deterministic (RFC6979), so the result is identical to BRTransactionSign()
+int BRTransactionSignParallel(BRTransaction *tx, int forkId, BRKey keys[], size_t keysCount, size_t threadCount)
+{
+    BRTxSignContext ctx;
     size_t i, j;
+    int r = 0;
     
     assert(tx != NULL);
     assert(keys != NULL || keysCount == 0);
+    if (! tx) return 0;
     
-    for (i = 0; tx && i < keysCount; i++) {
-        pkh[i] = BRKeyHash160(&keys[i]);
-    }
+    BRTransactionClearCache(tx);
+    ctx.tx = tx;
+    ctx.forkId = forkId;
+    ctx.keys = keys;
+    ctx.pkh = calloc((keysCount > 0) ? keysCount : 1, sizeof(*ctx.pkh));
+    ctx.sigs = calloc((tx->inCount > 0) ? tx->inCount : 1, sizeof(*ctx.sigs));
+    assert(ctx.pkh != NULL && ctx.sigs != NULL);
+    _BRTransactionParallelFor(keysCount, threadCount, _BRTransactionKeyHashWork, &ctx);
+    _BRTxSigHashCacheInit(&ctx.cache, tx); // signing only changes input scripts, so the BIP143 hashes are fixed
     
-    for (i = 0; tx && i < tx->inCount; i++) {
+    for (i = 0; i < tx->inCount; i++) {
         BRTxInput *input = &tx->inputs[i];
         const uint8_t *hash = BRScriptPKH(input->script, input->scriptLen);
         
         j = 0;
-        while (j < keysCount && (! hash || ! UInt160Eq(pkh[j], UInt160Get(hash)))) j++;
+        while (j < keysCount && (! hash || ! UInt160Eq(ctx.pkh[j], UInt160Get(hash)))) j++;
+        ctx.sigs[i].keyIdx = (j < keysCount) ? j : SIZE_MAX;
         if (j >= keysCount) continue;
         
         const uint8_t *elems[BRScriptElements(NULL, 0, input->script, input->scriptLen)];
         size_t elemsCount = BRScriptElements(elems, sizeof(elems)/sizeof(*elems), input->script, input->scriptLen);
-        uint8_t pubKey[BRKeyPubKey(&keys[j], NULL, 0)];
-        size_t pkLen = BRKeyPubKey(&keys[j], pubKey, sizeof(pubKey));
-        uint8_t sig[73], script[1 + sizeof(sig) + 1 + sizeof(pubKey)];
-        size_t sigLen, scriptLen;
-        UInt256 md = UINT256_ZERO;
         
         if (elemsCount == 2 && *elems[0] == OP_0 && *elems[1] == 20) { // pay-to-witness-pubkey-hash
-            uint8_t data[_BRTransactionWitnessData(tx, NULL, 0, i, forkId | SIGHASH_ALL)];
-            size_t dataLen = _BRTransactionWitnessData(tx, data, sizeof(data), i, forkId | SIGHASH_ALL);
-            
-            BRSHA256_2(&md, data, dataLen);
-            sigLen = BRKeySign(&keys[j], sig, sizeof(sig) - 1, md);
-            sig[sigLen++] = forkId | SIGHASH_ALL;
-            scriptLen = BRScriptPushData(script, sizeof(script), sig, sigLen);
-            scriptLen += BRScriptPushData(&script[scriptLen], sizeof(script) - scriptLen, pubKey, pkLen);
-            BRTxInputSetSignature(input, script, 0);
-            BRTxInputSetWitness(input, script, scriptLen);
+            ctx.sigs[i].type = TX_SIGN_P2WPKH;
         }
         else if (elemsCount >= 2 && *elems[elemsCount - 2] == OP_EQUALVERIFY) { // pay-to-pubkey-hash
-            uint8_t data[_BRTransactionData(tx, NULL, 0, i, forkId | SIGHASH_ALL)];
-            size_t dataLen = _BRTransactionData(tx, data, sizeof(data), i, forkId | SIGHASH_ALL);
-            
-            BRSHA256_2(&md, data, dataLen);
-            sigLen = BRKeySign(&keys[j], sig, sizeof(sig) - 1, md);
-            sig[sigLen++] = forkId | SIGHASH_ALL;
-            scriptLen = BRScriptPushData(script, sizeof(script), sig, sigLen);
-            scriptLen += BRScriptPushData(&script[scriptLen], sizeof(script) - scriptLen, pubKey, pkLen);
-            BRTxInputSetSignature(input, script, scriptLen);
-            BRTxInputSetWitness(input, script, 0);
-        }
-        else { // pay-to-pubkey
-            uint8_t data[_BRTransactionData(tx, NULL, 0, i, forkId | SIGHASH_ALL)];
-            size_t dataLen = _BRTransactionData(tx, data, sizeof(data), i, forkId | SIGHASH_ALL);
-
-            BRSHA256_2(&md, data, dataLen);
-            sigLen = BRKeySign(&keys[j], sig, sizeof(sig) - 1, md);
-            sig[sigLen++] = forkId | SIGHASH_ALL;
-            scriptLen = BRScriptPushData(script, sizeof(script), sig, sigLen);
-            BRTxInputSetSignature(input, script, scriptLen);
-            BRTxInputSetWitness(input, script, 0);
+            ctx.sigs[i].type = TX_SIGN_P2PKH;
         }
+        else ctx.sigs[i].type = TX_SIGN_P2PK; // pay-to-pubkey
     }
     
-    if (tx && BRTransactionIsSigned(tx)) {
-        uint8_t data[BRTransactionSerialize(tx, NULL, 0)];
-        size_t len = BRTransactionSerialize(tx, data, sizeof(data));
-        BRTransaction *t = BRTransactionParse(data, len);
+    // the signature hashes only read tx, so inputs can be signed concurrently and the scripts set afterwards in order
+    _BRTransactionParallelFor(tx->inCount, threadCount, _BRTransactionSignWork, &ctx);
+    
+    for (i = 0; i < tx->inCount; i++) {
+        BRTxInputSig *s = &ctx.sigs[i];
         
-        if (t) tx->txHash = t->txHash, tx->wtxHash = t->wtxHash;
-        if (t) BRTransactionFree(t);
-        return 1;
+        if (s->keyIdx == SIZE_MAX) continue;
+        
+        if (s->type == TX_SIGN_P2WPKH) {
+            BRTxInputSetSignature(&tx->inputs[i], s->script, 0);
+            BRTxInputSetWitness(&tx->inputs[i], s->script, s->scriptLen);
+        }
+        else {
+            BRTxInputSetSignature(&tx->inputs[i], s->script, s->scriptLen);
+            BRTxInputSetWitness(&tx->inputs[i], s->script, 0);
+        }
+    }
+    
+    mem_clean(ctx.sigs, ((tx->inCount > 0) ? tx->inCount : 1)*sizeof(*ctx.sigs));
+    free(ctx.sigs);
+    free(ctx.pkh);
+    
+    if (BRTransactionIsSigned(tx)) {
+        _BRTransactionSetHashes(tx);
+        r = 1;
     }
-    else return 0;
+    
+    return r;
 }
 
 // true if tx meets IsStandard() rules: https://bitcoin.org/en/developer-guide#standard-transactions
@@ -743,6 +1155,7 @@ void BRTransactionFree(BRTransaction *tx)
             BRTxOutputSetScript(&tx->outputs[i], NULL, 0);
         }
 
+        BRTransactionClearCache(tx);
         array_free(tx->outputs);
         array_free(tx->inputs);
         free(tx);
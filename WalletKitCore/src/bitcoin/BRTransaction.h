@@ -59,6 +59,8 @@ typedef struct {
     uint8_t *witness;
     size_t witLen;
     uint32_t sequence;
+    BRScriptType sigType; // the spend classified from witness, or signature if there's no witness, when either is set
+    uint8_t sigPKH[20]; // the hash of the pubkey or redeem script that signs, if sigType is standard
 } BRTxInput;
 
 size_t BRTxInputAddress(const BRTxInput *input, char *address, size_t addrLen, BRAddressParams params);
@@ -67,10 +69,16 @@ void BRTxInputSetScript(BRTxInput *input, const uint8_t *script, size_t scriptLe
 void BRTxInputSetSignature(BRTxInput *input, const uint8_t *signature, size_t sigLen);
 void BRTxInputSetWitness(BRTxInput *input, const uint8_t *witness, size_t witLen);
 
+// writes the 20byte hash of the pubkey or redeem script that signs input to pkh20 and returns the number of bytes
+// written, the same as BRWitnessPKH() or BRSignaturePKH() but without parsing the witness or signature again
+size_t BRTxInputPKH(const BRTxInput *input, uint8_t *pkh20);
+
 typedef struct {
     uint64_t amount;
     uint8_t *script;
     size_t scriptLen;
+    BRScriptType scriptType; // script classified when set
+    uint8_t scriptHash[32]; // the 20byte hash (32byte for P2WSH) that script pays to, if scriptType is standard
 } BRTxOutput;
 
 #define BR_TX_OUTPUT_NONE ((const BRTxOutput) { 0, NULL, 0 })
@@ -80,6 +88,10 @@ size_t BRTxOutputAddress(const BRTxOutput *output, char *address, size_t addrLen
 void BRTxOutputSetAddress(BRTxOutput *output, BRAddressParams params, const char *address);
 void BRTxOutputSetScript(BRTxOutput *output, const uint8_t *script, size_t scriptLen);
 
+// returns a pointer to the 20byte pubkey-hash that output pays to, or NULL if none, the same as BRScriptPKH() but
+// without parsing the script again
+const uint8_t *BRTxOutputPKH(const BRTxOutput *output);
+
 typedef struct {
     UInt256 txHash;
     UInt256 wtxHash;
@@ -91,6 +103,9 @@ typedef struct {
     uint32_t lockTime;
     uint32_t blockHeight;
     uint32_t timestamp; // time interval since unix epoch
+    uint8_t *bytes; // serialized signed tx, cached when tx is parsed or signed, NULL otherwise
+    size_t bytesLen;
+    size_t size, vsize; // BRTransactionSize() and BRTransactionVSize(), valid while bytes is cached
 } BRTransaction;
 
 // returns a newly allocated empty transaction that must be freed by calling BRTransactionFree()
@@ -103,10 +118,63 @@ BRTransaction *BRTransactionCopy(const BRTransaction *tx);
 // retruns a transaction that must be freed by calling BRTransactionFree()
 BRTransaction *BRTransactionParse(const uint8_t *buf, size_t bufLen);
 
+// a serialized signed tx that has been validated and indexed in place, without any allocation, so that it can be
+// examined before deciding to parse it with BRTransactionParse(), a view is only valid as long as the buffer it views
+typedef struct {
+    UInt256 txHash;
+    UInt256 wtxHash;
+    uint32_t version;
+    size_t inCount;
+    size_t outCount;
+    uint32_t lockTime;
+    const uint8_t *bytes; // the serialized signed tx
+    size_t bytesLen;
+    size_t inOff, outOff, witnessOff; // offsets in bytes of the first input, output and witness (witnessOff is 0 if none)
+} BRTransactionView;
+
+typedef struct {
+    UInt256 txHash;
+    uint32_t index;
+    const uint8_t *signature;
+    size_t sigLen;
+    const uint8_t *witness;
+    size_t witLen;
+    uint32_t sequence;
+} BRTxInputView;
+
+typedef struct {
+    uint64_t amount;
+    const uint8_t *script;
+    size_t scriptLen;
+} BRTxOutputView;
+
+// the position of the next input or output of a view, a cursor must be zero initialized before the first input/output
+typedef struct {
+    size_t index, off, witnessOff;
+} BRTxViewCursor;
+
+// buf must contain a serialized tx, which is validated exactly as BRTransactionParse() would
+// returns the length of the serialized tx viewed, or 0 if it's malformed or unsigned (use BRTransactionParse() instead)
+size_t BRTransactionViewParse(BRTransactionView *view, const uint8_t *buf, size_t bufLen);
+
+// sets input to the input at cursor and advances cursor, returns false when there are no more inputs
+int BRTransactionViewNextInput(const BRTransactionView *view, BRTxViewCursor *cursor, BRTxInputView *input);
+
+// sets output to the output at cursor and advances cursor, returns false when there are no more outputs
+int BRTransactionViewNextOutput(const BRTransactionView *view, BRTxViewCursor *cursor, BRTxOutputView *output);
+
 // returns number of bytes written to buf, or total bufLen needed if buf is NULL
 // (tx->blockHeight and tx->timestamp are not serialized)
 size_t BRTransactionSerialize(const BRTransaction *tx, uint8_t *buf, size_t bufLen);
 
+// appends the serialized tx to buf, a byte array created with array_new() that is grown as needed
+// returns the number of bytes appended
+size_t BRTransactionSerializeAppend(const BRTransaction *tx, uint8_t **buf);
+
+// the serialization of a signed tx is cached, and the functions here that modify tx clear the cache
+// call this after modifying the inputs, outputs, version or lockTime of a signed tx directly
+void BRTransactionClearCache(BRTransaction *tx);
+
 // adds an input to tx
 void BRTransactionAddInput(BRTransaction *tx, UInt256 txHash, uint32_t index, uint64_t amount,
                            const uint8_t *script, size_t scriptLen, const uint8_t *signature, size_t sigLen,
@@ -135,6 +203,11 @@ int BRTransactionIsSigned(const BRTransaction *tx);
 // returns true if tx is signed
 int BRTransactionSign(BRTransaction *tx, int forkId, BRKey keys[], size_t keysCount);
 
+// same as BRTransactionSign(), but hashes keys and signs inputs using up to threadCount threads, or one per cpu if
+// threadCount is 0
+// signatures are deterministic (RFC6979), so the result is identical to BRTransactionSign()
+int BRTransactionSignParallel(BRTransaction *tx, int forkId, BRKey keys[], size_t keysCount, size_t threadCount);
+
 // true if tx meets IsStandard() rules: https://bitcoin.org/en/developer-guide#standard-transactions
 int BRTransactionIsStandard(const BRTransaction *tx);
 
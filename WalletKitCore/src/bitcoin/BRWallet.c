@@ -58,7 +58,7 @@ inline static size_t _txChainIndex(const BRTransaction *tx, const UInt160 *chain
     
     for (size_t i = array_count(chain); i > 0; i--) {
         for (size_t j = 0; j < tx->outCount; j++) {
-            pkh = BRScriptPKH(tx->outputs[j].script, tx->outputs[j].scriptLen);
+            pkh = BRTxOutputPKH(&tx->outputs[j]);
             if (pkh && _pkhEq(pkh, &chain[i - 1])) return i - 1;
         }
     }
@@ -72,6 +72,7 @@ struct BRWalletStruct {
     BRUTXO *utxos;
     BRTransaction **transactions;
     BRMasterPubKey masterPubKey;
+    BRBIP32ChainKey internalKey, externalKey; // N(m/0H/chain), derived once rather than for every address
     BRAddressParams addrParams;
     UInt160 *internalChain, *externalChain;
     BRSet *allTx, *invalidTx, *pendingTx, *spentOutputs, *usedPKH, *allPKH;
@@ -139,7 +140,7 @@ static int _BRWalletContainsTx(BRWallet *wallet, const BRTransaction *tx)
     UInt160 hash;
     
     for (size_t i = 0; ! r && i < tx->outCount; i++) {
-        pkh = BRScriptPKH(tx->outputs[i].script, tx->outputs[i].scriptLen);
+        pkh = BRTxOutputPKH(&tx->outputs[i]);
         if (pkh && BRSetContains(wallet->allPKH, pkh)) r = 1;
     }
     
@@ -147,13 +148,42 @@ static int _BRWalletContainsTx(BRWallet *wallet, const BRTransaction *tx)
         BRTransaction *t = BRSetGet(wallet->allTx, &tx->inputs[i].txHash);
         uint32_t n = tx->inputs[i].index;
         
-        pkh = (t && n < t->outCount) ? BRScriptPKH(t->outputs[n].script, t->outputs[n].scriptLen) : NULL;
+        pkh = (t && n < t->outCount) ? BRTxOutputPKH(&t->outputs[n]) : NULL;
         if (pkh && BRSetContains(wallet->allPKH, pkh)) r = 1;
     }
     
     for (size_t i = 0; ! r && i < tx->inCount; i++) {
-        size_t l = (tx->inputs[i].witLen > 0) ? BRWitnessPKH(hash.u8, tx->inputs[i].witness, tx->inputs[i].witLen)
-                                              : BRSignaturePKH(hash.u8, tx->inputs[i].signature, tx->inputs[i].sigLen);
+        if (BRTxInputPKH(&tx->inputs[i], hash.u8) > 0 && BRSetContains(wallet->allPKH, &hash)) r = 1;
+    }
+
+    return r;
+}
+
+// non-threadsafe version of BRWalletContainsTransactionView(), the same checks as _BRWalletContainsTx()
+static int _BRWalletContainsTxView(BRWallet *wallet, const BRTransactionView *tx)
+{
+    int r = 0;
+    const uint8_t *pkh;
+    UInt160 hash;
+    BRTxViewCursor cur;
+    BRTxInputView in;
+    BRTxOutputView out;
+
+    for (cur = (BRTxViewCursor) { 0 }; ! r && BRTransactionViewNextOutput(tx, &cur, &out);) {
+        pkh = BRScriptPKH(out.script, out.scriptLen);
+        if (pkh && BRSetContains(wallet->allPKH, pkh)) r = 1;
+    }
+
+    for (cur = (BRTxViewCursor) { 0 }; ! r && BRTransactionViewNextInput(tx, &cur, &in);) {
+        BRTransaction *t = BRSetGet(wallet->allTx, &in.txHash);
+
+        pkh = (t && in.index < t->outCount) ? BRTxOutputPKH(&t->outputs[in.index]) : NULL;
+        if (pkh && BRSetContains(wallet->allPKH, pkh)) r = 1;
+    }
+
+    for (cur = (BRTxViewCursor) { 0 }; ! r && BRTransactionViewNextInput(tx, &cur, &in);) {
+        size_t l = (in.witLen > 0) ? BRWitnessPKH(hash.u8, in.witness, in.witLen)
+                                   : BRSignaturePKH(hash.u8, in.signature, in.sigLen);
 
         if (l > 0 && BRSetContains(wallet->allPKH, &hash)) r = 1;
     }
@@ -230,7 +260,7 @@ static void _BRWalletUpdateBalance(BRWallet *wallet)
         // TODO: don't add coin generation outputs < 100 blocks deep
         // NOTE: balance/UTXOs will then need to be recalculated when last block changes
         for (j = 0; j < tx->outCount; j++) {
-            pkh = BRScriptPKH(tx->outputs[j].script, tx->outputs[j].scriptLen);
+            pkh = BRTxOutputPKH(&tx->outputs[j]);
 
             if (pkh && BRSetContains(wallet->allPKH, pkh)) {
                 BRSetAdd(wallet->usedPKH, (void *)pkh);
@@ -271,6 +301,8 @@ BRWallet *BRWalletNew(BRAddressParams addrParams, BRTransaction *transactions[],
     array_new(wallet->transactions, txCount + 100);
     wallet->feePerKb = DEFAULT_FEE_PER_KB;
     wallet->masterPubKey = mpk;
+    wallet->internalKey = BRBIP32ChainPubKey(mpk, SEQUENCE_INTERNAL_CHAIN);
+    wallet->externalKey = BRBIP32ChainPubKey(mpk, SEQUENCE_EXTERNAL_CHAIN);
     wallet->addrParams = addrParams;
     array_new(wallet->internalChain, 100);
     array_new(wallet->externalChain, 100);
@@ -290,7 +322,7 @@ BRWallet *BRWalletNew(BRAddressParams addrParams, BRTransaction *transactions[],
         _BRWalletInsertTx(wallet, tx);
 
         for (size_t j = 0; j < tx->outCount; j++) {
-            pkh = BRScriptPKH(tx->outputs[j].script, tx->outputs[j].scriptLen);
+            pkh = BRTxOutputPKH(&tx->outputs[j]);
             if (pkh) BRSetAdd(wallet->usedPKH, (void *)pkh);
         }
     }
@@ -339,14 +371,16 @@ void BRWalletSetCallbacks(BRWallet *wallet, void *info,
 // returns the number addresses written to addrs
 size_t BRWalletUnusedAddrs(BRWallet *wallet, BRAddress addrs[], uint32_t gapLimit, uint32_t internal)
 {
-    UInt160 *chain = NULL, *origChain;
-    size_t i, j = 0, count, startCount;
+    UInt160 *chain = NULL, *origChain, pkh;
+    const BRBIP32ChainKey *chainKey = NULL;
+    BRECPoint *pubKeys;
+    size_t i, j = 0, k, n, count, startCount;
 
     assert(wallet != NULL);
     assert(gapLimit > 0);
     pthread_mutex_lock(&wallet->lock);
-    if (internal == SEQUENCE_EXTERNAL_CHAIN) chain = wallet->externalChain;
-    if (internal == SEQUENCE_INTERNAL_CHAIN) chain = wallet->internalChain;
+    if (internal == SEQUENCE_EXTERNAL_CHAIN) chain = wallet->externalChain, chainKey = &wallet->externalKey;
+    if (internal == SEQUENCE_INTERNAL_CHAIN) chain = wallet->internalChain, chainKey = &wallet->internalKey;
     assert(chain != NULL);
     origChain = chain;
     i = count = startCount = array_count(chain);
@@ -354,15 +388,20 @@ size_t BRWalletUnusedAddrs(BRWallet *wallet, BRAddress addrs[], uint32_t gapLimi
     // keep only the trailing contiguous block of addresses with no transactions
     while (i > 0 && ! BRSetContains(wallet->usedPKH, &chain[i - 1])) i--;
     
-    while (i + gapLimit > count) { // generate new addresses up to gapLimit
-        BRKey key;
-        uint8_t pubKey[BRBIP32PubKey(NULL, 0, wallet->masterPubKey, internal, count)];
-        size_t len = BRBIP32PubKey(pubKey, sizeof(pubKey), wallet->masterPubKey, internal, (uint32_t)count);
+    while (i + gapLimit > count) { // generate new addresses up to gapLimit, a batch of pubKeys at a time
+        pubKeys = malloc((i + gapLimit - count)*sizeof(*pubKeys));
+        assert(pubKeys != NULL);
+        n = BRBIP32PubKeyList(pubKeys, i + gapLimit - count, *chainKey, (uint32_t)count, 0);
         
-        if (! BRKeySetPubKey(&key, pubKey, len)) break;
-        array_add(chain, BRKeyHash160(&key));
-        count++;
-        if (BRSetContains(wallet->usedPKH, &chain[array_count(chain) - 1])) i = count;
+        for (k = 0; k < n; k++) {
+            BRHash160(&pkh, pubKeys[k].p, sizeof(pubKeys[k])); // same as BRKeyHash160() of the compressed pubKey
+            array_add(chain, pkh);
+            count++;
+            if (BRSetContains(wallet->usedPKH, &chain[array_count(chain) - 1])) i = count;
+        }
+        
+        free(pubKeys);
+        if (n == 0) break;
     }
 
     if (addrs && i + gapLimit <= count) {
@@ -730,6 +769,27 @@ BRTransaction *BRWalletCreateTxForOutputsWithFeePerKb(BRWallet *wallet, uint64_t
 // seed is the master private key (wallet seed) corresponding to the master public key given when the wallet was created
 // returns true if all inputs were signed, or false if there was an error or not all inputs were able to be signed
 int BRWalletSignTransaction(BRWallet *wallet, BRTransaction *tx, uint8_t forkId, const void *seed, size_t seedLen)
+{
+    BRBIP32PrivChainKey internalChain, externalChain;
+    int r = -1; // user canceled authentication
+    
+    if (seed) {
+        BRBIP32PrivChainKeyPath(&internalChain, seed, seedLen, 2, 0 | BIP32_HARD, SEQUENCE_INTERNAL_CHAIN);
+        BRBIP32PrivChainKeyPath(&externalChain, seed, seedLen, 2, 0 | BIP32_HARD, SEQUENCE_EXTERNAL_CHAIN);
+        // TODO: XXX wipe seed callback
+        seed = NULL;
+        r = BRWalletSignTransactionWithChainKeys(wallet, tx, forkId, &internalChain, &externalChain);
+        var_clean(&internalChain, &externalChain);
+    }
+    
+    return r;
+}
+
+// same as BRWalletSignTransaction(), with private keys derived from the extended private keys of the wallet's internal
+// and external chains, paths m/0H/1 and m/0H/0, as set by BRBIP32PrivChainKeyPath()
+int BRWalletSignTransactionWithChainKeys(BRWallet *wallet, BRTransaction *tx, uint8_t forkId,
+                                         const BRBIP32PrivChainKey *internalChain,
+                                         const BRBIP32PrivChainKey *externalChain)
 {
     uint32_t j, internalIdx[tx->inCount], externalIdx[tx->inCount];
     size_t i, internalCount = 0, externalCount = 0;
@@ -737,6 +797,8 @@ int BRWalletSignTransaction(BRWallet *wallet, BRTransaction *tx, uint8_t forkId,
     
     assert(wallet != NULL);
     assert(tx != NULL);
+    assert(internalChain != NULL);
+    assert(externalChain != NULL);
     pthread_mutex_lock(&wallet->lock);
     
     for (i = 0; tx && i < tx->inCount; i++) {
@@ -755,16 +817,10 @@ int BRWalletSignTransaction(BRWallet *wallet, BRTransaction *tx, uint8_t forkId,
 
     BRKey keys[internalCount + externalCount];
 
-    if (seed) {
-        BRBIP32PrivKeyList(keys, internalCount, seed, seedLen, SEQUENCE_INTERNAL_CHAIN, internalIdx);
-        BRBIP32PrivKeyList(&keys[internalCount], externalCount, seed, seedLen, SEQUENCE_EXTERNAL_CHAIN, externalIdx);
-        // TODO: XXX wipe seed callback
-        seed = NULL;
-        if (tx) r = BRTransactionSign(tx, forkId, keys, internalCount + externalCount);
-        for (i = 0; i < internalCount + externalCount; i++) BRKeyClean(&keys[i]);
-    }
-    else r = -1; // user canceled authentication
-    
+    BRBIP32PrivKeyListFromChain(keys, internalCount, internalChain, internalIdx);
+    BRBIP32PrivKeyListFromChain(&keys[internalCount], externalCount, externalChain, externalIdx);
+    if (tx) r = BRTransactionSignParallel(tx, forkId, keys, internalCount + externalCount, 0);
+    for (i = 0; i < internalCount + externalCount; i++) BRKeyClean(&keys[i]);
     return r;
 }
 
@@ -781,6 +837,19 @@ int BRWalletContainsTransaction(BRWallet *wallet, const BRTransaction *tx)
     return r;
 }
 
+// true if the tx viewed is associated with the wallet, this lets a relayed tx be checked before it's parsed
+int BRWalletContainsTransactionView(BRWallet *wallet, const BRTransactionView *tx)
+{
+    int r = 0;
+
+    assert(wallet != NULL);
+    assert(tx != NULL);
+    pthread_mutex_lock(&wallet->lock);
+    if (tx) r = _BRWalletContainsTxView(wallet, tx);
+    pthread_mutex_unlock(&wallet->lock);
+    return r;
+}
+
 // adds a transaction to the wallet, or returns false if it isn't associated with the wallet
 int BRWalletRegisterTransaction(BRWallet *wallet, BRTransaction *tx)
 {
@@ -1018,14 +1087,10 @@ static int _BRWalletContainsTxInput(BRWallet *wallet, const BRTransaction *tx, c
     BRTransaction *t = BRSetGet(wallet->allTx, &txInput->txHash);
     uint32_t n = txInput->index;
 
-    pkh = (t && n < t->outCount) ? BRScriptPKH(t->outputs[n].script, t->outputs[n].scriptLen) : NULL;
+    pkh = (t && n < t->outCount) ? BRTxOutputPKH(&t->outputs[n]) : NULL;
     if (pkh && BRSetContains(wallet->allPKH, pkh)) return 1;
 
-    size_t l = ((txInput->witLen > 0)
-                ? BRWitnessPKH(hash.u8, txInput->witness, txInput->witLen)
-                : BRSignaturePKH(hash.u8, txInput->signature, txInput->sigLen));
-
-    if (l > 0 && BRSetContains(wallet->allPKH, &hash)) return 1;
+    if (BRTxInputPKH(txInput, hash.u8) > 0 && BRSetContains(wallet->allPKH, &hash)) return 1;
 
     return 0;
 }
@@ -1137,7 +1202,7 @@ uint64_t BRWalletAmountReceivedFromTx(BRWallet *wallet, const BRTransaction *tx)
     
     // TODO: don't include outputs below TX_MIN_OUTPUT_AMOUNT
     for (size_t i = 0; tx && i < tx->outCount; i++) {
-        pkh = BRScriptPKH(tx->outputs[i].script, tx->outputs[i].scriptLen);
+        pkh = BRTxOutputPKH(&tx->outputs[i]);
         if (pkh && BRSetContains(wallet->allPKH, pkh)) amount += tx->outputs[i].amount;
     }
     
@@ -1160,7 +1225,7 @@ uint64_t BRWalletAmountSentByTx(BRWallet *wallet, const BRTransaction *tx)
         const uint8_t *pkh;
 
         if (t && n < t->outCount) {
-            pkh = BRScriptPKH(t->outputs[n].script, t->outputs[n].scriptLen);
+            pkh = BRTxOutputPKH(&t->outputs[n]);
             if (pkh && BRSetContains(wallet->allPKH, pkh)) amount += t->outputs[n].amount;
         }
     }
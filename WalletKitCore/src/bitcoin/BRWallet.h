@@ -159,9 +159,18 @@ BRTransaction *BRWalletCreateTxForOutputsWithFeePerKb(BRWallet *wallet, uint64_t
 // returns true if all inputs were signed, or false if there was an error or not all inputs were able to be signed
 int BRWalletSignTransaction(BRWallet *wallet, BRTransaction *tx, uint8_t forkId, const void *seed, size_t seedLen);
 
+// same as BRWalletSignTransaction(), with private keys derived from the extended private keys of the wallet's internal
+// and external chains, paths m/0H/1 and m/0H/0, as set by BRBIP32PrivChainKeyPath()
+int BRWalletSignTransactionWithChainKeys(BRWallet *wallet, BRTransaction *tx, uint8_t forkId,
+                                         const BRBIP32PrivChainKey *internalChain,
+                                         const BRBIP32PrivChainKey *externalChain);
+
 // true if the given transaction is associated with the wallet (even if it hasn't been registered)
 int BRWalletContainsTransaction(BRWallet *wallet, const BRTransaction *tx);
 
+// true if the tx viewed is associated with the wallet, this lets a relayed tx be checked before it's parsed
+int BRWalletContainsTransactionView(BRWallet *wallet, const BRTransactionView *tx);
+
 // adds a transaction to the wallet, or returns false if it isn't associated with the wallet
 int BRWalletRegisterTransaction(BRWallet *wallet, BRTransaction *tx);
 
@@ -8,7 +8,11 @@
 //  See the LICENSE file at the project root for license information.
 //  See the CONTRIBUTORS file at the project root for a list of contributors.
 
+#include <unistd.h>
+#include <sys/mman.h>
+
 #include "support/BROSCompat.h"
+#include "support/BRCrypto.h"
 #include "BRCryptoAccountP.h"
 #include "BRCryptoNetworkP.h"
 
@@ -421,6 +425,120 @@ cryptoAccountGetUids (BRCryptoAccount account) {
     return account->uids;
 }
 
+// MARK: - Signing Session
+
+struct BRCryptoSigningSessionRecord {
+    pthread_mutex_t lock;
+
+    /// The seed and the keys derived from it, alone in a page so that locking it pins nothing else.
+    BRCryptoSigningKeys *keys;
+    size_t keysPageSize;
+
+    BRCryptoBoolean locked;
+    BRCryptoBoolean closed;
+    BRCryptoRef ref;
+};
+
+IMPLEMENT_CRYPTO_GIVE_TAKE (BRCryptoSigningSession, cryptoSigningSession);
+
+extern BRCryptoSigningSession
+cryptoSigningSessionCreate (const char *paperKey) {
+    long   pageSize     = sysconf (_SC_PAGESIZE);
+    size_t keysPageSize = (pageSize > 0 && (size_t) pageSize >= sizeof (BRCryptoSigningKeys)
+                           ? (size_t) pageSize
+                           : 4096);
+
+    void *keys = NULL;
+    if (0 != posix_memalign (&keys, keysPageSize, keysPageSize)) return NULL;
+
+    BRCryptoBoolean locked = AS_CRYPTO_BOOLEAN (0 == mlock (keys, keysPageSize));
+
+    BRCryptoSigningSession session = calloc (1, sizeof (struct BRCryptoSigningSessionRecord));
+    if (NULL == session) {
+        // Nothing has been derived yet; just give back the keys page
+        if (CRYPTO_TRUE == locked) munlock (keys, keysPageSize);
+        free (keys);
+        return NULL;
+    }
+
+    session->keys         = keys;
+    session->keysPageSize = keysPageSize;
+    session->locked       = locked;
+    session->closed       = CRYPTO_FALSE;
+
+    // Derive directly into the page; neither the seed nor a chain key is held in a temporary
+    memset (keys, 0, keysPageSize);
+    BRBIP39DeriveKey (session->keys->seed.u8, paperKey, NULL);
+
+    BRBIP32PrivChainKeyPath (&session->keys->btcInternal, &session->keys->seed, sizeof (UInt512), 2,
+                             0 | BIP32_HARD, SEQUENCE_INTERNAL_CHAIN);
+    BRBIP32PrivChainKeyPath (&session->keys->btcExternal, &session->keys->seed, sizeof (UInt512), 2,
+                             0 | BIP32_HARD, SEQUENCE_EXTERNAL_CHAIN);
+    deriveChainKeyFromSeed  (&session->keys->eth, &session->keys->seed);
+
+    pthread_mutex_init_brd (&session->lock, PTHREAD_MUTEX_NORMAL);
+    session->ref = CRYPTO_REF_ASSIGN (cryptoSigningSessionRelease);
+
+    return session;
+}
+
+static void
+cryptoSigningSessionRelease (BRCryptoSigningSession session) {
+    cryptoSigningSessionClose (session);
+
+    if (CRYPTO_TRUE == session->locked) munlock (session->keys, session->keysPageSize);
+    free (session->keys);
+
+    pthread_mutex_destroy (&session->lock);
+
+    memset (session, 0, sizeof(*session));
+    free (session);
+}
+
+extern void
+cryptoSigningSessionClose (BRCryptoSigningSession session) {
+    pthread_mutex_lock (&session->lock);
+    mem_clean (session->keys, session->keysPageSize);
+    session->closed = CRYPTO_TRUE;
+    pthread_mutex_unlock (&session->lock);
+}
+
+extern BRCryptoBoolean
+cryptoSigningSessionIsClosed (BRCryptoSigningSession session) {
+    pthread_mutex_lock (&session->lock);
+
+    // Read back through a volatile pointer so that the check can't be optimized away
+    const volatile uint8_t *bytes = (const volatile uint8_t *) session->keys;
+    uint8_t bits = 0;
+
+    for (size_t index = 0; index < session->keysPageSize; index++)
+        bits |= bytes[index];
+
+    BRCryptoBoolean closed = AS_CRYPTO_BOOLEAN (CRYPTO_TRUE == session->closed && 0 == bits);
+    pthread_mutex_unlock (&session->lock);
+
+    return closed;
+}
+
+extern BRCryptoBoolean
+cryptoSigningSessionIsLocked (BRCryptoSigningSession session) {
+    return session->locked;
+}
+
+private_extern const BRCryptoSigningKeys *
+cryptoSigningSessionLockKeys (BRCryptoSigningSession session) {
+    pthread_mutex_lock (&session->lock);
+    if (CRYPTO_FALSE == session->closed) return session->keys;
+
+    pthread_mutex_unlock (&session->lock);
+    return NULL;
+}
+
+private_extern void
+cryptoSigningSessionUnlockKeys (BRCryptoSigningSession session) {
+    pthread_mutex_unlock (&session->lock);
+}
+
 // https://en.wikipedia.org/wiki/Fletcher%27s_checksum
 static uint16_t
 checksumFletcher16(const uint8_t *data, size_t count )
@@ -59,6 +59,30 @@ cryptoAccountInstall (void);
 private_extern UInt512
 cryptoAccountDeriveSeed (const char *phrase);
 
+/**
+ * The keys held by a Signing Session, all within its locked page.  Besides the seed, the BIP32
+ * extended private keys that BTC and ETH sign from are derived once, so that signing only
+ * derives each address' key from its chain.
+ */
+typedef struct {
+    UInt512 seed;
+    BRBIP32PrivChainKey btcInternal;    // m/0H/1
+    BRBIP32PrivChainKey btcExternal;    // m/0H/0
+    BRBIP32PrivChainKey eth;            // m/44'/60'/0'/0
+} BRCryptoSigningKeys;
+
+/**
+ * Lock the session and return its keys, in place.  The keys must not be used after
+ * `cryptoSigningSessionUnlockKeys()`, which must be called unless NULL is returned.
+ *
+ * @return the keys, or NULL if the session has been closed, in which case it is not locked.
+ */
+private_extern const BRCryptoSigningKeys *
+cryptoSigningSessionLockKeys (BRCryptoSigningSession session);
+
+private_extern void
+cryptoSigningSessionUnlockKeys (BRCryptoSigningSession session);
+
 // MARK: Account As {ETH,BTC,XRP,HBAR,XTZ}
 
 static inline BRMasterPubKey
@@ -41,6 +41,9 @@
     "cry" \
 })
 
+// threads used for the scrypt lanes of a BIP38 key import, each needs its own 16MB of memory
+#define CRYPTO_KEY_BIP38_THREADS    4
+
 struct BRCryptoKeyRecord {
     BRKey core;
     BRAddressParams coreAddressParams;
@@ -122,11 +125,14 @@ cryptoKeyCreateFromStringProtectedPrivate (const char *privateKey, const char *
     if (!BRBIP38KeyIsValid (privateKey)) return NULL;
 
     BRKey core;
-    BRCryptoKey result = (1 == BRKeySetBIP38Key(&core, privateKey, passphrase, BITCOIN_ADDRESS_PARAMS)
+    BRCryptoKey result = (1 == BRKeySetBIP38KeyParallel (&core, privateKey, passphrase, BITCOIN_ADDRESS_PARAMS,
+                                                         CRYPTO_KEY_BIP38_THREADS)
                           ? cryptoKeyCreateInternal (core, BITCOIN_ADDRESS_PARAMS)
-                          : (1 == BRKeySetBIP38Key(&core, privateKey, passphrase, BITCOIN_TEST_ADDRESS_PARAMS)
+                          : (1 == BRKeySetBIP38KeyParallel (&core, privateKey, passphrase, BITCOIN_TEST_ADDRESS_PARAMS,
+                                                            CRYPTO_KEY_BIP38_THREADS)
                              ? cryptoKeyCreateInternal (core, BITCOIN_TEST_ADDRESS_PARAMS)
-                             : (1 == BRKeySetBIP38Key(&core, privateKey, passphrase, CRYPTO_ADDRESS_PARAMS)
+                             : (1 == BRKeySetBIP38KeyParallel (&core, privateKey, passphrase, CRYPTO_ADDRESS_PARAMS,
+                                                               CRYPTO_KEY_BIP38_THREADS)
                                 ? cryptoKeyCreateInternal (core, CRYPTO_ADDRESS_PARAMS)
                                 : NULL)));
 
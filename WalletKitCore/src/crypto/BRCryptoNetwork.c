@@ -17,6 +17,8 @@
 
 #include "BRCryptoHandlersP.h"
 
+#include <ctype.h>
+
 // If '1' then display a detailed list of the builting currencies for each network
 #define SHOW_BUILTIN_CURRENCIES 0 // DEBUG
 
@@ -98,6 +100,57 @@ cryptoNetworkFeeRelease (BRCryptoNetworkFee networkFee) {
 
 IMPLEMENT_CRYPTO_GIVE_TAKE (BRCryptoNetwork, cryptoNetwork)
 
+/// MARK: - Currency Index
+
+///
+/// An entry in one of the network's case-insensitive currency indexes.  The `key` (a uids or an
+/// issuer) is owned by the currency at `index` in the network's `associations`.
+///
+struct BRCryptoNetworkCurrencyIndexEntryRecord {
+    const char *key;
+    size_t index;
+};
+
+static size_t
+cryptoNetworkCurrencyIndexEntryHashValue (const void *entry) {
+    // FNV-1a, case folded
+    size_t hash = 0x811c9dc5;
+    for (const char *c = ((const BRCryptoNetworkCurrencyIndexEntry *) entry)->key; *c; c++)
+        hash = (hash ^ (size_t) tolower ((unsigned char) *c)) * 0x01000193;
+    return hash;
+}
+
+static int
+cryptoNetworkCurrencyIndexEntryIsEqual (const void *entry1, const void *entry2) {
+    return 0 == strcasecmp (((const BRCryptoNetworkCurrencyIndexEntry *) entry1)->key,
+                            ((const BRCryptoNetworkCurrencyIndexEntry *) entry2)->key);
+}
+
+static void
+cryptoNetworkCurrencyIndexAdd (BRSetOf(BRCryptoNetworkCurrencyIndexEntry*) currencyIndex,
+                               const char *key,
+                               size_t index) {
+    BRCryptoNetworkCurrencyIndexEntry probe = { key, 0 };
+
+    // The first association for `key` is the one found, as with a linear search.
+    if (NULL == key || BRSetContains (currencyIndex, &probe)) return;
+
+    BRCryptoNetworkCurrencyIndexEntry *entry = malloc (sizeof (BRCryptoNetworkCurrencyIndexEntry));
+    *entry = probe;
+    entry->index = index;
+    BRSetAdd (currencyIndex, entry);
+}
+
+// lock is not held for this static method; caller must hold it
+static BRCryptoCurrencyAssociation *
+cryptoNetworkCurrencyIndexLookup (BRCryptoNetwork network,
+                                  BRSetOf(BRCryptoNetworkCurrencyIndexEntry*) currencyIndex,
+                                  const char *key) {
+    BRCryptoNetworkCurrencyIndexEntry probe = { key, 0 };
+    BRCryptoNetworkCurrencyIndexEntry *entry = (NULL == key ? NULL : BRSetGet (currencyIndex, &probe));
+    return (NULL == entry ? NULL : &network->associations[entry->index]);
+}
+
 extern BRCryptoNetwork
 cryptoNetworkAllocAndInit (size_t sizeInBytes,
                            BRCryptoBlockChainType type,
@@ -124,6 +177,12 @@ cryptoNetworkAllocAndInit (size_t sizeInBytes,
     network->currency = NULL;
     network->height = 0;
     array_new (network->associations, CRYPTO_NETWORK_DEFAULT_CURRENCY_ASSOCIATIONS);
+    network->associationsByUids   = BRSetNew (cryptoNetworkCurrencyIndexEntryHashValue,
+                                              cryptoNetworkCurrencyIndexEntryIsEqual,
+                                              CRYPTO_NETWORK_DEFAULT_CURRENCY_ASSOCIATIONS);
+    network->associationsByIssuer = BRSetNew (cryptoNetworkCurrencyIndexEntryHashValue,
+                                              cryptoNetworkCurrencyIndexEntryIsEqual,
+                                              CRYPTO_NETWORK_DEFAULT_CURRENCY_ASSOCIATIONS);
     array_new (network->fees, CRYPTO_NETWORK_DEFAULT_FEES);
 
     network->confirmationPeriodInSeconds = confirmationPeriodInSeconds;
@@ -152,6 +211,9 @@ cryptoNetworkRelease (BRCryptoNetwork network) {
 
     cryptoHashGive (network->verifiedBlockHash);
 
+    BRSetFreeAll (network->associationsByIssuer, free);
+    BRSetFreeAll (network->associationsByUids,   free);
+
     for (size_t index = 0; index < array_count (network->associations); index++) {
         BRCryptoCurrencyAssociation *association = &network->associations[index];
         cryptoCurrencyGive (association->currency);
@@ -332,14 +394,9 @@ cryptoNetworkGetCurrencyForCode (BRCryptoNetwork network,
 extern BRCryptoCurrency
 cryptoNetworkGetCurrencyForUids (BRCryptoNetwork network,
                                    const char *uids) {
-    BRCryptoCurrency currency = NULL;
     pthread_mutex_lock (&network->lock);
-    for (size_t index = 0; index < array_count(network->associations); index++) {
-        if (0 == strcasecmp (uids, cryptoCurrencyGetUids (network->associations[index].currency))) {
-            currency = cryptoCurrencyTake (network->associations[index].currency);
-            break;
-        }
-    }
+    BRCryptoCurrencyAssociation *association = cryptoNetworkCurrencyIndexLookup (network, network->associationsByUids, uids);
+    BRCryptoCurrency currency = (NULL == association ? NULL : cryptoCurrencyTake (association->currency));
     pthread_mutex_unlock (&network->lock);
     return currency;
 }
@@ -347,15 +404,9 @@ cryptoNetworkGetCurrencyForUids (BRCryptoNetwork network,
 extern BRCryptoCurrency
 cryptoNetworkGetCurrencyForIssuer (BRCryptoNetwork network,
                                    const char *issuer) {
-    BRCryptoCurrency currency = NULL;
     pthread_mutex_lock (&network->lock);
-    for (size_t index = 0; index < array_count(network->associations); index++) {
-        const char *i = cryptoCurrencyGetIssuer(network->associations[index].currency);
-        if (NULL != i && 0 == strcasecmp (issuer, i)) {
-            currency = cryptoCurrencyTake (network->associations[index].currency);
-            break;
-        }
-    }
+    BRCryptoCurrencyAssociation *association = cryptoNetworkCurrencyIndexLookup (network, network->associationsByIssuer, issuer);
+    BRCryptoCurrency currency = (NULL == association ? NULL : cryptoCurrencyTake (association->currency));
     pthread_mutex_unlock (&network->lock);
     return currency;
 }
@@ -364,6 +415,14 @@ static BRCryptoCurrencyAssociation *
 cryptoNetworkLookupCurrency (BRCryptoNetwork network,
                              BRCryptoCurrency currency) {
     // lock is not held for this static method; caller must hold it
+    if (NULL == currency) return NULL;
+
+    // Identical currencies have the same uids; the uids index is case-insensitive, so confirm.
+    BRCryptoCurrencyAssociation *association = cryptoNetworkCurrencyIndexLookup (network, network->associationsByUids,
+                                                                                 cryptoCurrencyGetUids (currency));
+    if (NULL != association && CRYPTO_TRUE == cryptoCurrencyIsIdentical (currency, association->currency))
+        return association;
+
     for (size_t index = 0; index < array_count(network->associations); index++) {
         if (CRYPTO_TRUE == cryptoCurrencyIsIdentical (currency, network->associations[index].currency)) {
             return &network->associations[index];
@@ -436,6 +495,10 @@ cryptoNetworkAddCurrency (BRCryptoNetwork network,
     pthread_mutex_lock (&network->lock);
     array_new (association.units, 2);
     array_add (network->associations, association);
+
+    size_t index = array_count (network->associations) - 1;
+    cryptoNetworkCurrencyIndexAdd (network->associationsByUids,   cryptoCurrencyGetUids   (currency), index);
+    cryptoNetworkCurrencyIndexAdd (network->associationsByIssuer, cryptoCurrencyGetIssuer (currency), index);
     pthread_mutex_unlock (&network->lock);
 }
 
@@ -15,6 +15,7 @@
 #include <stdbool.h>
 
 #include "support/BRArray.h"
+#include "support/BRSet.h"
 #include "BRCryptoBaseP.h"
 #include "BRCryptoHashP.h"
 #include "BRCryptoNetwork.h"
@@ -46,6 +47,9 @@ typedef struct {
     BRArrayOf(BRCryptoUnit) units;
 } BRCryptoCurrencyAssociation;
 
+/// An entry in a network's index of `associations`; see BRCryptoNetwork.c
+typedef struct BRCryptoNetworkCurrencyIndexEntryRecord BRCryptoNetworkCurrencyIndexEntry;
+
 /// MARK: - Network Handlers
 
 typedef BRCryptoNetwork
@@ -126,6 +130,10 @@ struct BRCryptoNetworkRecord {
     BRCryptoCurrency currency;
     BRArrayOf(BRCryptoCurrencyAssociation) associations;
 
+    // Case-insensitive indexes of `associations`, by currency uids and by currency issuer
+    BRSetOf(BRCryptoNetworkCurrencyIndexEntry*) associationsByUids;
+    BRSetOf(BRCryptoNetworkCurrencyIndexEntry*) associationsByIssuer;
+
     uint32_t confirmationPeriodInSeconds;
     uint32_t confirmationsUntilFinal;
 
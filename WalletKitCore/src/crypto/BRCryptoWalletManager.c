@@ -296,6 +296,11 @@ cryptoWalletManagerAllocAndInit (size_t sizeInBytes,
                                                                  manager,
                                                                  cryptoWalletManagerFileServiceErrorHandler);
 
+    // Commit saves from the file service's own thread, so that a slow disk doesn't stall the
+    // event handler or the P2P callbacks.
+    if (NULL != manager->fileService)
+        fileServiceSetWriteBehind (manager->fileService, true);
+
     // Create the alarm clock, but don't start it.
     alarmClockCreateIfNecessary(0);
 
@@ -685,6 +690,7 @@ cryptoWalletManagerAddWallet (BRCryptoWalletManager cwm,
     pthread_mutex_lock (&cwm->lock);
     if (CRYPTO_FALSE == cryptoWalletManagerHasWallet (cwm, wallet)) {
         array_add (cwm->wallets, cryptoWalletTake (wallet));
+        if (NULL != cwm->handlers->addWallet) cwm->handlers->addWallet (cwm, wallet);
         cryptoWalletManagerGenerateEvent (cwm, (BRCryptoWalletManagerEvent) {
             CRYPTO_WALLET_MANAGER_EVENT_WALLET_ADDED,
             { .wallet = cryptoWalletTake (wallet) }
@@ -703,6 +709,7 @@ cryptoWalletManagerRemWallet (BRCryptoWalletManager cwm,
         if (CRYPTO_TRUE == cryptoWalletEqual(cwm->wallets[index], wallet)) {
             managerWallet = cwm->wallets[index];
             array_rm (cwm->wallets, index);
+            if (NULL != cwm->handlers->remWallet) cwm->handlers->remWallet (cwm, managerWallet);
             cryptoWalletManagerGenerateEvent (cwm, (BRCryptoWalletManagerEvent) {
                 CRYPTO_WALLET_MANAGER_EVENT_WALLET_DELETED,
                 { .wallet = cryptoWalletTake (wallet) }
@@ -853,6 +860,21 @@ cryptoWalletManagerCreateTransferMultiple (BRCryptoWalletManager cwm,
 
 // MARK: - Sign/Submit
 
+static BRCryptoBoolean
+cryptoWalletManagerSignWithSeed (BRCryptoWalletManager manager,
+                                 BRCryptoWallet wallet,
+                                 BRCryptoTransfer transfer,
+                                 UInt512 seed) {
+    BRCryptoBoolean success = manager->handlers->signTransactionWithSeed (manager,
+                                                                          wallet,
+                                                                          transfer,
+                                                                          seed);
+    if (CRYPTO_TRUE == success)
+        cryptoTransferSetState (transfer, cryptoTransferStateInit (CRYPTO_TRANSFER_STATE_SIGNED));
+
+    return success;
+}
+
 extern BRCryptoBoolean
 cryptoWalletManagerSign (BRCryptoWalletManager manager,
                          BRCryptoWallet wallet,
@@ -861,15 +883,37 @@ cryptoWalletManagerSign (BRCryptoWalletManager manager,
     // Derived the seed used for signing.
     UInt512 seed = cryptoAccountDeriveSeed(paperKey);
 
-    BRCryptoBoolean success = manager->handlers->signTransactionWithSeed (manager,
-                                                                          wallet,
-                                                                          transfer,
-                                                                          seed);
-    if (CRYPTO_TRUE == success)
-        cryptoTransferSetState (transfer, cryptoTransferStateInit (CRYPTO_TRANSFER_STATE_SIGNED));
+    BRCryptoBoolean success = cryptoWalletManagerSignWithSeed (manager, wallet, transfer, seed);
 
     // Zero-out the seed.
-    seed = UINT512_ZERO;
+    mem_clean (&seed, sizeof (seed));
+
+    return success;
+}
+
+extern BRCryptoBoolean
+cryptoWalletManagerSignWithSession (BRCryptoWalletManager manager,
+                                    BRCryptoWallet wallet,
+                                    BRCryptoTransfer transfer,
+                                    BRCryptoSigningSession session) {
+    // The keys were derived when the session was created; a closed session can't sign.
+    const BRCryptoSigningKeys *keys = cryptoSigningSessionLockKeys (session);
+    if (NULL == keys) return CRYPTO_FALSE;
+
+    // Sign from the session's page, in place, unless the handler only signs with a seed.
+    BRCryptoBoolean success = (NULL != manager->handlers->signTransactionWithSigningKeys
+                               ? manager->handlers->signTransactionWithSigningKeys (manager,
+                                                                                    wallet,
+                                                                                    transfer,
+                                                                                    keys)
+                               : manager->handlers->signTransactionWithSeed (manager,
+                                                                             wallet,
+                                                                             transfer,
+                                                                             keys->seed));
+    cryptoSigningSessionUnlockKeys (session);
+
+    if (CRYPTO_TRUE == success)
+        cryptoTransferSetState (transfer, cryptoTransferStateInit (CRYPTO_TRANSFER_STATE_SIGNED));
 
     return success;
 }
@@ -20,6 +20,7 @@
 #include "BRCryptoWallet.h"
 #include "BRCryptoWalletManager.h"
 
+#include "BRCryptoAccountP.h"
 #include "BRCryptoClientP.h"
 #include "BRCryptoWalletP.h"
 
@@ -68,6 +69,14 @@ typedef BRCryptoBoolean
                                                        BRCryptoTransfer transfer,
                                                        BRCryptoKey key);
 
+/// Signs with the keys of a Signing Session, in place; optional, if NULL the session's seed is
+/// passed to the SignTransactionWithSeed handler instead.
+typedef BRCryptoBoolean
+(*BRCryptoWalletManagerSignTransactionWithSigningKeysHandler) (BRCryptoWalletManager manager,
+                                                               BRCryptoWallet wallet,
+                                                               BRCryptoTransfer transfer,
+                                                               const BRCryptoSigningKeys *keys);
+
 typedef BRCryptoAmount
 (*BRCryptoWalletManagerEstimateLimitHandler) (BRCryptoWalletManager cwm,
                                               BRCryptoWallet  wallet,
@@ -133,6 +142,12 @@ typedef BRCryptoWalletSweeper
                                                     BRCryptoWallet wallet,
                                                     BRCryptoKey key);
 
+/// Called when `wallet` is added to, or removed from, the manager's wallets; a handler can keep
+/// its own index of wallets current.  Called with the manager's lock held.
+typedef void
+(*BRCryptoWalletManagerWalletChangedHandler) (BRCryptoWalletManager cwm,
+                                              BRCryptoWallet wallet);
+
 typedef struct {
     BRCryptoWalletManagerCreateHandler create;
     BRCryptoWalletManagerReleaseHandler release;
@@ -142,6 +157,7 @@ typedef struct {
     BRCryptoWalletManagerCreateWalletHandler createWallet;
     BRCryptoWalletManagerSignTransactionWithSeedHandler signTransactionWithSeed;
     BRCryptoWalletManagerSignTransactionWithKeyHandler signTransactionWithKey;
+    BRCryptoWalletManagerSignTransactionWithSigningKeysHandler signTransactionWithSigningKeys;
     BRCryptoWalletManagerEstimateLimitHandler estimateLimit;
     BRCryptoWalletManagerEstimateFeeBasisHandler estimateFeeBasis;
     BRCryptoWalletManagerSaveTransactionBundleHandler saveTransactionBundle;
@@ -151,6 +167,8 @@ typedef struct {
     BRCryptoWalletManagerRecoverFeeBasisFromFeeEstimateHandler        recoverFeeBasisFromFeeEstimate;
     BRCryptoWalletManagerWalletSweeperValidateSupportedHandler validateSweeperSupported;
     BRCryptoWalletManagerCreateWalletSweeperHandler createSweeper;
+    BRCryptoWalletManagerWalletChangedHandler addWallet;
+    BRCryptoWalletManagerWalletChangedHandler remWallet;
 } BRCryptoWalletManagerHandlers;
 
 // MARK: - Wallet Manager State
@@ -22,6 +22,7 @@
 #include "bitcoin/BRTransaction.h"
 #include "bitcoin/BRChainParams.h"
 #include "bitcoin/BRPaymentProtocol.h"
+#include "bitcoin/BRPeerManager.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -236,12 +237,14 @@ cryptoHashCreateAsBTC (UInt256 btc);
 extern const char *fileServiceTypeTransactionsBTC;
 extern const char *fileServiceTypeBlocksBTC;
 extern const char *fileServiceTypePeersBTC;
+extern const char *fileServiceTypePeerQualitiesBTC;
 
 extern size_t fileServiceSpecificationsCountBTC;
 extern BRFileServiceTypeSpecification *fileServiceSpecificationsBTC;
 
 extern BRArrayOf(BRTransaction*) initialTransactionsLoadBTC (BRCryptoWalletManager manager);
 extern BRArrayOf(BRPeer)         initialPeersLoadBTC        (BRCryptoWalletManager manager);
+extern BRArrayOf(BRPeerQualityEntry) initialPeerQualitiesLoadBTC (BRCryptoWalletManager manager);
 extern BRArrayOf(BRMerkleBlock*) initialBlocksLoadBTC       (BRCryptoWalletManager manager);
 
 // MARK: - Events
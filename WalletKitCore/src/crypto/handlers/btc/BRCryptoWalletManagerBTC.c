@@ -154,6 +154,19 @@ cryptoWalletManagerSignTransactionWithSeedBTC (BRCryptoWalletManager manager,
     return AS_CRYPTO_BOOLEAN (1 == BRWalletSignTransaction (btcWallet, btcTransaction, btcParams->forkId, seed.u8, sizeof(UInt512)));
 }
 
+static BRCryptoBoolean
+cryptoWalletManagerSignTransactionWithSigningKeysBTC (BRCryptoWalletManager manager,
+                                                      BRCryptoWallet wallet,
+                                                      BRCryptoTransfer transfer,
+                                                      const BRCryptoSigningKeys *keys) {
+    BRWallet      *btcWallet       = cryptoWalletAsBTC   (wallet);
+    BRTransaction *btcTransaction  = cryptoTransferAsBTC (transfer);         // OWN/REF ?
+    const BRChainParams *btcParams = cryptoNetworkAsBTC  (manager->network);
+
+    return AS_CRYPTO_BOOLEAN (1 == BRWalletSignTransactionWithChainKeys (btcWallet, btcTransaction, btcParams->forkId,
+                                                                         &keys->btcInternal, &keys->btcExternal));
+}
+
 static BRCryptoBoolean
 cryptoWalletManagerSignTransactionWithKeyBTC (BRCryptoWalletManager manager,
                                                      BRCryptoWallet wallet,
@@ -163,7 +176,8 @@ cryptoWalletManagerSignTransactionWithKeyBTC (BRCryptoWalletManager manager,
     BRKey         *btcKey          = cryptoKeyGetCore (key);
     const BRChainParams *btcParams = cryptoNetworkAsBTC  (manager->network);
 
-    return AS_CRYPTO_BOOLEAN (1 == BRTransactionSign (btcTransaction, btcParams->forkId, btcKey, 1));
+    // A sweep spends every output of the key, so sign its inputs in parallel as the wallet does
+    return AS_CRYPTO_BOOLEAN (1 == BRTransactionSignParallel (btcTransaction, btcParams->forkId, btcKey, 1, 0));
 }
 
 static BRCryptoAmount
@@ -679,6 +693,7 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersBTC = {
     cryptoWalletManagerCreateWalletBTC,
     cryptoWalletManagerSignTransactionWithSeedBTC,
     cryptoWalletManagerSignTransactionWithKeyBTC,
+    cryptoWalletManagerSignTransactionWithSigningKeysBTC,
     cryptoWalletManagerEstimateLimitBTC,
     cryptoWalletManagerEstimateFeeBasisBTC,
     cryptoWalletManagerSaveTransactionBundleBTC,
@@ -687,7 +702,9 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersBTC = {
     cryptoWalletManagerRecoverTransferFromTransferBundleBTC,
     NULL,//BRCryptoWalletManagerRecoverFeeBasisFromFeeEstimateHandler not supported
     cryptoWalletManagerWalletSweeperValidateSupportedBTC,
-    cryptoWalletManagerCreateWalletSweeperBTC
+    cryptoWalletManagerCreateWalletSweeperBTC,
+    NULL, // BRCryptoWalletManagerWalletChangedHandler addWallet
+    NULL  // BRCryptoWalletManagerWalletChangedHandler remWallet
 };
 
 BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersBCH = {
@@ -699,6 +716,7 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersBCH = {
     cryptoWalletManagerCreateWalletBTC,
     cryptoWalletManagerSignTransactionWithSeedBTC,
     cryptoWalletManagerSignTransactionWithKeyBTC,
+    cryptoWalletManagerSignTransactionWithSigningKeysBTC,
     cryptoWalletManagerEstimateLimitBTC,
     cryptoWalletManagerEstimateFeeBasisBTC,
     cryptoWalletManagerSaveTransactionBundleBTC,
@@ -707,7 +725,9 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersBCH = {
     cryptoWalletManagerRecoverTransferFromTransferBundleBTC,
     NULL,//BRCryptoWalletManagerRecoverFeeBasisFromFeeEstimateHandler not supported
     cryptoWalletManagerWalletSweeperValidateSupportedBTC,
-    cryptoWalletManagerCreateWalletSweeperBTC
+    cryptoWalletManagerCreateWalletSweeperBTC,
+    NULL, // BRCryptoWalletManagerWalletChangedHandler addWallet
+    NULL  // BRCryptoWalletManagerWalletChangedHandler remWallet
 };
 
 BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersBSV = {
@@ -719,6 +739,7 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersBSV = {
     cryptoWalletManagerCreateWalletBTC,
     cryptoWalletManagerSignTransactionWithSeedBTC,
     cryptoWalletManagerSignTransactionWithKeyBTC,
+    cryptoWalletManagerSignTransactionWithSigningKeysBTC,
     cryptoWalletManagerEstimateLimitBTC,
     cryptoWalletManagerEstimateFeeBasisBTC,
     cryptoWalletManagerSaveTransactionBundleBTC,
@@ -727,5 +748,7 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersBSV = {
     cryptoWalletManagerRecoverTransferFromTransferBundleBTC,
     NULL,//BRCryptoWalletManagerRecoverFeeBasisFromFeeEstimateHandler not supported
     cryptoWalletManagerWalletSweeperValidateSupportedBTC,
-    cryptoWalletManagerCreateWalletSweeperBTC
+    cryptoWalletManagerCreateWalletSweeperBTC,
+    NULL, // BRCryptoWalletManagerWalletChangedHandler addWallet
+    NULL  // BRCryptoWalletManagerWalletChangedHandler remWallet
 };
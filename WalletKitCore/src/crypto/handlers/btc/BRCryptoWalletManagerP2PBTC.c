@@ -75,6 +75,13 @@ cryptoClientP2PManagerConnectBTC (BRCryptoClientP2PManager baseManager,
     // Calling `SetFixedPeer` will 100% disconnect.  We could avoid calling SetFixedPeer
     // if we kept a reference to `peer` and checked if it differs.
     BRPeerManagerSetFixedPeer (manager->btcPeerManager, address, port);
+
+    // When P2P syncs (rather than only sends), BTC syncs with BIP157/158 compact filters; BCH and
+    // BSV nodes don't serve them.  A mode that is unchanged keeps the filter sync progress.
+    BRCryptoSyncMode mode = cryptoWalletManagerGetMode (&manager->manager->base);
+    BRPeerManagerSetCompactFilterMode (manager->btcPeerManager,
+                                       (CRYPTO_NETWORK_TYPE_BTC == manager->base.type &&
+                                        CRYPTO_SYNC_MODE_P2P_ONLY == mode));
     BRPeerManagerConnect(manager->btcPeerManager);
 }
 
@@ -389,6 +396,20 @@ static void cryptoWalletManagerBTCSavePeers  (void *info, int replace, const BRP
     }
 }
 
+static void cryptoWalletManagerBTCSavePeerQualities (void *info, const BRPeerQualityEntry *qualities, size_t count) {
+    BRCryptoWalletManagerBTC manager = info;
+
+    // as for peers, fileServiceReplace expects an array of pointers to entities
+    const BRPeerQualityEntry **qualityRefs = calloc (count + 1, sizeof(BRPeerQualityEntry *));
+
+    for (size_t i = 0; i < count; i++) {
+        qualityRefs[i] = &qualities[i];
+    }
+
+    fileServiceReplace (manager->base.fileService, fileServiceTypePeerQualitiesBTC, (const void **) qualityRefs, count);
+    free (qualityRefs);
+}
+
 static int cryptoWalletManagerBTCNetworkIsReachable (void *info) {
     BRCryptoWalletManagerBTC manager = info;
     BRCryptoClientP2PManager baseP2P = manager->base.p2pManager;
@@ -444,6 +465,7 @@ cryptoWalletManagerCreateP2PManagerBTC (BRCryptoWalletManager manager) {
 
     BRArrayOf(BRMerkleBlock*) blocks = initialBlocksLoadBTC (manager);
     BRArrayOf(BRPeer)         peers  = initialPeersLoadBTC  (manager);
+    BRArrayOf(BRPeerQualityEntry) qualities = initialPeerQualitiesLoadBTC (manager);
 
     p2pManagerBTC->btcPeerManager = BRPeerManagerNew (btcChainParams,
                                                 btcWallet,
@@ -464,8 +486,15 @@ cryptoWalletManagerCreateP2PManagerBTC (BRCryptoWalletManager manager) {
                                cryptoWalletManagerBTCNetworkIsReachable,
                                cryptoWalletManagerBTCThreadCleanup);
 
+    BRPeerManagerSetPeerQualityCallback (p2pManagerBTC->btcPeerManager,
+                                         cryptoWalletManagerBTCSavePeerQualities);
+
+    BRPeerManagerSetPeerQualities (p2pManagerBTC->btcPeerManager,
+                                   qualities, (NULL == qualities ? 0 : array_count (qualities)));
+
     if (NULL != blocks) array_free (blocks);
     if (NULL != peers ) array_free (peers);
+    if (NULL != qualities) array_free (qualities);
 
     return p2pManager;
 }
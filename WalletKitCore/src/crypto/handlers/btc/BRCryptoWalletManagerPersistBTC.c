@@ -37,6 +37,9 @@ fileServiceTypeTransactionV1Writer (BRFileServiceContext context,
 
     size_t txTimestampSize  = sizeof (uint32_t);
     size_t txBlockHeightSize = sizeof (uint32_t);
+
+    // A signed transaction caches its serialization; sizing it and then copying it out below
+    // serializes nothing.
     size_t txSize = BRTransactionSerialize (transaction, NULL, 0);
 
     assert (txTimestampSize   == sizeof(transaction->timestamp));
@@ -44,7 +47,8 @@ fileServiceTypeTransactionV1Writer (BRFileServiceContext context,
 
     *bytesCount = (uint32_t) (txSize + txBlockHeightSize + txTimestampSize);
 
-    uint8_t *bytes = calloc (*bytesCount, 1);
+    // Every byte is written below
+    uint8_t *bytes = malloc (*bytesCount);
 
     size_t bytesOffset = 0;
 
@@ -127,7 +131,7 @@ fileServiceTypeBlockV1Writer (BRFileServiceContext context,
     // The serialization of a block does not include the block height.  Thus, we'll need to
     // append the height.
 
-    // These are serialization sizes
+    // These are serialization sizes; sizing a block is arithmetic, nothing is serialized twice
     size_t blockHeightSize = sizeof (uint32_t);
     size_t blockSize = BRMerkleBlockSerialize(block, NULL, 0);
 
@@ -137,8 +141,8 @@ fileServiceTypeBlockV1Writer (BRFileServiceContext context,
     // Update bytesCound with the total of what is written.
     *bytesCount = (uint32_t) (blockSize + blockHeightSize);
 
-    // Get our bytes
-    uint8_t *bytes = calloc (*bytesCount, 1);
+    // Get our bytes; every one is written below
+    uint8_t *bytes = malloc (*bytesCount);
 
     // We'll serialize the block itself first
     BRMerkleBlockSerialize(block, bytes, blockSize);
@@ -293,6 +297,116 @@ initialPeersLoadBTC (BRCryptoWalletManager manager) {
     return peers;
 }
 
+/// MARK: - Peer Quality File Service
+
+#define FILE_SERVICE_TYPE_PEER_QUALITY        "peerqualities"
+
+enum {
+    FILE_SERVICE_TYPE_PEER_QUALITY_VERSION_1
+};
+
+#define PEER_QUALITY_V1_BYTES_COUNT     (sizeof (UInt128) + sizeof (uint16_t) + BR_PEER_QUALITY_SERIALIZED_SIZE)
+
+static UInt256
+fileServiceTypePeerQualityV1Identifier (BRFileServiceContext context,
+                                        BRFileService fs,
+                                        const void *entity) {
+    const BRPeerQualityEntry *entry = entity;
+    uint8_t bytes[sizeof (UInt128) + sizeof (uint16_t)];
+
+    // Identified by the address and port only; a changed quality replaces the prior one
+    memcpy (&bytes[0], entry->address.u8, sizeof (UInt128));
+    UInt16SetBE (&bytes[sizeof (UInt128)], entry->port);
+
+    UInt256 hash;
+    BRSHA256 (&hash, bytes, sizeof (bytes));
+
+    return hash;
+}
+
+static uint8_t *
+fileServiceTypePeerQualityV1Writer (BRFileServiceContext context,
+                                    BRFileService fs,
+                                    const void* entity,
+                                    uint32_t *bytesCount) {
+    const BRPeerQualityEntry *entry = entity;
+    size_t offset = 0;
+
+    *bytesCount = PEER_QUALITY_V1_BYTES_COUNT;
+    uint8_t *bytes = malloc (*bytesCount);
+
+    memcpy (&bytes[offset], entry->address.u8, sizeof (UInt128));
+    offset += sizeof (UInt128);
+
+    UInt16SetBE (&bytes[offset], entry->port);
+    offset += sizeof (uint16_t);
+
+    offset += BRPeerQualitySerialize (&entry->quality, &bytes[offset], *bytesCount - offset); (void) offset;
+
+    return bytes;
+}
+
+static void *
+fileServiceTypePeerQualityV1Reader (BRFileServiceContext context,
+                                    BRFileService fs,
+                                    uint8_t *bytes,
+                                    uint32_t bytesCount) {
+    assert (bytesCount == PEER_QUALITY_V1_BYTES_COUNT);
+
+    size_t offset = 0;
+
+    BRPeerQualityEntry *entry = malloc (sizeof (BRPeerQualityEntry));
+
+    memcpy (entry->address.u8, &bytes[offset], sizeof (UInt128));
+    offset += sizeof (UInt128);
+
+    entry->port = UInt16GetBE (&bytes[offset]);
+    offset += sizeof (uint16_t);
+
+    entry->quality = BRPeerQualityParse (&bytes[offset], bytesCount - offset);
+
+    return entry;
+}
+
+static size_t
+peerQualityEntryHash (const void *entry) {
+    return BRPeerHash (&(const BRPeer) {
+        ((const BRPeerQualityEntry *) entry)->address,
+        ((const BRPeerQualityEntry *) entry)->port
+    });
+}
+
+static int
+peerQualityEntryEq (const void *entry1, const void *entry2) {
+    return (entry1 == entry2 ||
+            (UInt128Eq (((const BRPeerQualityEntry *) entry1)->address, ((const BRPeerQualityEntry *) entry2)->address) &&
+             ((const BRPeerQualityEntry *) entry1)->port == ((const BRPeerQualityEntry *) entry2)->port));
+}
+
+extern BRArrayOf(BRPeerQualityEntry)
+initialPeerQualitiesLoadBTC (BRCryptoWalletManager manager) {
+    BRSetOf(BRPeerQualityEntry*) entrySet = BRSetNew (peerQualityEntryHash, peerQualityEntryEq, 100);
+    if (1 != fileServiceLoad (manager->fileService, entrySet, fileServiceTypePeerQualitiesBTC, 1)) {
+        BRSetFreeAll(entrySet, free);
+        _peer_log ("BWM: %4s: failed to load peer qualities",
+                   cryptoBlockChainTypeGetCurrencyCode (manager->type));
+        return NULL;
+    }
+
+    size_t entriesCount = BRSetCount(entrySet);
+
+    BRArrayOf(BRPeerQualityEntry) entries;
+    array_new (entries, entriesCount);
+
+    FOR_SET (BRPeerQualityEntry*, entry, entrySet) array_add (entries, *entry);
+    BRSetFreeAll(entrySet, free);
+
+    _peer_log ("BWM: %4s: loaded %4zu peer qualities\n",
+               cryptoBlockChainTypeGetCurrencyCode (manager->type),
+               entriesCount);
+    return entries;
+}
+
 ///
 /// For BTC, the FileService DOES NOT save BRCryptoClientTransactionBundles; instead BTC saves
 /// BRTransaction.  This allows the P2P mode to work seamlessly as P2P mode has zero knowledge of
@@ -342,12 +456,27 @@ static BRFileServiceTypeSpecification fileServiceSpecificationsArrayBTC[] = {
                 fileServiceTypePeerV1Writer
             }
         }
+    },
+
+    {
+        FILE_SERVICE_TYPE_PEER_QUALITY,
+        FILE_SERVICE_TYPE_PEER_QUALITY_VERSION_1,
+        1,
+        {
+            {
+                FILE_SERVICE_TYPE_PEER_QUALITY_VERSION_1,
+                fileServiceTypePeerQualityV1Identifier,
+                fileServiceTypePeerQualityV1Reader,
+                fileServiceTypePeerQualityV1Writer
+            }
+        }
     }
 };
 
 const char *fileServiceTypeTransactionsBTC = FILE_SERVICE_TYPE_TRANSACTION;
 const char *fileServiceTypeBlocksBTC       = FILE_SERVICE_TYPE_BLOCK;
 const char *fileServiceTypePeersBTC        = FILE_SERVICE_TYPE_PEER;
+const char *fileServiceTypePeerQualitiesBTC = FILE_SERVICE_TYPE_PEER_QUALITY;
 
 size_t fileServiceSpecificationsCountBTC = sizeof(fileServiceSpecificationsArrayBTC)/sizeof(BRFileServiceTypeSpecification);
 BRFileServiceTypeSpecification *fileServiceSpecificationsBTC = fileServiceSpecificationsArrayBTC;
@@ -213,7 +213,13 @@ inline static int BRWalletSweeperIsSourceInput(BRTxInput *input, BRAddressParams
     return match;
 }
 
-inline static int BRWalletSweeperIsSourceOutput(BRTxOutput *output, BRAddressParams addrParams, char * sourceAddress) {
+inline static int BRWalletSweeperIsSourceOutput(BRTxOutput *output, BRAddressParams addrParams, char * sourceAddress,
+                                                const uint8_t *sourceScript, size_t sourceScriptLen) {
+    // The address of a standard output is determined by its script; compare scripts rather than encode an address
+    if (BRScriptTypeUnclassified != output->scriptType && BRScriptTypeNonStandard != output->scriptType)
+        return (output->scriptLen == sourceScriptLen &&
+                0 == memcmp (output->script, sourceScript, sourceScriptLen));
+
     size_t addressLength = BRTxOutputAddress (output, NULL, 0, addrParams);
     char * address = malloc (addressLength + 1);
     BRTxOutputAddress (output, address, addressLength, addrParams);
@@ -231,12 +237,17 @@ BRWalletSweeperGetUTXOs (BRCryptoWalletSweeperBTC sweeper) {
 
     // TODO(fix): This is horrible; we should be building up this knowledge as transactions are added
 
+    size_t sourceScriptLen = BRAddressScriptPubKey (NULL, 0, sweeper->addrParams, sweeper->sourceAddress);
+    uint8_t sourceScript[sourceScriptLen > 0 ? sourceScriptLen : 1];
+    sourceScriptLen = BRAddressScriptPubKey (sourceScript, sourceScriptLen, sweeper->addrParams, sweeper->sourceAddress);
+
     // loop through and add all the unspent outputs
     for (size_t index = 0; index < array_count (sweeper->txns); index++) {
         BRTransaction *txn = sweeper->txns[index];
 
         for (uint32_t i = 0; i < txn->outCount; i++) {
-            if (BRWalletSweeperIsSourceOutput (&txn->outputs[i], sweeper->addrParams, sweeper->sourceAddress)) {
+            if (BRWalletSweeperIsSourceOutput (&txn->outputs[i], sweeper->addrParams, sweeper->sourceAddress,
+                                               sourceScript, sourceScriptLen)) {
                 BRWalletSweeperUTXO * utxo = malloc (sizeof(BRWalletSweeperUTXO));
                 utxo->txHash = txn->txHash;
                 utxo->utxoIndex = i;
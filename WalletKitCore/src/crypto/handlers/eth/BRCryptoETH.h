@@ -179,6 +179,9 @@ typedef struct BRCryptoWalletManagerETHRecord {
 
     BRSetOf(BREthereumToken) tokens;
 
+    // The token wallets in `base.wallets`, by `ethToken`
+    BRSetOf(BRCryptoWalletETH) walletsByToken;
+
     BRRlpCoder coder;
 
 } *BRCryptoWalletManagerETH;
@@ -195,6 +198,15 @@ cryptoWalletManagerEnsureWalletForToken (BRCryptoWalletManagerETH managerETH,
 extern BRCryptoClientP2PManager
 cryptoWalletManagerCreateP2PManagerETH (BRCryptoWalletManager manager);
 
+/**
+ * Add `address` to the P2P sync of `manager`, if any; transactions and logs for `address` are
+ * then found along with those of the account's primary address.  The address is saved (with
+ * its bloom index) and restored when the P2P manager is next created.
+ */
+extern void
+cryptoWalletManagerAddAddressP2PETH (BRCryptoWalletManager manager,
+                                     BREthereumAddress address);
+
 private_extern void
 ewmHandleTransaction (BREthereumBCSCallbackContext context,
                       BREthereumBCSCallbackTransactionType type,
@@ -245,6 +257,7 @@ extern const char *fileServiceTypeLogsETH;
 extern const char *fileServiceTypeExchangesETH;
 extern const char *fileServiceTypeBlocksETH;
 extern const char *fileServiceTypeNodesETH;
+extern const char *fileServiceTypeBloomIndexesETH;
 extern const char *fileServiceTypeTokensETH;
 extern const char *fileServiceTypeWalletsETH;
 
@@ -258,6 +271,7 @@ extern BRSetOf(BREthereumLog)         initialLogsLoadETH         (BRCryptoWallet
 extern BRSetOf(BREthereumExchange)    initialExchangesLoadETH    (BRCryptoWalletManager manager);
 extern BRSetOf(BREthereumBlock)       initialBlocksLoadETH       (BRCryptoWalletManager manager);
 extern BRSetOf(BREthereumNodeConfig)  initialNodesLoadETH        (BRCryptoWalletManager manager);
+extern BRSetOf(BREthereumBloomIndex)  initialBloomIndexesLoadETH (BRCryptoWalletManager manager);
 extern BRSetOf(BREthereumToken)       initialTokensLoadETH       (BRCryptoWalletManager manager);
 #if 0
 extern BRSetOf(BREthereumWalletState) initialWalletsLoadETH      (BRCryptoWalletManager manager);
@@ -41,6 +41,16 @@ typedef struct {
     BRRlpCoder coder;
 } BRCryptoWalletManagerCreateContextETH;
 
+static size_t
+cryptoWalletETHTokenHashValue (const void *wallet) {
+    return (size_t) ((const struct BRCryptoWalletETHRecord *) wallet)->ethToken;
+}
+
+static int
+cryptoWalletETHTokenHashEqual (const void *wallet1, const void *wallet2) {
+    return ((const struct BRCryptoWalletETHRecord *) wallet1)->ethToken == ((const struct BRCryptoWalletETHRecord *) wallet2)->ethToken;
+}
+
 static void
 cryptoWaleltMangerCreateCallbackETH (BRCryptoWalletManagerCreateContext context,
                                      BRCryptoWalletManager manager) {
@@ -50,6 +60,7 @@ cryptoWaleltMangerCreateCallbackETH (BRCryptoWalletManagerCreateContext context,
     managerETH->network = contextETH->network;
     managerETH->account = contextETH->account;
     managerETH->coder   = contextETH->coder;
+    managerETH->walletsByToken = BRSetNew (cryptoWalletETHTokenHashValue, cryptoWalletETHTokenHashEqual, 10);
 }
 
 static BRCryptoWalletManager
@@ -127,6 +138,8 @@ cryptoWalletManagerReleaseETH (BRCryptoWalletManager manager) {
     BRCryptoWalletManagerETH managerETH = cryptoWalletManagerCoerceETH (manager);
 
     rlpCoderRelease (managerETH->coder);
+    if (NULL != managerETH->walletsByToken)
+        BRSetFreeAll (managerETH->walletsByToken, (void (*) (void*)) cryptoWalletGive);
     if (NULL != managerETH->tokens)
         BRSetFreeAll(managerETH->tokens, (void (*) (void*)) ethTokenRelease);
 }
@@ -225,6 +238,27 @@ cryptoWalletManagerSignTransactionWithSeedETH (BRCryptoWalletManager manager,
                                                &key);
 }
 
+static BRCryptoBoolean
+cryptoWalletManagerSignTransactionWithSigningKeysETH (BRCryptoWalletManager manager,
+                                                      BRCryptoWallet wallet,
+                                                      BRCryptoTransfer transfer,
+                                                      const BRCryptoSigningKeys *keys) {
+    BRCryptoWalletManagerETH managerETH  = cryptoWalletManagerCoerceETH (manager);
+
+    BREthereumAccount     ethAccount     = managerETH->account;
+    BREthereumAddress     ethAddress     = ethAccountGetPrimaryAddress (ethAccount);
+
+    BRKey key = derivePrivateKeyFromChainKey (&keys->eth, ethAccountGetAddressIndex (ethAccount, ethAddress));
+
+    BRCryptoBoolean success = cryptoWalletManagerSignTransaction (manager,
+                                                                  wallet,
+                                                                  transfer,
+                                                                  &key);
+    BRKeyClean (&key);
+
+    return success;
+}
+
 static BRCryptoBoolean
 cryptoWalletManagerSignTransactionWithKeyETH (BRCryptoWalletManager manager,
                                               BRCryptoWallet wallet,
@@ -421,6 +455,29 @@ cryptoWalletManagerCreateCurrencyForToken (BRCryptoWalletManagerETH managerETH,
     cryptoCurrencyGive (currency);
 }
 
+// Token wallets are indexed as they are added to, and removed from, `base.wallets`; the index
+// holds a reference.  Both are called with the manager's lock held.
+static void
+cryptoWalletManagerAddWalletETH (BRCryptoWalletManager manager,
+                                 BRCryptoWallet wallet) {
+    BRCryptoWalletManagerETH managerETH = cryptoWalletManagerCoerceETH (manager);
+    BRCryptoWalletETH        walletETH  = cryptoWalletCoerce (wallet);
+
+    if (NULL == walletETH->ethToken || BRSetContains (managerETH->walletsByToken, walletETH)) return;
+    BRSetAdd (managerETH->walletsByToken, cryptoWalletTake (wallet));
+}
+
+static void
+cryptoWalletManagerRemWalletETH (BRCryptoWalletManager manager,
+                                 BRCryptoWallet wallet) {
+    BRCryptoWalletManagerETH managerETH = cryptoWalletManagerCoerceETH (manager);
+    BRCryptoWalletETH        walletETH  = cryptoWalletCoerce (wallet);
+
+    if (NULL == walletETH->ethToken || walletETH != BRSetGet (managerETH->walletsByToken, walletETH)) return;
+    BRSetRemove (managerETH->walletsByToken, walletETH);
+    cryptoWalletGive (wallet);
+}
+
 static BRCryptoWallet
 cryptoWalletManagerCreateWalletETH (BRCryptoWalletManager manager,
                                     BRCryptoCurrency currency,
@@ -461,12 +518,11 @@ cryptoWalletManagerLookupWalletForToken (BRCryptoWalletManagerETH managerETH,
                                          BREthereumToken token) {
     if (NULL == token) return (BRCryptoWalletETH) cryptoWalletTake (managerETH->base.wallet);
 
-    for (size_t index = 0; index < array_count(managerETH->base.wallets); index++) {
-        BRCryptoWalletETH wallet = cryptoWalletCoerce (managerETH->base.wallets[index]);
-        if (token == wallet->ethToken)
-            return wallet;
-    }
-    return NULL;
+    pthread_mutex_lock (&managerETH->base.lock);
+    BRCryptoWalletETH wallet = BRSetGet (managerETH->walletsByToken, &(struct BRCryptoWalletETHRecord) { .ethToken = token });
+    pthread_mutex_unlock (&managerETH->base.lock);
+
+    return wallet;
 }
 
 private_extern BRCryptoWalletETH
@@ -900,6 +956,7 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersETH = {
     cryptoWalletManagerCreateWalletETH,
     cryptoWalletManagerSignTransactionWithSeedETH,
     cryptoWalletManagerSignTransactionWithKeyETH,
+    cryptoWalletManagerSignTransactionWithSigningKeysETH,
     cryptoWalletManagerEstimateLimitETH,
     cryptoWalletManagerEstimateFeeBasisETH,
     NULL, // BRCryptoWalletManagerSaveTransactionBundleHandler
@@ -909,4 +966,6 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersETH = {
     cryptoWalletManagerRecoverFeeBasisFromFeeEstimateETH,
     NULL,//BRCryptoWalletManagerWalletSweeperValidateSupportedHandler not supported
     NULL,//BRCryptoWalletManagerCreateWalletSweeperHandler not supported
+    cryptoWalletManagerAddWalletETH,
+    cryptoWalletManagerRemWalletETH
 };
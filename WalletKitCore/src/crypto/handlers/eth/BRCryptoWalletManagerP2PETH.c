@@ -650,6 +650,19 @@ ewmHandleSaveNodes (BREthereumBCSCallbackContext context,
     array_free (nodes);
 }
 
+static void
+ewmHandleSaveBloomIndex (BREthereumBCSCallbackContext context,
+                         OwnershipKept BREthereumBloomIndex index) {
+    BRCryptoWalletManagerETH manager = context;
+
+    eth_log("EWM", "Save Bloom Index (Storage): %" PRIu64 " Checked, %zu Matched",
+            bloomIndexGetCheckedCount (index),
+            bloomIndexGetMatchCount (index));
+    fileServiceSave (manager->base.fileService,
+                     fileServiceTypeBloomIndexesETH,
+                     index);
+}
+
 //extern void
 //ewmHandleSaveTransaction (BREthereumBCSCallbackContext context,
 //                          BREthereumTransaction transaction,
@@ -828,6 +841,7 @@ cryptoWalletManagerCreateP2PManagerETH (BRCryptoWalletManager manager) {
         ewmHandleLog,
         ewmHandleSaveBlocks,
         ewmHandleSaveNodes,
+        ewmHandleSaveBloomIndex,
         ewmHandleSync,
         ewmHandleGetBlocks
     };
@@ -840,6 +854,7 @@ cryptoWalletManagerCreateP2PManagerETH (BRCryptoWalletManager manager) {
     // Exchanges
     BRSetOf(BREthereumNodeConfig)  nodes        = initialNodesLoadETH        (manager);
     BRSetOf(BREthereumBlock)       blocks       = initialBlocksLoadETH       (manager);
+    BRSetOf(BREthereumBloomIndex)  bloomIndexes = initialBloomIndexesLoadETH (manager);
 
     // If we have no blocks; then add a checkpoint
     if (0 == BRSetCount(blocks)) {
@@ -849,6 +864,14 @@ cryptoWalletManagerCreateP2PManagerETH (BRCryptoWalletManager manager) {
         BRSetAdd (blocks, block);
     }
 
+    // Each address added to a prior BCS saved a bloom index; restore those addresses.
+    BRArrayOf(BREthereumAddress) addresses;
+    array_new (addresses, 1);
+    if (NULL != bloomIndexes)
+        FOR_SET (BREthereumBloomIndex, bloomIndex, bloomIndexes)
+            if (ETHEREUM_BOOLEAN_IS_FALSE (ethAddressEqual (address, bloomIndexGetAddress (bloomIndex))))
+                array_add (addresses, bloomIndexGetAddress (bloomIndex));
+
     p2p->bcs = bcsCreate (network,
                           address,
                           listener,
@@ -856,7 +879,21 @@ cryptoWalletManagerCreateP2PManagerETH (BRCryptoWalletManager manager) {
                           nodes,
                           blocks,
                           transactions,
-                          logs);
+                          logs,
+                          bloomIndexes);
+
+    for (size_t index = 0; index < array_count (addresses); index++)
+        bcsAddAddress (p2p->bcs, addresses[index]);
+    array_free (addresses);
 
     return p2pBase;
 }
+
+extern void
+cryptoWalletManagerAddAddressP2PETH (BRCryptoWalletManager manager,
+                                     BREthereumAddress address) {
+    pthread_mutex_lock (&manager->lock);
+    if (NULL != manager->p2pManager)
+        bcsAddAddress (cryptoClientP2PManagerCoerce (manager->p2pManager)->bcs, address);
+    pthread_mutex_unlock (&manager->lock);
+}
@@ -267,7 +267,8 @@ initialBlocksLoadETH (BRCryptoWalletManager manager) {
 
 #define fileServiceTypeNodes "nodes"
 enum {
-    EWM_NODE_VERSION_1
+    EWM_NODE_VERSION_1,
+    EWM_NODE_VERSION_2      // adds the node's quality
 };
 
 static UInt256
@@ -284,7 +285,7 @@ fileServiceTypeNodeV1Identifier (BRFileServiceContext context,
 }
 
 static uint8_t *
-fileServiceTypeNodeV1Writer (BRFileServiceContext context,
+fileServiceTypeNodeV2Writer (BRFileServiceContext context,
                              BRFileService fs,
                              const void* entity,
                              uint32_t *bytesCount) {
@@ -299,6 +300,7 @@ fileServiceTypeNodeV1Writer (BRFileServiceContext context,
     return data.bytes;
 }
 
+// Reads both versions; nodeConfigDecode() takes the quality as optional.
 static void *
 fileServiceTypeNodeV1Reader (BRFileServiceContext context,
                              BRFileService fs,
@@ -325,6 +327,67 @@ initialNodesLoadETH (BRCryptoWalletManager manager) {
     return nodes;
 }
 
+/// MARK: - Bloom Index File Service
+
+#define fileServiceTypeBloomIndexes "blooms"
+enum {
+    EWM_BLOOM_INDEX_VERSION_1
+};
+
+static UInt256
+fileServiceTypeBloomIndexV1Identifier (BRFileServiceContext context,
+                                       BRFileService fs,
+                                       const void *entity) {
+    const BREthereumBloomIndex index = (BREthereumBloomIndex) entity;
+    BREthereumHash hash = bloomIndexGetHash(index);
+
+    UInt256 result;
+    memcpy (result.u8, hash.bytes, ETHEREUM_HASH_BYTES);
+    return result;
+}
+
+static uint8_t *
+fileServiceTypeBloomIndexV1Writer (BRFileServiceContext context,
+                                   BRFileService fs,
+                                   const void* entity,
+                                   uint32_t *bytesCount) {
+    BRCryptoWalletManagerETH manager = context;
+    BREthereumBloomIndex index = (BREthereumBloomIndex) entity;
+
+    BRRlpItem item = bloomIndexRlpEncode (index, manager->coder);
+    BRRlpData data = rlpItemGetData (manager->coder, item);
+    rlpItemRelease (manager->coder, item);
+
+    *bytesCount = (uint32_t) data.bytesCount;
+    return data.bytes;
+}
+
+static void *
+fileServiceTypeBloomIndexV1Reader (BRFileServiceContext context,
+                                   BRFileService fs,
+                                   uint8_t *bytes,
+                                   uint32_t bytesCount) {
+    BRCryptoWalletManagerETH manager = context;
+
+    BRRlpData data = { bytesCount, bytes };
+    BRRlpItem item = rlpDataGetItem (manager->coder, data);
+
+    BREthereumBloomIndex index = bloomIndexRlpDecode (item, manager->coder);
+    rlpItemRelease (manager->coder, item);
+
+    return index;
+}
+
+extern BRSetOf(BREthereumBloomIndex)
+initialBloomIndexesLoadETH (BRCryptoWalletManager manager) {
+    BRSetOf(BREthereumBloomIndex) indexes = BRSetNew(bloomIndexHashValue, bloomIndexHashEqual, EWM_INITIAL_SET_SIZE_DEFAULT);
+    if (NULL != indexes && 1 != fileServiceLoad (manager->fileService, indexes, fileServiceTypeBloomIndexesETH, 1)) {
+        BRSetFreeAll (indexes, (void (*) (void*)) bloomIndexRelease);
+        return NULL;
+    }
+    return indexes;
+}
+
 /// MARK: - Token File Service
 
 #define fileServiceTypeTokens "tokens"
@@ -523,14 +586,37 @@ static BRFileServiceTypeSpecification fileServiceSpecificationsArrayETH[] = {
 
     {
         fileServiceTypeNodes,
-        EWM_NODE_VERSION_1,
-        1,
+        EWM_NODE_VERSION_2,
+        2,
         {
+            // A build that predates EWM_NODE_VERSION_2 has no handler for it and so skips the
+            // load of saved nodes, rather than decoding a record it doesn't know.  Only the
+            // current version is ever written.
             {
                 EWM_NODE_VERSION_1,
                 fileServiceTypeNodeV1Identifier,
                 fileServiceTypeNodeV1Reader,
-                fileServiceTypeNodeV1Writer
+                NULL
+            },
+            {
+                EWM_NODE_VERSION_2,
+                fileServiceTypeNodeV1Identifier,
+                fileServiceTypeNodeV1Reader,
+                fileServiceTypeNodeV2Writer
+            }
+        }
+    },
+
+    {
+        fileServiceTypeBloomIndexes,
+        EWM_BLOOM_INDEX_VERSION_1,
+        1,
+        {
+            {
+                EWM_BLOOM_INDEX_VERSION_1,
+                fileServiceTypeBloomIndexV1Identifier,
+                fileServiceTypeBloomIndexV1Reader,
+                fileServiceTypeBloomIndexV1Writer
             }
         }
     },
@@ -570,6 +656,7 @@ const char *fileServiceTypeLogsETH         = fileServiceTypeLogs;
 const char *fileServiceTypeExchangesETH    = fileServiceTypeExchanges;
 const char *fileServiceTypeBlocksETH       = fileServiceTypeBlocks;
 const char *fileServiceTypeNodesETH        = fileServiceTypeNodes;
+const char *fileServiceTypeBloomIndexesETH = fileServiceTypeBloomIndexes;
 const char *fileServiceTypeTokensETH       = fileServiceTypeTokens;
 //const char *ewmFileServiceTypeWallets      = fileServiceTypeWallets;
 
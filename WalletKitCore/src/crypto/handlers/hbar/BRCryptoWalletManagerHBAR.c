@@ -100,9 +100,8 @@ cryptoWalletManagerSignTransactionWithSeedHBAR (BRCryptoWalletManager manager,
                                                 BRCryptoTransfer transfer,
                                                 UInt512 seed) {
     BRHederaAccount account = cryptoAccountAsHBAR (manager->account);
-    BRKey publicKey = hederaAccountGetPublicKey (account);
     BRHederaTransaction transaction = cryptoTransferCoerceHBAR(transfer)->hbarTransaction;
-    size_t tx_size = hederaTransactionSignTransaction (transaction, publicKey, seed);
+    size_t tx_size = hederaTransactionSignTransaction (transaction, account, seed);
     return AS_CRYPTO_BOOLEAN(tx_size > 0);
 }
 
@@ -303,6 +302,7 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersHBAR = {
     cryptoWalletManagerCreateWalletHBAR,
     cryptoWalletManagerSignTransactionWithSeedHBAR,
     cryptoWalletManagerSignTransactionWithKeyHBAR,
+    NULL, // BRCryptoWalletManagerSignTransactionWithSigningKeysHandler
     cryptoWalletManagerEstimateLimitHBAR,
     cryptoWalletManagerEstimateFeeBasisHBAR,
     NULL, // BRCryptoWalletManagerSaveTransactionBundleHandler
@@ -311,5 +311,7 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersHBAR = {
     cryptoWalletManagerRecoverTransferFromTransferBundleHBAR,
     NULL,//BRCryptoWalletManagerRecoverFeeBasisFromFeeEstimateHandler not supported
     cryptoWalletManagerWalletSweeperValidateSupportedHBAR,
-    cryptoWalletManagerCreateWalletSweeperHBAR
+    cryptoWalletManagerCreateWalletSweeperHBAR,
+    NULL, // BRCryptoWalletManagerWalletChangedHandler addWallet
+    NULL  // BRCryptoWalletManagerWalletChangedHandler remWallet
 };
@@ -300,6 +300,7 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersXRP = {
     cryptoWalletManagerCreateWalletXRP,
     cryptoWalletManagerSignTransactionWithSeedXRP,
     cryptoWalletManagerSignTransactionWithKeyXRP,
+    NULL, // BRCryptoWalletManagerSignTransactionWithSigningKeysHandler
     cryptoWalletManagerEstimateLimitXRP,
     cryptoWalletManagerEstimateFeeBasisXRP,
     NULL, // BRCryptoWalletManagerSaveTransactionBundleHandler
@@ -308,5 +309,7 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersXRP = {
     cryptoWalletManagerRecoverTransferFromTransferBundleXRP,
     NULL,//BRCryptoWalletManagerRecoverFeeBasisFromFeeEstimateHandler not supported
     cryptoWalletManagerWalletSweeperValidateSupportedXRP,
-    cryptoWalletManagerCreateWalletSweeperXRP
+    cryptoWalletManagerCreateWalletSweeperXRP,
+    NULL, // BRCryptoWalletManagerWalletChangedHandler addWallet
+    NULL  // BRCryptoWalletManagerWalletChangedHandler remWallet
 };
@@ -356,6 +356,7 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersXTZ = {
     cryptoWalletManagerCreateWalletXTZ,
     cryptoWalletManagerSignTransactionWithSeedXTZ,
     cryptoWalletManagerSignTransactionWithKeyXTZ,
+    NULL, // BRCryptoWalletManagerSignTransactionWithSigningKeysHandler
     cryptoWalletManagerEstimateLimitXTZ,
     cryptoWalletManagerEstimateFeeBasisXTZ,
     NULL, // BRCryptoWalletManagerSaveTransactionBundleHandler
@@ -364,5 +365,7 @@ BRCryptoWalletManagerHandlers cryptoWalletManagerHandlersXTZ = {
     cryptoWalletManagerRecoverTransferFromTransferBundleXTZ,
     cryptoWalletManagerRecoverFeeBasisFromFeeEstimateXTZ,
     cryptoWalletManagerWalletSweeperValidateSupportedXTZ,
-    cryptoWalletManagerCreateWalletSweeperXTZ
+    cryptoWalletManagerCreateWalletSweeperXTZ,
+    NULL, // BRCryptoWalletManagerWalletChangedHandler addWallet
+    NULL  // BRCryptoWalletManagerWalletChangedHandler remWallet
 };
@@ -9,6 +9,7 @@
 //  See the CONTRIBUTORS file at the project root for a list of contributors.
 
 #include <assert.h>
+#include <string.h>
 #include "support/BRCrypto.h"
 #include "BREthereumSignature.h"
 
@@ -86,6 +87,62 @@ ethSignatureCreate(BREthereumSignatureType type,
     return signature;
 }
 
+extern void
+ethSignatureExtractAddressList (BREthereumAddress addresses[],
+                                int success[],
+                                const BREthereumSignature signatures[],
+                                const uint8_t *bytes[],
+                                const size_t bytesCount[],
+                                size_t count) {
+    if (0 == count) return;
+
+    UInt256 *digests = malloc (count * sizeof (UInt256));
+    BREthereumSignatureVRS *sigs = malloc (count * sizeof (BREthereumSignatureVRS));
+    const void **sigPtrs = malloc (count * sizeof (void *));
+    BRKey *keys = calloc (count, sizeof (BRKey));
+    assert (NULL != digests && NULL != sigs && NULL != sigPtrs && NULL != keys);
+
+    BRKeccak256Batch (digests, (const void **) bytes, bytesCount, count);
+
+    // An RSV signature recovers the same uncompressed public key as the equivalent VRS one, with
+    // the 0x1b offset applied to 'v', so the whole batch is recovered in the VRS format.  A
+    // signature of an unknown type is left zeroed, which recovers nothing.
+    for (size_t index = 0; index < count; index++) {
+        switch (signatures[index].type) {
+            case SIGNATURE_TYPE_RECOVERABLE_VRS_EIP:
+                sigs[index] = signatures[index].sig.vrs;
+                break;
+            case SIGNATURE_TYPE_RECOVERABLE_RSV:
+                sigs[index].v = 27 + signatures[index].sig.rsv.v;
+                memcpy (sigs[index].r, signatures[index].sig.rsv.r, 32);
+                memcpy (sigs[index].s, signatures[index].sig.rsv.s, 32);
+                break;
+            default:
+                memset (&sigs[index], 0, sizeof (BREthereumSignatureVRS));
+                break;
+        }
+        sigPtrs[index] = &sigs[index];
+        success[index] = 0;
+    }
+
+    BRKeyRecoverPubKeyList (keys, success, digests, sigPtrs, count, 0);
+
+    for (size_t index = 0; index < count; index++) {
+        if (SIGNATURE_TYPE_RECOVERABLE_VRS_EIP != signatures[index].type &&
+            SIGNATURE_TYPE_RECOVERABLE_RSV     != signatures[index].type)
+            success[index] = 0;
+
+        addresses[index] = (0 == success[index]
+                            ? (BREthereumAddress) EMPTY_ADDRESS_INIT
+                            : ethAddressCreateKey (&keys[index]));
+    }
+
+    free (keys);
+    free (sigPtrs);
+    free (sigs);
+    free (digests);
+}
+
 extern BREthereumBoolean
 ethSignatureEqual (BREthereumSignature s1, BREthereumSignature s2) {
     return (s1.type == s2.type &&
@@ -92,6 +92,23 @@ ethSignatureExtractAddress (const BREthereumSignature signature,
                             size_t bytesCount,
                             int *success);
 
+/**
+ * Extract the address for each of `count` signatures of `bytes[i]`, as ethSignatureExtractAddress()
+ * does for one.  The digests are hashed with BRKeccak256Batch(), four at a time on AVX2 cpus.  The
+ * recoveries share no work; each is a full public key recovery and the list only spreads them
+ * across cores.  This is meant for the many transactions of a block body.
+ *
+ * @param addresses filled with the recovered address, or an empty address on failure
+ * @param success filled with 1 if the address was recovered, 0 otherwise
+ */
+extern void
+ethSignatureExtractAddressList (BREthereumAddress addresses[],
+                                int success[],
+                                const BREthereumSignature signatures[],
+                                const uint8_t *bytes[],
+                                const size_t bytesCount[],
+                                size_t count);
+
 extern BREthereumBoolean
 ethSignatureEqual (BREthereumSignature s1, BREthereumSignature s2);
 
@@ -23,6 +23,7 @@
 
 #define BCS_TRANSACTIONS_INITIAL_CAPACITY (50)
 #define BCS_LOGS_INITIAL_CAPACITY (50)
+#define BCS_BLOOM_INDEXES_INITIAL_CAPACITY (5)
 
 // Any orphan more then AGE_OFFSET blocks in the past will be purged.  That is, if the head block
 // is N, then any orphan block we hold at (N - ARG_OFFSET) will no longer be chainable - unless
@@ -172,6 +173,72 @@ bcsCreateInitializeLogs (BREthereumBCS bcs,
     BRSetFree (logs);
 }
 
+/// MARK: - Bloom Indexes
+
+static BREthereumBloomIndex
+bcsGetBloomIndex (BREthereumBCS bcs,
+                  BREthereumAddress address) {
+    // The address is the first field of a bloom index; thus a suitable BRSet key.
+    return BRSetGet (bcs->bloomIndexes, &address);
+}
+
+static void
+bcsEnsureBloomIndex (BREthereumBCS bcs,
+                     BREthereumAddress address) {
+    if (NULL == bcsGetBloomIndex (bcs, address))
+        BRSetAdd (bcs->bloomIndexes, bloomIndexCreate (address));
+}
+
+/**
+ * Check if every address has checked `number` and found no match.  If so, the block holds
+ * nothing of interest.
+ */
+static BREthereumBoolean
+bcsBloomIndexesHaveCheckedWithoutMatch (BREthereumBCS bcs,
+                                        uint64_t number) {
+    for (size_t index = 0; index < array_count(bcs->addresses); index++) {
+        BREthereumBloomIndex bloomIndex = bcsGetBloomIndex (bcs, bcs->addresses[index]);
+        if (ETHEREUM_BOOLEAN_IS_FALSE (bloomIndexHasChecked (bloomIndex, number)) ||
+            ETHEREUM_BOOLEAN_IS_TRUE  (bloomIndexHasMatch   (bloomIndex, number)))
+            return ETHEREUM_BOOLEAN_FALSE;
+    }
+    return ETHEREUM_BOOLEAN_TRUE;
+}
+
+/**
+ * Add `block`, having had its body searched, to every address' bloom index.  The block matches
+ * an address if the header's logsBloom matches or if one of `transactions` has the address.  We
+ * only add a block that is well below the head; a block subject to a reorg might yet change.
+ */
+static void
+bcsBloomIndexesAddBlock (BREthereumBCS bcs,
+                         BREthereumBlock block,
+                         BRArrayOf(BREthereumTransaction) transactions) {
+    uint64_t number = blockGetNumber (block);
+    if (number + BCS_REORG_LIMIT > bcs->headNumber) return;
+
+    for (size_t index = 0; index < array_count(bcs->addresses); index++) {
+        BREthereumBloomIndex bloomIndex = bcsGetBloomIndex (bcs, bcs->addresses[index]);
+        BREthereumBoolean matched = bloomIndexMatchesHeader (bloomIndex, blockGetHeader (block));
+
+        size_t transactionsCount = (NULL == transactions ? 0 : array_count(transactions));
+        for (size_t i = 0; ETHEREUM_BOOLEAN_IS_FALSE (matched) && i < transactionsCount; i++)
+            matched = transactionHasAddress (transactions[i], bcs->addresses[index]);
+
+        bloomIndexAddBlock (bloomIndex, number, matched);
+    }
+    bcs->bloomIndexesUpdated = 1;
+}
+
+static void
+bcsSaveBloomIndexes (BREthereumBCS bcs) {
+    if (!bcs->bloomIndexesUpdated) return;
+
+    FOR_SET (BREthereumBloomIndex, bloomIndex, bcs->bloomIndexes)
+        bcs->listener.saveBloomIndexCallback (bcs->listener.context, bloomIndex);
+    bcs->bloomIndexesUpdated = 0;
+}
+
 extern BREthereumBCS
 bcsCreate (BREthereumNetwork network,
            BREthereumAddress address,
@@ -180,17 +247,22 @@ bcsCreate (BREthereumNetwork network,
            OwnershipGiven BRSetOf(BREthereumNodeConfig) peers,
            OwnershipGiven BRSetOf(BREthereumBlock) blocks,
            OwnershipGiven BRSetOf(BREthereumTransaction) transactions,
-           OwnershipGiven BRSetOf(BREthereumLog) logs) {
+           OwnershipGiven BRSetOf(BREthereumLog) logs,
+           OwnershipGiven BRSetOf(BREthereumBloomIndex) bloomIndexes) {
 
     BREthereumBCS bcs = (BREthereumBCS) calloc (1, sizeof(struct BREthereumBCSStruct));
 
     bcs->network = network;
     bcs->address = address;
+    array_new (bcs->addresses, 1);
+    array_add (bcs->addresses, address);
     bcs->accountStateBlockNumber = 0;
     bcs->accountState = accountStateCreateEmpty ();
     bcs->mode = mode;
-    bcs->filterForAddressOnTransactions = bloomFilterCreateAddress(bcs->address);
-    bcs->filterForAddressOnLogs = logTopicGetBloomFilterAddress(bcs->address);
+    array_new (bcs->bitsForAddressesOnTransactions, 1);
+    array_add (bcs->bitsForAddressesOnTransactions, bloomFilterBitsCreate (bloomFilterCreateAddress(bcs->address)));
+    array_new (bcs->bitsForAddressesOnLogs, 1);
+    array_add (bcs->bitsForAddressesOnLogs, bloomFilterBitsCreate (logTopicGetBloomFilterAddress(bcs->address)));
 
     bcs->listener = listener;
 
@@ -223,6 +295,18 @@ bcsCreate (BREthereumNetwork network,
     array_new (bcs->pendingTransactions, BCS_PENDING_TRANSACTION_INITIAL_CAPACITY);
     array_new (bcs->pendingLogs, BCS_PENDING_LOGS_INITIAL_CAPACITY);
 
+    //
+    // Initialize `bloomIndexes` from saved state; ensure one for `address`
+    //
+    bcs->bloomIndexes = (NULL != bloomIndexes
+                         ? bloomIndexes
+                         : BRSetNew (bloomIndexHashValue,
+                                     bloomIndexHashEqual,
+                                     BCS_BLOOM_INDEXES_INITIAL_CAPACITY));
+    bcs->bloomIndexesUpdated = 0;
+    bcsEnsureBloomIndex (bcs, address);
+    bcs->headNumber = 0;
+
     // Our genesis block.
     bcs->genesis = networkGetGenesisBlock(network);
     BRSetAdd(bcs->blocks, bcs->genesis);
@@ -325,6 +409,50 @@ bcsIsStarted (BREthereumBCS bcs) {
     return AS_ETHEREUM_BOOLEAN (eventHandlerIsRunning(bcs->handler));
 }
 
+extern void
+bcsAddAddress (BREthereumBCS bcs,
+               BREthereumAddress address) {
+    bcsSignalAddAddress (bcs, address);
+}
+
+extern void
+bcsHandleAddAddress (BREthereumBCS bcs,
+                     BREthereumAddress address) {
+    for (size_t index = 0; index < array_count(bcs->addresses); index++)
+        if (ETHEREUM_BOOLEAN_IS_TRUE (ethAddressEqual (address, bcs->addresses[index])))
+            return;
+
+    array_add (bcs->addresses, address);
+
+    // Add the address' own bits; a union of filters would only match if every address did.
+    array_add (bcs->bitsForAddressesOnTransactions, bloomFilterBitsCreate (bloomFilterCreateAddress(address)));
+    array_add (bcs->bitsForAddressesOnLogs, bloomFilterBitsCreate (logTopicGetBloomFilterAddress(address)));
+
+    // Save the new bloom index; on a restart the address is restored from it.
+    bcsEnsureBloomIndex (bcs, address);
+    bcs->bloomIndexesUpdated = 1;
+
+    bcsSyncAddAddress (bcs->sync, address);
+}
+
+static BREthereumBoolean
+bcsTransactionHasAddress (BREthereumBCS bcs,
+                          BREthereumTransaction transaction) {
+    for (size_t index = 0; index < array_count(bcs->addresses); index++)
+        if (ETHEREUM_BOOLEAN_IS_TRUE (transactionHasAddress (transaction, bcs->addresses[index])))
+            return ETHEREUM_BOOLEAN_TRUE;
+    return ETHEREUM_BOOLEAN_FALSE;
+}
+
+static BREthereumBoolean
+bcsLogMatchesAddress (BREthereumBCS bcs,
+                      BREthereumLog log) {
+    for (size_t index = 0; index < array_count(bcs->addresses); index++)
+        if (ETHEREUM_BOOLEAN_IS_TRUE (logMatchesAddress (log, bcs->addresses[index], ETHEREUM_BOOLEAN_TRUE)))
+            return ETHEREUM_BOOLEAN_TRUE;
+    return ETHEREUM_BOOLEAN_FALSE;
+}
+
 extern void
 bcsDestroy (BREthereumBCS bcs) {
     // Ensure we are stopped and no longer handling events (anything submitted will pile up).
@@ -348,10 +476,16 @@ bcsDestroy (BREthereumBCS bcs) {
 
     // Logs
     BRSetFreeAll (bcs->logs, (void (*) (void*)) logRelease);
+
+    // Bloom Indexes
+    BRSetFreeAll (bcs->bloomIndexes, (void (*) (void*)) bloomIndexRelease);
     
     // pending transactions/logs are in bcs->transactions/logs; thus already released.
     array_free (bcs->pendingTransactions);
     array_free (bcs->pendingLogs);
+    array_free (bcs->addresses);
+    array_free (bcs->bitsForAddressesOnTransactions);
+    array_free (bcs->bitsForAddressesOnLogs);
 
     bcs->genesis = NULL;
     
@@ -634,6 +768,7 @@ bcsHandleStatus (BREthereumBCS bcs,
         return;
     }
 
+    bcs->headNumber = maximum (bcs->headNumber, headNumber);
     bcsSyncRange (bcs, node, blockGetNumber(bcs->chain), headNumber);
 }
 
@@ -660,6 +795,8 @@ bcsHandleAnnounce (BREthereumBCS bcs,
         return;
     }
 
+    bcs->headNumber = maximum (bcs->headNumber, headNumber);
+
     // If we are in the middle of a sync, we won't be reorganizing anything.
     if (ETHEREUM_BOOLEAN_IS_TRUE (bcsSyncIsActive(bcs->sync)) && 0 != reorgDepth) {
         reorgDepth = 0;
@@ -767,6 +904,7 @@ bcsReclaimAndSaveBlocksIfAppropriate (BREthereumBCS bcs) {
                 reclaimFromBlockNumber - 1);
 
         bcsSaveBlocks(bcs);
+        bcsSaveBloomIndexes(bcs);
     }
 }
 
@@ -1257,10 +1395,32 @@ bcsBlockHasMatchingTransactions (BREthereumBCS bcs,
     // return ETHEREUM_BOOLEAN_FALSE;
 }
 
+/**
+ * Screen the logsBloom of each of `headers` for logs with any of the BCS addresses.  Returns a
+ * newly allocated array with a match for each header.
+ */
+static BREthereumBoolean *
+bcsBlockHeadersHaveMatchingLogs (BREthereumBCS bcs,
+                                 BRArrayOf(BREthereumBlockHeader) headers) {
+    size_t headersCount = array_count (headers);
+    BREthereumBoolean *matches = malloc ((headersCount > 0 ? headersCount : 1) * sizeof (BREthereumBoolean));
+
+    for (size_t index = 0; index < headersCount; index++)
+        matches[index] = ETHEREUM_BOOLEAN_FALSE;
+
+    for (size_t index = 0; index < array_count (bcs->bitsForAddressesOnLogs); index++)
+        blockHeadersMatchBits (headers, &bcs->bitsForAddressesOnLogs[index], matches);
+
+    return matches;
+}
+
 static BREthereumBoolean
-bcsBlockHasMatchingLogs (BREthereumBCS bcs,
-                         BREthereumBlock block) {
-    return blockHeaderMatch (blockGetHeader (block), bcs->filterForAddressOnLogs);
+bcsTransactionReceiptHasMatchingLogs (BREthereumBCS bcs,
+                                      BREthereumTransactionReceipt receipt) {
+    for (size_t index = 0; index < array_count (bcs->bitsForAddressesOnLogs); index++)
+        if (ETHEREUM_BOOLEAN_IS_TRUE (transactionReceiptMatchBits (receipt, &bcs->bitsForAddressesOnLogs[index])))
+            return ETHEREUM_BOOLEAN_TRUE;
+    return ETHEREUM_BOOLEAN_FALSE;
 }
 
 static BREthereumBoolean
@@ -1282,10 +1442,12 @@ static void
 bcsHandleBlockHeaderInternal (BREthereumBCS bcs,
                               BREthereumNodeReference node,
                               OwnershipGiven BREthereumBlockHeader header,
+                              BREthereumBoolean hasMatchingLogs,
                               int isFromSync,
                               BRArrayOf(BREthereumHash) *bodiesHashes,
                               BRArrayOf(BREthereumHash) *receiptsHashes,
                               BRArrayOf(BREthereumHash) *accountsHashes,
+                              BRArrayOf(BREthereumHash) *accountsRoots,
                               BRArrayOf(uint64_t) *proofNumbers) {
 
     // Ignore the header if we have seen it before.  Given an identical hash, *nothing*, at any
@@ -1320,10 +1482,17 @@ bcsHandleBlockHeaderInternal (BREthereumBCS bcs,
     // proof' occassionally so that we can build on the block chain's total difficulty and
     // ultimately our Proof-of-Work validations.
     BREthereumBoolean needBodies   = bcsBlockHasMatchingTransactions(bcs, block);
-    BREthereumBoolean needReceipts = bcsBlockHasMatchingLogs(bcs, block);
+    BREthereumBoolean needReceipts = hasMatchingLogs;
     BREthereumBoolean needAccount  = bcsBlockNeedsAccountState(bcs, block);
     BREthereumBoolean needProof    = bcsBlockNeedsHeaderProof(bcs, block);
 
+    // If a prior sync checked this block, for every address, and found no match, then the block
+    // has nothing of interest - skip the bodies and receipts.  (A header proof is still needed.)
+    if (ETHEREUM_BOOLEAN_IS_TRUE (bcsBloomIndexesHaveCheckedWithoutMatch (bcs, blockGetNumber(block)))) {
+        needBodies   = ETHEREUM_BOOLEAN_FALSE;
+        needReceipts = ETHEREUM_BOOLEAN_FALSE;
+    }
+
     // Request block bodies, if needed.
     if (ETHEREUM_BOOLEAN_IS_TRUE(needBodies)) {
         blockReportStatusTransactionsRequest(block, BLOCK_REQUEST_PENDING);
@@ -1344,7 +1513,9 @@ bcsHandleBlockHeaderInternal (BREthereumBCS bcs,
     if (ETHEREUM_BOOLEAN_IS_TRUE(needAccount)) {
         blockReportStatusAccountStateRequest (block, BLOCK_REQUEST_PENDING);
         if (NULL == *accountsHashes ) array_new (*accountsHashes,  200);
+        if (NULL == *accountsRoots  ) array_new (*accountsRoots,   200);
         array_add (*accountsHashes, blockGetHash(block));
+        array_add (*accountsRoots,  blockHeaderGetStateRoot (blockGetHeader(block)));
         eth_log("BCS", "Block %" PRIu64 " Needs AccountState", blockGetNumber(block));
     }
 
@@ -1373,18 +1544,25 @@ bcsHandleBlockHeaders (BREthereumBCS bcs,
     BRArrayOf(BREthereumHash) bodiesHashes = NULL;
     BRArrayOf(BREthereumHash) receiptsHashes = NULL;
     BRArrayOf(BREthereumHash) accountsHashes = NULL;
+    BRArrayOf(BREthereumHash) accountsRoots = NULL;
     BRArrayOf(uint64_t) proofNumbers = NULL;
 
+    // Screen all the headers' logsBloom at once.
+    BREthereumBoolean *hasMatchingLogs = bcsBlockHeadersHaveMatchingLogs (bcs, headers);
+
     for (size_t index = 0; index < array_count(headers); index++)
         // Each `headers[index]` has 'OwnershipGiven'
         bcsHandleBlockHeaderInternal (bcs, node,
                                       headers[index],
+                                      hasMatchingLogs[index],
                                       isFromSync,
                                       &bodiesHashes,
                                       &receiptsHashes,
                                       &accountsHashes,
+                                      &accountsRoots,
                                       &proofNumbers);
 
+    free (hasMatchingLogs);
     array_free(headers);
 
     if (NULL != bodiesHashes && array_count(bodiesHashes) > 0)
@@ -1404,7 +1582,8 @@ bcsHandleBlockHeaders (BREthereumBCS bcs,
                                  (BREthereumLESProvisionContext) bcs,
                                  (BREthereumLESProvisionCallback) bcsSignalProvision,
                                  bcs->address,
-                                 accountsHashes);
+                                 accountsHashes,
+                                 accountsRoots);
 
     if (NULL != proofNumbers && array_count(proofNumbers) > 0)
         lesProvideBlockProofs (bcs->les, node,
@@ -1536,7 +1715,7 @@ bcsHandleBlockBody (BREthereumBCS bcs,
         assert (NULL != tx);
         
         // If it is our transaction (as source or target), handle it.
-        if (ETHEREUM_BOOLEAN_IS_TRUE(transactionHasAddress(tx, bcs->address))) {
+        if (ETHEREUM_BOOLEAN_IS_TRUE(bcsTransactionHasAddress(bcs, tx))) {
             eth_log("BCS", "Bodies %" PRIu64 " Found Transaction at %zu",
                     blockGetNumber(block), i);
 
@@ -1559,6 +1738,9 @@ bcsHandleBlockBody (BREthereumBCS bcs,
         // else - TODO: Handle if has a 'contract' address of interest?
     }
 
+    // Record the block as checked, with any matches, for each address.
+    bcsBloomIndexesAddBlock (bcs, block, neededTransactions);
+
     // Report the block status.  Do so even if neededTransaction is NULL.
     blockReportStatusTransactions(block, neededTransactions);
 
@@ -1592,7 +1774,8 @@ bcsHandleBlockBody (BREthereumBCS bcs,
                                         (BREthereumLESProvisionContext) bcs,
                                         (BREthereumLESProvisionCallback) bcsSignalProvision,
                                         bcs->address,
-                                        blockGetHash(block));
+                                        blockGetHash(block),
+                                        blockHeaderGetStateRoot (blockGetHeader(block)));
         }
     }
 
@@ -1690,7 +1873,7 @@ bcsHandleLogExtractInterest (BREthereumBCS bcs,
     *token = NULL;
     *tokenEvent = NULL;
 
-    if (ETHEREUM_BOOLEAN_IS_FALSE (logMatchesAddress(log, bcs->address, ETHEREUM_BOOLEAN_TRUE)))
+    if (ETHEREUM_BOOLEAN_IS_FALSE (bcsLogMatchesAddress(bcs, log)))
         return ETHEREUM_BOOLEAN_FALSE;
 
     *token = tokenLookupByAddress(logGetAddress(log));
@@ -1748,13 +1931,13 @@ bcsHandleTransactionReceipts (BREthereumBCS bcs,
     size_t receiptsCount = array_count(receipts);
     for (size_t ti = 0; ti < receiptsCount; ti++) { // transactionIndex
         BREthereumTransactionReceipt receipt = receipts[ti];
-        if (ETHEREUM_BOOLEAN_IS_TRUE (transactionReceiptMatch(receipt, bcs->filterForAddressOnLogs))) {
+        if (ETHEREUM_BOOLEAN_IS_TRUE (bcsTransactionReceiptHasMatchingLogs (bcs, receipt))) {
             size_t logsCount = transactionReceiptGetLogsCount(receipt);
             for (size_t li = 0; li < logsCount; li++) { // logIndex
                 BREthereumLog log = transactionReceiptGetLog(receipt, li);
 
                 // If `log` topics match our address....
-                if (ETHEREUM_BOOLEAN_IS_TRUE (logMatchesAddress(log, bcs->address, ETHEREUM_BOOLEAN_TRUE))) {
+                if (ETHEREUM_BOOLEAN_IS_TRUE (bcsLogMatchesAddress(bcs, log))) {
                     eth_log("BCS", "Receipts %" PRIu64 " Found Log at (%zu, %zu)",
                             blockGetNumber(block), ti, li);
 
@@ -2261,8 +2444,11 @@ bcsSyncReportProgressCallback (BREthereumBCS bcs,
         case BCS_CALLBACK_SYNC_UPDATE:
             break;
         case BCS_CALLBACK_SYNC_STARTED:
+            lesClean (bcs->les);
+            break;
         case BCS_CALLBACK_SYNC_STOPPED:
             lesClean (bcs->les);
+            bcsSaveBloomIndexes (bcs);
             break;
     }
 }
@@ -119,6 +119,13 @@ typedef void
 (*BREthereumBCSCallbackSavePeers) (BREthereumBCSCallbackContext context,
                                    OwnershipGiven BRArrayOf(BREthereumNodeConfig) peers);
 
+/**
+ * Save Bloom Index
+ */
+typedef void
+(*BREthereumBCSCallbackSaveBloomIndex) (BREthereumBCSCallbackContext context,
+                                        OwnershipKept BREthereumBloomIndex index);
+
 /**
  * Sync
  */
@@ -154,6 +161,7 @@ typedef struct {
     BREthereumBCSCallbackLog logCallback;
     BREthereumBCSCallbackSaveBlocks saveBlocksCallback;
     BREthereumBCSCallbackSavePeers savePeersCallback;
+    BREthereumBCSCallbackSaveBloomIndex saveBloomIndexCallback;
     BREthereumBCSCallbackSync syncCallback;
     BREthereumBCSCallbackGetBlocks getBlocksCallback;
 } BREthereumBCSListener;
@@ -163,6 +171,9 @@ typedef struct {
  * focused on the `account` primary address.  Initialize the synchronization with the previously
  * saved `headers`.  Provide `listener` to anounce BCS 'events'.
  *
+ * The previously saved `bloomIndexes` record, per address, the blocks already checked and the
+ * blocks that matched; a sync skips the bodies and receipts of checked blocks that did not match.
+ *
  * @parameters
  * @parameter headers - is this a BRArray; assume so for now.
  */
@@ -174,7 +185,8 @@ bcsCreate (BREthereumNetwork network,
            BRSetOf(BREthereumNodeConfig) peers,
            BRSetOf(BREthereumBlock) blocks,
            BRSetOf(BREthereumTransaction) transactions,
-           BRSetOf(BREthereumLog) logs);
+           BRSetOf(BREthereumLog) logs,
+           OwnershipGiven BRSetOf(BREthereumBloomIndex) bloomIndexes);
 
 extern void
 bcsStart (BREthereumBCS bcs);
@@ -185,6 +197,22 @@ bcsStop (BREthereumBCS bcs);
 extern BREthereumBoolean
 bcsIsStarted (BREthereumBCS bcs);
 
+/**
+ * Add `address` to the BCS making it a multi-address BCS.  Subsequent syncs (see bcsSync()) use
+ * one sync tree for all addresses - the block headers are shared and the account states for all
+ * addresses are requested together.  Transactions and logs for any address are announced to the
+ * listener; the account state announced is for the primary address only.
+ *
+ * The address is added on the BCS event thread, once earlier events have been handled; this may
+ * be called from any thread, before or after bcsStart().
+ *
+ * @param bcs
+ * @param address
+ */
+extern void
+bcsAddAddress (BREthereumBCS bcs,
+               BREthereumAddress address);
+
 extern void
 bcsDestroy (BREthereumBCS bcs);
 
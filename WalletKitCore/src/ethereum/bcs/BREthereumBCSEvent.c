@@ -236,6 +236,36 @@ bcsSignalLog (BREthereumBCS bcs,
     eventHandlerSignalEvent(bcs->handler, (BREvent *) &event);
 }
 
+// ==============================================================================================
+//
+// Signal/Handle Add Address
+//
+typedef struct {
+    BREvent base;
+    BREthereumBCS bcs;
+    BREthereumAddress address;
+} BREthereumHandleAddAddressEvent;
+
+static void
+bcsHandleAddAddressDispatcher (BREventHandler ignore,
+                               BREthereumHandleAddAddressEvent *event) {
+    bcsHandleAddAddress (event->bcs, event->address);
+}
+
+static BREventType handleAddAddressEventType = {
+    "BCS: Handle Add Address Event",
+    sizeof (BREthereumHandleAddAddressEvent),
+    (BREventDispatcher) bcsHandleAddAddressDispatcher
+};
+
+extern void
+bcsSignalAddAddress (BREthereumBCS bcs,
+                     BREthereumAddress address) {
+    BREthereumHandleAddAddressEvent event =
+    { { NULL, &handleAddAddressEventType}, bcs, address };
+    eventHandlerSignalEvent (bcs->handler, (BREvent *) &event);
+}
+
 // ==============================================================================================
 //
 // Signal/Handle Peers
@@ -331,6 +361,7 @@ bcsEventTypes[] = {
     &handleProvisionEventType,
     &handleTransactionEventType,
     &handleLogEventType,
+    &handleAddAddressEventType,
     &handleNodesEventType,
     &handleSyncProvisionEventType
 };
@@ -57,6 +57,14 @@ extern "C" {
  */
 #define BCS_SYNC_RESULT_PERIOD  250
 
+/**
+ * A sync pipelines its requests over ranges of blocks.  At most WINDOW ranges will have a LES
+ * request in flight, or have results waiting for earlier ranges, at once.  Thus headers for
+ * later ranges download while BCS validates earlier headers and fetches the bodies and receipts
+ * for their matching blocks.  With a WINDOW of 1 the sync is serial.
+ */
+#define BCS_SYNC_PIPELINE_WINDOW  (4)
+
 /**
  *
  */
@@ -79,21 +87,29 @@ struct BREthereumBCSStruct {
      */
     BREthereumAddress address;
 
+    /**
+     * All addresses of interest, starting with `address`.  In a multi-address BCS the sync,
+     * the transactions and the logs are for any one of `addresses`; the account state is
+     * for `address` alone.
+     */
+    BRArrayOf(BREthereumAddress) addresses;
+
     /**
      * The sync mode
      */
     BRCryptoSyncMode mode;
     
     /**
-     * A BloomFilter with address for application to transactions
+     * The BloomFilter bits, for each of `addresses`, for application to transactions.
      */
-    BREthereumBloomFilter filterForAddressOnTransactions;
+    BRArrayOf(BREthereumBloomFilterBits) bitsForAddressesOnTransactions;
 
     /**
-     * A BloomFilter with address for application to logs.  For logs, the bloom filter is based
-     * on matching `LogTopic` data.
+     * The BloomFilter bits, for each of `addresses`, for application to logs.  For logs, the
+     * bloom filter is based on matching `LogTopic` data.  A logsBloom matches if the bits for any
+     * one address match; a union of the address' filters would only match if every address did.
      */
-    BREthereumBloomFilter filterForAddressOnLogs;
+    BRArrayOf(BREthereumBloomFilterBits) bitsForAddressesOnLogs;
 
     /**
      * The listener interested in BCS events
@@ -195,6 +211,20 @@ struct BREthereumBCSStruct {
     uint64_t accountStateBlockNumber;
     BREthereumAccountState accountState;
 
+    /**
+     * A BRSet of bloom indexes, one for each of `addresses`.  A header for a block that every
+     * index has checked, and that no index matched, needs neither bodies nor receipts.  The
+     * indexes are saved when `updated`.
+     */
+    BRSetOf(BREthereumBloomIndex) bloomIndexes;
+    int bloomIndexesUpdated;
+
+    /**
+     * The largest head block number reported by any node, in a status or an announcement.  Only
+     * blocks at least BCS_REORG_LIMIT below this are added to `bloomIndexes`.
+     */
+    uint64_t headNumber;
+
     /**
      * Sync state
      */
@@ -298,6 +328,17 @@ extern void
 bcsSignalLog (BREthereumBCS bcs,
               BREthereumLog log);
 
+//
+// Add Address
+//
+extern void
+bcsHandleAddAddress (BREthereumBCS bcs,
+                     BREthereumAddress address);
+
+extern void
+bcsSignalAddAddress (BREthereumBCS bcs,
+                     BREthereumAddress address);
+
 //
 // Peers
 //
@@ -351,6 +392,14 @@ bcsSyncCreate (BREthereumBCSSyncContext context,
 extern void
 bcsSyncRelease (BREthereumBCSSync sync);
 
+extern void
+bcsSyncAddAddress (BREthereumBCSSync sync,
+                   BREthereumAddress address);
+
+extern void
+bcsSyncSetPipelineWindow (BREthereumBCSSync sync,
+                          size_t window);
+
 extern BREthereumBoolean
 bcsSyncIsActive (BREthereumBCSSync sync);
 
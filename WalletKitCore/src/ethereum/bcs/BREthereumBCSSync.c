@@ -13,12 +13,6 @@
 #include "BREthereumBCSPrivate.h"
 
 /* Forward Declarations */
-static void
-syncRangeComplete (BREthereumBCSSyncRange child);
-
-static void
-syncRangeDispatch (BREthereumBCSSyncRange range);
-
 static void
 computeOptimalStep (uint64_t numberOfBlocks,
                     uint64_t *optimalStep,
@@ -64,6 +58,22 @@ typedef enum {
     SYNC_RESULT_ACCOUNT
 } BREthereumBCSSyncResultState;
 
+/**
+ * The Sync Range State identifies where a range is in the sync pipeline.  A LINEAR_SMALL or
+ * N_ARY range starts PENDING, until its LES request is dispatched, and is then REQUESTED until
+ * the headers (and, for N_ARY, the account states) are provided.  A N_ARY range is then
+ * EXPLORING its children, as a MIXED or LINEAR_LARGE range is from the start.  A LINEAR_SMALL
+ * range is COMPLETED once its headers are provided; the headers are held until all prior ranges
+ * have been reported.  A range is ABANDONED if the sync stops while its request is in flight.
+ */
+typedef enum {
+    SYNC_RANGE_PENDING,
+    SYNC_RANGE_REQUESTED,
+    SYNC_RANGE_EXPLORING,
+    SYNC_RANGE_COMPLETED,
+    SYNC_RANGE_ABANDONED
+} BREthereumBCSSyncRangeState;
+
 /// MARK: - Sync Range
 
 /**
@@ -86,8 +96,11 @@ typedef void
  */
 struct BREthereumBCSSyncRangeRecord {
 
-    /** Addres of interest */
-    BREthereumAddress address;
+    /**
+     * Addresses of interest.  A range is explored if the account state of any address changes;
+     * the headers are shared by all addresses.
+     */
+    BRArrayOf(BREthereumAddress) addresses;
 
     /** LES for Node interactions */
     BREthereumLES les;
@@ -124,10 +137,14 @@ struct BREthereumBCSSyncRangeRecord {
      */
     uint64_t count;
 
+    /** The state of this range in the sync pipeline */
+    BREthereumBCSSyncRangeState state;
+
     /**
      * The result headers.  Once we get a set of headers, we make/will ask for the account state
      * at each header.  If the account state changed between two headers, we'll need to make
-     * a recusive request for headers - for that request we'll need the header block number.
+     * a recusive request for headers - for that request we'll need the header block number.  For
+     * a LINEAR_SMALL range, these are the headers held until the range is reported.
      */
     BRArrayOf(BREthereumBlockHeader) headers;
 
@@ -170,7 +187,7 @@ syncRangeReport (BREthereumBCSSyncRange range,
  * Create a Sync Range will all the paremeters provided
  */
 static BREthereumBCSSyncRange
-syncRangeCreateDetailed (BREthereumAddress address,
+syncRangeCreateDetailed (BRArrayOf(BREthereumAddress) addresses,
                          BREthereumLES les,
                          BREthereumNodeReference node,
                          BREventHandler handler,
@@ -185,7 +202,8 @@ syncRangeCreateDetailed (BREthereumAddress address,
 
     BREthereumBCSSyncRange range = calloc (1, sizeof (struct BREthereumBCSSyncRangeRecord));
 
-    range->address = address;
+    array_new (range->addresses, array_count (addresses));
+    array_add_array (range->addresses, addresses, array_count (addresses));
     range->les  = les;
     range->node = node;
     range->handler = handler;
@@ -199,6 +217,10 @@ syncRangeCreateDetailed (BREthereumAddress address,
     range->count = (type == SYNC_MIXED ? 0 : count);  // count is unused for SYNC_MIXED
     range->type  = type;
 
+    range->state = (SYNC_LINEAR_SMALL == type || SYNC_N_ARY == type
+                    ? SYNC_RANGE_PENDING
+                    : SYNC_RANGE_EXPLORING);
+
     range->headers = NULL;
 
     range->parent = NULL;
@@ -218,11 +240,36 @@ syncRangeRelease (BREthereumBCSSyncRange range) {
         array_free(range->children);
     }
 
-    // result[].header and result[].account should be gone already.
+    // Headers remain if the sync was stopped before `range` was reported.
+    if (NULL != range->headers) blockHeadersRelease (range->headers);
 
+    array_free (range->addresses);
     free (range);
 }
 
+/**
+ * Abandon `range` and its children.  A range with a LES request in flight can't be released
+ * until the request is provided; it is detached and marked ABANDONED, to be released then.
+ * Every other range is released now.
+ */
+static void
+syncRangeAbandon (BREthereumBCSSyncRange range) {
+    if (NULL != range->children) {
+        for (size_t index = 0; index < array_count(range->children); index++) {
+            range->children[index]->parent = NULL;
+            syncRangeAbandon (range->children[index]);
+        }
+        array_free (range->children);
+        range->children = NULL;
+    }
+
+    if (SYNC_RANGE_REQUESTED == range->state) {
+        range->parent = NULL;
+        range->state  = SYNC_RANGE_ABANDONED;
+    }
+    else syncRangeRelease (range);
+}
+
 /**
  * Return the Event Handler - we use this in BREthereumBCSEvent.c and thereby avoid needing to
  * expose the BREthereumBCSSyncRange and BREthereumBCSSync abstractions.
@@ -280,7 +327,7 @@ syncRangeRemChild (BREthereumBCSSyncRange child) {
 
 /**
  * Create a Sync Range as a child of `parent`.  This is a convenience method to 'inherit' many
- * of the parent's propertyes (address, les, handler).  This method calls
+ * of the parent's propertyes (addresses, les, handler).  This method calls
  * `syncRangeCreateDetailed()` - which isn't always the required way to create a SyncRange.
  */
 static void
@@ -290,7 +337,7 @@ syncRangeCreateAndAddChild (BREthereumBCSSyncRange parent,
                             uint64_t step,
                             uint64_t count,
                             BREthereumBCSSyncType type) {
-    syncRangeAddChild (parent, syncRangeCreateDetailed (parent->address,
+    syncRangeAddChild (parent, syncRangeCreateDetailed (parent->addresses,
                                                         parent->les,
                                                         parent->node,
                                                         parent->handler,
@@ -309,7 +356,7 @@ syncRangeCreateAndAddChild (BREthereumBCSSyncRange parent,
  * `step` and `count` for a 'N_ARY sync') will be optimized.
  */
 static BREthereumBCSSyncRange
-syncRangeCreate (BREthereumAddress address,
+syncRangeCreate (BRArrayOf(BREthereumAddress) addresses,
                  BREthereumLES les,
                  BREthereumNodeReference node,
                  BREventHandler handler,
@@ -336,7 +383,7 @@ syncRangeCreate (BREthereumAddress address,
                 : SYNC_MIXED);       // Not exact, add a LINEAR_SMALL node
     }
 
-    BREthereumBCSSyncRange root = syncRangeCreateDetailed (address, les, node, handler,
+    BREthereumBCSSyncRange root = syncRangeCreateDetailed (addresses, les, node, handler,
                                                            context, callback,
                                                            tail,
                                                            head,
@@ -396,40 +443,24 @@ syncRangeCreate (BREthereumAddress address,
 }
 
 /**
- * Dispatch a Sync Range by a) issuing a LES request and/or b) dispatching any children.
+ * Dispatch a Sync Range by issuing its LES request for headers.  Only a LINEAR_SMALL or a N_ARY
+ * range has a request; the other types are explored through their children.
  */
 static void
 syncRangeDispatch (BREthereumBCSSyncRange range) {
-    if (NULL == range->parent)
-        eth_log ("BCS", "Sync: Start%s", "");
+    assert (SYNC_RANGE_PENDING == range->state);
+    assert (SYNC_LINEAR_SMALL == range->type || SYNC_N_ARY == range->type);
 
     syncRangeReport(range, "Dispatch");
 
-    if (NULL == range->parent)
-        // Callback to announce sync start
-        range->callback (range->context, range, NULL, range->tail);
-
-    switch (range->type) {
-        case SYNC_LINEAR_SMALL:
-        case SYNC_N_ARY:
-            lesProvideBlockHeaders (range->les, range->node,
-                                    (BREthereumLESProvisionContext) range,
-                                    (BREthereumLESProvisionCallback) bcsSyncSignalProvision,
-                                    range->tail,
-                                    (uint32_t) (range->count + 1),  // both endpoints
-                                    range->step - 1,   // skip
-                                    ETHEREUM_BOOLEAN_FALSE);
-            break;
-
-        case SYNC_MIXED:
-        case SYNC_LINEAR_LARGE:
-            assert (NULL != range->children);
-            if (0 == array_count(range->children))
-                syncRangeComplete(range);
-            else
-                syncRangeDispatch(range->children[0]);
-            break;
-    }
+    range->state = SYNC_RANGE_REQUESTED;
+    lesProvideBlockHeaders (range->les, range->node,
+                            (BREthereumLESProvisionContext) range,
+                            (BREthereumLESProvisionCallback) bcsSyncSignalProvision,
+                            range->tail,
+                            (uint32_t) (range->count + 1),  // both endpoints
+                            range->step - 1,   // skip
+                            ETHEREUM_BOOLEAN_FALSE);
 }
 
 /**
@@ -442,45 +473,6 @@ syncRangeGetRoot (BREthereumBCSSyncRange range) {
             : syncRangeGetRoot(range->parent));
 }
 
-/**
- * Complete a Sync Range by a) completing the sync overall if `child` is the root, b) dispatching
- * on any remaining children of parent.
- */
-static void
-syncRangeComplete (BREthereumBCSSyncRange child) {
-    BREthereumBCSSyncRange parent = child->parent;
-
-    syncRangeReport (child, "Complete");
-
-    // If `child` does not have a `parent`, then we are at the top-level and completely complete.
-    if (NULL == parent) {
-        eth_log ("BCS", "Sync: Done%s", "");
-        child->callback (child->context, child, NULL, child->head);
-        return;
-    }
-
-    // If this is a LINEAR_SMALL sync, then report (incremental) progress
-    if (SYNC_LINEAR_SMALL == child->type) {
-        BREthereumBCSSyncRange root = syncRangeGetRoot (child);
-        root->callback (root->context, child, NULL, child->head);
-    }
-
-    // Remove the child from parent.
-    syncRangeRemChild(child);
-
-    // Release child.
-    assert (NULL == child->children || array_count(child->children) == 0);
-    syncRangeRelease(child);
-
-    // If we have children remaining, then dispatch the first one; otherwise ...
-    if (array_count(parent->children) > 0)
-        syncRangeDispatch(parent->children[0]);
-
-    // ... parent is complete.
-    else
-        syncRangeComplete (parent);
-}
-
 /// MARK: - Sync
 
 /**
@@ -488,8 +480,8 @@ syncRangeComplete (BREthereumBCSSyncRange child) {
  * needed.
  */
 struct BREthereumBCSSyncStruct {
-    /** Addres of interest */
-    BREthereumAddress address;
+    /** Addresses of interest.  New syncs will be for all addresses. */
+    BRArrayOf(BREthereumAddress) addresses;
 
     /** LES for Node interactions */
     BREthereumLES les;
@@ -507,6 +499,18 @@ struct BREthereumBCSSyncStruct {
 
     /** Accumulated sync results.  Will be periodically reported with the callback. */
     BRArrayOf(BREthereumBCSSyncResult) results;
+
+    /**
+     * The pipeline window - the maximum number of ranges with a LES request in flight plus
+     * those with results held for reporting.  With a window of `1` the sync is serial.
+     */
+    size_t window;
+
+    /** The number of ranges with a LES request in flight */
+    size_t requested;
+
+    /** The number of completed ranges whose results are held until prior ranges complete */
+    size_t completed;
 };
 
 /**
@@ -521,7 +525,8 @@ bcsSyncCreate (BREthereumBCSSyncContext context,
                BREventHandler handler) {
     BREthereumBCSSync sync = malloc (sizeof(struct BREthereumBCSSyncStruct));
 
-    sync->address = address;
+    array_new (sync->addresses, 1);
+    array_add (sync->addresses, address);
     sync->les = les;
     sync->handler = handler;
 
@@ -534,6 +539,10 @@ bcsSyncCreate (BREthereumBCSSyncContext context,
 
     // Allocate `result` with at most BCS_SYNC_RESULT_PERIOD results.
     array_new (sync->results, BCS_SYNC_RESULT_PERIOD);
+
+    sync->window = BCS_SYNC_PIPELINE_WINDOW;
+    sync->requested = 0;
+    sync->completed = 0;
     return sync;
 }
 
@@ -551,10 +560,35 @@ bcsSyncRelease (BREthereumBCSSync sync) {
         array_free(sync->results);
     }
 
+    array_free (sync->addresses);
+
     memset (sync, 0, sizeof (struct BREthereumBCSSyncStruct));
     free (sync);
 }
 
+/**
+ * Add `address` to the addresses of interest.  A sync in progress continues with the addresses
+ * it started with; subsequent syncs serve all addresses with one set of shared headers.
+ */
+extern void
+bcsSyncAddAddress (BREthereumBCSSync sync,
+                   BREthereumAddress address) {
+    for (size_t index = 0; index < array_count(sync->addresses); index++)
+        if (ETHEREUM_BOOLEAN_IS_TRUE (ethAddressEqual (address, sync->addresses[index])))
+            return;
+
+    array_add (sync->addresses, address);
+}
+
+/**
+ * Set the pipeline window.  Applies to a sync in progress at the next dispatch.
+ */
+extern void
+bcsSyncSetPipelineWindow (BREthereumBCSSync sync,
+                          size_t window) {
+    sync->window = (0 == window ? 1 : window);
+}
+
 /**
  * Return `true` if active; `false` otherwise
  */
@@ -628,6 +662,117 @@ bcsSyncRangeCallback (BREthereumBCSSync sync,
     }
 }
 
+/// MARK: - Sync Pipeline
+
+/**
+ * Dispatch, in block order, the LES requests of PENDING ranges in the tree at `range` until the
+ * pipeline window is full.  The first unfinished range - the one holding up all reports - is
+ * dispatched regardless of the window, lest held results fill the window and stall the sync.
+ * Thus headers for later ranges are downloaded while earlier ranges are reported and their
+ * blocks' bodies and receipts are fetched.
+ */
+static void
+bcsSyncFill (BREthereumBCSSync sync,
+             BREthereumBCSSyncRange range,
+             int *isFirst) {
+    if (!*isFirst && sync->requested + sync->completed >= sync->window) return;
+
+    switch (range->state) {
+        case SYNC_RANGE_PENDING:
+            syncRangeDispatch (range);
+            sync->requested += 1;
+            *isFirst = 0;
+            break;
+
+        case SYNC_RANGE_REQUESTED:
+            *isFirst = 0;
+            break;
+
+        case SYNC_RANGE_EXPLORING:
+            if (NULL != range->children)
+                for (size_t index = 0; index < array_count(range->children); index++)
+                    bcsSyncFill (sync, range->children[index], isFirst);
+            break;
+
+        case SYNC_RANGE_COMPLETED:
+            break;
+
+        case SYNC_RANGE_ABANDONED:
+            assert (0);
+    }
+}
+
+/**
+ * Report, in block order, the ranges in the tree at `range` that have completed and release
+ * them from the tree.  Return `1` if `range` itself is complete; otherwise `0`.  The caller
+ * releases `range`.
+ */
+static int
+bcsSyncDrain (BREthereumBCSSync sync,
+              BREthereumBCSSyncRange range) {
+    BREthereumBCSSyncRange root = syncRangeGetRoot (range);
+
+    switch (range->state) {
+        case SYNC_RANGE_PENDING:
+        case SYNC_RANGE_REQUESTED:
+            return 0;
+
+        case SYNC_RANGE_EXPLORING:
+            // Children complete in order; stop at the first incomplete one.
+            while (NULL != range->children && array_count(range->children) > 0) {
+                BREthereumBCSSyncRange child = range->children[0];
+                if (!bcsSyncDrain (sync, child)) return 0;
+
+                syncRangeReport (child, "Complete");
+                syncRangeRemChild (child);
+                syncRangeRelease (child);
+            }
+            return 1;
+
+        case SYNC_RANGE_COMPLETED:
+            assert (SYNC_LINEAR_SMALL == range->type);
+
+            // TODO: Don't make `count` callback invocations; make one with `count` headers.
+            for (size_t index = 0; index < array_count(range->headers); index++)
+                // `header` is now owned by `root->context`.
+                root->callback (root->context, range, range->headers[index], 0);
+
+            array_free (range->headers);
+            range->headers = NULL;
+            sync->completed -= 1;
+
+            // Report (incremental) progress; the root reports once the sync is done.
+            if (NULL != range->parent)
+                root->callback (root->context, range, NULL, range->head);
+            return 1;
+
+        case SYNC_RANGE_ABANDONED:
+            assert (0);
+            return 0;
+    }
+}
+
+/**
+ * Advance the sync by reporting completed ranges and then dispatching pending ones.  If the
+ * root completes, the sync is done.
+ */
+static void
+bcsSyncAdvance (BREthereumBCSSync sync) {
+    BREthereumBCSSyncRange root = sync->root;
+
+    if (bcsSyncDrain (sync, root)) {
+        assert (0 == sync->requested && 0 == sync->completed);
+        syncRangeReport (root, "Complete");
+        eth_log ("BCS", "Sync: Done%s", "");
+        // Callback to announce sync done; releases `root`.
+        root->callback (root->context, root, NULL, root->head);
+        return;
+    }
+
+    int isFirst = 1;
+    bcsSyncFill (sync, root, &isFirst);
+}
+
 /**
  * Continue a sync for blocks from `chainBlockNumber` to `needBlockNumber`.
  */
@@ -659,7 +804,7 @@ bcsSyncStart (BREthereumBCSSync sync,
 
     // If total is small enough, then syncRangeCreate will produce a LINEAR sync...
     if (total < SYNC_LINEAR_LIMIT)
-        sync->root = syncRangeCreate (sync->address,
+        sync->root = syncRangeCreate (sync->addresses,
                                       sync->les,
                                       node,
                                       sync->handler,
@@ -673,7 +818,7 @@ bcsSyncStart (BREthereumBCSSync sync,
     // will generally be a N_ARY sync, which may itself end with a LINEAR_SMALL sync.  But herein
     // we want a suitable number of headers - so as to build up trust in the blockchain.
     else {
-        sync->root = syncRangeCreateDetailed (sync->address,
+        sync->root = syncRangeCreateDetailed (sync->addresses,
                                               sync->les,
                                               node,
                                               sync->handler,
@@ -690,7 +835,7 @@ bcsSyncStart (BREthereumBCSSync sync,
 
         // Add the first child; it will generally be a N_ARY sync
         syncRangeAddChild (sync->root,
-                           syncRangeCreate (sync->address,
+                           syncRangeCreate (sync->addresses,
                                             sync->les,
                                             node,
                                             sync->handler,
@@ -702,7 +847,7 @@ bcsSyncStart (BREthereumBCSSync sync,
 
         // Add the second child; we've orchastrated this is be a LINEAR sync.
         syncRangeAddChild (sync->root,
-                           syncRangeCreate (sync->address,
+                           syncRangeCreate (sync->addresses,
                                             sync->les,
                                             node,
                                             sync->handler,
@@ -714,7 +859,14 @@ bcsSyncStart (BREthereumBCSSync sync,
     }
 
     // Kick off the new sync.
-    syncRangeDispatch (sync->root);
+    eth_log ("BCS", "Sync: Start%s", "");
+    sync->requested = 0;
+    sync->completed = 0;
+
+    // Callback to announce sync start
+    sync->root->callback (sync->root->context, sync->root, NULL, sync->root->tail);
+
+    bcsSyncAdvance (sync);
 }
 
 extern void
@@ -734,8 +886,12 @@ bcsSyncStopInternal (BREthereumBCSSync sync,
                             sync->root->head,
                             sync->root->head);
 
-    syncRangeRelease(sync->root);
+    // Ranges with requests in flight are released when their requests are provided.
+    syncRangeAbandon (sync->root);
     sync->root = NULL;
+
+    sync->requested = 0;
+    sync->completed = 0;
 }
 
 extern void
@@ -748,7 +904,7 @@ bcsSyncStop (BREthereumBCSSync sync) {
 
 /**
  * Given all block headers then: a) for a N_ARY range, request the account states; or b) for a
- * LINEAR_SMALL range, invoke the callback to report the header results.
+ * LINEAR_SMALL range, hold the header results for reporting in block order.
  */
 static void
 bcsSyncHandleBlockHeaders (BREthereumBCSSyncRange range,
@@ -769,30 +925,52 @@ bcsSyncHandleBlockHeaders (BREthereumBCSSyncRange range,
 
             // Setup a call to lesProvideAccountStates()
             BRArrayOf(BREthereumHash) hashes;
+            BRArrayOf(BREthereumHash) roots;
 
             array_new (hashes, count);
+            array_new (roots,  count);
 
-            for (size_t index = 0; index < count; index++)
-                array_add (hashes,  blockHeaderGetHash (headers[index]));
+            for (size_t index = 0; index < count; index++) {
+                array_add (hashes, blockHeaderGetHash (headers[index]));
+                array_add (roots,  blockHeaderGetStateRoot (headers[index]));
+            }
 
-            lesProvideAccountStates (range->les, node,
-                                     (BREthereumLESProvisionContext) range,
-                                     (BREthereumLESProvisionCallback) bcsSyncSignalProvision,
-                                     range->address,
-                                     hashes);
+            if (1 == array_count (range->addresses))
+                lesProvideAccountStates (range->les, node,
+                                         (BREthereumLESProvisionContext) range,
+                                         (BREthereumLESProvisionCallback) bcsSyncSignalProvision,
+                                         range->addresses[0],
+                                         hashes,
+                                         roots);
+
+            // With multiple addresses, request every address at every header in one provision,
+            // which LES batches into shared `GetProofs` messages.
+            else {
+                BRArrayOf(BREthereumAddress) addresses;
+                array_new (addresses, array_count (range->addresses));
+                array_add_array (addresses, range->addresses, array_count (range->addresses));
+
+                lesProvideAccountStatesMany (range->les, node,
+                                             (BREthereumLESProvisionContext) range,
+                                             (BREthereumLESProvisionCallback) bcsSyncSignalProvision,
+                                             addresses,
+                                             hashes,
+                                             roots);
+            }
             break;
         }
 
         case SYNC_LINEAR_SMALL: {
-            BREthereumBCSSyncRange root = syncRangeGetRoot(range);
+            BREthereumBCSSync sync = (BREthereumBCSSync) syncRangeGetRoot(range)->context;
 
-            // TODO: Don't make `count` callback invocations; make one with `count` headers.
-            for (size_t index = 0; index < count; index++)
-                // `header` is now owned by `root->context`.
-                root->callback (root->context, range, headers[index], 0);
+            // Hold the headers until all prior ranges are reported.
+            range->headers = headers;
+            range->state = SYNC_RANGE_COMPLETED;
+
+            sync->requested -= 1;
+            sync->completed += 1;
 
-            array_free (headers);
-            syncRangeComplete (range);
+            bcsSyncAdvance (sync);
             break;
         }
     }
@@ -800,28 +978,34 @@ bcsSyncHandleBlockHeaders (BREthereumBCSSyncRange range,
 
 /**
  * Given all the accoun states, compare each pair of consecutive accounts and if different create a
- * new subrange as a child to range.  Once all accounts have been compared then dispatch on the
- * first child (if any exist).
+ * new subrange as a child to range.  Once all accounts have been compared then advance the sync
+ * to dispatch the children (if any exist).  With multiple addresses, `states` holds the account state of each
+ * address at each header (ordered by header) and a subrange is created if any address changed.
  */
 static void
 bcsSyncHandleAccountStates (BREthereumBCSSyncRange range,
                             BREthereumNodeReference node,
-                            BREthereumAddress address,
                             OwnershipGiven BRArrayOf(BREthereumHash) hashes,
                             OwnershipGiven BRArrayOf(BREthereumAccountState) states) {
-    size_t count = array_count(states);
+    size_t addressesCount = array_count(range->addresses);
+    size_t count = array_count(hashes);
 
     assert (1 + range->count == count);
-    assert (array_count(hashes) == count);
+    assert (array_count(states) == count * addressesCount);
 
     assert (SYNC_N_ARY == range->type);
 
     for (size_t index = 1; index < count; index++) {
-        BREthereumAccountState oldState = states[index - 1];
-        BREthereumAccountState newState = states[index];
+        BREthereumBoolean changed = ETHEREUM_BOOLEAN_FALSE;
+
+        for (size_t a = 0; a < addressesCount && ETHEREUM_BOOLEAN_IS_FALSE(changed); a++) {
+            BREthereumAccountState oldState = states[(index - 1) * addressesCount + a];
+            BREthereumAccountState newState = states[index * addressesCount + a];
+            changed = AS_ETHEREUM_BOOLEAN (ETHEREUM_BOOLEAN_IS_FALSE(accountStateEqual(oldState, newState)));
+        }
 
         // If we found an AcountState change...
-        if (ETHEREUM_BOOLEAN_IS_FALSE(accountStateEqual(oldState, newState))) {
+        if (ETHEREUM_BOOLEAN_IS_TRUE(changed)) {
             BREthereumBlockHeader oldHeader = range->headers[index - 1];
             BREthereumBlockHeader newHeader = range->headers[index];
 
@@ -832,7 +1016,7 @@ bcsSyncHandleAccountStates (BREthereumBCSSyncRange range,
 
             // ... then we need to explore this header range, recursively.
             syncRangeAddChild (range,
-                               syncRangeCreate (range->address,
+                               syncRangeCreate (range->addresses,
                                                 range->les,
                                                 range->node,
                                                 range->handler,
@@ -843,8 +1027,6 @@ bcsSyncHandleAccountStates (BREthereumBCSSyncRange range,
                                                 SYNC_LINEAR_LIMIT_IF_N_ARY));
         }
     }
-    // TODO: Move this to syncRangeComplete?  Switch on type for N_ARY only?
-
     array_free (hashes);
     array_free (states);
 
@@ -852,14 +1034,13 @@ bcsSyncHandleAccountStates (BREthereumBCSSyncRange range,
     blockHeadersRelease(range->headers);
     range->headers = NULL;
 
-    // If we now have children, dispatch on the first one.  As each one completes, we'll
-    // dispatch on the subsequent ones until this N_ARY range itself completes.
-    if (NULL != range->children && array_count(range->children) > 0)
-        syncRangeDispatch(range->children[0]);
+    // Explore the children, if any; as they complete, this N_ARY range itself completes.
+    BREthereumBCSSync sync = (BREthereumBCSSync) syncRangeGetRoot(range)->context;
+
+    range->state = SYNC_RANGE_EXPLORING;
+    sync->requested -= 1;
 
-    // Otherwise nothing left, completely complete here and now.
-    else
-        syncRangeComplete(range);
+    bcsSyncAdvance (sync);
 }
 
 /**
@@ -919,10 +1100,20 @@ bcsSyncHandleProvision (BREthereumBCSSyncRange range,
                         OwnershipGiven BREthereumProvisionResult result) {
     assert (range->les == les);
 
+    // If the sync stopped while `range` was requested, then `range` is no longer in the sync.
+    if (SYNC_RANGE_ABANDONED == range->state) {
+        syncRangeRelease (range);
+        provisionResultRelease (&result);
+        return;
+    }
+
     BREthereumProvision *provision = &result.provision;
     switch (result.status) {
         case PROVISION_ERROR: {
             BREthereumBCSSyncRange root = syncRangeGetRoot (range);
+
+            // No longer requested; the stop will release `range`.
+            range->state = SYNC_RANGE_PENDING;
             bcsSyncStopInternal((BREthereumBCSSync) root->context, "provision failed");
             break;
         }
@@ -950,7 +1141,6 @@ bcsSyncHandleProvision (BREthereumBCSSyncRange range,
                     BRArrayOf(BREthereumAccountState) accounts;
                     provisionAccountsConsume (&provision->u.accounts, &hashes, &accounts);
                     bcsSyncHandleAccountStates (range, node,
-                                                provision->u.accounts.address,
                                                 hashes,
                                                 accounts);
                     break;
@@ -350,6 +350,28 @@ derivePrivateKeyFromSeed (UInt512 seed, uint32_t index) {
     return privateKey;
 }
 
+extern void
+deriveChainKeyFromSeed (BRBIP32PrivChainKey *chainKey, const UInt512 *seed) {
+    // The BIP32 extended privateKey for m/44'/60'/0'/0, the parent of every address index
+    BRBIP32PrivChainKeyPath(chainKey, seed, sizeof(UInt512), 4,
+                            44 | BIP32_HARD,          // purpose  : BIP-44
+                            60 | BIP32_HARD,          // coin_type: Ethereum
+                            0 | BIP32_HARD,          // account  : <n/a>
+                            0);                       // change   : not change
+}
+
+extern BRKey
+derivePrivateKeyFromChainKey (const BRBIP32PrivChainKey *chainKey, uint32_t index) {
+    BRKey privateKey;
+
+    // The BIP32 privateKey for m/44'/60'/0'/0/index
+    BRBIP32PrivKeyListFromChain (&privateKey, 1, chainKey, &index);
+
+    privateKey.compressed = 0;
+
+    return privateKey;
+}
+
 //
 // New
 //
@@ -13,6 +13,7 @@
 
 #include "support/BRInt.h"
 #include "support/BRKey.h"
+#include "support/BRBIP32Sequence.h"
 #include "ethereum/base/BREthereumBase.h"
 
 #ifdef __cplusplus
@@ -131,6 +132,12 @@ deriveSeedFromPaperKey (const char *paperKey);
 extern BRKey
 derivePrivateKeyFromSeed (UInt512 seed, uint32_t index);
 
+extern void
+deriveChainKeyFromSeed (BRBIP32PrivChainKey *chainKey, const UInt512 *seed);
+
+extern BRKey
+derivePrivateKeyFromChainKey (const BRBIP32PrivChainKey *chainKey, uint32_t index);
+
 
 //
 // New
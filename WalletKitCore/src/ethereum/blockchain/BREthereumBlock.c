@@ -245,6 +245,11 @@ blockHeaderGetParentHash (BREthereumBlockHeader header) {
     return header->parentHash;
 }
 
+extern BREthereumHash
+blockHeaderGetStateRoot (BREthereumBlockHeader header) {
+    return header->stateRoot;
+}
+
 extern uint64_t
 blockHeaderGetNumber (BREthereumBlockHeader header) {
     return header->number;
@@ -315,6 +320,25 @@ blockHeaderMatchAddress (BREthereumBlockHeader header,
      ETHEREUM_BOOLEAN_IS_TRUE (blockHeaderMatch (header, logTopicGetBloomFilterAddress (address))));
 }
 
+extern BREthereumBoolean
+blockHeaderMatchBits (BREthereumBlockHeader header,
+                      const BREthereumBloomFilterBits *bits) {
+    return bloomFilterBitsMatch (bits, &header->logsBloom);
+}
+
+extern size_t
+blockHeadersMatchBits (BRArrayOf(BREthereumBlockHeader) headers,
+                       const BREthereumBloomFilterBits *bits,
+                       BREthereumBoolean *matches) {
+    size_t headersCount = array_count (headers);
+    const BREthereumBloomFilter *filters[headersCount > 0 ? headersCount : 1];
+
+    for (size_t index = 0; index < headersCount; index++)
+        filters[index] = &headers[index]->logsBloom;
+
+    return bloomFilterBitsMatchMany (bits, filters, headersCount, matches);
+}
+
 extern uint64_t
 chtRootNumberGetFromNumber (uint64_t number) {
     assert (0 != number);
@@ -948,14 +972,10 @@ blockTransactionsRlpDecode (BRRlpItem item,
 
     BRArrayOf(BREthereumTransaction) transactions;
     array_new(transactions, itemsCount);
+    array_set_count(transactions, itemsCount);
 
-    for (int i = 0; i < itemsCount; i++) {
-        BREthereumTransaction transaction = transactionRlpDecode(items[i],
-                                                                     network,
-                                                                     type,
-                                                                     coder);
-        array_add (transactions, transaction);
-    }
+    // Decoded together so that the senders of a block body are recovered as one batch
+    transactionRlpDecodeList (transactions, items, itemsCount, network, type, coder);
 
     return transactions;
 }
@@ -118,6 +118,9 @@ blockHeaderGetTimestamp (BREthereumBlockHeader header);
 extern BREthereumHash
 blockHeaderGetParentHash (BREthereumBlockHeader header);
 
+extern BREthereumHash
+blockHeaderGetStateRoot (BREthereumBlockHeader header);
+
 extern BREthereumHash
 blockHeaderGetMixHash (BREthereumBlockHeader header);
 
@@ -137,6 +140,22 @@ extern BREthereumBoolean
 blockHeaderMatchAddress (BREthereumBlockHeader header,
                          BREthereumAddress address);
 
+extern BREthereumBoolean
+blockHeaderMatchBits (BREthereumBlockHeader header,
+                      const BREthereumBloomFilterBits *bits);
+
+/**
+ * Match `bits` against the logsBloom of each of `headers`.  For each match, the corresponding
+ * element of `matches` is set to TRUE; other elements are unchanged.  See
+ * bloomFilterBitsMatchMany().
+ *
+ * @return the number of `headers` matched
+ */
+extern size_t
+blockHeadersMatchBits (BRArrayOf(BREthereumBlockHeader) headers,
+                       const BREthereumBloomFilterBits *bits,
+                       BREthereumBoolean *matches);
+
 // Support BRSet
 extern size_t
 blockHeaderHashValue (const void *h);
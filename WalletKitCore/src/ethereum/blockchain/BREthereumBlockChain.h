@@ -19,5 +19,6 @@
 #include "BREthereumTransactionStatus.h"
 #include "BREthereumTransactionReceipt.h"
 #include "BREthereumBlock.h"
+#include "BREthereumBloomIndex.h"
 
 #endif // BR_Ethereum_Blochchain_h
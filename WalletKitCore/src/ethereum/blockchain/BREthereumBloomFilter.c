@@ -25,6 +25,23 @@ bloomFilterClrBit (BREthereumBloomFilter *filter, unsigned int index);
 static unsigned int
 bloomFilterCreateIndex (uint8_t highByte, uint8_t lowByte);
 
+//
+// Word access.  The filter bytes have no particular alignment; memcpy() lets the compiler use
+// an unaligned load/store.  The words are in native byte order - that is fine as the masks in
+// BloomFilter Bits are extracted with the same order.
+//
+static inline uint64_t
+bloomFilterGetWord (const BREthereumBloomFilter *filter, size_t index) {
+    uint64_t word;
+    memcpy (&word, &filter->bytes[index * sizeof (uint64_t)], sizeof (uint64_t));
+    return word;
+}
+
+static inline void
+bloomFilterSetWord (BREthereumBloomFilter *filter, size_t index, uint64_t word) {
+    memcpy (&filter->bytes[index * sizeof (uint64_t)], &word, sizeof (uint64_t));
+}
+
 //
 // An Empty BloomFilter
 //
@@ -70,16 +87,15 @@ bloomFilterCreateString (const char *string) {
 
 extern BREthereumBloomFilter
 bloomFilterOr (const BREthereumBloomFilter filter1, const BREthereumBloomFilter filter2) {
-    BREthereumBloomFilter result = empty;
-    for (int i = 0; i < ETHEREUM_BLOOM_FILTER_BYTES; i++)
-        result.bytes[i] = filter1.bytes[i] | filter2.bytes[i];
+    BREthereumBloomFilter result = filter1;
+    bloomFilterOrInPlace (&result, &filter2);
     return result;
 }
 
 extern void
-bloomFilterOrInPlace (BREthereumBloomFilter filter1, const BREthereumBloomFilter filter2) {
-    for (int i = 0; i < ETHEREUM_BLOOM_FILTER_BYTES; i++)
-        filter1.bytes[i] |= filter2.bytes[i];
+bloomFilterOrInPlace (BREthereumBloomFilter *filter1, const BREthereumBloomFilter *filter2) {
+    for (size_t i = 0; i < ETHEREUM_BLOOM_FILTER_WORDS; i++)
+        bloomFilterSetWord (filter1, i, bloomFilterGetWord (filter1, i) | bloomFilterGetWord (filter2, i));
 }
 
 extern BREthereumBoolean
@@ -91,7 +107,52 @@ bloomFilterEqual (const BREthereumBloomFilter filter1, const BREthereumBloomFilt
 
 extern BREthereumBoolean
 bloomFilterMatch (const BREthereumBloomFilter filter, const BREthereumBloomFilter other) {
-    return bloomFilterEqual(filter, bloomFilterOr(filter, other));
+    for (size_t i = 0; i < ETHEREUM_BLOOM_FILTER_WORDS; i++) {
+        uint64_t word = bloomFilterGetWord (&other, i);
+        if (word != (word & bloomFilterGetWord (&filter, i)))
+            return ETHEREUM_BOOLEAN_FALSE;
+    }
+    return ETHEREUM_BOOLEAN_TRUE;
+}
+
+//
+// Bloom Filter Bits
+//
+extern BREthereumBloomFilterBits
+bloomFilterBitsCreate (const BREthereumBloomFilter filter) {
+    BREthereumBloomFilterBits bits = { 0 };
+    for (size_t i = 0; i < ETHEREUM_BLOOM_FILTER_WORDS; i++) {
+        uint64_t word = bloomFilterGetWord (&filter, i);
+        if (0 != word) {
+            bits.words[bits.count] = (uint8_t) i;
+            bits.masks[bits.count] = word;
+            bits.count++;
+        }
+    }
+    return bits;
+}
+
+extern BREthereumBoolean
+bloomFilterBitsMatch (const BREthereumBloomFilterBits *bits,
+                      const BREthereumBloomFilter *filter) {
+    for (unsigned int i = 0; i < bits->count; i++)
+        if (bits->masks[i] != (bits->masks[i] & bloomFilterGetWord (filter, bits->words[i])))
+            return ETHEREUM_BOOLEAN_FALSE;
+    return ETHEREUM_BOOLEAN_TRUE;
+}
+
+extern size_t
+bloomFilterBitsMatchMany (const BREthereumBloomFilterBits *bits,
+                          const BREthereumBloomFilter *filters[],
+                          size_t filtersCount,
+                          BREthereumBoolean *matches) {
+    size_t matchesCount = 0;
+    for (size_t index = 0; index < filtersCount; index++)
+        if (ETHEREUM_BOOLEAN_IS_TRUE (bloomFilterBitsMatch (bits, filters[index]))) {
+            matches[index] = ETHEREUM_BOOLEAN_TRUE;
+            matchesCount++;
+        }
+    return matchesCount;
 }
 
 //
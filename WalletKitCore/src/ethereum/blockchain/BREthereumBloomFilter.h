@@ -19,6 +19,7 @@ extern "C" {
 
 #define ETHEREUM_BLOOM_FILTER_BITS 2048
 #define ETHEREUM_BLOOM_FILTER_BYTES   (ETHEREUM_BLOOM_FILTER_BITS / 8)
+#define ETHEREUM_BLOOM_FILTER_WORDS   (ETHEREUM_BLOOM_FILTER_BYTES / sizeof (uint64_t))
 
 /**
  * An Etereum Bloom Filter is a 2048-bit 'fuzzy' representation of one or more addresses.
@@ -79,8 +80,11 @@ bloomFilterCreateString (const char *string);
 extern BREthereumBloomFilter
 bloomFilterOr (const BREthereumBloomFilter filter1, const BREthereumBloomFilter filter2);
 
+/**
+ * Or `filter2` into `filter1`.
+ */
 extern void
-bloomFilterOrInPlace (BREthereumBloomFilter filter1, const BREthereumBloomFilter filter2);
+bloomFilterOrInPlace (BREthereumBloomFilter *filter1, const BREthereumBloomFilter *filter2);
 
 extern BREthereumBoolean
 bloomFilterEqual (const BREthereumBloomFilter filter1, const BREthereumBloomFilter filter2);
@@ -99,6 +103,44 @@ bloomFilterEqual (const BREthereumBloomFilter filter1, const BREthereumBloomFilt
 extern BREthereumBoolean
 bloomFilterMatch (const BREthereumBloomFilter filter, const BREthereumBloomFilter other);
 
+/// MARK: - Bloom Filter Bits
+
+/**
+ * The Bits of a BloomFilter are the filter's non-zero 64-bit words.  A filter created from
+ * a hash (an address or a log topic) has at most three non-zero words; matching with the bits
+ * checks only those words rather than every byte of the filter.  Create the bits once, for
+ * each address or topic of interest, and then match them against many block header filters.
+ */
+typedef struct {
+    unsigned int count;
+    uint8_t  words[ETHEREUM_BLOOM_FILTER_WORDS];
+    uint64_t masks[ETHEREUM_BLOOM_FILTER_WORDS];
+} BREthereumBloomFilterBits;
+
+extern BREthereumBloomFilterBits
+bloomFilterBitsCreate (const BREthereumBloomFilter filter);
+
+/**
+ * Check if `bits` are contained in `filter`.  Identical to bloomFilterMatch() with the filter
+ * from which `bits` was created.
+ */
+extern BREthereumBoolean
+bloomFilterBitsMatch (const BREthereumBloomFilterBits *bits,
+                      const BREthereumBloomFilter *filter);
+
+/**
+ * Check if `bits` are contained in each of `filters`.  For each match, the corresponding element
+ * of `matches` is set to TRUE; other elements are unchanged - thus matches for different `bits`
+ * accumulate.
+ *
+ * @return the number of `filters` matched
+ */
+extern size_t
+bloomFilterBitsMatchMany (const BREthereumBloomFilterBits *bits,
+                          const BREthereumBloomFilter *filters[],
+                          size_t filtersCount,
+                          BREthereumBoolean *matches);
+
 extern BRRlpItem
 bloomFilterRlpEncode(BREthereumBloomFilter filter, BRRlpCoder coder);
 
@@ -0,0 +1,268 @@
+//
+//  BREthereumBloomIndex.c
+//  BRCore
+//
+//  Copyright © 2020 Breadwinner AG.  All rights reserved.
+//
+//  See the LICENSE file at the project root for license information.
+//  See the CONTRIBUTORS file at the project root for a list of contributors.
+
+#include <stdlib.h>
+#include <assert.h>
+#include "support/BRArray.h"
+#include "BREthereumLog.h"
+#include "BREthereumBloomIndex.h"
+
+/**
+ * A range of checked block numbers, inclusive of `tail` and `head`.
+ */
+typedef struct {
+    uint64_t tail;
+    uint64_t head;
+} BREthereumBloomIndexRange;
+
+struct BREthereumBloomIndexRecord {
+    /** The address.  Must be first so that a BRSet can be searched with an address. */
+    BREthereumAddress address;
+
+    /** The logsBloom filter bits for `address` - not persisted */
+    BREthereumBloomFilterBits bits;
+
+    /** The checked ranges, ordered, disjoint and non-adjacent */
+    BRArrayOf(BREthereumBloomIndexRange) ranges;
+
+    /** The matching block numbers, ordered */
+    BRArrayOf(uint64_t) matches;
+};
+
+extern BREthereumBloomIndex
+bloomIndexCreate (BREthereumAddress address) {
+    BREthereumBloomIndex index = calloc (1, sizeof (struct BREthereumBloomIndexRecord));
+
+    index->address = address;
+    index->bits    = bloomFilterBitsCreate (logTopicGetBloomFilterAddress (address));
+
+    array_new (index->ranges,  10);
+    array_new (index->matches, 10);
+
+    return index;
+}
+
+extern void
+bloomIndexRelease (BREthereumBloomIndex index) {
+    array_free (index->ranges);
+    array_free (index->matches);
+    free (index);
+}
+
+extern BREthereumAddress
+bloomIndexGetAddress (BREthereumBloomIndex index) {
+    return index->address;
+}
+
+extern BREthereumHash
+bloomIndexGetHash (BREthereumBloomIndex index) {
+    return ethAddressGetHash (index->address);
+}
+
+extern BREthereumBoolean
+bloomIndexMatchesHeader (BREthereumBloomIndex index,
+                         BREthereumBlockHeader header) {
+    return blockHeaderMatchBits (header, &index->bits);
+}
+
+/**
+ * Find the index of the first range with a `tail` greater than `number`.  The range preceeding
+ * that index, if any, is the only one that might contain `number`.
+ */
+static size_t
+bloomIndexFindRange (BREthereumBloomIndex index,
+                     uint64_t number) {
+    size_t lo = 0, hi = array_count (index->ranges);
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (index->ranges[mid].tail <= number) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * Find the index of the first match not less than `number`.
+ */
+static size_t
+bloomIndexFindMatch (BREthereumBloomIndex index,
+                     uint64_t number) {
+    size_t lo = 0, hi = array_count (index->matches);
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (index->matches[mid] < number) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static void
+bloomIndexAddChecked (BREthereumBloomIndex index,
+                      uint64_t number) {
+    size_t next = bloomIndexFindRange (index, number);
+
+    BREthereumBloomIndexRange *prevRange = (next > 0 ? &index->ranges[next - 1] : NULL);
+    BREthereumBloomIndexRange *nextRange = (next < array_count (index->ranges) ? &index->ranges[next] : NULL);
+
+    // Already checked
+    if (NULL != prevRange && number <= prevRange->head) return;
+
+    int extendsPrev = (NULL != prevRange && prevRange->head + 1 == number);
+    int extendsNext = (NULL != nextRange && number + 1 == nextRange->tail);
+
+    if (extendsPrev && extendsNext) {
+        // `number` fills the gap between two ranges; join them.
+        prevRange->head = nextRange->head;
+        array_rm (index->ranges, next);
+    }
+    else if (extendsPrev) prevRange->head = number;
+    else if (extendsNext) nextRange->tail = number;
+    else {
+        BREthereumBloomIndexRange range = { number, number };
+        array_insert (index->ranges, next, range);
+    }
+}
+
+extern void
+bloomIndexAddBlock (BREthereumBloomIndex index,
+                    uint64_t number,
+                    BREthereumBoolean matched) {
+    bloomIndexAddChecked (index, number);
+
+    if (ETHEREUM_BOOLEAN_IS_TRUE (matched)) {
+        size_t position = bloomIndexFindMatch (index, number);
+        if (position == array_count (index->matches) || number != index->matches[position])
+            array_insert (index->matches, position, number);
+    }
+}
+
+extern BREthereumBoolean
+bloomIndexHasChecked (BREthereumBloomIndex index,
+                      uint64_t number) {
+    size_t next = bloomIndexFindRange (index, number);
+    return AS_ETHEREUM_BOOLEAN (next > 0 && number <= index->ranges[next - 1].head);
+}
+
+extern BREthereumBoolean
+bloomIndexHasMatch (BREthereumBloomIndex index,
+                    uint64_t number) {
+    size_t position = bloomIndexFindMatch (index, number);
+    return AS_ETHEREUM_BOOLEAN (position < array_count (index->matches) &&
+                                number == index->matches[position]);
+}
+
+extern uint64_t
+bloomIndexGetCheckedCount (BREthereumBloomIndex index) {
+    uint64_t count = 0;
+    for (size_t i = 0; i < array_count (index->ranges); i++)
+        count += 1 + index->ranges[i].head - index->ranges[i].tail;
+    return count;
+}
+
+extern size_t
+bloomIndexGetMatchCount (BREthereumBloomIndex index) {
+    return array_count (index->matches);
+}
+
+/// MARK: - RLP Encode/Decode
+
+//
+// The ranges and the matches are both ordered; we encode each number as the difference from the
+// prior one so that the RLP encoding of the (generally) small differences is compact.
+//
+static BRRlpItem
+bloomIndexRlpEncodeNumbers (BRRlpCoder coder,
+                            const uint64_t *numbers,
+                            size_t numbersCount) {
+    // The index grows without bound; keep its items off the stack.
+    BRRlpItem *items = calloc (numbersCount > 0 ? numbersCount : 1, sizeof (BRRlpItem));
+
+    uint64_t prior = 0;
+    for (size_t i = 0; i < numbersCount; i++) {
+        assert (numbers[i] >= prior);
+        items[i] = rlpEncodeUInt64 (coder, numbers[i] - prior, 1);
+        prior = numbers[i];
+    }
+
+    BRRlpItem item = rlpEncodeListItems (coder, items, numbersCount);
+    free (items);
+    return item;
+}
+
+static BRArrayOf(uint64_t)
+bloomIndexRlpDecodeNumbers (BRRlpCoder coder,
+                            BRRlpItem item) {
+    size_t itemsCount = 0;
+    const BRRlpItem *items = rlpDecodeList (coder, item, &itemsCount);
+
+    BRArrayOf(uint64_t) numbers;
+    array_new (numbers, (itemsCount > 0 ? itemsCount : 10));
+
+    uint64_t prior = 0;
+    for (size_t i = 0; i < itemsCount; i++) {
+        prior += rlpDecodeUInt64 (coder, items[i], 1);
+        array_add (numbers, prior);
+    }
+
+    return numbers;
+}
+
+extern BRRlpItem
+bloomIndexRlpEncode (BREthereumBloomIndex index,
+                     BRRlpCoder coder) {
+    assert (sizeof (BREthereumBloomIndexRange) == 2 * sizeof (uint64_t));
+
+    return rlpEncodeList (coder, 3,
+                          ethAddressRlpEncode (index->address, coder),
+                          bloomIndexRlpEncodeNumbers (coder,
+                                                      (const uint64_t *) index->ranges,
+                                                      2 * array_count (index->ranges)),
+                          bloomIndexRlpEncodeNumbers (coder,
+                                                      index->matches,
+                                                      array_count (index->matches)));
+}
+
+extern BREthereumBloomIndex
+bloomIndexRlpDecode (BRRlpItem item,
+                     BRRlpCoder coder) {
+    size_t itemsCount = 0;
+    const BRRlpItem *items = rlpDecodeList (coder, item, &itemsCount);
+    assert (3 == itemsCount);
+
+    BREthereumBloomIndex index = bloomIndexCreate (ethAddressRlpDecode (items[0], coder));
+
+    BRArrayOf(uint64_t) ranges = bloomIndexRlpDecodeNumbers (coder, items[1]);
+    assert (0 == array_count (ranges) % 2);
+
+    for (size_t i = 0; i + 1 < array_count (ranges); i += 2) {
+        BREthereumBloomIndexRange range = { ranges[i], ranges[i + 1] };
+        array_add (index->ranges, range);
+    }
+    array_free (ranges);
+
+    array_free (index->matches);
+    index->matches = bloomIndexRlpDecodeNumbers (coder, items[2]);
+
+    return index;
+}
+
+// Support BRSet
+extern size_t
+bloomIndexHashValue (const void *index) {
+    return ethAddressHashValue (((BREthereumBloomIndex) index)->address);
+}
+
+// Support BRSet
+extern int
+bloomIndexHashEqual (const void *index1,
+                     const void *index2) {
+    return (index1 == index2 ||
+            ethAddressHashEqual (((BREthereumBloomIndex) index1)->address,
+                                 ((BREthereumBloomIndex) index2)->address));
+}
@@ -0,0 +1,97 @@
+//
+//  BREthereumBloomIndex.h
+//  BRCore
+//
+//  Copyright © 2020 Breadwinner AG.  All rights reserved.
+//
+//  See the LICENSE file at the project root for license information.
+//  See the CONTRIBUTORS file at the project root for a list of contributors.
+
+#ifndef BR_Ethereum_Bloom_Index_h
+#define BR_Ethereum_Bloom_Index_h
+
+#include "BREthereumBlock.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A Bloom Index records, for one address, the block numbers that have been checked for the
+ * address and, of those, the block numbers that matched.  A block is checked once its header's
+ * logsBloom has been matched against the address and its body searched for transactions with
+ * the address; a block matches if either found the address.  Once checked, the answer never
+ * changes - so a subsequent sync over checked blocks need only fetch bodies, receipts and proofs
+ * for the matching blocks.
+ *
+ * The checked block numbers are held as ordered, disjoint ranges; the matching block numbers
+ * are held in order.  Both are compact enough to persist.
+ */
+typedef struct BREthereumBloomIndexRecord *BREthereumBloomIndex;
+
+extern BREthereumBloomIndex
+bloomIndexCreate (BREthereumAddress address);
+
+extern void
+bloomIndexRelease (BREthereumBloomIndex index);
+
+extern BREthereumAddress
+bloomIndexGetAddress (BREthereumBloomIndex index);
+
+extern BREthereumHash
+bloomIndexGetHash (BREthereumBloomIndex index);
+
+/**
+ * Check if the logsBloom in `header` matches the address.
+ */
+extern BREthereumBoolean
+bloomIndexMatchesHeader (BREthereumBloomIndex index,
+                         BREthereumBlockHeader header);
+
+/**
+ * Record `number` as checked and, if `matched`, as matching.
+ */
+extern void
+bloomIndexAddBlock (BREthereumBloomIndex index,
+                    uint64_t number,
+                    BREthereumBoolean matched);
+
+extern BREthereumBoolean
+bloomIndexHasChecked (BREthereumBloomIndex index,
+                      uint64_t number);
+
+extern BREthereumBoolean
+bloomIndexHasMatch (BREthereumBloomIndex index,
+                    uint64_t number);
+
+/**
+ * The count of checked blocks and the count of matching blocks.
+ */
+extern uint64_t
+bloomIndexGetCheckedCount (BREthereumBloomIndex index);
+
+extern size_t
+bloomIndexGetMatchCount (BREthereumBloomIndex index);
+
+extern BRRlpItem
+bloomIndexRlpEncode (BREthereumBloomIndex index,
+                     BRRlpCoder coder);
+
+extern BREthereumBloomIndex
+bloomIndexRlpDecode (BRRlpItem item,
+                     BRRlpCoder coder);
+
+// Support BRSet
+extern size_t
+bloomIndexHashValue (const void *index);
+
+// Support BRSet
+extern int
+bloomIndexHashEqual (const void *index1,
+                     const void *index2);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BR_Ethereum_Bloom_Index_h */
@@ -329,6 +329,54 @@ transactionExtractAddress(BREthereumTransaction transaction,
     return address;
 }
 
+extern void
+transactionExtractAddressList (BREthereumAddress addresses[],
+                               BREthereumTransaction transactions[],
+                               size_t count,
+                               BREthereumNetwork network,
+                               BRRlpCoder coder) {
+    // Zeroed, so that nothing past `signedCount` is ever read uninitialized
+    size_t *signedIndexes = calloc (count, sizeof (size_t));
+    BREthereumSignature *signatures = calloc (count, sizeof (BREthereumSignature));
+    BRRlpData *data = calloc (count, sizeof (BRRlpData));
+    const uint8_t **bytes = calloc (count, sizeof (uint8_t *));
+    size_t *bytesCount = calloc (count, sizeof (size_t));
+    BREthereumAddress *signedAddresses = calloc (count, sizeof (BREthereumAddress));
+    int *success = calloc (count, sizeof (int));
+    size_t signedCount = 0;
+
+    // Encoding uses `coder` and stays on this thread; only the recovery is spread out.
+    for (size_t index = 0; index < count; index++) {
+        addresses[index] = (BREthereumAddress) EMPTY_ADDRESS_INIT;
+        if (ETHEREUM_BOOLEAN_IS_FALSE (transactionIsSigned (transactions[index]))) continue;
+
+        BRRlpItem item = transactionRlpEncode (transactions[index], network, RLP_TYPE_TRANSACTION_UNSIGNED, coder);
+        data[signedCount] = rlpItemGetData (coder, item);
+        rlpItemRelease (coder, item);
+
+        signedIndexes[signedCount] = index;
+        signatures[signedCount] = transactions[index]->signature;
+        bytes[signedCount]      = data[signedCount].bytes;
+        bytesCount[signedCount] = data[signedCount].bytesCount;
+        signedCount++;
+    }
+
+    ethSignatureExtractAddressList (signedAddresses, success, signatures, bytes, bytesCount, signedCount);
+
+    for (size_t signedIndex = 0; signedIndex < signedCount; signedIndex++) {
+        addresses[signedIndexes[signedIndex]] = signedAddresses[signedIndex];
+        rlpDataRelease (data[signedIndex]);
+    }
+
+    free (success);
+    free (signedAddresses);
+    free (bytesCount);
+    free (bytes);
+    free (data);
+    free (signatures);
+    free (signedIndexes);
+}
+
 //
 // Tranaction RLP Encode
 //
@@ -405,11 +453,12 @@ transactionRlpEncode(BREthereumTransaction transaction,
 //
 // Tranaction RLP Decode
 //
-extern BREthereumTransaction
-transactionRlpDecode (BRRlpItem item,
-                      BREthereumNetwork network,
-                      BREthereumRlpType type,
-                      BRRlpCoder coder) {
+static BREthereumTransaction
+transactionRlpDecodeInternal (BRRlpItem item,
+                              BREthereumNetwork network,
+                              BREthereumRlpType type,
+                              BRRlpCoder coder,
+                              int extractAddress) {
     
     BREthereumTransaction transaction = calloc (1, sizeof(struct BREthereumTransactionRecord));
     
@@ -478,7 +527,8 @@ transactionRlpDecode (BRRlpItem item,
             transaction->hash = ethHashCreateFromData(result);
 
             // :fingers-crossed:
-            transaction->sourceAddress = transactionExtractAddress (transaction, network, coder);
+            if (extractAddress)
+                transaction->sourceAddress = transactionExtractAddress (transaction, network, coder);
             break;
         }
 
@@ -491,6 +541,36 @@ transactionRlpDecode (BRRlpItem item,
     return transaction;
 }
 
+extern BREthereumTransaction
+transactionRlpDecode (BRRlpItem item,
+                      BREthereumNetwork network,
+                      BREthereumRlpType type,
+                      BRRlpCoder coder) {
+    return transactionRlpDecodeInternal (item, network, type, coder, 1);
+}
+
+extern void
+transactionRlpDecodeList (BREthereumTransaction transactions[],
+                          const BRRlpItem items[],
+                          size_t count,
+                          BREthereumNetwork network,
+                          BREthereumRlpType type,
+                          BRRlpCoder coder) {
+    // Signed transactions have their source address recovered as one batch, below.
+    for (size_t index = 0; index < count; index++)
+        transactions[index] = transactionRlpDecodeInternal (items[index], network, type, coder, 0);
+
+    if (RLP_TYPE_TRANSACTION_SIGNED == type && count > 0) {
+        BREthereumAddress *addresses = malloc (count * sizeof (BREthereumAddress));
+        transactionExtractAddressList (addresses, transactions, count, network, coder);
+
+        for (size_t index = 0; index < count; index++)
+            transactions[index]->sourceAddress = addresses[index];
+
+        free (addresses);
+    }
+}
+
 extern BRRlpData
 transactionGetRlpData (BREthereumTransaction transaction,
                        BREthereumNetwork network,
@@ -175,6 +175,18 @@ extern BREthereumAddress
 transactionExtractAddress(BREthereumTransaction transaction,
                           BREthereumNetwork network,
                           BRRlpCoder coder);
+
+/**
+ * Extract the signer's address of each of `count` transactions into `addresses`.  The
+ * recoveries are independent and only spread across cores, as ethSignatureExtractAddressList()
+ * describes.  If a transaction is not signed, an empty address is returned.
+ */
+extern void
+transactionExtractAddressList (BREthereumAddress addresses[],
+                               BREthereumTransaction transactions[],
+                               size_t count,
+                               BREthereumNetwork network,
+                               BRRlpCoder coder);
 //
 // Transaction RLP Encoding
 //
@@ -184,6 +196,18 @@ transactionRlpDecode (BRRlpItem item,
                       BREthereumRlpType type,
                       BRRlpCoder coder);
 
+/**
+ * Decode `count` transactions from `items` into `transactions`.  For RLP_TYPE_TRANSACTION_SIGNED
+ * the source addresses are extracted together with transactionExtractAddressList().
+ */
+extern void
+transactionRlpDecodeList (BREthereumTransaction transactions[],
+                          const BRRlpItem items[],
+                          size_t count,
+                          BREthereumNetwork network,
+                          BREthereumRlpType type,
+                          BRRlpCoder coder);
+
 /**
  * RLP encode transaction for the provided network with the specified type.  Different networks
  * have different RLP encodings - notably the network's chainId is part of the encoding.
@@ -71,6 +71,12 @@ transactionReceiptMatch (BREthereumTransactionReceipt receipt,
     return bloomFilterMatch(receipt->bloomFilter, filter);
 }
 
+extern BREthereumBoolean
+transactionReceiptMatchBits (BREthereumTransactionReceipt receipt,
+                             const BREthereumBloomFilterBits *bits) {
+    return bloomFilterBitsMatch (bits, &receipt->bloomFilter);
+}
+
 extern BREthereumBoolean
 transactionReceiptMatchAddress (BREthereumTransactionReceipt receipt,
                                 BREthereumAddress address) {
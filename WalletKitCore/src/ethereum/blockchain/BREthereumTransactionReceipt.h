@@ -46,6 +46,10 @@ extern BREthereumBoolean
 transactionReceiptMatch (BREthereumTransactionReceipt receipt,
                          BREthereumBloomFilter filter);
 
+extern BREthereumBoolean
+transactionReceiptMatchBits (BREthereumTransactionReceipt receipt,
+                             const BREthereumBloomFilterBits *bits);
+
 extern BREthereumBoolean
 transactionReceiptMatchAddress (BREthereumTransactionReceipt receipt,
                                 BREthereumAddress address);
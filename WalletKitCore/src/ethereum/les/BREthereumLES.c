@@ -90,6 +90,13 @@ static inline int minimum (int a, int b) { return a < b ? a : b; }
 
 #define LES_PREFERRED_NODE_INDEX     0
 
+// A node won't be given more parts, of a join, once it has this many messages worth of requests
+// pending.  Keeps parts for nodes that free up first.
+#define LES_NODE_PENDING_PARTS       2
+
+// The throughput, in requests per second, assumed for a node that has yet to provide any.
+#define LES_NODE_THROUGHPUT_DEFAULT  (100.0)
+
 // Iterate over LES nodes...
 #define FOR_SET(type,var,set) \
   for (type var = BRSetIterate(set, NULL); \
@@ -124,6 +131,9 @@ struct BREthereumNodeConfigRecord {
 
     /** the priority */
     BREthereumNodePriority priority;
+
+    /** the quality */
+    BRPeerQuality quality;
 };
 
 extern void
@@ -139,11 +149,15 @@ nodeConfigGetHash (BREthereumNodeConfig config) {
 extern BRRlpItem
 nodeConfigEncode (BREthereumNodeConfig config,
                      BRRlpCoder coder) {
-    return rlpEncodeList (coder, 4,
+    uint8_t qualityBytes[BR_PEER_QUALITY_SERIALIZED_SIZE];
+    BRPeerQualitySerialize (&config->quality, qualityBytes, sizeof (qualityBytes));
+
+    return rlpEncodeList (coder, 5,
                           rlpEncodeBytes(coder, config->key.pubKey, 65),
                           endpointDISEncode(&config->endpoint, coder),
                           nodeStateEncode(&config->state, coder),
-                          rlpEncodeUInt64(coder, config->priority, 0));
+                          rlpEncodeUInt64(coder, config->priority, 0),
+                          rlpEncodeBytes(coder, qualityBytes, sizeof (qualityBytes)));
 }
 
 extern BREthereumNodeConfig
@@ -153,7 +167,8 @@ nodeConfigDecode (BRRlpItem item,
 
     size_t itemsCount = 0;
     const BRRlpItem *items = rlpDecodeList (coder, item, &itemsCount);
-    assert (4 == itemsCount);
+    // A config saved before node qualities were recorded has no quality.
+    assert (4 == itemsCount || 5 == itemsCount);
 
     BRRlpData keyData = rlpDecodeBytesSharedDontRelease (coder, items[0]);
     BRKeySetPubKey(&config->key, keyData.bytes, keyData.bytesCount);
@@ -162,6 +177,12 @@ nodeConfigDecode (BRRlpItem item,
     config->state    = nodeStateDecode (items[2], coder);
     config->priority = (BREthereumNodePriority) rlpDecodeUInt64(coder, items[3], 0);
 
+    if (5 == itemsCount) {
+        BRRlpData qualityData = rlpDecodeBytesSharedDontRelease (coder, items[4]);
+        config->quality = BRPeerQualityParse (qualityData.bytes, qualityData.bytesCount);
+    }
+    else config->quality = BR_PEER_QUALITY_NONE;
+
     config->hash = ethHashCreateFromData((BRRlpData) { 64, &config->key.pubKey[1] });
 
     return config;
@@ -177,6 +198,7 @@ nodeConfigCreate (BREthereumNode node) {
     config->endpoint = nodeEndpointGetDISNeighbor(ne).node;
     config->state = nodeGetState(node, NODE_ROUTE_TCP);
     config->priority = nodeGetPriority (node);
+    config->quality = nodeGetQuality (node);
 
     config->hash = ethHashCreateFromData((BRRlpData) { 64, &config->key.pubKey[1] });
 
@@ -252,6 +274,13 @@ typedef struct {
      */
     BREthereumNode node;
 
+    /**
+     * If this request is a part of a join, the join's identifier and the offset of this request's
+     * provision in the join's provision; otherwise PROVISION_IDENTIFIER_UNDEFINED.
+     */
+    BREthereumProvisionIdentifier joinIdentifier;
+    size_t joinOffset;
+
 } BREthereumLESRequest;
 
 static void
@@ -272,6 +301,45 @@ requestsRelease (OwnershipGiven BRArrayOf(BREthereumLESRequest) requests) {
     }
 }
 
+/**
+ * A LES Join is a request with a large provision - of headers, proofs, bodies or receipts - that
+ * we split into parts.  Each part is a LES Request, sized to the credits its node has available,
+ * and the parts are spread over the active nodes.  As parts are provided their results are joined
+ * into the join's provision; once all are joined, we'll invoke the `callback`.
+ */
+typedef struct {
+    BREthereumLESProvisionContext context;
+    BREthereumLESProvisionCallback callback;
+
+    /** The provision, holding the joined results */
+    BREthereumProvision provision;
+
+    /** The node for every part; if NODE_REFERENCE_ANY, we'll select a node for each part */
+    BREthereumNodeReference nodeReference;
+
+    /** The count of `provision` requests */
+    size_t count;
+
+    /** The offset of the first request not yet split off into a part */
+    size_t offset;
+
+    /** The count of parts split off but not yet joined */
+    size_t partsCount;
+
+    /** The node that provided the most recently joined part */
+    BREthereumNode node;
+
+} BREthereumLESJoin;
+
+static void
+joinsRelease (OwnershipGiven BRArrayOf(BREthereumLESJoin) joins) {
+    if (NULL != joins) {
+        for (size_t index = 0; index < array_count(joins); index++)
+            provisionRelease (&joins[index].provision, ETHEREUM_BOOLEAN_TRUE);
+        array_free (joins);
+    }
+}
+
 /// MARK: - LES
 
 /**
@@ -332,6 +400,9 @@ struct BREthereumLESRecord {
     /** Requests - pending, have not been provisioned to a node */
     BRArrayOf (BREthereumLESRequest) requests;
 
+    /** Joins - requests being split into parts; the parts are in `requests` */
+    BRArrayOf (BREthereumLESJoin) joins;
+
     /** Unique request identifier */
     BREthereumProvisionIdentifier requestsIdentifier;
 
@@ -385,6 +456,7 @@ lesEnsureNodeForEndpoint (BREthereumLES les,
                           OwnershipGiven BREthereumNodeEndpoint endpoint,
                           BREthereumNodeState state,
                           BREthereumNodePriority priority,
+                          BRPeerQuality quality,
                           BREthereumBoolean *added) {
 
     // Skip out if given an invalid endpoint
@@ -417,6 +489,7 @@ lesEnsureNodeForEndpoint (BREthereumLES les,
                            (BREthereumNodeCallbackNeighbor) lesHandleNeighbor,
                            les->handleSync);
         nodeSetStateInitial (node, NODE_ROUTE_TCP, state);
+        nodeSetQuality (node, quality);
 
         // ... add it to 'all nodes'
         BRSetAdd(les->nodes, node);
@@ -493,6 +566,7 @@ lesSeedQuery (BREthereumLESSeedContext *context) {
                                      nodeEndpointCreateEnode(enode),
                                      (BREthereumNodeState) { NODE_AVAILABLE },
                                      context->priority,
+                                     BR_PEER_QUALITY_NONE,
                                      &added);
             if (ETHEREUM_BOOLEAN_IS_TRUE(added))
                 context->added += 1;
@@ -612,6 +686,7 @@ lesCreate (BREthereumNetwork network,
     // Initialize requests
     les->requestsIdentifier = 0;
     array_new (les->requests, LES_REQUESTS_INITIAL_SIZE);
+    array_new (les->joins, LES_REQUESTS_INITIAL_SIZE);
 
     // The Set of all known nodes.
     les->nodes = BRSetNew (nodeHashValue,
@@ -640,6 +715,7 @@ lesCreate (BREthereumNetwork network,
                                           nodeConfigCreateEndpoint (config),
                                           nodeGetPreferredState (config->state),
                                           config->priority,
+                                          config->quality,
                                           NULL);
 #endif // !defined(LES_BOOTSTRAP_LCL_ONLY)
 
@@ -695,9 +771,13 @@ lesRelease(BREthereumLES les) {
     nodeEndpointRelease (les->localEndpoint);
 
     requestsRelease(les->requests);
+    joinsRelease(les->joins);
 
     rlpCoderRelease(les->coder);
 
+    // Drop the verified MPT nodes; with LES released, its proofs won't be revisited.
+    mptNodeCacheClear ();
+
     // requests, requestsToSend
 
     // TODO: NodeEnpdoint Release (to release 'hello' and 'status' messages
@@ -853,6 +933,97 @@ lesHandleAnnounce (BREthereumLES les,
 }
 
 
+/**
+ * Find the index of the join with `identifier`; return -1 if the join no longer exists.
+ */
+static ssize_t
+lesFindJoin (BREthereumLES les,
+             BREthereumProvisionIdentifier identifier) {
+    for (ssize_t index = 0; index < array_count (les->joins); index++)
+        if (identifier == les->joins[index].provision.identifier)
+            return index;
+    return -1;
+}
+
+/**
+ * Remove the join at `joinIndex` and invoke its callback with `status`.  On an error, any results
+ * already joined are released and the callback gets the join's provision to, perhaps, retry.
+ */
+static void
+lesFinishJoin (BREthereumLES les,
+               size_t joinIndex,
+               BREthereumProvisionStatus status,
+               BREthereumProvisionErrorReason reason) {
+    BREthereumLESJoin join = les->joins[joinIndex];
+    array_rm (les->joins, joinIndex);
+
+    if (PROVISION_ERROR == status)
+        provisionReleaseResults (&join.provision);
+
+    BREthereumProvisionResult result = {
+        join.provision.identifier,
+        join.provision.type,
+        status,
+        join.provision,
+        { .success = {}}
+    };
+
+    if (PROVISION_ERROR == status)
+        result.u.error.reason = reason;
+
+    join.callback (join.context,
+                   les,
+                   (PROVISION_SUCCESS == status
+                    ? (BREthereumNodeReference) join.node
+                    : join.nodeReference),
+                   result);
+}
+
+/**
+ * Handle the `result` of a join's part, at `offset`.  Once all the parts have been joined, or
+ * once one part has failed, invoke the join's callback.
+ *
+ * @note This is always called from the LES 'Main Thread'
+ */
+static void
+lesHandleProvisionForPart (BREthereumLES les,
+                           BREthereumProvisionIdentifier joinIdentifier,
+                           size_t offset,
+                           BREthereumNodeReference node,
+                           OwnershipGiven BREthereumProvisionResult result) {
+    ssize_t joinIndex = lesFindJoin (les, joinIdentifier);
+
+    // If the join has already failed, then the part is of no use.
+    if (-1 == joinIndex) {
+        provisionResultRelease (&result);
+        return;
+    }
+
+    BREthereumLESJoin *join = &les->joins[joinIndex];
+    join->partsCount--;
+
+    switch (result.status) {
+        case PROVISION_SUCCESS:
+            join->node = (BREthereumNode) node;
+            provisionJoin (&join->provision, offset, &result.provision);
+            provisionResultRelease (&result);
+
+            // Once there are no remaining parts, the join is finished.
+            if (join->offset == join->count && 0 == join->partsCount)
+                lesFinishJoin (les, joinIndex, PROVISION_SUCCESS, (BREthereumProvisionErrorReason) 0);
+            break;
+
+        case PROVISION_ERROR: {
+            // Fail the join.  Remaining parts will find no join and will be released as they
+            // are handled.
+            BREthereumProvisionErrorReason reason = result.u.error.reason;
+            provisionResultRelease (&result);
+            lesFinishJoin (les, joinIndex, PROVISION_ERROR, reason);
+            break;
+        }
+    }
+}
+
 /**
  * Handle a Node's Provision result by invoking the result's callback.  On success, the result
  * is everything requested from LES - such as Block Header, Block Bodies, ..., Account States.
@@ -875,16 +1046,23 @@ lesHandleProvision (BREthereumLES les,
         if (result.identifier == request->provision.identifier)
             switch (result.status) {
                 case PROVISION_SUCCESS:
-                    // On success, invoke `request->callback`
+                    // On success, invoke `request->callback` or, for a part, join the result.
 
                     // We've passed ownership of the provision, in result.  We can simply
                     // remove the request (which releases the result but we passed a copy,
                     // w/ provision and w/ provision references (to hashes, etc)).
 
-                    request->callback (request->context,
-                                       les,
-                                       node,
-                                       result);
+                    if (PROVISION_IDENTIFIER_UNDEFINED != request->joinIdentifier)
+                        lesHandleProvisionForPart (les,
+                                                   request->joinIdentifier,
+                                                   request->joinOffset,
+                                                   (BREthereumNodeReference) node,
+                                                   result);
+                    else
+                        request->callback (request->context,
+                                           les,
+                                           node,
+                                           result);
 
 
                     array_rm (les->requests, index);
@@ -943,6 +1121,7 @@ lesHandleNeighbor (BREthereumLES les,
                                   nodeEndpointCreate(neighbors[index]),
                                   (BREthereumNodeState) { NODE_AVAILABLE },
                                   NODE_PRIORITY_DIS,
+                                  BR_PEER_QUALITY_NONE,
                                   NULL);
     // array_free (neighbors);
 
@@ -1019,6 +1198,135 @@ lesDeactivateNodes (BREthereumLES les,
         lesDeactivateNode (les, route, nodesToDeactivate[ri], explain);
 }
 
+/// MARK: - LES Scheduling
+
+/**
+ * The count of `provision` requests, up to `remaining`, that `node` should handle now - limited
+ * by the credits the node has available.  Zero if the node is not connected, can't handle the
+ * provision or already has plenty of requests pending.
+ */
+static size_t
+lesGetPartCount (BREthereumLES les,
+                 BREthereumNode node,
+                 BREthereumProvision *provision,
+                 size_t remaining) {
+    if (!nodeHasState (node, NODE_ROUTE_TCP, NODE_CONNECTED) ||
+        ETHEREUM_BOOLEAN_IS_FALSE (nodeCanHandleProvision (node, *provision)))
+        return 0;
+
+    // Don't pile requests onto one node; leave them for the node that frees up first.
+    size_t limit = nodeGetProvisionCountForCredits (node, provision->type, UINT64_MAX);
+    if (nodeGetProvisionsPendingCount (node) >= LES_NODE_PENDING_PARTS * limit)
+        return 0;
+
+    size_t count = nodeGetProvisionCountForCredits (node, provision->type, nodeGetCreditsAvailable (node));
+    return (count < remaining ? count : remaining);
+}
+
+/**
+ * Select an active node to handle `provision`.  Of the nodes with a non-zero part count (see
+ * lesGetPartCount()), select the one expected to provide soonest given its pending requests and
+ * its measured throughput.  Fill `count`, if not NULL, with the selected node's part count.
+ *
+ * @return the node or NULL if no node can handle `provision` now.
+ */
+static BREthereumNode
+lesSelectNode (BREthereumLES les,
+               BREthereumProvision *provision,
+               size_t remaining,
+               size_t *count) {
+    BREthereumNode nodeSelected  = NULL;
+    size_t         countSelected = 0;
+    double         timeSelected  = 0.0;
+
+    BRArrayOf(BREthereumNode) nodes = les->activeNodesByRoute[NODE_ROUTE_TCP];
+    for (size_t index = 0; index < array_count(nodes); index++) {
+        BREthereumNode node = nodes[index];
+
+        size_t nodeCount = lesGetPartCount (les, node, provision, remaining);
+        if (0 == nodeCount) continue;
+
+        double throughput = nodeGetThroughput (node);
+        if (0.0 == throughput) throughput = LES_NODE_THROUGHPUT_DEFAULT;
+
+        // The expected time until `node` provides the first request of `provision`.
+        double time = (1 + nodeGetProvisionsPendingCount (node)) / throughput;
+
+        if (NULL == nodeSelected || time < timeSelected) {
+            nodeSelected  = node;
+            countSelected = nodeCount;
+            timeSelected  = time;
+        }
+    }
+
+    if (NULL != count) *count = countSelected;
+    return nodeSelected;
+}
+
+/**
+ * Split the remaining requests of each join into parts, as nodes have the credits to handle them,
+ * and establish each part's provision in its node.  A join for a specific node fails if that node
+ * is not connected.
+ */
+static void
+lesScheduleJoins (BREthereumLES les) {
+    size_t joinIndex = 0;
+    while (joinIndex < array_count (les->joins)) {
+        BREthereumLESJoin *join = &les->joins[joinIndex];
+        BREthereumNodeReference nodeRef = join->nodeReference;
+
+        // A specific node must be connected - just like for a request.
+        if (!NODE_REFERENCE_IS_GENERIC (nodeRef) &&
+            NODE_REFERENCE_ANY != nodeRef &&
+            !nodeHasState ((BREthereumNode) nodeRef, NODE_ROUTE_TCP, NODE_CONNECTED)) {
+            lesFinishJoin (les, joinIndex, PROVISION_ERROR, PROVISION_ERROR_NODE_INACTIVE);
+            continue; // `joinIndex` now references the next join
+        }
+
+        while (join->offset < join->count) {
+            size_t count = 0;
+            size_t remaining = join->count - join->offset;
+
+            BREthereumNode node = NULL;
+            if (NODE_REFERENCE_ANY == nodeRef)
+                node = lesSelectNode (les, &join->provision, remaining, &count);
+            else {
+                node = (NODE_REFERENCE_IS_GENERIC (nodeRef)
+                        ? ((size_t) nodeRef < array_count (les->activeNodesByRoute[NODE_ROUTE_TCP])
+                           ? les->activeNodesByRoute[NODE_ROUTE_TCP][(size_t) nodeRef]
+                           : NULL)
+                        : (BREthereumNode) nodeRef);
+                if (NULL != node) count = lesGetPartCount (les, node, &join->provision, remaining);
+            }
+
+            // Wait for a node with credits.
+            if (NULL == node || 0 == count) break;
+
+            BREthereumProvision part = provisionSplit (&join->provision, join->offset, count);
+            part.identifier = les->requestsIdentifier++;
+
+            BREthereumLESRequest request = {
+                NULL,
+                NULL,
+                part,
+                nodeRef,
+                node,
+                join->provision.identifier,
+                join->offset
+            };
+            array_add (les->requests, request);
+
+            join->offset     += count;
+            join->partsCount += 1;
+
+            // See the memory-management note in lesThread() regarding passing a provision copy.
+            nodeHandleProvision (node, part);
+        }
+
+        joinIndex++;
+    }
+}
+
 static void
 lesHandleSelectError (BREthereumLES les,
                       int error) {
@@ -1116,6 +1424,7 @@ lesThreadBootstrapSeeds (BREthereumLES les) {
                                           nodeEndpointCreateEnode(enodes[index]),
                                           (BREthereumNodeState) { NODE_AVAILABLE },
                                           enodesDecl[indexDecl].priority,
+                                          BR_PEER_QUALITY_NONE,
                                           &added);
 
             if (ETHEREUM_BOOLEAN_IS_TRUE(added))
@@ -1185,6 +1494,11 @@ lesThread (BREthereumLES les) {
             }
         }
         
+        //
+        // Split joins into parts, as nodes have the credits to handle them.
+        //
+        lesScheduleJoins (les);
+
         //
         // Handle any/all pending requests by 'establishing a provision' in the requested node.  If
         // the requested node is not connected the request must fail.
@@ -1204,21 +1518,29 @@ lesThread (BREthereumLES les) {
 
                 // We require all arbitary references to have been resolved when the
                 // provision was added as a request.  An `arbitary` reference is something like
-                // NODE_REFERENCE_{ANY,ALL} where the request did not specify a specific node
-                assert (!NODE_REFERENCE_IS_ARBITRARY(nodeRef));
+                // NODE_REFERENCE_{ANY,ALL} where the request did not specify a specific node.
+                // The exception is a join's part, which we'll reschedule with NODE_REFERENCE_ANY
+                assert (!NODE_REFERENCE_IS_ARBITRARY(nodeRef) ||
+                        (NODE_REFERENCE_ANY == nodeRef &&
+                         PROVISION_IDENTIFIER_UNDEFINED != les->requests[index].joinIdentifier));
 
                 // The request will be handled based on the `nodeReference` - if the reference is
-                // 'generic' we'll get a node from `activeNodesByRoute`; otherwise we'll use the
-                // specific node.
+                // ANY we'll select the node expected to provide soonest; if 'generic' we'll get a
+                // node from `activeNodesByRoute`; otherwise we'll use the specific node.
 
 #define ACTIVE_NODE(ref)                                                 \
     (((int)(ref)) < array_count(les->activeNodesByRoute[NODE_ROUTE_TCP]) \
      ? les->activeNodesByRoute[NODE_ROUTE_TCP][(int)(ref)]               \
      : NULL)
 
-                BREthereumNode nodeToUse = (NODE_REFERENCE_IS_GENERIC (nodeRef)
-                                            ? ACTIVE_NODE (nodeRef)
-                                            : (BREthereumNode) les->requests[index].nodeReference);
+                BREthereumNode nodeToUse = (NODE_REFERENCE_ANY == nodeRef
+                                            ? lesSelectNode (les,
+                                                             &les->requests[index].provision,
+                                                             provisionGetCount (&les->requests[index].provision),
+                                                             NULL)
+                                            : (NODE_REFERENCE_IS_GENERIC (nodeRef)
+                                               ? ACTIVE_NODE (nodeRef)
+                                               : (BREthereumNode) les->requests[index].nodeReference));
 #undef ACTIVE_NODE
 
                 // If `nodeToUse` is NULL, then there may be no active nodes.  We'll leave the
@@ -1272,16 +1594,25 @@ lesThread (BREthereumLES les) {
             size_t requestIndex = requestsToFail[index];
             BREthereumLESRequest *request = &les->requests[requestIndex];
 
-            request->callback (request->context,
-                               les,
-                               request->nodeReference,
-                               (BREthereumProvisionResult) {
-                                   request->provision.identifier,
-                                   request->provision.type,
-                                   PROVISION_ERROR,
-                                   request->provision,
-                                   { .error = { PROVISION_ERROR_NODE_INACTIVE }}
-                               });
+            BREthereumProvisionResult result = {
+                request->provision.identifier,
+                request->provision.type,
+                PROVISION_ERROR,
+                request->provision,
+                { .error = { PROVISION_ERROR_NODE_INACTIVE }}
+            };
+
+            if (PROVISION_IDENTIFIER_UNDEFINED != request->joinIdentifier)
+                lesHandleProvisionForPart (les,
+                                           request->joinIdentifier,
+                                           request->joinOffset,
+                                           request->nodeReference,
+                                           result);
+            else
+                request->callback (request->context,
+                                   les,
+                                   request->nodeReference,
+                                   result);
         }
 
         // ... and then remove them in reverse order.
@@ -1536,6 +1867,10 @@ lesThread (BREthereumLES les) {
         requestRelease(&les->requests[index]);
     array_clear(les->requests);
 
+    for (size_t index = 0; index < array_count(les->joins); index++)
+        provisionRelease (&les->joins[index].provision, ETHEREUM_BOOLEAN_TRUE);
+    array_clear(les->joins);
+
     // Something with 'head {hash, number, totalDifficulty}'?
 
     les->theTimeToQuitIsNow = 0;
@@ -1557,10 +1892,21 @@ lesAddRequestSpecifically (BREthereumLES les,
                            BREthereumLESProvisionCallback callback,
                            OwnershipGiven BREthereumProvision provision) {
     provision.identifier = les->requestsIdentifier++;
-    BREthereumLESRequest request = { context, callback, provision, node, NULL };
+    BREthereumLESRequest request = { context, callback, provision, node, NULL, PROVISION_IDENTIFIER_UNDEFINED, 0 };
     array_add (les->requests, request);
 }
 
+static void
+lesAddJoin (BREthereumLES les,
+            BREthereumNodeReference node,
+            BREthereumLESProvisionContext context,
+            BREthereumLESProvisionCallback callback,
+            OwnershipGiven BREthereumProvision provision) {
+    provision.identifier = les->requestsIdentifier++;
+    BREthereumLESJoin join = { context, callback, provision, node, provisionGetCount (&provision), 0, 0, NULL };
+    array_add (les->joins, join);
+}
+
 /**
  * Use `provision` it define a new LES request.  The request will be dispatched to the preferred
  * node, when appropriate.
@@ -1578,12 +1924,20 @@ lesAddRequest (BREthereumLES les,
                OwnershipGiven BREthereumProvision provision) {
     assert (PROVISION_IDENTIFIER_UNDEFINED == provision.identifier);
 
-    if (NODE_REFERENCE_NIL == node) node = NODE_REFERENCE_0;
-    if (NODE_REFERENCE_ANY == node) node = NODE_REFERENCE_0;
+    if (NODE_REFERENCE_NIL == node) node = NODE_REFERENCE_ANY;
 
     pthread_mutex_lock (&les->lock);
-    if (NODE_REFERENCE_ALL != node)
-        lesAddRequestSpecifically (les, node, context, callback, provision);
+
+    // A provision with many requests is split into parts, possibly handled by different nodes.
+    if (NODE_REFERENCE_ALL != node &&
+        ETHEREUM_BOOLEAN_IS_TRUE (provisionIsSplittable (&provision)) &&
+        provisionGetCount (&provision) > 0)
+        lesAddJoin (les, node, context, callback, provision);
+
+    else if (NODE_REFERENCE_ALL != node)
+        lesAddRequestSpecifically (les,
+                                   (NODE_REFERENCE_ANY == node ? NODE_REFERENCE_0 : node),
+                                   context, callback, provision);
     else {
         // We'll make NODE_REFERENCE_MAX - NODE_REFERENCE_MIN specific requests.  Since we have at
         // most LES_ACTIVE_NODE_COUNT active nodes, we might not get (MAX - MIN) actual requests
@@ -1713,12 +2067,32 @@ lesProvideAccountStates (BREthereumLES les,
                          BREthereumLESProvisionContext context,
                          BREthereumLESProvisionCallback callback,
                          BREthereumAddress address,
-                         OwnershipGiven BRArrayOf(BREthereumHash) blockHashes) {
+                         OwnershipGiven BRArrayOf(BREthereumHash) blockHashes,
+                         OwnershipGiven BRArrayOf(BREthereumHash) stateRoots) {
+    assert (array_count (blockHashes) == array_count (stateRoots));
+    lesAddRequest (les, node, context, callback,
+                   (BREthereumProvision) {
+                       PROVISION_IDENTIFIER_UNDEFINED,
+                       PROVISION_ACCOUNTS,
+                       { .accounts = { address, NULL, blockHashes, stateRoots, NULL }}
+                   });
+}
+
+extern void
+lesProvideAccountStatesMany (BREthereumLES les,
+                             BREthereumNodeReference node,
+                             BREthereumLESProvisionContext context,
+                             BREthereumLESProvisionCallback callback,
+                             OwnershipGiven BRArrayOf(BREthereumAddress) addresses,
+                             OwnershipGiven BRArrayOf(BREthereumHash) blockHashes,
+                             OwnershipGiven BRArrayOf(BREthereumHash) stateRoots) {
+    assert (array_count (addresses) > 0);
+    assert (array_count (blockHashes) == array_count (stateRoots));
     lesAddRequest (les, node, context, callback,
                    (BREthereumProvision) {
                        PROVISION_IDENTIFIER_UNDEFINED,
                        PROVISION_ACCOUNTS,
-                       { .accounts = { address, blockHashes, NULL }}
+                       { .accounts = { addresses[0], addresses, blockHashes, stateRoots, NULL }}
                    });
 }
 
@@ -1728,9 +2102,11 @@ lesProvideAccountStatesOne (BREthereumLES les,
                             BREthereumLESProvisionContext context,
                             BREthereumLESProvisionCallback callback,
                             BREthereumAddress address,
-                            BREthereumHash blockHash) {
+                            BREthereumHash blockHash,
+                            BREthereumHash stateRoot) {
     lesProvideAccountStates (les, node, context, callback, address,
-                             lesCreateHashArray(les, blockHash));
+                             lesCreateHashArray(les, blockHash),
+                             lesCreateHashArray(les, stateRoot));
 }
 
 extern void
@@ -348,7 +348,9 @@ lesProvideReceiptsOne (BREthereumLES les,
  * @param context
  * @param callback
  * @param address
- * @param BREthereumHash
+ * @param blockHashes
+ * @param stateRoots the header stateRoot for each of `blockHashes`; the account proofs must be
+ *    rooted at these.
  */
 extern void
 lesProvideAccountStates (BREthereumLES les,
@@ -356,7 +358,31 @@ lesProvideAccountStates (BREthereumLES les,
                          BREthereumLESProvisionContext context,
                          BREthereumLESProvisionCallback callback,
                          BREthereumAddress address,
-                         OwnershipGiven BRArrayOf(BREthereumHash) blockHashes);
+                         OwnershipGiven BRArrayOf(BREthereumHash) blockHashes,
+                         OwnershipGiven BRArrayOf(BREthereumHash) stateRoots);
+
+/**
+ * @function lesProvideAccountStatesMany
+ *
+ * Provide the account state of every one of `addresses` at every one of `blockHashes`.  The
+ * requests are batched into shared LES `GetProofs` messages; the result's `accounts` are ordered
+ * by hash, then by address (see BREthereumProvisionAccounts).
+ *
+ * @param les
+ * @param context
+ * @param callback
+ * @param addresses
+ * @param blockHashes
+ * @param stateRoots
+ */
+extern void
+lesProvideAccountStatesMany (BREthereumLES les,
+                             BREthereumNodeReference node,
+                             BREthereumLESProvisionContext context,
+                             BREthereumLESProvisionCallback callback,
+                             OwnershipGiven BRArrayOf(BREthereumAddress) addresses,
+                             OwnershipGiven BRArrayOf(BREthereumHash) blockHashes,
+                             OwnershipGiven BRArrayOf(BREthereumHash) stateRoots);
 
 extern void
 lesProvideAccountStatesOne (BREthereumLES les,
@@ -364,7 +390,8 @@ lesProvideAccountStatesOne (BREthereumLES les,
                             BREthereumLESProvisionContext context,
                             BREthereumLESProvisionCallback callback,
                             BREthereumAddress address,
-                            BREthereumHash blockHash);
+                            BREthereumHash blockHash,
+                            BREthereumHash stateRoot);
 
 /**
  * @function lesProvideTransactionStauts
@@ -9,6 +9,7 @@
 //  See the CONTRIBUTORS file at the project root for a list of contributors.
 
 #include <unistd.h>
+#include <sys/time.h>
 #include <sys/socket.h>
 #include <sys/select.h>
 #include <pthread.h>
@@ -308,8 +309,8 @@ typedef struct {
     /** The count of messages received */
     size_t messagesReceivedCount;
 
-    /** Time of creation */
-    long timestamp;
+    /** Time, in milliseconds, when the first message was sent */
+    uint64_t timestamp;
 
     BREthereumProvisionStatus status;
 
@@ -336,10 +337,19 @@ provisionerMessageOfInterest (BREthereumNodeProvisioner *provisioner,
             messageIdentifier < (provisioner->messageIdentifier + provisioner->messagesCount));
 }
 
+static BREthereumMessage *
+provisionerMessageNext (BREthereumNodeProvisioner *provisioner) {
+    return &provisioner->messages [provisioner->messagesCount -
+                                   provisioner->messagesRemainingCount];
+}
+
 static BREthereumNodeStatus
-provisionerMessageSend (BREthereumNodeProvisioner *provisioner) {
-    BREthereumMessage message = provisioner->messages [provisioner->messagesCount -
-                                                       provisioner->messagesRemainingCount];
+provisionerMessageSend (BREthereumNodeProvisioner *provisioner,
+                        uint64_t now) {
+    if (provisioner->messagesRemainingCount == provisioner->messagesCount)
+        provisioner->timestamp = now;
+
+    BREthereumMessage message = *provisionerMessageNext (provisioner);
     BREthereumNodeStatus status = nodeSend (provisioner->node, NODE_ROUTE_TCP, message);
     provisioner->messagesRemainingCount--;
 
@@ -358,7 +368,7 @@ provisionerGetCount (BREthereumNodeProvisioner *provisioner) {
         case PROVISION_TRANSACTION_RECEIPTS:
             return array_count (provisioner->provision.u.receipts.hashes);
         case PROVISION_ACCOUNTS:
-            return array_count (provisioner->provision.u.accounts.hashes);
+            return provisionAccountsGetCount (&provisioner->provision.u.accounts);
         case PROVISION_TRANSACTION_STATUSES:
             return array_count (provisioner->provision.u.statuses.hashes);
         case PROVISION_SUBMIT_TRANSACTION:
@@ -370,14 +380,13 @@ provisionerGetCount (BREthereumNodeProvisioner *provisioner) {
 }
 
 static size_t
-provisionerGetMessageContentLimit (BREthereumNodeProvisioner *provisioner) {
-    assert (NULL != provisioner->node);
-
-    switch (nodeGetType(provisioner->node)) {
+nodeGetMessageContentLimit (BREthereumNode node,
+                            BREthereumProvisionType type) {
+    switch (nodeGetType(node)) {
         case NODE_TYPE_UNKNOWN:
             assert (0);
         case NODE_TYPE_GETH: {
-            BREthereumLESMessageIdentifier id = provisionGetMessageLESIdentifier(provisioner->provision.type);
+            BREthereumLESMessageIdentifier id = provisionGetMessageLESIdentifier(type);
             return messageLESSpecs[id].limit;
         }
         case NODE_TYPE_PARITY:
@@ -386,6 +395,12 @@ provisionerGetMessageContentLimit (BREthereumNodeProvisioner *provisioner) {
     }
 }
 
+static size_t
+provisionerGetMessageContentLimit (BREthereumNodeProvisioner *provisioner) {
+    assert (NULL != provisioner->node);
+    return nodeGetMessageContentLimit (provisioner->node, provisioner->provision.type);
+}
+
 static void
 provisionerEstablish (BREthereumNodeProvisioner *provisioner,
                       BREthereumNode node) {
@@ -485,9 +500,30 @@ struct BREthereumNodeRecord {
     // TODO: This should not be LES specific; applies to PIP too.
     BREthereumLESMessageSpec specs [NUMBER_OF_LES_MESSAGE_IDENTIFIERS];
 
-    /** Credit remaining (if not zero) */
+    /**
+     * Flow Control.  The remote node keeps a buffer of credits for us; every request costs
+     * `baseCost + count * reqCost` credits (see `specs`) and the buffer recharges, over time, up
+     * to a limit.  A response reports the buffer's value; between responses we estimate it.  A
+     * request sent without enough credits gets us disconnected.
+     */
+
+    /** The buffer limit (BL), in credits.  If zero, the remote has no flow control */
+    uint64_t creditsLimit;
+
+    /** The buffer recharge rate (MRR), in credits per millisecond */
+    uint64_t creditsRecharge;
+
+    /** The estimated credits remaining in the buffer, as of `creditsTimestamp` */
     uint64_t credits;
 
+    /** The time, in milliseconds, of the `credits` estimate */
+    uint64_t creditsTimestamp;
+
+    /** The quality - the measured latency and throughput over completed provisions, in
+     * provided items (headers, bodies, etc) per second, and the history of TCP connections.
+     * Persisted, with the node's config, across LES instances. */
+    BRPeerQuality quality;
+
     /** Callbacks */
     BREthereumNodeContext callbackContext;
     BREthereumNodeCallbackStatus callbackStatus;
@@ -538,7 +574,7 @@ nodeShow (BREthereumNode node) {
     eth_log (LES_LOG_TOPIC, "   UDP       : %s", nodeStateDescribe (&node->states[NODE_ROUTE_UDP], descUDP));
     eth_log (LES_LOG_TOPIC, "   TCP       : %s", nodeStateDescribe (&node->states[NODE_ROUTE_TCP], descTCP));
     eth_log (LES_LOG_TOPIC, "   Discovered: %s", (ETHEREUM_BOOLEAN_IS_TRUE(node->discovered) ? "Yes" : "No"));
-    eth_log (LES_LOG_TOPIC, "   Credits   : %" PRIu64, node->credits);
+    eth_log (LES_LOG_TOPIC, "   Credits   : %" PRIu64 " / %" PRIu64, node->credits, node->creditsLimit);
 }
 
 extern const BREthereumNodeEndpoint
@@ -563,14 +599,28 @@ nodeNeighborCompare (BREthereumNode n1,
     }
 }
 
+static BREthereumComparison
+nodeQualityCompare (BREthereumNode node1,
+                    BREthereumNode node2) {
+    switch (BRPeerQualityCompare (&node1->quality, &node2->quality)) {
+        case -1: return ETHEREUM_COMPARISON_LT;
+        case  0: return ETHEREUM_COMPARISON_EQ;
+        case +1: return ETHEREUM_COMPARISON_GT;
+        default: BRFail();
+    }
+}
+
 extern BREthereumComparison
 nodeCompare (BREthereumNode node1,
              BREthereumNode node2) {
+    BREthereumComparison comparison;
     return (node1->priority < node2->priority
             ? ETHEREUM_COMPARISON_LT
             : (node1->priority > node2->priority
                ? ETHEREUM_COMPARISON_GT
-               : nodeNeighborCompare(node1, node2)));
+               : (ETHEREUM_COMPARISON_EQ != (comparison = nodeQualityCompare (node1, node2))
+                  ? comparison
+                  : nodeNeighborCompare(node1, node2))));
 }
 
 static size_t
@@ -584,10 +634,63 @@ nodeGetThenIncrementMessageIdentifier (BREthereumNode node,
     return identifier;
 }
 
+/**
+ * Record, in the node's quality, the outcome of a TCP connection reaching `state`.  A connection
+ * that succeeds, or fails, counts as such; a protocol error from malformed data also counts as
+ * misbehavior.
+ */
+static void
+nodeQualityAddState (BREthereumNode node,
+                     BREthereumNodeState state) {
+    switch (state.type) {
+        case NODE_AVAILABLE:
+        case NODE_CONNECTING:
+            break;
+
+        case NODE_CONNECTED:
+            BRPeerQualityAddOutcome (&node->quality, 1);
+            break;
+
+        case NODE_ERROR:
+            switch (state.u.error.type) {
+                case NODE_ERROR_UNIX:
+                case NODE_ERROR_DISCONNECT:
+                    BRPeerQualityAddOutcome (&node->quality, 0);
+                    break;
+
+                case NODE_ERROR_PROTOCOL:
+                    switch (state.u.error.u.protocol) {
+                        case NODE_PROTOCOL_UDP_EXCESSIVE_BYTE_COUNT:
+                        case NODE_PROTOCOL_TCP_AUTHENTICATION:
+                        case NODE_PROTOCOL_RLP_PARSE:
+                            BRPeerQualityAddMisbehavior (&node->quality);
+                            break;
+
+                        case NODE_PROTOCOL_EXHAUSTED:
+                        case NODE_PROTOCOL_NONSTANDARD_PORT:
+                        case NODE_PROTOCOL_PING_PONG_MISSED:
+                        case NODE_PROTOCOL_TCP_HELLO_MISSED:
+                        case NODE_PROTOCOL_TCP_STATUS_MISSED:
+                        case NODE_PROTOCOL_CAPABILITIES_MISMATCH:
+                        case NODE_PROTOCOL_STATUS_MISMATCH:
+                            BRPeerQualityAddOutcome (&node->quality, 0);
+                            break;
+                    }
+                    break;
+            }
+            break;
+    }
+}
+
 static BREthereumNodeState
 nodeStateAnnounce (BREthereumNode node,
                    BREthereumNodeEndpointRoute route,
                    BREthereumNodeState state) {
+    // Only a change in the TCP state is an outcome; an error is often announced twice - when it
+    // occurs and again on the subsequent disconnect.
+    if (NODE_ROUTE_TCP == route && state.type != node->states[route].type)
+        nodeQualityAddState (node, state);
+
     node->states [route] = state;
     return state;
 }
@@ -683,8 +786,12 @@ nodeCreate (BREthereumNodePriority priority,
     for (int i = 0; i < NUMBER_OF_LES_MESSAGE_IDENTIFIERS; i++)
         node->specs[i] = messageLESSpecs[i];
 
-    // No credits, yet.
+    // No credits, yet; we'll get the flow control parameters from the remote status.
+    node->creditsLimit = 0;
+    node->creditsRecharge = 0;
     node->credits = 0;
+    node->creditsTimestamp = 0;
+    node->quality = BR_PEER_QUALITY_NONE;
 
     node->sendDataBuffer = (BRRlpData) { DEFAULT_SEND_DATA_BUFFER_SIZE, malloc (DEFAULT_SEND_DATA_BUFFER_SIZE) };
     node->recvDataBuffer = (BRRlpData) { DEFAULT_RECV_DATA_BUFFER_SIZE, malloc (DEFAULT_RECV_DATA_BUFFER_SIZE) };
@@ -857,6 +964,188 @@ nodeDisconnect (BREthereumNode node,
     return node->states[route];
 }
 
+/// MARK: - Flow Control
+
+static uint64_t
+nodeGetMilliseconds (void) {
+    struct timeval tv;
+    gettimeofday (&tv, NULL);
+    return 1000 * (uint64_t) tv.tv_sec + (uint64_t) tv.tv_usec / 1000;
+}
+
+/**
+ * The credits that `message` costs.  Only LES messages have a cost; for PIP we don't have the
+ * remote's cost table.
+ */
+static uint64_t
+nodeGetMessageCost (BREthereumNode node,
+                    BREthereumMessage *message) {
+    switch (message->identifier) {
+        case MESSAGE_P2P: return 0;
+        case MESSAGE_DIS: return 0;
+        case MESSAGE_ETH: return 0;
+        case MESSAGE_LES:
+            return (node->specs[message->u.les.identifier].baseCost +
+                    messageLESGetCreditsCount (&message->u.les) * node->specs[message->u.les.identifier].reqCost);
+        case MESSAGE_PIP: return 0;
+    }
+}
+
+/**
+ * The credits of messages sent but not yet responded to, excluding the message for `requestId`.
+ * The credits reported by the remote do not yet account for these.
+ */
+static uint64_t
+nodeGetCreditsInFlight (BREthereumNode node,
+                        uint64_t requestId) {
+    uint64_t credits = 0;
+    for (size_t index = 0; index < array_count (node->provisioners); index++) {
+        BREthereumNodeProvisioner *provisioner = &node->provisioners[index];
+        size_t sentCount = provisioner->messagesCount - provisioner->messagesRemainingCount;
+
+        // Responses arrive, largely, in the order sent.
+        for (size_t mi = provisioner->messagesReceivedCount; mi < sentCount; mi++)
+            if (provisioner->messageIdentifier + mi != requestId)
+                credits += nodeGetMessageCost (node, &provisioner->messages[mi]);
+    }
+    return credits;
+}
+
+/**
+ * Recharge the estimated credits for the time elapsed since the estimate was made.
+ */
+static void
+nodeRechargeCredits (BREthereumNode node,
+                     uint64_t now) {
+    if (now <= node->creditsTimestamp) return;
+
+    uint64_t deficit = node->creditsLimit - node->credits;
+    uint64_t elapsed = now - node->creditsTimestamp;
+
+    if (0 != node->creditsRecharge && elapsed > deficit / node->creditsRecharge)
+        node->credits = node->creditsLimit;
+    else
+        node->credits += elapsed * node->creditsRecharge;
+
+    node->creditsTimestamp = now;
+}
+
+/**
+ * Update the estimated credits from those reported by the remote in the response to `requestId`.
+ */
+static void
+nodeUpdateCredits (BREthereumNode node,
+                   uint64_t requestId,
+                   uint64_t credits) {
+    if (0 == node->creditsLimit) return;
+
+    uint64_t inFlight = nodeGetCreditsInFlight (node, requestId);
+
+    node->credits = (credits > inFlight ? credits - inFlight : 0);
+    if (node->credits > node->creditsLimit) node->credits = node->creditsLimit;
+    node->creditsTimestamp = nodeGetMilliseconds();
+}
+
+/**
+ * Check if `message` can be sent, at `now`, within the estimated credits.  A message costing more
+ * than the limit will never fit; we'll send it once the buffer is full.
+ */
+static int
+nodeCanSendMessage (BREthereumNode node,
+                    BREthereumMessage *message,
+                    uint64_t now) {
+    if (0 == node->creditsLimit) return 1;
+    nodeRechargeCredits (node, now);
+
+    uint64_t cost = nodeGetMessageCost (node, message);
+    return cost <= node->credits || node->credits == node->creditsLimit;
+}
+
+static void
+nodeSpendCredits (BREthereumNode node,
+                  BREthereumMessage *message) {
+    uint64_t cost = nodeGetMessageCost (node, message);
+    node->credits = (cost < node->credits ? node->credits - cost : 0);
+}
+
+static void
+nodeUpdateQuality (BREthereumNode node,
+                   size_t count,
+                   size_t messagesCount,
+                   uint64_t timestamp) {
+    uint64_t now = nodeGetMilliseconds();
+    uint64_t elapsed = (now > timestamp ? now - timestamp : 1);
+
+    // The latency is per message - a provision's messages are sent together.
+    BRPeerQualityAddLatency   (&node->quality, (double) elapsed / (messagesCount > 0 ? messagesCount : 1));
+    BRPeerQualityAddBandwidth (&node->quality, (1000.0 * count) / elapsed);
+}
+
+extern uint64_t
+nodeGetCreditsAvailable (BREthereumNode node) {
+    if (0 == node->creditsLimit) return UINT64_MAX;
+    nodeRechargeCredits (node, nodeGetMilliseconds());
+
+    // Credits, less those for messages not yet sent.
+    uint64_t credits = node->credits;
+    for (size_t index = 0; index < array_count (node->provisioners); index++) {
+        BREthereumNodeProvisioner *provisioner = &node->provisioners[index];
+        for (size_t mi = provisioner->messagesCount - provisioner->messagesRemainingCount; mi < provisioner->messagesCount; mi++) {
+            uint64_t cost = nodeGetMessageCost (node, &provisioner->messages[mi]);
+            credits = (cost < credits ? credits - cost : 0);
+        }
+    }
+    return credits;
+}
+
+extern size_t
+nodeGetProvisionCountForCredits (BREthereumNode node,
+                                 BREthereumProvisionType type,
+                                 uint64_t credits) {
+    switch (node->type) {
+        case NODE_TYPE_UNKNOWN:
+            return 0;
+
+        case NODE_TYPE_GETH: {
+            BREthereumLESMessageSpec *spec = &node->specs[provisionGetMessageLESIdentifier (type)];
+            if (credits < spec->baseCost) return 0;
+
+            uint64_t count = (0 == spec->reqCost
+                              ? spec->limit
+                              : (credits - spec->baseCost) / spec->reqCost);
+            return (size_t) (count < spec->limit ? count : spec->limit);
+        }
+
+        case NODE_TYPE_PARITY:
+            // No cost table; limit to the content of one message.
+            return nodeGetMessageContentLimit (node, type);
+    }
+}
+
+extern double
+nodeGetThroughput (BREthereumNode node) {
+    return node->quality.bandwidth;
+}
+
+extern BRPeerQuality
+nodeGetQuality (BREthereumNode node) {
+    return node->quality;
+}
+
+extern void
+nodeSetQuality (BREthereumNode node,
+                BRPeerQuality quality) {
+    node->quality = quality;
+}
+
+extern size_t
+nodeGetProvisionsPendingCount (BREthereumNode node) {
+    size_t count = 0;
+    for (size_t index = 0; index < array_count (node->provisioners); index++)
+        count += provisionerGetCount (&node->provisioners[index]);
+    return count;
+}
+
 /// MARK: - Node Process
 
 extern BREthereumBoolean
@@ -866,7 +1155,10 @@ nodeCanHandleProvision (BREthereumNode node,
         case NODE_TYPE_UNKNOWN:
             return ETHEREUM_BOOLEAN_FALSE;
         case NODE_TYPE_GETH:
-            return AS_ETHEREUM_BOOLEAN(((BREthereumLESMessageIdentifier) -1) != provisionGetMessageLESIdentifier (provision.type));
+            return AS_ETHEREUM_BOOLEAN(((BREthereumLESMessageIdentifier) -1) != provisionGetMessageLESIdentifier (provision.type) &&
+                                       // A full buffer must afford at least one request.
+                                       (0 == node->creditsLimit ||
+                                        0 != nodeGetProvisionCountForCredits (node, provision.type, node->creditsLimit)));
         case NODE_TYPE_PARITY:
             return AS_ETHEREUM_BOOLEAN(((BREthereumPIPRequestType) -1) != provisionGetMessagePIPIdentifier(provision.type));
     }
@@ -900,6 +1192,18 @@ nodeHandleProvisionerMessage (BREthereumNode node,
 
     // If all messages have been received...
     if (!provisionerRecvMessagesPending(provisioner)) {
+        // ... update the latency and throughput,
+        if (PROVISION_SUCCESS == provisioner->status &&
+            PROVISION_SUBMIT_TRANSACTION != provisioner->provision.type)
+            nodeUpdateQuality (node,
+                               provisionerGetCount (provisioner),
+                               provisioner->messagesCount,
+                               provisioner->timestamp);
+
+        // ... a data error is misbehavior,
+        if (PROVISION_ERROR == provisioner->status)
+            BRPeerQualityAddMisbehavior (&node->quality);
+
         // ... callback the result,
         BREthereumProvisionResult result = {
             provisioner->provision.identifier,
@@ -1143,7 +1447,18 @@ nodeProcessRecvPIP (BREthereumNode node,
             break;
 
         case PIP_MESSAGE_UPDATE_CREDIT_PARAMETERS: {
-            // TODO: Process the new credit parameters...
+            // Adopt the new credit parameters...
+            UInt256 max      = message.u.updateCreditParameters.max;
+            UInt256 recharge = message.u.updateCreditParameters.recharge;
+
+            node->creditsLimit    = (0 == max.u64[1] && 0 == max.u64[2] && 0 == max.u64[3]
+                                     ? max.u64[0]
+                                     : UINT64_MAX);
+            node->creditsRecharge = (0 == recharge.u64[1] && 0 == recharge.u64[2] && 0 == recharge.u64[3]
+                                     ? recharge.u64[0]
+                                     : UINT64_MAX);
+            if (node->credits > node->creditsLimit) node->credits = node->creditsLimit;
+
 
             // ... and then, immediately acknowledge the update.
             BREthereumMessage ack = {
@@ -1229,6 +1544,15 @@ nodeDefineRemoteStatus (BREthereumNode node,
             assert (MESSAGE_LES == message.identifier);
             assert (LES_MESSAGE_STATUS == message.u.les.identifier);
             status = message.u.les.u.status.p2p;
+
+            // The remote's cost table replaces our defaults.
+            for (size_t index = 0; index < NUMBER_OF_LES_MESSAGE_IDENTIFIERS; index++) {
+                const BREthereumLESMessageStatusMRC *cost = &message.u.les.u.status.costs[index];
+                if (index == cost->msgCode && (0 != cost->baseCost || 0 != cost->reqCost)) {
+                    node->specs[index].baseCost = cost->baseCost;
+                    node->specs[index].reqCost  = cost->reqCost;
+                }
+            }
             break;
 
         case NODE_TYPE_PARITY:
@@ -1238,6 +1562,18 @@ nodeDefineRemoteStatus (BREthereumNode node,
             break;
     }
 
+    // Define the flow control parameters; the buffer starts out full.
+    BREthereumP2PMessageStatusValue value;
+
+    node->creditsLimit = (messageP2PStatusExtractValue (&status, P2P_MESSAGE_STATUS_FLOW_CONTROL_BL, &value)
+                          ? value.u.integer
+                          : 0);
+    node->creditsRecharge = (messageP2PStatusExtractValue (&status, P2P_MESSAGE_STATUS_FLOW_CONTROL_MRR, &value)
+                             ? value.u.integer
+                             : 0);
+    node->credits = node->creditsLimit;
+    node->creditsTimestamp = nodeGetMilliseconds();
+
     nodeEndpointSetStatus (node->remote, messageP2PStatusCopy (&status));
 }
 
@@ -1360,13 +1696,23 @@ nodeProcess (BREthereumNode node,
                     case NODE_ROUTE_UDP:
                         break;
 
-                    case NODE_ROUTE_TCP:
+                    case NODE_ROUTE_TCP: {
+                        uint64_t milliseconds = nodeGetMilliseconds();
+
                         // Look for the pending message in some provisioner
                         for (size_t index = 0; index < array_count (node->provisioners); index++)
                             if (provisionerSendMessagesPending (&node->provisioners[index])) {
-                                BREthereumNodeStatus status = provisionerMessageSend(&node->provisioners[index]);
+                                BREthereumNodeProvisioner *provisioner = &node->provisioners[index];
+                                BREthereumMessage *message = provisionerMessageNext (provisioner);
+
+                                // If the remote lacks the credits, wait for a recharge.  Messages
+                                // are sent in order; don't let a later, cheaper one go first.
+                                if (!nodeCanSendMessage (node, message, milliseconds)) break;
+
+                                BREthereumNodeStatus status = provisionerMessageSend (provisioner, milliseconds);
                                 switch (status) {
                                     case NODE_STATUS_SUCCESS:
+                                        nodeSpendCredits (node, message);
                                         break;
                                     case NODE_STATUS_ERROR:
                                         break;
@@ -1375,6 +1721,7 @@ nodeProcess (BREthereumNode node,
                                 break; // from for node->provisioners
                             }
                         break;
+                    }
                 }
             }
 
@@ -1835,10 +2182,16 @@ nodeUpdateDescriptors (BREthereumNode node,
             if (NULL != recv)
                 FD_SET (socket, recv);
 
-            // If we have any provisioner with a pending message, we are willing to send
+            // If we have any provisioner with a pending message, we are willing to send - but
+            // only if the remote has the credits for it.  Otherwise, we'll check again after the
+            // next timeout.
             for (size_t index = 0; index < array_count (node->provisioners); index++)
                 if (provisionerSendMessagesPending (&node->provisioners[index])) {
-                    if (NULL != send) FD_SET (socket, send);
+                    if (NULL != send &&
+                        nodeCanSendMessage (node,
+                                            provisionerMessageNext (&node->provisioners[index]),
+                                            nodeGetMilliseconds()))
+                        FD_SET (socket, send);
                     break;
                 }
 
@@ -2170,11 +2523,20 @@ nodeRecv (BREthereumNode node,
                 rlpShowItem(node->coder.rlp, item, "RECV");
 #endif
 
-            // If this is a LES response message, then it has credit information.
+            // If this is a LES or PIP response message, then it has credit information.
             if (!rlpCoderHasFailed(node->coder.rlp) &&
                 MESSAGE_LES == message.identifier &&
                 messageLESHasUse (&message.u.les, LES_MESSAGE_USE_RESPONSE))
-                node->credits = messageLESGetCredits (&message.u.les);
+                nodeUpdateCredits (node,
+                                   messageLESGetRequestId (&message.u.les),
+                                   messageLESGetCredits (&message.u.les));
+
+            else if (!rlpCoderHasFailed(node->coder.rlp) &&
+                     MESSAGE_PIP == message.identifier &&
+                     PIP_MESSAGE_RESPONSE == message.u.pip.type)
+                nodeUpdateCredits (node,
+                                   messagePIPGetRequestId (&message.u.pip),
+                                   messagePIPGetCredits (&message.u.pip));
             
             rlpItemRelease (node->coder.rlp, item);
             rlpItemRelease (node->coder.rlp, identifierItem);
@@ -2209,31 +2571,6 @@ nodeRecv (BREthereumNode node,
 }
 
 
-#pragma clang diagnostic push
-#pragma GCC diagnostic push
-#pragma clang diagnostic ignored "-Wunused-function"
-#pragma GCC diagnostic ignored "-Wunused-function"
-static uint64_t
-nodeEstimateCredits (BREthereumNode node,
-                     BREthereumMessage message) {
-    switch (message.identifier) {
-        case MESSAGE_P2P: return 0;
-        case MESSAGE_DIS: return 0;
-        case MESSAGE_ETH: return 0;
-        case MESSAGE_LES:
-            return (node->specs[message.u.les.identifier].baseCost +
-                    messageLESGetCreditsCount (&message.u.les) * node->specs[message.u.les.identifier].reqCost);
-        case MESSAGE_PIP: return 0;
-    }
-}
-
-static uint64_t
-nodeGetCredits (BREthereumNode node) {
-    return node->credits;
-}
-#pragma clang diagnostic pop
-#pragma GCC diagnostic pop
-
 /// MARK: - Discovered
 
 extern BREthereumBoolean
@@ -11,6 +11,7 @@
 #ifndef BR_Ethereum_Node_H
 #define BR_Ethereum_Node_H
 
+#include "support/BRPeerQuality.h"
 #include "BREthereumMessage.h"
 #include "BREthereumNodeEndpoint.h"
 #include "BREthereumProvision.h"
@@ -271,13 +272,53 @@ nodeHandleProvision (BREthereumNode node,
 extern BRArrayOf(BREthereumProvision)
 nodeUnhandleProvisions (BREthereumNode node);
 
+/**
+ * The credits we estimate the remote node has available for our requests - its flow control
+ * buffer, recharged since the last response, less the cost of our requests not yet sent.  If the
+ * remote node has no flow control, then UINT64_MAX.
+ */
+extern uint64_t
+nodeGetCreditsAvailable (BREthereumNode node);
+
+/**
+ * The number of requests of `type`, in a single message, that the remote node can handle
+ * within `credits`.  Zero if not even one request can be handled.
+ */
+extern size_t
+nodeGetProvisionCountForCredits (BREthereumNode node,
+                                 BREthereumProvisionType type,
+                                 uint64_t credits);
+
+/**
+ * The measured throughput, in provided requests per second; zero if not yet measured.
+ */
+extern double
+nodeGetThroughput (BREthereumNode node);
+
+/**
+ * The quality - measured latency, throughput, connection successes and misbehavior.  The quality
+ * is set from a prior LES instance so that we prefer nodes that have served us well.
+ */
+extern BRPeerQuality
+nodeGetQuality (BREthereumNode node);
+
+extern void
+nodeSetQuality (BREthereumNode node,
+                BRPeerQuality quality);
+
+/**
+ * The count of requests in provisions handled by `node` but not yet provided.
+ */
+extern size_t
+nodeGetProvisionsPendingCount (BREthereumNode node);
+
 extern const BREthereumNodeEndpoint
 nodeGetRemoteEndpoint (BREthereumNode node);
 
 extern const BREthereumNodeEndpoint
 nodeGetLocalEndpoint (BREthereumNode node);
 
-/** Compare nodes based on their priority and DIS neighbor distance */
+/** Compare nodes based on their priority, quality and DIS neighbor distance */
 extern BREthereumComparison
 nodeCompare (BREthereumNode node1,
              BREthereumNode node2);
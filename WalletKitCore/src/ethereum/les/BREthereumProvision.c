@@ -13,6 +13,32 @@
 
 static size_t minimum (size_t x, size_t  y) { return x < y ? x : y; }
 
+/// MARK: - Accounts
+
+// The hash index for the `index`-th requested account state; see BREthereumProvisionAccounts
+static size_t
+provisionAccountsGetHashIndex (BREthereumProvisionAccounts *provision, size_t index) {
+    return (NULL == provision->addresses ? index : index / array_count (provision->addresses));
+}
+
+// The address for the `index`-th requested account state
+static BREthereumAddress
+provisionAccountsGetAddress (BREthereumProvisionAccounts *provision, size_t index) {
+    return (NULL == provision->addresses
+            ? provision->address
+            : provision->addresses[index % array_count (provision->addresses)]);
+}
+
+static BRArrayOf(BREthereumAddress)
+provisionAccountsCopyAddresses (BRArrayOf(BREthereumAddress) addresses) {
+    if (NULL == addresses) return NULL;
+
+    BRArrayOf(BREthereumAddress) copy;
+    array_new (copy, array_count (addresses));
+    array_add_array (copy, addresses, array_count (addresses));
+    return copy;
+}
+
 extern const char *
 provisionErrorGetReasonName (BREthereumProvisionErrorReason reason) {
     static const char *names[] = {
@@ -190,24 +216,24 @@ provisionCreateMessageLES (BREthereumProvision *provisionMulti,
         case PROVISION_ACCOUNTS: {
             BREthereumProvisionAccounts *provision = &provisionMulti->u.accounts;
 
-            BREthereumAddress address = provision->address;
             BRArrayOf(BREthereumHash) hashes = provision->hashes;
-            size_t hashesCount = array_count(hashes);
+            size_t accountsCount = provisionAccountsGetCount (provision);
 
             if (NULL == provision->accounts) {
-                array_new (provision->accounts, hashesCount);
-                array_set_count (provision->accounts, hashesCount);
+                array_new (provision->accounts, accountsCount);
+                array_set_count (provision->accounts, accountsCount);
             }
 
-            size_t hashesOffset = index * messageContentLimit;
+            size_t accountsOffset = index * messageContentLimit;
 
             BRArrayOf(BREthereumLESMessageGetProofsSpec) specs;
-            array_new (specs, hashesCount);
+            array_new (specs, minimum (messageContentLimit, accountsCount - accountsOffset));
 
-            for (size_t i = 0; i < minimum (messageContentLimit, hashesCount - hashesOffset); i++) {
+            // With multiple addresses, the specs for one header are adjacent.
+            for (size_t i = 0; i < minimum (messageContentLimit, accountsCount - accountsOffset); i++) {
                 BREthereumLESMessageGetProofsSpec spec = {
-                    hashes[hashesOffset + i],
-                    address,
+                    hashes[provisionAccountsGetHashIndex (provision, accountsOffset + i)],
+                    provisionAccountsGetAddress (provision, accountsOffset + i),
                     0,
                 };
                 array_add (specs, spec);
@@ -422,8 +448,6 @@ provisionHandleMessageLES (BREthereumProvision *provisionMulti,
         case PROVISION_ACCOUNTS: {
             assert (LES_MESSAGE_PROOFS == message.identifier);
             BREthereumProvisionAccounts *provision = &provisionMulti->u.accounts;
-            BREthereumHash hash = ethAddressGetHash(provision->address);
-            BREthereumData key  = { sizeof(BREthereumHash), hash.bytes };
 
             // We'll fill this - at the proper index if a multiple provision.
             BRArrayOf(BREthereumAccountState) provisionAccounts = provision->accounts;
@@ -450,8 +474,13 @@ provisionHandleMessageLES (BREthereumProvision *provisionMulti,
                     // is be have an empty array for messagePaths - that is, no proofs and no
                     // non-proofs.  That is surely an error (boot the node), but...
                     BREthereumMPTNodePath path = messagePaths[index];
+                    BREthereumHash hash = ethAddressGetHash (provisionAccountsGetAddress (provision, offset + index));
+                    BREthereumHash root = provision->stateRoots[provisionAccountsGetHashIndex (provision, offset + index)];
+                    BREthereumData key  = { sizeof(BREthereumHash), hash.bytes };
                     BREthereumBoolean foundValue = ETHEREUM_BOOLEAN_FALSE;
-                    BRRlpData data = mptNodePathGetValue (path, key, &foundValue);
+                    BRRlpData data = (ETHEREUM_BOOLEAN_IS_TRUE (mptNodePathIsValidForRoot (path, key, root))
+                                      ? mptNodePathGetValue (path, key, &foundValue)
+                                      : (BRRlpData) { 0, NULL });
                     if (ETHEREUM_BOOLEAN_IS_TRUE(foundValue)) {
                         BRRlpItem item = rlpDataGetItem (coder, data);
                         provisionAccounts[offset + index] = accountStateRlpDecode (item, coder);
@@ -639,23 +668,24 @@ provisionCreateMessagePIP (BREthereumProvision *provisionMulti,
         case PROVISION_ACCOUNTS: {
             BREthereumProvisionAccounts *provision = &provisionMulti->u.accounts;
 
-            BREthereumHash addressHash = ethAddressGetHash(provision->address);
             BRArrayOf(BREthereumHash) hashes = provision->hashes;
-            size_t hashesCount = array_count(hashes);
+            size_t accountsCount = provisionAccountsGetCount (provision);
 
             if (NULL == provision->accounts) {
-                array_new (provision->accounts, hashesCount);
-                array_set_count (provision->accounts, hashesCount);
+                array_new (provision->accounts, accountsCount);
+                array_set_count (provision->accounts, accountsCount);
             }
 
-            size_t hashesOffset = index * messageContentLimit;
+            size_t accountsOffset = index * messageContentLimit;
 
             BRArrayOf(BREthereumPIPRequestInput) inputs;
             array_new (inputs, messageContentLimit);
-            for (size_t i = 0; i < minimum (messageContentLimit, hashesCount - hashesOffset); i++) {
+            for (size_t i = 0; i < minimum (messageContentLimit, accountsCount - accountsOffset); i++) {
                 BREthereumPIPRequestInput input = {
                     PIP_REQUEST_ACCOUNT,
-                    { .account = { hashes[hashesOffset + i], addressHash }}
+                    { .account = {
+                        hashes[provisionAccountsGetHashIndex (provision, accountsOffset + i)],
+                        ethAddressGetHash (provisionAccountsGetAddress (provision, accountsOffset + i)) }}
                 };
                 array_add (inputs, input);
             }
@@ -1062,7 +1092,9 @@ provisionCopy (BREthereumProvision *provision,
                 provision->type,
                 { .accounts = {
                     provision->u.accounts.address,
+                    provisionAccountsCopyAddresses (provision->u.accounts.addresses),
                     ethHashesCopy(provision->u.accounts.hashes),
+                    ethHashesCopy(provision->u.accounts.stateRoots),
                     NULL }}
             };
 
@@ -1093,16 +1125,19 @@ provisionReleaseResults (BREthereumProvision *provision) {
             if (NULL != provision->u.headers.headers)
                 // Sometimes the headers will be NULL - because we preallocated the response.
                 blockHeadersRelease(provision->u.headers.headers);
+            provision->u.headers.headers = NULL;
             break;
 
         case PROVISION_BLOCK_PROOFS:
             if (NULL != provision->u.proofs.proofs)
                 array_free (provision->u.proofs.proofs);
+            provision->u.proofs.proofs = NULL;
             break;
 
         case PROVISION_BLOCK_BODIES:
             if (NULL != provision->u.bodies.pairs)
                 blockBodyPairsRelease(provision->u.bodies.pairs);
+            provision->u.bodies.pairs = NULL;
             break;
 
         case PROVISION_TRANSACTION_RECEIPTS:
@@ -1112,16 +1147,19 @@ provisionReleaseResults (BREthereumProvision *provision) {
                     transactionReceiptsRelease (provision->u.receipts.receipts[index]);
                 array_free (provision->u.receipts.receipts);
             }
+            provision->u.receipts.receipts = NULL;
             break;
 
         case PROVISION_ACCOUNTS:
             if (NULL != provision->u.accounts.accounts)
                 array_free (provision->u.accounts.accounts);
+            provision->u.accounts.accounts = NULL;
             break;
 
         case PROVISION_TRANSACTION_STATUSES:
             if (NULL != provision->u.statuses.statuses)
                 array_free (provision->u.statuses.statuses);
+            provision->u.statuses.statuses = NULL;
             break;
 
         case PROVISION_SUBMIT_TRANSACTION:
@@ -1129,6 +1167,179 @@ provisionReleaseResults (BREthereumProvision *provision) {
     }
 }
 
+/// MARK: - Split / Join
+
+extern size_t
+provisionGetCount (BREthereumProvision *provision) {
+    switch (provision->type) {
+        case PROVISION_BLOCK_HEADERS:
+            return provision->u.headers.limit;
+        case PROVISION_BLOCK_PROOFS:
+            return array_count (provision->u.proofs.numbers);
+        case PROVISION_BLOCK_BODIES:
+            return array_count (provision->u.bodies.hashes);
+        case PROVISION_TRANSACTION_RECEIPTS:
+            return array_count (provision->u.receipts.hashes);
+        case PROVISION_ACCOUNTS:
+            return provisionAccountsGetCount (&provision->u.accounts);
+        case PROVISION_TRANSACTION_STATUSES:
+            return array_count (provision->u.statuses.hashes);
+        case PROVISION_SUBMIT_TRANSACTION:
+            return 1;
+    }
+}
+
+extern BREthereumBoolean
+provisionIsSplittable (BREthereumProvision *provision) {
+    switch (provision->type) {
+        case PROVISION_BLOCK_HEADERS:
+        case PROVISION_BLOCK_PROOFS:
+        case PROVISION_BLOCK_BODIES:
+        case PROVISION_TRANSACTION_RECEIPTS:
+            return ETHEREUM_BOOLEAN_TRUE;
+
+        // Accounts are requested for every address at every hash; statuses are few and a
+        // submission is just one.
+        case PROVISION_ACCOUNTS:
+        case PROVISION_TRANSACTION_STATUSES:
+        case PROVISION_SUBMIT_TRANSACTION:
+            return ETHEREUM_BOOLEAN_FALSE;
+    }
+}
+
+static BRArrayOf(uint64_t)
+numbersSplit (BRArrayOf(uint64_t) numbers, size_t offset, size_t count) {
+    BRArrayOf(uint64_t) result;
+    array_new (result, count);
+    array_add_array (result, &numbers[offset], count);
+    return result;
+}
+
+static BRArrayOf(BREthereumHash)
+hashesSplit (BRArrayOf(BREthereumHash) hashes, size_t offset, size_t count) {
+    BRArrayOf(BREthereumHash) result;
+    array_new (result, count);
+    array_add_array (result, &hashes[offset], count);
+    return result;
+}
+
+extern BREthereumProvision
+provisionSplit (BREthereumProvision *provision,
+                size_t offset,
+                size_t count) {
+    assert (offset + count <= provisionGetCount (provision));
+
+    switch (provision->type) {
+        case PROVISION_BLOCK_HEADERS: {
+            // The first header of the part is `offset` headers, each `skip + 1` blocks apart, from
+            // the provision's first header - in the direction of `reverse`.
+            uint64_t distance = offset * (1 + provision->u.headers.skip);
+            return (BREthereumProvision) {
+                PROVISION_IDENTIFIER_UNDEFINED,
+                provision->type,
+                { .headers = {
+                    (ETHEREUM_BOOLEAN_IS_TRUE (provision->u.headers.reverse)
+                     ? provision->u.headers.start - distance
+                     : provision->u.headers.start + distance),
+                    provision->u.headers.skip,
+                    (uint32_t) count,
+                    provision->u.headers.reverse,
+                    NULL }}
+            };
+        }
+
+        case PROVISION_BLOCK_PROOFS:
+            return (BREthereumProvision) {
+                PROVISION_IDENTIFIER_UNDEFINED,
+                provision->type,
+                { .proofs = {
+                    numbersSplit (provision->u.proofs.numbers, offset, count),
+                    NULL }}
+            };
+
+        case PROVISION_BLOCK_BODIES:
+            return (BREthereumProvision) {
+                PROVISION_IDENTIFIER_UNDEFINED,
+                provision->type,
+                { .bodies = {
+                    hashesSplit (provision->u.bodies.hashes, offset, count),
+                    NULL }}
+            };
+
+        case PROVISION_TRANSACTION_RECEIPTS:
+            return (BREthereumProvision) {
+                PROVISION_IDENTIFIER_UNDEFINED,
+                provision->type,
+                { .receipts = {
+                    hashesSplit (provision->u.receipts.hashes, offset, count),
+                    NULL }}
+            };
+
+        case PROVISION_ACCOUNTS:
+        case PROVISION_TRANSACTION_STATUSES:
+        case PROVISION_SUBMIT_TRANSACTION:
+            break;
+    }
+
+    // Not splittable; see provisionIsSplittable()
+    assert (0);
+    return (BREthereumProvision) { PROVISION_IDENTIFIER_UNDEFINED, provision->type };
+}
+
+// Move the results of a part, `partResults`, into `results` at `offset`.  The `results` are
+// allocated, as the provision's `total` results, when the first part joins.
+#define provisionJoinResults(results, total, offset, partResults)                   \
+    do {                                                                            \
+        if (NULL == (results)) {                                                    \
+            array_new ((results), (total));                                         \
+            array_set_count ((results), (total));                                   \
+        }                                                                           \
+        if (NULL != (partResults)) {                                                \
+            assert ((offset) + array_count (partResults) <= array_count (results)); \
+            memcpy (&(results)[(offset)], (partResults),                            \
+                    array_count (partResults) * sizeof (*(results)));               \
+            array_free (partResults);                                               \
+            (partResults) = NULL;                                                   \
+        }                                                                           \
+    } while (0)
+
+extern void
+provisionJoin (BREthereumProvision *provision,
+               size_t offset,
+               BREthereumProvision *part) {
+    assert (provision->type == part->type);
+    size_t total = provisionGetCount (provision);
+
+    switch (provision->type) {
+        case PROVISION_BLOCK_HEADERS:
+            provisionJoinResults (provision->u.headers.headers, total, offset,
+                                  part->u.headers.headers);
+            break;
+
+        case PROVISION_BLOCK_PROOFS:
+            provisionJoinResults (provision->u.proofs.proofs, total, offset,
+                                  part->u.proofs.proofs);
+            break;
+
+        case PROVISION_BLOCK_BODIES:
+            provisionJoinResults (provision->u.bodies.pairs, total, offset,
+                                  part->u.bodies.pairs);
+            break;
+
+        case PROVISION_TRANSACTION_RECEIPTS:
+            provisionJoinResults (provision->u.receipts.receipts, total, offset,
+                                  part->u.receipts.receipts);
+            break;
+
+        case PROVISION_ACCOUNTS:
+        case PROVISION_TRANSACTION_STATUSES:
+        case PROVISION_SUBMIT_TRANSACTION:
+            // Not splittable; see provisionIsSplittable()
+            assert (0);
+            break;
+    }
+}
+
 extern void
 provisionRelease (BREthereumProvision *provision,
                   BREthereumBoolean releaseResults) {
@@ -1152,8 +1363,12 @@ provisionRelease (BREthereumProvision *provision,
             break;
 
         case PROVISION_ACCOUNTS:
+            if (NULL != provision->u.accounts.addresses)
+                array_free (provision->u.accounts.addresses);
             if (NULL != provision->u.accounts.hashes)
                 array_free (provision->u.accounts.hashes);
+            if (NULL != provision->u.accounts.stateRoots)
+                array_free (provision->u.accounts.stateRoots);
             break;
 
         case PROVISION_TRANSACTION_STATUSES:
@@ -1213,6 +1428,11 @@ provisionAccountsConsume (BREthereumProvisionAccounts *provision,
 }
 
 
+extern size_t
+provisionAccountsGetCount (BREthereumProvisionAccounts *provision) {
+    return array_count (provision->hashes) * (NULL == provision->addresses ? 1 : array_count (provision->addresses));
+}
+
 extern void
 provisionStatusesConsume (BREthereumProvisionStatuses *provision,
                           BRArrayOf(BREthereumHash) *hashes,
@@ -119,11 +119,21 @@ provisionReceiptsConsume (BREthereumProvisionReceipts *provision,
 
 /**
  * Accounts
+ *
+ * If `addresses` is not NULL, then the account state of every address is requested at every
+ * hash (and `address` is unused).  The requests are batched into the same messages and the
+ * `accounts` response is ordered by hash, then by address - that is, the state for hashes[h] and
+ * addresses[a] is at accounts[h * array_count(addresses) + a].
+ *
+ * The `stateRoots` hold the stateRoot of the header for each of `hashes`; every account proof must
+ * be rooted at its header's stateRoot or the account state is reported as empty.
  */
 typedef struct {
     // Request
     BREthereumAddress address;
+    BRArrayOf(BREthereumAddress) addresses;
     BRArrayOf(BREthereumHash) hashes;
+    BRArrayOf(BREthereumHash) stateRoots;
     // Response
     BRArrayOf(BREthereumAccountState) accounts;
 } BREthereumProvisionAccounts;
@@ -133,6 +143,12 @@ provisionAccountsConsume (BREthereumProvisionAccounts *provision,
                           BRArrayOf(BREthereumHash) *hashes,
                           BRArrayOf(BREthereumAccountState) *accounts);
 
+/**
+ * The number of account states requested - one per hash for each address.
+ */
+extern size_t
+provisionAccountsGetCount (BREthereumProvisionAccounts *provision);
+
 /**
  * Transaction Statuses
  */
@@ -204,6 +220,38 @@ provisionRelease (BREthereumProvision *provision,
 extern void
 provisionReleaseResults (BREthereumProvision *provision);
 
+/**
+ * The number of individual requests in `provision` - such as the number of headers, of block
+ * numbers or of block hashes.
+ */
+extern size_t
+provisionGetCount (BREthereumProvision *provision);
+
+/**
+ * Check if `provision` can be split into parts, each part requesting a contiguous range of the
+ * provision's requests.  Headers, proofs, bodies and receipts can be split.
+ */
+extern BREthereumBoolean
+provisionIsSplittable (BREthereumProvision *provision);
+
+/**
+ * Create a new provision for the `count` requests of `provision` starting at `offset`.  The new
+ * provision has an undefined identifier, no results and its own copy of the requests.
+ */
+extern BREthereumProvision
+provisionSplit (BREthereumProvision *provision,
+                size_t offset,
+                size_t count);
+
+/**
+ * Join the results of `part`, split from `provision` at `offset`, into `provision`.  The results
+ * are moved; `part` is left without results.
+ */
+extern void
+provisionJoin (BREthereumProvision *provision,
+               size_t offset,
+               BREthereumProvision *part);
+
 extern BREthereumMessage
 provisionCreateMessage (BREthereumProvision *provision,
                         BREthereumMessageIdentifier type,
@@ -8,17 +8,134 @@
 //  See the LICENSE file at the project root for license information.
 //  See the CONTRIBUTORS file at the project root for a list of contributors.
 
+#include <pthread.h>
 #include "support/BRAssert.h"
+#include "support/BRSet.h"
 #include "BREthereumMPT.h"
 
 #undef MPT_SHOW_PROOF_NODES
 
+/// MARK: - MPT Node Cache
+
+/**
+ * The maximum number of verified nodes held in the shared node cache.  State trie nodes are at
+ * most ~530 bytes, so a full cache holds roughly 2MB of node encodings.
+ */
+#define MPT_NODE_CACHE_CAPACITY     (4096)
+
+typedef struct {
+    BREthereumHash hash;      // first, for ethHashSetValue()/ethHashSetEqual()
+    BRRlpData encoding;
+} BREthereumMPTNodeCacheEntry;
+
+/**
+ * A process-wide, bounded cache of MPT nodes whose hashes have been verified.  The cache is
+ * keyed by node hash; a node is known verified, without hashing, if its encoding is identical to
+ * the cached encoding for the hash that its parent references.  Proofs for different accounts,
+ * or for nearby blocks, share most of their upper nodes - the cache is shared across all proof
+ * verifications (and thus all BCS instances) so that only the novel, leaf-side nodes of a proof
+ * are hashed.  Entries are evicted oldest first.
+ */
+static struct {
+    pthread_mutex_t lock;
+    BRSetOf(BREthereumMPTNodeCacheEntry*) entries;
+    BREthereumMPTNodeCacheEntry *order[MPT_NODE_CACHE_CAPACITY];
+    size_t next;
+} mptNodeCache = { PTHREAD_MUTEX_INITIALIZER, NULL, { NULL }, 0 };
+
+static size_t
+mptNodeCacheEntryHashValue (const void *entry) {
+    return ethHashSetValue (&((const BREthereumMPTNodeCacheEntry *) entry)->hash);
+}
+
+static int
+mptNodeCacheEntryHashEqual (const void *entry1, const void *entry2) {
+    return ethHashSetEqual (&((const BREthereumMPTNodeCacheEntry *) entry1)->hash,
+                            &((const BREthereumMPTNodeCacheEntry *) entry2)->hash);
+}
+
+static void
+mptNodeCacheEntryRelease (BREthereumMPTNodeCacheEntry *entry) {
+    rlpDataRelease (entry->encoding);
+    free (entry);
+}
+
+static int
+mptNodeCacheHas (BREthereumHash hash,
+                 BRRlpData encoding) {
+    int found = 0;
+    pthread_mutex_lock (&mptNodeCache.lock);
+    if (NULL != mptNodeCache.entries) {
+        BREthereumMPTNodeCacheEntry *entry = BRSetGet (mptNodeCache.entries, &hash);
+        found = (NULL != entry &&
+                 entry->encoding.bytesCount == encoding.bytesCount &&
+                 0 == memcmp (entry->encoding.bytes, encoding.bytes, encoding.bytesCount));
+    }
+    pthread_mutex_unlock (&mptNodeCache.lock);
+    return found;
+}
+
+static void
+mptNodeCacheAdd (BREthereumHash hash,
+                 BRRlpData encoding) {
+    pthread_mutex_lock (&mptNodeCache.lock);
+    if (NULL == mptNodeCache.entries)
+        mptNodeCache.entries = BRSetNew (mptNodeCacheEntryHashValue,
+                                         mptNodeCacheEntryHashEqual,
+                                         MPT_NODE_CACHE_CAPACITY);
+
+    // Another thread may have verified the same node concurrently.
+    if (NULL == BRSetGet (mptNodeCache.entries, &hash)) {
+        BREthereumMPTNodeCacheEntry *oldest = mptNodeCache.order[mptNodeCache.next];
+        if (NULL != oldest) {
+            BRSetRemove (mptNodeCache.entries, oldest);
+            mptNodeCacheEntryRelease (oldest);
+        }
+
+        BREthereumMPTNodeCacheEntry *entry = malloc (sizeof (BREthereumMPTNodeCacheEntry));
+        entry->hash     = hash;
+        entry->encoding = rlpDataCopy (encoding);
+
+        BRSetAdd (mptNodeCache.entries, entry);
+        mptNodeCache.order[mptNodeCache.next] = entry;
+        mptNodeCache.next = (mptNodeCache.next + 1) % MPT_NODE_CACHE_CAPACITY;
+    }
+    pthread_mutex_unlock (&mptNodeCache.lock);
+}
+
+extern void
+mptNodeCacheClear (void) {
+    pthread_mutex_lock (&mptNodeCache.lock);
+    if (NULL != mptNodeCache.entries) {
+        BRSetFree (mptNodeCache.entries);
+        mptNodeCache.entries = NULL;
+    }
+    for (size_t index = 0; index < MPT_NODE_CACHE_CAPACITY; index++)
+        if (NULL != mptNodeCache.order[index]) {
+            mptNodeCacheEntryRelease (mptNodeCache.order[index]);
+            mptNodeCache.order[index] = NULL;
+        }
+    mptNodeCache.next = 0;
+    pthread_mutex_unlock (&mptNodeCache.lock);
+}
+
 /// MARK: - MPT Node
 
 typedef struct BREthereumMPTNodeRecord *BREthereumMPTNode;
 
+///
+/// A branch's or extension's reference to a child node.  A child whose RLP encoding is 32 bytes
+/// or more is referenced by its hash; a shorter child is embedded, as an RLP list, in its parent.
+/// An embedded child is decoded with its parent and needs no verification of its own.
+///
+typedef struct {
+    BREthereumHash hash;
+    BREthereumMPTNode embedded;   // NULL unless the child is embedded
+} BREthereumMPTNodeReference;
+
 struct BREthereumMPTNodeRecord {
     BREthereumMPTNodeType type;
+    BRRlpData encoding;       // the node's RLP encoding; hashed to verify the node
     union {
         struct {
             BREthereumData path;  // data w/ each byte a nibble a/ preface stripped!
@@ -27,11 +144,11 @@ struct BREthereumMPTNodeRecord {
 
         struct {
             BREthereumData path;  // data w/ each byte a nibble a/ preface stripped!
-            BREthereumHash key;
+            BREthereumMPTNodeReference key;
         } extension;
 
         struct {
-            BREthereumHash keys[16];
+            BREthereumMPTNodeReference keys[16];
             BRRlpData value;
         } branch;
     } u;
@@ -44,9 +161,16 @@ mptNodeCreate (BREthereumMPTNodeType type) {
     return node;
 }
 
+static int
+mptNodeReferenceIsEmpty (BREthereumMPTNodeReference reference) {
+    return (NULL == reference.embedded &&
+            ETHEREUM_BOOLEAN_IS_TRUE (ethHashEqual (reference.hash, EMPTY_HASH_INIT)));
+}
+
 static void
 mptNodeRelease (BREthereumMPTNode node) {
     if (NULL == node) return;  // On RLP coding error during 'nodes' processing
+    rlpDataRelease (node->encoding);
     switch (node->type) {
         case MPT_NODE_LEAF:
             ethDataRelease(node->u.leaf.path);
@@ -55,10 +179,13 @@ mptNodeRelease (BREthereumMPTNode node) {
 
         case MPT_NODE_EXTENSION:
             ethDataRelease (node->u.extension.path);
+            mptNodeRelease (node->u.extension.key.embedded);
             break;
 
         case MPT_NODE_BRANCH:
             rlpDataRelease (node->u.branch.value);
+            for (size_t index = 0; index < 16; index++)
+                mptNodeRelease (node->u.branch.keys[index].embedded);
             break;
     }
     free (node);
@@ -104,20 +231,71 @@ mptNodeConsume (BREthereumMPTNode node, uint8_t *key) {
         }
 
         case MPT_NODE_BRANCH: {
-            // We'll consume one byte if the node's key is not an empty hash
-            return (ETHEREUM_BOOLEAN_IS_TRUE (ethHashEqual (node->u.branch.keys[key[0]],
-                                                         EMPTY_HASH_INIT))
-                    ? 0
-                    : 1);
+            // We'll consume one byte if the node's key is not empty
+            return (mptNodeReferenceIsEmpty (node->u.branch.keys[key[0]]) ? 0 : 1);
         }
     }
 }
 
+///
+/// Return the reference to the child node reached from `node` by consuming `key`; the node must be
+/// an extension or a branch.
+///
+static BREthereumMPTNodeReference
+mptNodeGetChild (BREthereumMPTNode node, uint8_t *key) {
+    switch (node->type) {
+        case MPT_NODE_LEAF:      BRFail();
+        case MPT_NODE_EXTENSION: return node->u.extension.key;
+        case MPT_NODE_BRANCH:    return node->u.branch.keys[key[0]];
+    }
+}
+
+///
+/// Verify that `node` hashes to `hash`, whatever the size of its encoding.  The shared node cache
+/// is consulted first; only if the node is not cached is it hashed, and then added to the cache.
+///
+static BREthereumBoolean
+mptNodeIsVerified (BREthereumMPTNode node,
+                   BREthereumHash hash) {
+    if (mptNodeCacheHas (hash, node->encoding)) return ETHEREUM_BOOLEAN_TRUE;
+
+    if (ETHEREUM_BOOLEAN_IS_FALSE (ethHashEqual (hash, ethHashCreateFromData (node->encoding))))
+        return ETHEREUM_BOOLEAN_FALSE;
+
+    mptNodeCacheAdd (hash, node->encoding);
+    return ETHEREUM_BOOLEAN_TRUE;
+}
+
 #define NIBBLE_UPPER(x)     (0x0f & ((x) >> 4))
 #define NIBBLE_LOWER(x)     (0x0f & ((x) >> 0))
 
 #define NIBBLE_GET(x, upper) (0x0f & ((x) >> ((upper) ? 4 : 0)))
 
+static BREthereumMPTNode
+mptNodeDecode (BRRlpItem item,
+               BRRlpCoder coder);
+
+///
+/// Decode the reference to a child: either empty (0x), a hash (0x<32 bytes>) or, if `item` is
+/// an RLP list, the embedded child itself.
+///
+static BREthereumMPTNodeReference
+mptNodeReferenceDecode (BRRlpItem item,
+                        BRRlpCoder coder) {
+    BRRlpData data = rlpItemGetDataSharedDontRelease (coder, item);
+
+    if (0 == data.bytesCount || 1 == data.bytesCount)
+        return (BREthereumMPTNodeReference) { EMPTY_HASH_INIT, NULL };
+
+    if (data.bytes[0] >= 0xc0) {
+        BREthereumMPTNode embedded = mptNodeDecode (item, coder);
+        if (NULL != embedded) embedded->encoding = rlpDataCopy (data);
+        return (BREthereumMPTNodeReference) { EMPTY_HASH_INIT, embedded };
+    }
+
+    return (BREthereumMPTNodeReference) { ethHashRlpDecode (item, coder), NULL };
+}
+
 static BREthereumMPTNode
 mptNodeDecode (BRRlpItem item,
                BRRlpCoder coder) {
@@ -176,7 +354,7 @@ mptNodeDecode (BRRlpItem item,
 
                 case MPT_NODE_EXTENSION:
                     node->u.extension.path = path;
-                    node->u.extension.key = ethHashRlpDecode (items[1], coder);
+                    node->u.extension.key = mptNodeReferenceDecode (items[1], coder);
                     break;
 
                 case MPT_NODE_BRANCH:
@@ -187,13 +365,8 @@ mptNodeDecode (BRRlpItem item,
 
         case 17: {
             node = mptNodeCreate(MPT_NODE_BRANCH);
-            for (size_t index = 0; index < 16; index++) {
-                BRRlpData data = rlpItemGetDataSharedDontRelease (coder, items[index]);
-                // Either a hash (0x<32 bytes>) or empty (0x)
-                node->u.branch.keys[index] = (0 == data.bytesCount || 1 == data.bytesCount
-                                              ? EMPTY_HASH_INIT
-                                              : ethHashRlpDecode(items[index], coder));
-            }
+            for (size_t index = 0; index < 16; index++)
+                node->u.branch.keys[index] = mptNodeReferenceDecode (items[index], coder);
             node->u.branch.value = rlpItemGetData (coder, items[16]);
             break;
         }
@@ -240,8 +413,11 @@ mptNodePathDecode (BRRlpItem item,
 
     BRArrayOf (BREthereumMPTNode) nodes;
     array_new (nodes, itemsCount);
-    for (size_t index = 0; index < itemsCount; index++)
-        array_add (nodes, mptNodeDecode (items[index], coder));
+    for (size_t index = 0; index < itemsCount; index++) {
+        BREthereumMPTNode node = mptNodeDecode (items[index], coder);
+        if (NULL != node) node->encoding = rlpItemGetData (coder, items[index]);
+        array_add (nodes, node);
+    }
 
     return mptNodePathCreate(nodes);
 }
@@ -259,7 +435,9 @@ mptNodePathDecodeFromBytes (BRRlpItem item,
         // and then RLP encode the bytes (but this time as RLP items.... got it??).
         BRRlpData data = rlpDecodeBytesSharedDontRelease (coder, items[index]);
         BRRlpItem item = rlpDataGetItem(coder, data);
-        array_add (nodes, mptNodeDecode (item, coder));
+        BREthereumMPTNode node = mptNodeDecode (item, coder);
+        if (NULL != node) node->encoding = rlpDataCopy (data);
+        array_add (nodes, node);
 #if defined (MPT_SHOW_PROOF_NODES)
         rlpShowItem (coder, item, "MPTN");
 #endif
@@ -271,9 +449,43 @@ mptNodePathDecodeFromBytes (BRRlpItem item,
     return mptNodePathCreate(nodes);
 }
 
-extern BREthereumMPTNode
-mptNodePathGetNode (BREthereumMPTNodePath path,
-                    BREthereumData key) {
+///
+/// Follow `reference` from the node at `*index` in `path` to the child node.  An embedded child is
+/// the child; a node in `path` that repeats the embedded child is skipped.  Otherwise the child is
+/// the next node in `path`, which must hash to the reference.  Returns NULL if there is no child.
+///
+static BREthereumMPTNode
+mptNodePathFollow (BREthereumMPTNodePath path,
+                   size_t *index,
+                   BREthereumMPTNodeReference reference) {
+    BREthereumMPTNode next = (*index + 1 < array_count (path->nodes)
+                              ? path->nodes[*index + 1]
+                              : NULL);
+
+    if (NULL != reference.embedded) {
+        if (NULL != next &&
+            next->encoding.bytesCount == reference.embedded->encoding.bytesCount &&
+            0 == memcmp (next->encoding.bytes, reference.embedded->encoding.bytes, next->encoding.bytesCount))
+            *index += 1;
+        return reference.embedded;
+    }
+
+    if (NULL == next || ETHEREUM_BOOLEAN_IS_FALSE (mptNodeIsVerified (next, reference.hash)))
+        return NULL;
+
+    *index += 1;
+    return next;
+}
+
+///
+/// Walk the path's nodes, consuming `key`, and return the node holding the key's value or NULL.
+/// Each node reached from its parent by hash must hash to the parent's reference; an embedded node
+/// is taken from its parent.  If `root` is not NULL then the first node must hash to `root`.
+///
+static BREthereumMPTNode
+mptNodePathGetNodeVerified (BREthereumMPTNodePath path,
+                            BREthereumData key,
+                            const BREthereumHash *root) {
     size_t  keyEncodedCount = 2 * key.count;
     uint8_t keyEncoded [keyEncodedCount];
 
@@ -284,42 +496,73 @@ mptNodePathGetNode (BREthereumMPTNodePath path,
         keyEncoded [2 * index + 1] = NIBBLE_LOWER(byte);
     }
 
-    uint8_t keyEncodedIndex = 0;
+    size_t keyEncodedIndex = 0;
+
+    if (0 == array_count (path->nodes) || NULL == path->nodes[0]) return NULL;
+
+    // The root is referenced by hash, no matter how short its encoding.
+    if (NULL != root && ETHEREUM_BOOLEAN_IS_FALSE (mptNodeIsVerified (path->nodes[0], *root)))
+        return NULL;
 
-    // Walk the nodes, consuming the key if possible.
-    for (size_t index = 0; index < array_count (path->nodes); index++) {
-        BREthereumMPTNode node = path->nodes[index];
+    // Walk the nodes, consuming the key if possible.  Every step consumes at least one nibble.
+    size_t index = 0;
+    BREthereumMPTNode node = path->nodes[0];
+
+    while (NULL != node) {
         size_t keyEncodedIncrement = mptNodeConsume (node, &keyEncoded[keyEncodedIndex]);
 
         // nothing consumed, definitively node missed
         if (0 == keyEncodedIncrement)
             break;
 
-        keyEncodedIndex += keyEncodedIncrement;
-
         // If all of key is consumed, then done.
-        if (keyEncodedCount == keyEncodedIndex) {
+        if (keyEncodedCount == keyEncodedIndex + keyEncodedIncrement) {
             // We have a screwy case here... we've seen a subsequent 'leaf' node, without any
             // path, holding the 'value'.  Not sure why (Parity bug submitted); we'll try to
-            // pick out that node
-            if (index + 1 + 1 == array_count(path->nodes) &&       // one node remains...
-                MPT_NODE_LEAF == path->nodes[index + 1]->type &&   // it is a leaf node
-                0 == path->nodes[index + 1]->u.leaf.path.count)    // it has no path
-                return path->nodes[index + 1];
-
+            // pick out that node - as any other child, it must match this node's reference.
+            if (MPT_NODE_LEAF != node->type) {
+                BREthereumMPTNode next = mptNodePathFollow (path, &index,
+                                                            mptNodeGetChild (node, &keyEncoded[keyEncodedIndex]));
+                if (NULL != next &&
+                    MPT_NODE_LEAF == next->type &&
+                    0 == next->u.leaf.path.count)
+                    return next;
+            }
             return node;
         }
+
+        // A leaf, with key remaining, is a miss.
+        if (MPT_NODE_LEAF == node->type)
+            break;
+
+        // The next node must be the one that this node references.
+        node = mptNodePathFollow (path, &index, mptNodeGetChild (node, &keyEncoded[keyEncodedIndex]));
+
+        keyEncodedIndex += keyEncodedIncrement;
     }
 
     return NULL;
 }
 
+extern BREthereumMPTNode
+mptNodePathGetNode (BREthereumMPTNodePath path,
+                    BREthereumData key) {
+    return mptNodePathGetNodeVerified (path, key, NULL);
+}
+
 extern BREthereumBoolean
 mptNodePathIsValid (BREthereumMPTNodePath path,
                     BREthereumData key) {
     return AS_ETHEREUM_BOOLEAN (NULL != mptNodePathGetNode (path, key));
 }
 
+extern BREthereumBoolean
+mptNodePathIsValidForRoot (BREthereumMPTNodePath path,
+                           BREthereumData key,
+                           BREthereumHash root) {
+    return AS_ETHEREUM_BOOLEAN (NULL != mptNodePathGetNodeVerified (path, key, &root));
+}
+
 extern BRRlpData
 mptNodePathGetValue (BREthereumMPTNodePath path,
                       BREthereumData key,
@@ -65,6 +65,23 @@ extern BREthereumBoolean
 mptNodePathIsValid (BREthereumMPTNodePath path,
                     BREthereumData key);
 
+/**
+ * Check that `path` proves `key` and that it is rooted at `root`.  The first node must hash to
+ * `root` (typically a block header's stateRoot) and every node referenced by hash must hash to
+ * the reference held by its parent; only a node embedded in its parent is not hashed.  Verified
+ * nodes are held in a shared, bounded cache; nodes already in the cache are not hashed again.
+ */
+extern BREthereumBoolean
+mptNodePathIsValidForRoot (BREthereumMPTNodePath path,
+                           BREthereumData key,
+                           BREthereumHash root);
+
+/**
+ * Release all nodes held in the shared cache of verified MPT nodes.
+ */
+extern void
+mptNodeCacheClear (void);
+
 extern BREthereumMPTNodePath
 mptNodePathDecode (BRRlpItem item,
                    BRRlpCoder coder);
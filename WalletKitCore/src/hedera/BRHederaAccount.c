@@ -14,7 +14,10 @@
 
 #include <stdlib.h>
 #include <assert.h>
+#include <pthread.h>
 #include "support/BRArray.h"
+#include "support/BRCrypto.h"
+#include "support/BROSCompat.h"
 
 #define HEDERA_EXCHANGE_RATE                     0.03  // 1 Hbar == 0.03 USD (3 US Cents)
 #define HEDERA_WALLET_CREATE_FEE_TINY_BAR       (0.01     * HEDERA_HBAR_SCALE_FACTOR / HEDERA_EXCHANGE_RATE)  // 1.0    US Cents
@@ -33,6 +36,11 @@ struct BRHederaAccountRecord {
     BRArrayOf(BRHederaAddress) nodes;
     BRHederaFeeBasis feeBasis;
 
+    // The signing key expanded from the seed, so that signing doesn't derive and expand it again;
+    // it's valid when signingKeySeedHash is the SHA256 of the seed it came from.
+    BREd25519Key signingKey;
+    UInt256 signingKeySeedHash;
+    pthread_mutex_t lock;
 };
 
 static BRHederaAccount
@@ -40,6 +48,7 @@ hederaAccountCreate (BRHederaAddress address) {
     BRHederaAccount account = calloc(1, sizeof(struct BRHederaAccountRecord));
 
     account->address = address;
+    pthread_mutex_init_brd (&account->lock, PTHREAD_MUTEX_NORMAL);
 
     // TODO - do we just hard code Hedera nodes here - we probably can for now
     // but perhaps in the future there will be additional shards/realms
@@ -110,6 +119,10 @@ extern void hederaAccountFree (BRHederaAccount account)
     }
     array_free(account->nodes);
 
+    BREd25519KeyClean (&account->signingKey);
+    mem_clean (&account->signingKeySeedHash, sizeof(UInt256));
+    pthread_mutex_destroy (&account->lock);
+
     free(account);
 }
 
@@ -131,6 +144,40 @@ extern BRKey hederaAccountGetPublicKey (BRHederaAccount account)
     return key;
 }
 
+extern int
+hederaAccountGetSigningKey (BRHederaAccount account, UInt512 seed, BREd25519Key *key)
+{
+    assert (account);
+    assert (key);
+
+    UInt256 seedHash;
+    BRSHA256 (seedHash.u8, seed.u8, sizeof(seed));
+
+    pthread_mutex_lock (&account->lock);
+    int valid = UInt256Eq (seedHash, account->signingKeySeedHash);
+
+    if (!valid) {
+        // Expand the key and check that the seed is this account's before caching it
+        BRKey privateKey = hederaKeyCreate (seed);
+        BREd25519Key signingKey;
+        BREd25519KeySetSeed (&signingKey, privateKey.secret.u8);
+        BRKeyClean (&privateKey);
+
+        valid = (0 == memcmp (signingKey.pubKey, account->publicKey, HEDERA_PUBLIC_KEY_SIZE));
+        if (valid) {
+            account->signingKey = signingKey;
+            account->signingKeySeedHash = seedHash;
+        }
+        BREd25519KeyClean (&signingKey);
+    }
+
+    if (valid) *key = account->signingKey;
+    pthread_mutex_unlock (&account->lock);
+
+    mem_clean (&seedHash, sizeof(UInt256));
+    return valid;
+}
+
 extern uint8_t *
 hederaAccountGetPublicKeyBytes (BRHederaAccount account, size_t *bytesCount) {
     uint8_t *bytes = malloc (HEDERA_PUBLIC_KEY_SIZE);
@@ -14,6 +14,7 @@
 
 #include "support/BRKey.h"
 #include "support/BRInt.h"
+#include "support/BRKeyEd25519.h"
 #include "BRHederaBase.h"
 #include "BRHederaAddress.h"
 #include "BRHederaFeeBasis.h"
@@ -81,6 +82,20 @@ extern void hederaAccountSetAddress (BRHederaAccount account, BRHederaAddress ac
  */
 extern BRKey hederaAccountGetPublicKey (BRHederaAccount account);
 
+/**
+ * Get the Ed25519 signing key for this Hedera account.  The key is expanded from the seed
+ * once and kept by the account, so that signing again with the same seed doesn't repeat
+ * the derivation.
+ *
+ * @param account
+ * @param seed    - seed for this account
+ * @param key     - set to the signing key, which the caller should wipe with BREd25519KeyClean()
+ *
+ * @return true if the key was set, false if the seed doesn't belong to this account
+ */
+extern int
+hederaAccountGetSigningKey (BRHederaAccount account, UInt512 seed, BREd25519Key *key);
+
 extern uint8_t *
 hederaAccountGetPublicKeyBytes (BRHederaAccount account, size_t *bytesCount);
 
@@ -11,7 +11,7 @@
 #include "BRHederaTransaction.h"
 #include "BRHederaCrypto.h"
 #include "BRHederaSerialize.h"
-#include "ed25519/ed25519.h"
+#include "support/BRKeyEd25519.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
@@ -177,24 +177,24 @@ hederaTransactionGetMemo(BRHederaTransaction transaction)
 
 extern size_t
 hederaTransactionSignTransaction (BRHederaTransaction transaction,
-                                  BRKey publicKey,
+                                  BRHederaAccount account,
                                   UInt512 seed)
 {
     assert (transaction);
+    assert (account);
 
     // If previously signed - delete and resign
     if (transaction->serializedBytes) {
         free (transaction->serializedBytes);
+        transaction->serializedBytes = NULL;
         transaction->serializedSize = 0;
     }
 
-    BRHederaUnitTinyBar fee = hederaFeeBasisGetFee(&transaction->feeBasis);
+    // The account holds the signing key once it has been expanded from the seed
+    BREd25519Key signingKey;
+    if (!hederaAccountGetSigningKey (account, seed, &signingKey)) return 0;
 
-    // Generate the private key from the seed
-    BRKey key = hederaKeyCreate (seed);
-    unsigned char privateKey[64] = {0};
-    unsigned char temp[32] = {0}; // Use the public key that is sent in instead
-    ed25519_create_keypair (temp, privateKey, key.secret.u8);
+    BRHederaUnitTinyBar fee = hederaFeeBasisGetFee(&transaction->feeBasis);
 
     // First we need to serialize the body since it is the thing we sign
     size_t bodySize;
@@ -209,12 +209,15 @@ hederaTransactionSignTransaction (BRHederaTransaction transaction,
 
     // Create signature from the body bytes
     unsigned char signature[64];
+    uint8_t publicKey[32];
     memset (signature, 0x00, 64);
-    ed25519_sign(signature, body, bodySize, publicKey.pubKey, privateKey);
+    BREd25519Sign (&signingKey, signature, body, bodySize);
+    memcpy (publicKey, signingKey.pubKey, 32);
+    BREd25519KeyClean (&signingKey);
 
     // Serialize the full transaction including signature and public key
     uint8_t * serializedBytes = hederaTransactionPack (signature, 64,
-                                                       publicKey.pubKey, 32,
+                                                       publicKey, 32,
                                                        body, bodySize,
                                                        &transaction->serializedSize);
 
@@ -73,17 +73,15 @@ extern void hederaTransactionFree (BRHederaTransaction transaction);
  * Sign a Hedera transaction
  *
  * @param transaction
- * @param public key      - of the source account
- * @param timeStamp       - used to create the transaction id - just use current
- *                          time
- * @param fee             - max number of tinybars the caller is willing to pay
+ * @param account         - the source account
  * @param seed            - seed for this account, used to create private key
  *
- * @return size           - number of bytes in the signed transaction
+ * @return size           - number of bytes in the signed transaction, or 0 if the seed is not
+ *                          the account's or the signature does not verify
  */
 extern size_t
 hederaTransactionSignTransaction (BRHederaTransaction transaction,
-                                  BRKey publicKey,
+                                  BRHederaAccount account,
                                   UInt512 seed);
 
 /**
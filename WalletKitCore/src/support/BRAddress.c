@@ -257,55 +257,92 @@ int BRScriptPubKeyIsValid(const uint8_t *script, size_t scriptLen)
     return r;
 }
 
+// returns the offset of the 20byte (32byte for P2WSH) hash in a standard scriptPubKey, and its type
+// a script matching one of these byte templates is exactly one that BRScriptElements() would parse as the template
+static size_t _BRScriptTemplateHash(const uint8_t *script, size_t scriptLen, BRScriptType *type)
+{
+    if (scriptLen == 25 && script[0] == OP_DUP && script[1] == OP_HASH160 && script[2] == 20 &&
+        script[23] == OP_EQUALVERIFY && script[24] == OP_CHECKSIG) {
+        *type = BRScriptTypeP2PKH;
+        return 3;
+    }
+    else if (scriptLen == 23 && script[0] == OP_HASH160 && script[1] == 20 && script[22] == OP_EQUAL) {
+        *type = BRScriptTypeP2SH;
+        return 2;
+    }
+    else if (scriptLen == 22 && (script[0] == OP_0 || (script[0] >= OP_1 && script[0] <= OP_16)) && script[1] == 20) {
+        *type = BRScriptTypeP2WPKH;
+        return 2;
+    }
+    else if (scriptLen == 34 && script[0] == OP_0 && script[1] == 32) {
+        *type = BRScriptTypeP2WSH;
+        return 2;
+    }
+
+    *type = BRScriptTypeNonStandard;
+    return 0;
+}
+
 // returns a pointer to the 20byte pubkey-hash, or NULL if none
 const uint8_t *BRScriptPKH(const uint8_t *script, size_t scriptLen)
 {
     assert(script != NULL || scriptLen == 0);
     if (! script || scriptLen == 0 || scriptLen > MAX_SCRIPT_LENGTH) return NULL;
 
-    const uint8_t *elems[BRScriptElements(NULL, 0, script, scriptLen)], *r = NULL;
-    size_t l, count = BRScriptElements(elems, sizeof(elems)/sizeof(*elems), script, scriptLen);
-    
-    if (count == 5 && *elems[0] == OP_DUP && *elems[1] == OP_HASH160 && *elems[2] == 20 &&
-        *elems[3] == OP_EQUALVERIFY && *elems[4] == OP_CHECKSIG) {
-        r = BRScriptData(elems[2], &l); // pay-to-pubkey-hash
-    }
-    else if (count == 3 && *elems[0] == OP_HASH160 && *elems[1] == 20 && *elems[2] == OP_EQUAL) {
-        r = BRScriptData(elems[1], &l); // pay-to-script-hash
-    }
-    else if (count == 2 && (*elems[0] == OP_0 || (*elems[0] >= OP_1 && *elems[0] <= OP_16)) && *elems[1] == 20) {
-        r = BRScriptData(elems[1], &l); // pay-to-witness
-    }
-    
-    return r;
+    BRScriptType type;
+    size_t off = _BRScriptTemplateHash(script, scriptLen, &type);
+
+    return (type == BRScriptTypeP2PKH || type == BRScriptTypeP2SH || type == BRScriptTypeP2WPKH) ? &script[off] : NULL;
 }
 
-// writes the 20byte pubkey hash from signature to pkh20 and returns the number of bytes written
-size_t BRSignaturePKH(uint8_t *pkh20, const uint8_t *signature, size_t sigLen)
+// classifies scriptPubKey by matching its bytes against the standard templates, without parsing it into elements
+// writes the 20byte hash (32byte for P2WSH) it pays to to hash, which is the hash BRScriptPKH() returns
+BRScriptType BRScriptClassify(uint8_t hash[32], const uint8_t *script, size_t scriptLen)
 {
-    assert(pkh20 != NULL);
-    assert(signature != NULL || sigLen == 0);
-    if (! signature || sigLen == 0 || sigLen > MAX_SCRIPT_LENGTH) return 0;
-    
+    BRScriptType type = BRScriptTypeNonStandard;
+    size_t off;
+
+    assert(hash != NULL);
+    assert(script != NULL || scriptLen == 0);
+    if (! script || scriptLen == 0 || scriptLen > MAX_SCRIPT_LENGTH) return type;
+
+    off = _BRScriptTemplateHash(script, scriptLen, &type);
+    if (type != BRScriptTypeNonStandard) memcpy(hash, &script[off], (type == BRScriptTypeP2WSH) ? 32 : 20);
+    return type;
+}
+
+static BRScriptType _BRSignaturePKH(uint8_t *pkh20, const uint8_t *signature, size_t sigLen)
+{
+    if (! signature || sigLen == 0 || sigLen > MAX_SCRIPT_LENGTH) return BRScriptTypeNonStandard;
+
     const uint8_t *d = NULL, *elems[BRScriptElements(NULL, 0, signature, sigLen)];
-    size_t r = 0, l = 0, count = BRScriptElements(elems, sizeof(elems)/sizeof(*elems), signature, sigLen);
-    
+    size_t l = 0, count = BRScriptElements(elems, sizeof(elems)/sizeof(*elems), signature, sigLen);
+    BRScriptType r = BRScriptTypeNonStandard;
+
     if (count == 2 && *elems[0] <= OP_PUSHDATA4 && (*elems[1] == 65 || *elems[1] == 33)) {
         // pay-to-pubkey-hash scriptSig
         d = BRScriptData(elems[1], &l);
         if (l != 65 && l != 33) d = NULL;
-        if (d) BRHash160(pkh20, d, l), r = 20;
+        if (d) BRHash160(pkh20, d, l), r = BRScriptTypeP2PKH;
     }
     else if (count >= 1 && *elems[count - 1] <= OP_PUSHDATA4 && *elems[count - 1] > 0 &&
              (count >= 2 || ((d = BRScriptData(elems[0], &l)) && (d[0] == OP_0 || (d[0] >= OP_1 && d[0] <= OP_16))))) {
         // pay-to-script-hash scriptSig
         d = BRScriptData(elems[count - 1], &l);
-        if (d) BRHash160(pkh20, d, l), r = 20;
+        if (d) BRHash160(pkh20, d, l), r = BRScriptTypeP2SH;
     }
-    
+
     return r;
 }
 
+// writes the 20byte pubkey hash from signature to pkh20 and returns the number of bytes written
+size_t BRSignaturePKH(uint8_t *pkh20, const uint8_t *signature, size_t sigLen)
+{
+    assert(pkh20 != NULL);
+    assert(signature != NULL || sigLen == 0);
+    return (_BRSignaturePKH(pkh20, signature, sigLen) != BRScriptTypeNonStandard) ? 20 : 0;
+}
+
 // writes the 20byte pubkey hash from witness to pkh20 and returns the number of bytes written
 size_t BRWitnessPKH(uint8_t *pkh20, const uint8_t *witness, size_t witLen)
 {
@@ -326,6 +363,19 @@ size_t BRWitnessPKH(uint8_t *pkh20, const uint8_t *witness, size_t witLen)
     return r;
 }
 
+// classifies the spend of an output by witness if witLen > 0, otherwise by signature
+// writes the 20byte hash that BRWitnessPKH() or BRSignaturePKH() would to pkh20, if type isn't BRScriptTypeNonStandard
+BRScriptType BRSignatureClassify(uint8_t pkh20[20], const uint8_t *signature, size_t sigLen,
+                                 const uint8_t *witness, size_t witLen)
+{
+    assert(pkh20 != NULL);
+    assert(signature != NULL || sigLen == 0);
+    assert(witness != NULL || witLen == 0);
+
+    if (witLen > 0) return (BRWitnessPKH(pkh20, witness, witLen) > 0) ? BRScriptTypeP2WPKH : BRScriptTypeNonStandard;
+    return _BRSignaturePKH(pkh20, signature, sigLen);
+}
+
 // writes the bitcoin address for a scriptPubKey to addr
 // returns the number of bytes written, or addrLen needed if addr is NULL
 size_t BRAddressFromScriptPubKey(char *addr, size_t addrLen, BRAddressParams params,
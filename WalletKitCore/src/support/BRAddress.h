@@ -90,6 +90,24 @@ size_t BRSignaturePKH(uint8_t *pkh20, const uint8_t *signature, size_t sigLen);
   
 // writes the 20byte pubkey hash from witness to pkh20 and returns the number of bytes written
 size_t BRWitnessPKH(uint8_t *pkh20, const uint8_t *witness, size_t witLen);
+
+typedef enum {
+    BRScriptTypeUnclassified = 0, // not yet classified, a zeroed struct is unclassified
+    BRScriptTypeNonStandard,
+    BRScriptTypeP2PKH,  // pay-to-pubkey-hash, or a scriptSig spending one
+    BRScriptTypeP2SH,   // pay-to-script-hash, or a scriptSig spending one
+    BRScriptTypeP2WPKH, // pay-to-witness with a 20byte program (P2WPKH for witness version 0), or a witness spending one
+    BRScriptTypeP2WSH   // pay-to-witness-script-hash with a 32byte program
+} BRScriptType;
+
+// classifies scriptPubKey by matching its bytes against the standard templates, without parsing it into elements
+// writes the 20byte hash (32byte for P2WSH) it pays to to hash, which is the hash BRScriptPKH() returns
+BRScriptType BRScriptClassify(uint8_t hash[32], const uint8_t *script, size_t scriptLen);
+
+// classifies the spend of an output by witness if witLen > 0, otherwise by signature
+// writes the 20byte hash that BRWitnessPKH() or BRSignaturePKH() would to pkh20, if type isn't BRScriptTypeNonStandard
+BRScriptType BRSignatureClassify(uint8_t pkh20[20], const uint8_t *signature, size_t sigLen,
+                                 const uint8_t *witness, size_t witLen);
    
 typedef struct {
     uint8_t pubKeyPrefix;
@@ -25,13 +25,19 @@
 #include "BRBIP32Sequence.h"
 #include "BRCrypto.h"
 #include "BRBase58.h"
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #define BIP32_SEED_KEY "Bitcoin seed"
 #define BIP32_XPRV     "\x04\x88\xAD\xE4"
 #define BIP32_XPUB     "\x04\x88\xB2\x1E"
 
+#define BIP32_LIST_MAX_THREADS      64
+#define BIP32_LIST_MIN_THREAD_KEYS  8
+
 // BIP32 is a scheme for deriving chains of addresses from a seed value
 // https://github.com/bitcoin/bips/blob/master/bip-0032.mediawiki
 
@@ -49,7 +55,8 @@
 // - In case parse256(IL) >= n or ki = 0, the resulting key is invalid, and one should proceed with the next value for i
 //   (Note: this has probability lower than 1 in 2^127.)
 //
-static void _CKDpriv(UInt256 *k, UInt256 *c, uint32_t i)
+// P is point(k), it's only used for a normal child and is computed if NULL
+static void _CKDprivP(UInt256 *k, UInt256 *c, const BRECPoint *P, uint32_t i)
 {
     uint8_t buf[sizeof(BRECPoint) + sizeof(i)];
     UInt512 I;
@@ -58,6 +65,7 @@ static void _CKDpriv(UInt256 *k, UInt256 *c, uint32_t i)
         buf[0] = 0;
         UInt256Set(&buf[1], *k);
     }
+    else if (P) *(BRECPoint *)buf = *P;
     else BRSecp256k1PointGen((BRECPoint *)buf, k);
     
     UInt32SetBE(&buf[sizeof(BRECPoint)], i);
@@ -71,6 +79,11 @@ static void _CKDpriv(UInt256 *k, UInt256 *c, uint32_t i)
     mem_clean(buf, sizeof(buf));
 }
 
+static void _CKDpriv(UInt256 *k, UInt256 *c, uint32_t i)
+{
+    _CKDprivP(k, c, NULL, i);
+}
+
 // Public parent key -> public child key
 //
 // CKDpub((Kpar, cpar), i) -> (Ki, ci) computes a child extended public key from the parent extended public key.
@@ -154,6 +167,111 @@ size_t BRBIP32PubKey(uint8_t *pubKey, size_t pubKeyLen, BRMasterPubKey mpk, uint
     return (! pubKey || sizeof(BRECPoint) <= pubKeyLen) ? sizeof(BRECPoint) : 0;
 }
 
+// returns the extended public key for path N(m/0H/chain), for repeated use with BRBIP32PubKeyList()
+BRBIP32ChainKey BRBIP32ChainPubKey(BRMasterPubKey mpk, uint32_t chain)
+{
+    BRBIP32ChainKey chainKey;
+    
+    assert(memcmp(&mpk, &BR_MASTER_PUBKEY_NONE, sizeof(mpk)) != 0);
+    chainKey.chainCode = mpk.chainCode;
+    chainKey.pubKey = *(BRECPoint *)mpk.pubKey;
+    _CKDpub(&chainKey.pubKey, &chainKey.chainCode, chain); // path N(m/0H/chain)
+    return chainKey;
+}
+
+typedef struct {
+    BRECPoint *pubKeys;
+    size_t count;
+    const BRBIP32ChainKey *chainKey;
+    uint32_t index;
+    size_t written;
+} BRBIP32PubKeyJob;
+
+// derives a contiguous run of normal children of job->chainKey, the hmac is keyed with the chain code only once, and
+// the points are computed in a single batch once all the tweaks are known
+static void *_BRBIP32PubKeyListThread(void *info)
+{
+    BRBIP32PubKeyJob *job = info;
+    UInt256 *tweaks = malloc(job->count*sizeof(*tweaks));
+    BRHMACContext key, ctx;
+    uint8_t buf[sizeof(BRECPoint) + sizeof(uint32_t)];
+    UInt512 I;
+    
+    assert(tweaks != NULL);
+    BRHMACInit(&key, BRSHA512, sizeof(UInt512), &job->chainKey->chainCode, sizeof(UInt256));
+    *(BRECPoint *)buf = job->chainKey->pubKey;
+    
+    for (size_t i = 0; i < job->count; i++) {
+        UInt32SetBE(&buf[sizeof(BRECPoint)], job->index + (uint32_t)i);
+        ctx = key;
+        BRHMACUpdate(&ctx, buf, sizeof(buf));
+        BRHMACFinal(&ctx, &I); // I = HMAC-SHA512(c, P(K) || i)
+        tweaks[i] = *(UInt256 *)&I; // IL, the chain code IR isn't needed for a leaf key
+    }
+    
+    job->written = BRSecp256k1PointAddList(job->pubKeys, &job->chainKey->pubKey, tweaks, job->count); // K = P(IL) + K
+    var_clean(&I);
+    mem_clean(&key, sizeof(key));
+    mem_clean(tweaks, job->count*sizeof(*tweaks));
+    free(tweaks);
+    return NULL;
+}
+
+// writes the public keys for paths N(m/0H/chain/index) through N(m/0H/chain/index + count - 1) to pubKeys, where
+// chainKey is the result of BRBIP32ChainPubKey(), the work is split across up to threadCount threads, or one per cpu
+// if threadCount is 0
+// returns number of keys written, which is less than count only if a key in the range is invalid
+size_t BRBIP32PubKeyList(BRECPoint pubKeys[], size_t count, BRBIP32ChainKey chainKey, uint32_t index,
+                         size_t threadCount)
+{
+    BRBIP32PubKeyJob jobs[BIP32_LIST_MAX_THREADS];
+    pthread_t threads[BIP32_LIST_MAX_THREADS];
+    int started[BIP32_LIST_MAX_THREADS];
+    size_t i, n = 0, off = 0;
+    long cpus;
+    
+    assert(pubKeys != NULL || count == 0);
+    assert((index & BIP32_HARD) == 0 && count <= BIP32_HARD - index); // can't derive hardened children from a pubkey
+    if (count == 0) return 0;
+    
+    if (threadCount == 0) {
+        cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threadCount = (cpus > 0) ? (size_t)cpus : 1;
+    }
+    
+    if (threadCount > count/BIP32_LIST_MIN_THREAD_KEYS) threadCount = count/BIP32_LIST_MIN_THREAD_KEYS;
+    if (threadCount > BIP32_LIST_MAX_THREADS) threadCount = BIP32_LIST_MAX_THREADS;
+    if (threadCount < 1) threadCount = 1;
+    
+    for (i = 0; i < threadCount; i++) {
+        jobs[i].pubKeys = &pubKeys[off];
+        jobs[i].count = count/threadCount + ((i < count % threadCount) ? 1 : 0);
+        jobs[i].chainKey = &chainKey;
+        jobs[i].index = index + (uint32_t)off;
+        jobs[i].written = 0;
+        off += jobs[i].count;
+    }
+    
+    // the calling thread takes the first run, and also any run that a thread couldn't be started for
+    for (i = 1; i < threadCount; i++) started[i] = (pthread_create(&threads[i], NULL, _BRBIP32PubKeyListThread,
+                                                                   &jobs[i]) == 0);
+    _BRBIP32PubKeyListThread(&jobs[0]);
+    
+    for (i = 1; i < threadCount; i++) {
+        if (started[i]) pthread_join(threads[i], NULL);
+        else _BRBIP32PubKeyListThread(&jobs[i]);
+    }
+    
+    // only the leading run of keys with no invalid key in between is reported
+    for (i = 0; i < threadCount; i++) {
+        n += jobs[i].written;
+        if (jobs[i].written < jobs[i].count) break;
+    }
+    
+    var_clean(&chainKey);
+    return n;
+}
+
 // sets the private key for path m/0H/chain/index to key
 void BRBIP32PrivKey(BRKey *key, const void *seed, size_t seedLen, uint32_t chain, uint32_t index)
 {
@@ -164,30 +282,71 @@ void BRBIP32PrivKey(BRKey *key, const void *seed, size_t seedLen, uint32_t chain
 void BRBIP32PrivKeyList(BRKey keys[], size_t keysCount, const void *seed, size_t seedLen, uint32_t chain,
                         const uint32_t indexes[])
 {
-    UInt512 I;
-    UInt256 secret, chainCode, s, c;
+    BRBIP32PrivChainKey chainKey;
     
     assert(keys != NULL || keysCount == 0);
     assert(seed != NULL || seedLen == 0);
     assert(indexes != NULL || keysCount == 0);
     
     if (keys && keysCount > 0 && (seed || seedLen == 0) && indexes) {
+        BRBIP32PrivChainKeyPath(&chainKey, seed, seedLen, 2, 0 | BIP32_HARD, chain); // path m/0H/chain
+        BRBIP32PrivKeyListFromChain(keys, keysCount, &chainKey, indexes);
+        var_clean(&chainKey);
+    }
+}
+
+// sets chainKey to the extended private key for the specified path, for repeated use with
+// BRBIP32PrivKeyListFromChain()
+// depth is the number of arguments used to specify the path
+void BRBIP32PrivChainKeyPath(BRBIP32PrivChainKey *chainKey, const void *seed, size_t seedLen, int depth, ...)
+{
+    UInt512 I;
+    va_list ap;
+    
+    assert(chainKey != NULL);
+    assert(seed != NULL || seedLen == 0);
+    assert(depth >= 0);
+    
+    if (chainKey && (seed || seedLen == 0)) {
         BRHMAC(&I, BRSHA512, sizeof(UInt512), BIP32_SEED_KEY, strlen(BIP32_SEED_KEY), seed, seedLen);
-        secret = *(UInt256 *)&I;
-        chainCode = *(UInt256 *)&I.u8[sizeof(UInt256)];
+        chainKey->secret = *(UInt256 *)&I;
+        chainKey->chainCode = *(UInt256 *)&I.u8[sizeof(UInt256)];
         var_clean(&I);
+        
+        va_start(ap, depth);
+        
+        for (int i = 0; i < depth; i++) {
+            _CKDpriv(&chainKey->secret, &chainKey->chainCode, va_arg(ap, uint32_t));
+        }
+        
+        va_end(ap);
+    }
+}
 
-        _CKDpriv(&secret, &chainCode, 0 | BIP32_HARD); // path m/0H
-        _CKDpriv(&secret, &chainCode, chain); // path m/0H/chain
+// sets the private key for the normal child path chainKey/index to each element in keys, where chainKey is the result of
+// BRBIP32PrivChainKeyPath()
+void BRBIP32PrivKeyListFromChain(BRKey keys[], size_t keysCount, const BRBIP32PrivChainKey *chainKey,
+                                 const uint32_t indexes[])
+{
+    UInt256 s, c;
+    BRECPoint P;
     
+    assert(keys != NULL || keysCount == 0);
+    assert(chainKey != NULL);
+    assert(indexes != NULL || keysCount == 0);
+    
+    if (keys && keysCount > 0 && chainKey && indexes) {
+        BRSecp256k1PointGen(&P, &chainKey->secret); // computed once for the whole list rather than for each normal child
+        
         for (size_t i = 0; i < keysCount; i++) {
-            s = secret;
-            c = chainCode;
-            _CKDpriv(&s, &c, indexes[i]); // index'th key in chain
+            s = chainKey->secret;
+            c = chainKey->chainCode;
+            _CKDprivP(&s, &c, &P, indexes[i]); // index'th key in chain
             BRKeySetSecret(&keys[i], &s, 1);
         }
         
-        var_clean(&secret, &chainCode, &c, &s);
+        var_clean(&c, &s);
+        var_clean(&P);
     }
 }
 
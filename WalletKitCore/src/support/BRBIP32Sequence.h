@@ -82,6 +82,38 @@ BRMasterPubKey BRBIP32MasterPubKey(const void *seed, size_t seedLen);
 // returns number of bytes written, or pubKeyLen needed if pubKey is NULL
 size_t BRBIP32PubKey(uint8_t *pubKey, size_t pubKeyLen, BRMasterPubKey mpk, uint32_t chain, uint32_t index);
 
+// extended public key for a chain, N(m/0H/chain), from which the chain's addresses are derived
+typedef struct {
+    UInt256 chainCode;
+    BRECPoint pubKey;
+} BRBIP32ChainKey;
+
+// returns the extended public key for path N(m/0H/chain), for repeated use with BRBIP32PubKeyList()
+BRBIP32ChainKey BRBIP32ChainPubKey(BRMasterPubKey mpk, uint32_t chain);
+
+// writes the public keys for paths N(m/0H/chain/index) through N(m/0H/chain/index + count - 1) to pubKeys, where
+// chainKey is the result of BRBIP32ChainPubKey(), the work is split across up to threadCount threads, or one per cpu
+// if threadCount is 0
+// returns number of keys written, which is less than count only if a key in the range is invalid
+size_t BRBIP32PubKeyList(BRECPoint pubKeys[], size_t count, BRBIP32ChainKey chainKey, uint32_t index,
+                         size_t threadCount);
+
+// extended private key for a path, from which the private keys of the path's normal children are derived
+typedef struct {
+    UInt256 secret;
+    UInt256 chainCode;
+} BRBIP32PrivChainKey;
+
+// sets chainKey to the extended private key for the specified path, for repeated use with
+// BRBIP32PrivKeyListFromChain()
+// depth is the number of arguments used to specify the path
+void BRBIP32PrivChainKeyPath(BRBIP32PrivChainKey *chainKey, const void *seed, size_t seedLen, int depth, ...);
+
+// sets the private key for the normal child path chainKey/index to each element in keys, where chainKey is the result of
+// BRBIP32PrivChainKeyPath()
+void BRBIP32PrivKeyListFromChain(BRKey keys[], size_t keysCount, const BRBIP32PrivChainKey *chainKey,
+                                 const uint32_t indexes[]);
+
 // sets the private key for path m/0H/chain/index to key
 void BRBIP32PrivKey(BRKey *key, const void *seed, size_t seedLen, uint32_t chain, uint32_t index);
 
@@ -26,6 +26,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define SCRYPT_MAX_THREADS 16
 
 // endian swapping
 #if __BIG_ENDIAN__ || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
@@ -48,6 +52,37 @@
 // bitwise left rotation
 #define rol32(a, b) (((a) << (b)) | ((a) >> (32 - (b))))
 
+// buffers dataLen bytes of data into the blockLen byte block x, compressing each full block into state r
+#define _hashUpdate(compress, r, x, blockLen, len, data, dataLen) do {                                     \
+    size_t _off = (size_t)((len) % (blockLen)), _n;                                                       \
+    const uint8_t *_d = (const uint8_t *)(data);                                                          \
+                                                                                                          \
+    for (size_t _l = (dataLen); _l > 0; _l -= _n, _d += _n) {                                             \
+        _n = ((blockLen) - _off < _l) ? (blockLen) - _off : _l;                                           \
+        memcpy((uint8_t *)(x) + _off, _d, _n);                                                            \
+        _off += _n;                                                                                       \
+        if (_off == (blockLen)) compress((r), (x)), _off = 0;                                             \
+    }                                                                                                     \
+                                                                                                          \
+    (len) += (dataLen);                                                                                   \
+} while (0)
+
+// appends padding and the message length in bits (big endian if be), and compresses the final block(s) into state r
+#define _hashFinal(compress, r, x, blockLen, len, be) do {                                                 \
+    size_t _off = (size_t)((len) % (blockLen));                                                           \
+    uint64_t _bits = (uint64_t)(len) << 3;                                                                \
+                                                                                                          \
+    memset((uint8_t *)(x) + _off, 0, (blockLen) - _off); /* clear remainder of x */                       \
+    ((uint8_t *)(x))[_off] = 0x80; /* append padding */                                                   \
+    if (_off >= (blockLen) - (blockLen)/8) compress((r), (x)), memset((x), 0, (blockLen)); /* next block */ \
+                                                                                                          \
+    for (size_t _i = 0; _i < 8; _i++) { /* append length in bits */                                     \
+        ((uint8_t *)(x))[(be) ? (blockLen) - 1 - _i : (blockLen) - 8 + _i] = (uint8_t)(_bits >> 8*_i);    \
+    }                                                                                                     \
+                                                                                                          \
+    compress((r), (x)); /* finalize */                                                                    \
+} while (0)
+
 // basic sha1 functions
 #define f1(x, y, z) (((x) & (y)) | (~(x) & (z)))
 #define f2(x, y, z) ((x) ^ (y) ^ (z))
@@ -97,6 +132,32 @@ void BRSHA1(void *md20, const void *data, size_t dataLen)
     mem_clean(buf, sizeof(buf));
 }
 
+void BRSHA1Init(BRSHA1Context *ctx)
+{
+    static const uint32_t h[] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+
+    assert(ctx != NULL);
+    memcpy(ctx->h, h, sizeof(h));
+    ctx->len = 0;
+}
+
+void BRSHA1Update(BRSHA1Context *ctx, const void *data, size_t dataLen)
+{
+    assert(ctx != NULL);
+    assert(data != NULL || dataLen == 0);
+    _hashUpdate(_BRSHA1Compress, ctx->h, ctx->x, 64, ctx->len, data, dataLen);
+}
+
+void BRSHA1Final(BRSHA1Context *ctx, void *md20)
+{
+    assert(ctx != NULL);
+    assert(md20 != NULL);
+    _hashFinal(_BRSHA1Compress, ctx->h, ctx->x, 64, ctx->len, 1);
+    for (size_t i = 0; i < 5; i++) ctx->h[i] = be32(ctx->h[i]); // endian swap
+    memcpy(md20, ctx->h, 20); // write to md
+    mem_clean(ctx, sizeof(*ctx));
+}
+
 // bitwise right rotation
 #define ror32(a, b) (((a) >> (b)) | ((a) << (32 - (b))))
 
@@ -191,6 +252,45 @@ void BRSHA256(void *md32, const void *data, size_t dataLen)
     mem_clean(buf, sizeof(buf));
 }
 
+void BRSHA224Init(BRSHA256Context *ctx)
+{
+    static const uint32_t h[] = { 0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939, 0xffc00b31, 0x68581511,
+                                  0x64f98fa7, 0xbefa4fa4 };
+
+    assert(ctx != NULL);
+    memcpy(ctx->h, h, sizeof(h));
+    ctx->len = 0;
+    ctx->mdLen = 28;
+}
+
+void BRSHA256Init(BRSHA256Context *ctx)
+{
+    static const uint32_t h[] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c,
+                                  0x1f83d9ab, 0x5be0cd19 };
+
+    assert(ctx != NULL);
+    memcpy(ctx->h, h, sizeof(h));
+    ctx->len = 0;
+    ctx->mdLen = 32;
+}
+
+void BRSHA256Update(BRSHA256Context *ctx, const void *data, size_t dataLen)
+{
+    assert(ctx != NULL);
+    assert(data != NULL || dataLen == 0);
+    _hashUpdate(_BRSHA256Compress, ctx->h, ctx->x, 64, ctx->len, data, dataLen);
+}
+
+void BRSHA256Final(BRSHA256Context *ctx, void *md)
+{
+    assert(ctx != NULL);
+    assert(md != NULL);
+    _hashFinal(_BRSHA256Compress, ctx->h, ctx->x, 64, ctx->len, 1);
+    for (size_t i = 0; i < 8; i++) ctx->h[i] = be32(ctx->h[i]); // endian swap
+    memcpy(md, ctx->h, ctx->mdLen); // write to md
+    mem_clean(ctx, sizeof(*ctx));
+}
+
 // double-sha-256 = sha-256(sha-256(x))
 void BRSHA256_2(void *md32, const void *data, size_t dataLen)
 {
@@ -301,6 +401,45 @@ void BRSHA512(void *md64, const void *data, size_t dataLen)
     mem_clean(buf, sizeof(buf));
 }
 
+void BRSHA384Init(BRSHA512Context *ctx)
+{
+    static const uint64_t h[] = { 0xcbbb9d5dc1059ed8, 0x629a292a367cd507, 0x9159015a3070dd17, 0x152fecd8f70e5939,
+                                  0x67332667ffc00b31, 0x8eb44a8768581511, 0xdb0c2e0d64f98fa7, 0x47b5481dbefa4fa4 };
+
+    assert(ctx != NULL);
+    memcpy(ctx->h, h, sizeof(h));
+    ctx->len = 0;
+    ctx->mdLen = 48;
+}
+
+void BRSHA512Init(BRSHA512Context *ctx)
+{
+    static const uint64_t h[] = { 0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+                                  0x510e527fade682d1, 0x9b05688c2b3e6c1f, 0x1f83d9abfb41bd6b, 0x5be0cd19137e2179 };
+
+    assert(ctx != NULL);
+    memcpy(ctx->h, h, sizeof(h));
+    ctx->len = 0;
+    ctx->mdLen = 64;
+}
+
+void BRSHA512Update(BRSHA512Context *ctx, const void *data, size_t dataLen)
+{
+    assert(ctx != NULL);
+    assert(data != NULL || dataLen == 0);
+    _hashUpdate(_BRSHA512Compress, ctx->h, ctx->x, 128, ctx->len, data, dataLen);
+}
+
+void BRSHA512Final(BRSHA512Context *ctx, void *md)
+{
+    assert(ctx != NULL);
+    assert(md != NULL);
+    _hashFinal(_BRSHA512Compress, ctx->h, ctx->x, 128, ctx->len, 1);
+    for (size_t i = 0; i < 8; i++) ctx->h[i] = be64(ctx->h[i]); // endian swap
+    memcpy(md, ctx->h, ctx->mdLen); // write to md
+    mem_clean(ctx, sizeof(*ctx));
+}
+
 // basic ripemd functions
 #define f(x, y, z) ((x) ^ (y) ^ (z))
 #define g(x, y, z) (((x) & (y)) | (~(x) & (z)))
@@ -384,6 +523,32 @@ void BRRMD160(void *md20, const void *data, size_t dataLen)
     mem_clean(buf, sizeof(buf));
 }
 
+void BRRMD160Init(BRRMD160Context *ctx)
+{
+    static const uint32_t h[] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+
+    assert(ctx != NULL);
+    memcpy(ctx->h, h, sizeof(h));
+    ctx->len = 0;
+}
+
+void BRRMD160Update(BRRMD160Context *ctx, const void *data, size_t dataLen)
+{
+    assert(ctx != NULL);
+    assert(data != NULL || dataLen == 0);
+    _hashUpdate(_BRRMDCompress, ctx->h, ctx->x, 64, ctx->len, data, dataLen);
+}
+
+void BRRMD160Final(BRRMD160Context *ctx, void *md20)
+{
+    assert(ctx != NULL);
+    assert(md20 != NULL);
+    _hashFinal(_BRRMDCompress, ctx->h, ctx->x, 64, ctx->len, 0);
+    for (size_t i = 0; i < 5; i++) ctx->h[i] = le32(ctx->h[i]); // endian swap
+    memcpy(md20, ctx->h, 20); // write to md
+    mem_clean(ctx, sizeof(*ctx));
+}
+
 // bitcoin hash-160 = ripemd-160(sha-256(x))
 void BRHash160(void *md20, const void *data, size_t datalen)
 {
@@ -399,53 +564,104 @@ void BRHash160(void *md20, const void *data, size_t datalen)
 // bitwise left rotation
 #define rol64(a, b) ((a) << (b) ^ ((a) >> (64 - (b))))
 
-static void _BRSHA3Compress(uint64_t *r, const uint64_t *x, size_t blockSize)
+// keccak round constants
+static const uint64_t _keccakRC[] = {
+    0x0000000000000001, 0x0000000000008082, 0x800000000000808a, 0x8000000080008000, 0x000000000000808b,
+    0x0000000080000001, 0x8000000080008081, 0x8000000000008009, 0x000000000000008a, 0x0000000000000088,
+    0x0000000080008009, 0x000000008000000a, 0x000000008000808b, 0x800000000000008b, 0x8000000000008089,
+    0x8000000000008003, 0x8000000000008002, 0x8000000000000080, 0x000000000000800a, 0x800000008000000a,
+    0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008
+};
+
+// one keccak-f round (theta, rho, pi, chi, iota) from lanes A##xx into lanes E##xx, where lanes be, bi, go, ki, mi and
+// sa are held complemented so that chi needs one NOT per row rather than one per lane (keccak implementation overview,
+// section 2.2: https://keccak.team/files/Keccak-implementation-3.2.pdf)
+#define _keccakRound(A, E, rc) do {                                        \
+    Ca = A##ba ^ A##ga ^ A##ka ^ A##ma ^ A##sa;                             \
+    Ce = A##be ^ A##ge ^ A##ke ^ A##me ^ A##se;                             \
+    Ci = A##bi ^ A##gi ^ A##ki ^ A##mi ^ A##si;                             \
+    Co = A##bo ^ A##go ^ A##ko ^ A##mo ^ A##so;                             \
+    Cu = A##bu ^ A##gu ^ A##ku ^ A##mu ^ A##su;                             \
+    Da = Cu ^ rol64(Ce, 1); De = Ca ^ rol64(Ci, 1); Di = Ce ^ rol64(Co, 1); \
+    Do = Ci ^ rol64(Cu, 1); Du = Co ^ rol64(Ca, 1);                         \
+    A##ba ^= Da, Ba = A##ba; A##ge ^= De, Be = rol64(A##ge, 44);            \
+    A##ki ^= Di, Bi = rol64(A##ki, 43); A##mo ^= Do, Bo = rol64(A##mo, 21); \
+    A##su ^= Du, Bu = rol64(A##su, 14);                                     \
+    E##ba = Ba ^ (Be | Bi) ^ (rc), E##be = Be ^ (~Bi | Bo);                 \
+    E##bi = Bi ^ (Bo & Bu), E##bo = Bo ^ (Bu | Ba);                         \
+    E##bu = Bu ^ (Ba & Be);                                                 \
+    A##bo ^= Do, Ba = rol64(A##bo, 28); A##gu ^= Du, Be = rol64(A##gu, 20); \
+    A##ka ^= Da, Bi = rol64(A##ka, 3); A##me ^= De, Bo = rol64(A##me, 45);  \
+    A##si ^= Di, Bu = rol64(A##si, 61);                                     \
+    E##ga = Ba ^ (Be | Bi), E##ge = Be ^ (Bi & Bo);                         \
+    E##gi = Bi ^ (Bo | ~Bu), E##go = Bo ^ (Bu | Ba);                        \
+    E##gu = Bu ^ (Ba & Be);                                                 \
+    A##be ^= De, Ba = rol64(A##be, 1); A##gi ^= Di, Be = rol64(A##gi, 6);   \
+    A##ko ^= Do, Bi = rol64(A##ko, 25); A##mu ^= Du, Bo = rol64(A##mu, 8);  \
+    A##sa ^= Da, Bu = rol64(A##sa, 18);                                     \
+    E##ka = Ba ^ (Be | Bi), E##ke = Be ^ (Bi & Bo);                         \
+    E##ki = Bi ^ (~Bo & Bu), E##ko = ~(Bo ^ (Bu | Ba));                     \
+    E##ku = Bu ^ (Ba & Be);                                                 \
+    A##bu ^= Du, Ba = rol64(A##bu, 27); A##ga ^= Da, Be = rol64(A##ga, 36); \
+    A##ke ^= De, Bi = rol64(A##ke, 10); A##mi ^= Di, Bo = rol64(A##mi, 15); \
+    A##so ^= Do, Bu = rol64(A##so, 56);                                     \
+    E##ma = Ba ^ (Be & Bi), E##me = Be ^ (Bi | Bo);                         \
+    E##mi = Bi ^ (~Bo | Bu), E##mo = ~(Bo ^ (Bu & Ba));                     \
+    E##mu = Bu ^ (Ba | Be);                                                 \
+    A##bi ^= Di, Ba = rol64(A##bi, 62); A##go ^= Do, Be = rol64(A##go, 55); \
+    A##ku ^= Du, Bi = rol64(A##ku, 39); A##ma ^= Da, Bo = rol64(A##ma, 41); \
+    A##se ^= De, Bu = rol64(A##se, 2);                                      \
+    E##sa = Ba ^ (~Be & Bi), E##se = ~(Be ^ (Bi | Bo));                     \
+    E##si = Bi ^ (Bo & Bu), E##so = Bo ^ (Bu | Ba);                         \
+    E##su = Bu ^ (Ba & Be);                                                 \
+} while (0)
+
+// keccak-f[1600] permutation of the 25 lane state s, lanes in host byte order
+void BRKeccakF1600(uint64_t s[25])
 {
-    static const uint64_t k[] = { // keccak round constants
-        0x0000000000000001, 0x0000000000008082, 0x800000000000808a, 0x8000000080008000, 0x000000000000808b,
-        0x0000000080000001, 0x8000000080008081, 0x8000000000008009, 0x000000000000008a, 0x0000000000000088,
-        0x0000000080008009, 0x000000008000000a, 0x000000008000808b, 0x800000000000008b, 0x8000000000008089,
-        0x8000000000008003, 0x8000000000008002, 0x8000000000000080, 0x000000000000800a, 0x800000008000000a,
-        0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008
-    };
+    uint64_t Aba = s[0], Abe = ~s[1], Abi = ~s[2], Abo = s[3], Abu = s[4],
+             Aga = s[5], Age = s[6], Agi = s[7], Ago = ~s[8], Agu = s[9],
+             Aka = s[10], Ake = s[11], Aki = ~s[12], Ako = s[13], Aku = s[14],
+             Ama = s[15], Ame = s[16], Ami = ~s[17], Amo = s[18], Amu = s[19],
+             Asa = ~s[20], Ase = s[21], Asi = s[22], Aso = s[23], Asu = s[24],
+             Eba, Ebe, Ebi, Ebo, Ebu, Ega, Ege, Egi, Ego, Egu, Eka, Eke, Eki, Eko, Eku,
+             Ema, Eme, Emi, Emo, Emu, Esa, Ese, Esi, Eso, Esu,
+             Ba, Be, Bi, Bo, Bu, Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du;
+    
+    assert(s != NULL);
+    
+    for (size_t i = 0; i < 24; i += 2) {
+        _keccakRound(A, E, _keccakRC[i]);
+        _keccakRound(E, A, _keccakRC[i + 1]);
+    }
     
-    size_t i, j;
-    uint64_t a[5], b[5], r0, r1;
+    s[0] = Aba, s[1] = ~Abe, s[2] = ~Abi, s[3] = Abo, s[4] = Abu;
+    s[5] = Aga, s[6] = Age, s[7] = Agi, s[8] = ~Ago, s[9] = Agu;
+    s[10] = Aka, s[11] = Ake, s[12] = ~Aki, s[13] = Ako, s[14] = Aku;
+    s[15] = Ama, s[16] = Ame, s[17] = ~Ami, s[18] = Amo, s[19] = Amu;
+    s[20] = ~Asa, s[21] = Ase, s[22] = Asi, s[23] = Aso, s[24] = Asu;
+}
+
+static void _BRSHA3Compress(uint64_t *r, const uint64_t *x, size_t blockSize)
+{
+    size_t i;
     
     for (i = 0; i < blockSize/sizeof(uint64_t); i++) r[i] ^= le64(x[i]);
+    BRKeccakF1600(r);
+}
+
+// loads block j of the keccak padding of dataLen bytes of data into x
+static void _BRKeccakBlock(uint64_t x[17], const void *data, size_t dataLen, size_t j, uint8_t pad)
+{
+    size_t off = j*136, len = (off + 136 <= dataLen) ? 136 : dataLen - off;
     
-    for (i = 0; i < 24; i++) { // permute r
-        // theta(r)
-        for (j = 0; j < 5; j++) a[j] = r[j] ^ r[j + 5] ^ r[j + 10] ^ r[j + 15] ^ r[j + 20];
-        b[0] = rol64(a[1], 1) ^ a[4], b[1] = rol64(a[2], 1) ^ a[0], b[2] = rol64(a[3], 1) ^ a[1];
-        b[3] = rol64(a[4], 1) ^ a[2], b[4] = rol64(a[0], 1) ^ a[3];
-        for (j = 0; j < 5; j++) r[j] ^= b[j], r[j + 5] ^= b[j], r[j + 10] ^= b[j], r[j + 15] ^= b[j], r[j + 20] ^= b[j];
-        
-        // rho(r)
-        r[1] = rol64(r[1], 1), r[2] = rol64(r[2], 62), r[3] = rol64(r[3], 28), r[4] = rol64(r[4], 27);
-        r[5] = rol64(r[5], 36), r[6] = rol64(r[6], 44), r[7] = rol64(r[7], 6), r[8] = rol64(r[8], 55);
-        r[9] = rol64(r[9], 20), r[10] = rol64(r[10], 3), r[11] = rol64(r[11], 10), r[12] = rol64(r[12], 43);
-        r[13] = rol64(r[13], 25), r[14] = rol64(r[14], 39), r[15] = rol64(r[15], 41), r[16] = rol64(r[16], 45);
-        r[17] = rol64(r[17], 15), r[18] = rol64(r[18], 21), r[19] = rol64(r[19], 8), r[20] = rol64(r[20], 18);
-        r[21] = rol64(r[21], 2), r[22] = rol64(r[22], 61), r[23] = rol64(r[23], 56), r[24] = rol64(r[24], 14);
-        
-        // pi(r)
-        r1 = r[1], r[1] = r[6], r[6] = r[9], r[9] = r[22], r[22] = r[14], r[14] = r[20], r[20] = r[2], r[2] = r[12],
-        r[12] = r[13], r[13] = r[19], r[19] = r[23], r[23] = r[15], r[15] = r[4], r[4] = r[24], r[24] = r[21];
-        r[21] = r[8], r[8] = r[16], r[16] = r[5], r[5] = r[3], r[3] = r[18], r[18] = r[17], r[17] = r[11], r[11] = r[7];
-        r[7] = r[10], r[10] = r1; // r[0] left as is
-        
-        for (j = 0; j < 25; j += 5) { // chi(r)
-            r0 = r[0 + j], r1 = r[1 + j], r[0 + j] ^= ~r1 & r[2 + j], r[1 + j] ^= ~r[2 + j] & r[3 + j];
-            r[2 + j] ^= ~r[3 + j] & r[4 + j], r[3 + j] ^= ~r[4 + j] & r0, r[4 + j] ^= ~r0 & r1;
-        }
-        
-        *r ^= k[i]; // iota(r, i)
-    }
+    memset(x, 0, 136);
+    if (len > 0) memcpy(x, (const uint8_t *)data + off, len);
     
-    mem_clean(a, sizeof(a));
-    mem_clean(b, sizeof(b));
-    var_clean(&r0, &r1);
+    if (off + 136 > dataLen) { // final block
+        ((uint8_t *)x)[len] |= pad; // append padding
+        ((uint8_t *)x)[135] |= 0x80;
+    }
 }
 
 // sha3-256: http://nvlpubs.nist.gov/nistpubs/FIPS/NIST.FIPS.202.pdf
@@ -457,16 +673,11 @@ void BRSHA3_256(void *md32, const void *data, size_t dataLen)
     assert(md32 != NULL);
     assert(data != NULL || dataLen == 0);
     
-    for (i = 0; i <= dataLen; i += 136) { // process data in 136 byte blocks
-        memcpy(x, (const uint8_t *)data + i, (i + 136 < dataLen) ? 136 : dataLen - i);
-        if (i + 136 > dataLen) break;
+    for (i = 0; i <= dataLen/136; i++) { // process data in 136 byte blocks, the last one padded
+        _BRKeccakBlock(x, data, dataLen, i, 0x06);
         _BRSHA3Compress(buf, x, 136);
     }
     
-    memset((uint8_t *)x + (dataLen - i), 0, 136 - (dataLen - i)); // clear remainder of x
-    ((uint8_t *)x)[dataLen - i] |= 0x06; // append padding
-    ((uint8_t *)x)[135] |= 0x80;
-    _BRSHA3Compress(buf, x, 136); // finalize
     for (i = 0; i < 4; i++) buf[i] = le64(buf[i]); // endian swap
     memcpy(md32, buf, 32); // write to md
     mem_clean(x, sizeof(x));
@@ -482,22 +693,221 @@ void BRKeccak256(void *md32, const void *data, size_t dataLen)
     assert(md32 != NULL);
     assert(data != NULL || dataLen == 0);
     
-    for (i = 0; i <= dataLen; i += 136) { // process data in 136 byte blocks
-        memcpy(x, (const uint8_t *)data + i, (i + 136 < dataLen) ? 136 : dataLen - i);
-        if (i + 136 > dataLen) break;
+    for (i = 0; i <= dataLen/136; i++) { // process data in 136 byte blocks, the last one padded
+        _BRKeccakBlock(x, data, dataLen, i, 0x01);
         _BRSHA3Compress(buf, x, 136);
     }
     
-    memset((uint8_t *)x + (dataLen - i), 0, 136 - (dataLen - i)); // clear remainder of x
-    ((uint8_t *)x)[dataLen - i] |= 0x01; // append padding
-    ((uint8_t *)x)[135] |= 0x80;
-    _BRSHA3Compress(buf, x, 136); // finalize
     for (i = 0; i < 4; i++) buf[i] = le64(buf[i]); // endian swap
     memcpy(md32, buf, 32); // write to md
     mem_clean(x, sizeof(x));
     mem_clean(buf, sizeof(buf));
 }
 
+void BRSHA3_256Init(BRKeccakContext *ctx)
+{
+    assert(ctx != NULL);
+    memset(ctx->s, 0, sizeof(ctx->s));
+    ctx->len = 0;
+    ctx->pad = 0x06;
+}
+
+void BRKeccak256Init(BRKeccakContext *ctx)
+{
+    assert(ctx != NULL);
+    memset(ctx->s, 0, sizeof(ctx->s));
+    ctx->len = 0;
+    ctx->pad = 0x01;
+}
+
+static void _BRKeccakAbsorb(uint64_t *r, const uint64_t *x)
+{
+    _BRSHA3Compress(r, x, 136);
+}
+
+void BRKeccakUpdate(BRKeccakContext *ctx, const void *data, size_t dataLen)
+{
+    assert(ctx != NULL);
+    assert(data != NULL || dataLen == 0);
+    _hashUpdate(_BRKeccakAbsorb, ctx->s, ctx->x, 136, ctx->len, data, dataLen);
+}
+
+void BRKeccakFinal(BRKeccakContext *ctx, void *md32)
+{
+    size_t off = (size_t)(ctx->len % 136);
+    
+    assert(ctx != NULL);
+    assert(md32 != NULL);
+    memset((uint8_t *)ctx->x + off, 0, 136 - off); // clear remainder of x
+    ((uint8_t *)ctx->x)[off] |= ctx->pad; // append padding
+    ((uint8_t *)ctx->x)[135] |= 0x80;
+    _BRSHA3Compress(ctx->s, ctx->x, 136); // finalize
+    for (size_t i = 0; i < 4; i++) ctx->s[i] = le64(ctx->s[i]); // endian swap
+    memcpy(md32, ctx->s, 32); // write to md
+    mem_clean(ctx, sizeof(*ctx));
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+// the AVX2 keccak is built for AVX2 on its own, and only called once cpuid has reported AVX2
+#define BR_KECCAK_AVX2
+#include <immintrin.h>
+
+#define ROL4(a, b) _mm256_or_si256(_mm256_slli_epi64((a), (b)), _mm256_srli_epi64((a), 64 - (b)))
+#define XOR5(a, b, c, d, e) _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256((a), (b)), _mm256_xor_si256((c), (d))), (e))
+
+// one keccak-f round on four independent states, from lanes A##xx into lanes E##xx, andnot makes lane complementing
+// unnecessary
+#define _keccakRoundx4(A, E, rc) do {                                                                                 \
+    Ca = XOR5(A##ba, A##ga, A##ka, A##ma, A##sa);                                                                     \
+    Ce = XOR5(A##be, A##ge, A##ke, A##me, A##se);                                                                     \
+    Ci = XOR5(A##bi, A##gi, A##ki, A##mi, A##si);                                                                     \
+    Co = XOR5(A##bo, A##go, A##ko, A##mo, A##so);                                                                     \
+    Cu = XOR5(A##bu, A##gu, A##ku, A##mu, A##su);                                                                     \
+    Da = _mm256_xor_si256(Cu, ROL4(Ce, 1));                                                                           \
+    De = _mm256_xor_si256(Ca, ROL4(Ci, 1));                                                                           \
+    Di = _mm256_xor_si256(Ce, ROL4(Co, 1));                                                                           \
+    Do = _mm256_xor_si256(Ci, ROL4(Cu, 1));                                                                           \
+    Du = _mm256_xor_si256(Co, ROL4(Ca, 1));                                                                           \
+    Ba = _mm256_xor_si256(A##ba, Da);                                                                                 \
+    Be = ROL4(_mm256_xor_si256(A##ge, De), 44);                                                                       \
+    Bi = ROL4(_mm256_xor_si256(A##ki, Di), 43);                                                                       \
+    Bo = ROL4(_mm256_xor_si256(A##mo, Do), 21);                                                                       \
+    Bu = ROL4(_mm256_xor_si256(A##su, Du), 14);                                                                       \
+    E##ba = _mm256_xor_si256(_mm256_xor_si256(Ba, _mm256_andnot_si256(Be, Bi)), _mm256_set1_epi64x((long long)(rc))); \
+    E##be = _mm256_xor_si256(Be, _mm256_andnot_si256(Bi, Bo));                                                        \
+    E##bi = _mm256_xor_si256(Bi, _mm256_andnot_si256(Bo, Bu));                                                        \
+    E##bo = _mm256_xor_si256(Bo, _mm256_andnot_si256(Bu, Ba));                                                        \
+    E##bu = _mm256_xor_si256(Bu, _mm256_andnot_si256(Ba, Be));                                                        \
+    Ba = ROL4(_mm256_xor_si256(A##bo, Do), 28);                                                                       \
+    Be = ROL4(_mm256_xor_si256(A##gu, Du), 20);                                                                       \
+    Bi = ROL4(_mm256_xor_si256(A##ka, Da), 3);                                                                        \
+    Bo = ROL4(_mm256_xor_si256(A##me, De), 45);                                                                       \
+    Bu = ROL4(_mm256_xor_si256(A##si, Di), 61);                                                                       \
+    E##ga = _mm256_xor_si256(Ba, _mm256_andnot_si256(Be, Bi));                                                        \
+    E##ge = _mm256_xor_si256(Be, _mm256_andnot_si256(Bi, Bo));                                                        \
+    E##gi = _mm256_xor_si256(Bi, _mm256_andnot_si256(Bo, Bu));                                                        \
+    E##go = _mm256_xor_si256(Bo, _mm256_andnot_si256(Bu, Ba));                                                        \
+    E##gu = _mm256_xor_si256(Bu, _mm256_andnot_si256(Ba, Be));                                                        \
+    Ba = ROL4(_mm256_xor_si256(A##be, De), 1);                                                                        \
+    Be = ROL4(_mm256_xor_si256(A##gi, Di), 6);                                                                        \
+    Bi = ROL4(_mm256_xor_si256(A##ko, Do), 25);                                                                       \
+    Bo = ROL4(_mm256_xor_si256(A##mu, Du), 8);                                                                        \
+    Bu = ROL4(_mm256_xor_si256(A##sa, Da), 18);                                                                       \
+    E##ka = _mm256_xor_si256(Ba, _mm256_andnot_si256(Be, Bi));                                                        \
+    E##ke = _mm256_xor_si256(Be, _mm256_andnot_si256(Bi, Bo));                                                        \
+    E##ki = _mm256_xor_si256(Bi, _mm256_andnot_si256(Bo, Bu));                                                        \
+    E##ko = _mm256_xor_si256(Bo, _mm256_andnot_si256(Bu, Ba));                                                        \
+    E##ku = _mm256_xor_si256(Bu, _mm256_andnot_si256(Ba, Be));                                                        \
+    Ba = ROL4(_mm256_xor_si256(A##bu, Du), 27);                                                                       \
+    Be = ROL4(_mm256_xor_si256(A##ga, Da), 36);                                                                       \
+    Bi = ROL4(_mm256_xor_si256(A##ke, De), 10);                                                                       \
+    Bo = ROL4(_mm256_xor_si256(A##mi, Di), 15);                                                                       \
+    Bu = ROL4(_mm256_xor_si256(A##so, Do), 56);                                                                       \
+    E##ma = _mm256_xor_si256(Ba, _mm256_andnot_si256(Be, Bi));                                                        \
+    E##me = _mm256_xor_si256(Be, _mm256_andnot_si256(Bi, Bo));                                                        \
+    E##mi = _mm256_xor_si256(Bi, _mm256_andnot_si256(Bo, Bu));                                                        \
+    E##mo = _mm256_xor_si256(Bo, _mm256_andnot_si256(Bu, Ba));                                                        \
+    E##mu = _mm256_xor_si256(Bu, _mm256_andnot_si256(Ba, Be));                                                        \
+    Ba = ROL4(_mm256_xor_si256(A##bi, Di), 62);                                                                       \
+    Be = ROL4(_mm256_xor_si256(A##go, Do), 55);                                                                       \
+    Bi = ROL4(_mm256_xor_si256(A##ku, Du), 39);                                                                       \
+    Bo = ROL4(_mm256_xor_si256(A##ma, Da), 41);                                                                       \
+    Bu = ROL4(_mm256_xor_si256(A##se, De), 2);                                                                        \
+    E##sa = _mm256_xor_si256(Ba, _mm256_andnot_si256(Be, Bi));                                                        \
+    E##se = _mm256_xor_si256(Be, _mm256_andnot_si256(Bi, Bo));                                                        \
+    E##si = _mm256_xor_si256(Bi, _mm256_andnot_si256(Bo, Bu));                                                        \
+    E##so = _mm256_xor_si256(Bo, _mm256_andnot_si256(Bu, Ba));                                                        \
+    E##su = _mm256_xor_si256(Bu, _mm256_andnot_si256(Ba, Be));                                                        \
+} while (0)
+
+// keccak-f[1600] applied to four independent states, lane i of state n is element n of s[i]
+__attribute__((target("avx2")))
+static void _BRKeccakF1600x4(__m256i s[25])
+{
+    __m256i Aba = s[0], Abe = s[1], Abi = s[2], Abo = s[3], Abu = s[4],
+            Aga = s[5], Age = s[6], Agi = s[7], Ago = s[8], Agu = s[9],
+            Aka = s[10], Ake = s[11], Aki = s[12], Ako = s[13], Aku = s[14],
+            Ama = s[15], Ame = s[16], Ami = s[17], Amo = s[18], Amu = s[19],
+            Asa = s[20], Ase = s[21], Asi = s[22], Aso = s[23], Asu = s[24],
+            Eba, Ebe, Ebi, Ebo, Ebu, Ega, Ege, Egi, Ego, Egu, Eka, Eke, Eki, Eko, Eku,
+            Ema, Eme, Emi, Emo, Emu, Esa, Ese, Esi, Eso, Esu,
+            Ba, Be, Bi, Bo, Bu, Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du;
+    
+    for (size_t i = 0; i < 24; i += 2) {
+        _keccakRoundx4(A, E, _keccakRC[i]);
+        _keccakRoundx4(E, A, _keccakRC[i + 1]);
+    }
+    
+    s[0] = Aba, s[1] = Abe, s[2] = Abi, s[3] = Abo, s[4] = Abu;
+    s[5] = Aga, s[6] = Age, s[7] = Agi, s[8] = Ago, s[9] = Agu;
+    s[10] = Aka, s[11] = Ake, s[12] = Aki, s[13] = Ako, s[14] = Aku;
+    s[15] = Ama, s[16] = Ame, s[17] = Ami, s[18] = Amo, s[19] = Amu;
+    s[20] = Asa, s[21] = Ase, s[22] = Asi, s[23] = Aso, s[24] = Asu;
+}
+
+// keccak-256 of four independent messages, the nth digest is written to md32s + 32*n
+__attribute__((target("avx2")))
+static void _BRKeccak256x4(uint8_t *md32s, const void *data[], const size_t dataLen[])
+{
+    size_t i, j, n, blocks[4], maxBlocks = 0;
+    uint64_t x[4][17], lanes[4];
+    __m256i s[25];
+    
+    for (n = 0; n < 4; n++) {
+        blocks[n] = dataLen[n]/136 + 1;
+        if (blocks[n] > maxBlocks) maxBlocks = blocks[n];
+    }
+    
+    for (i = 0; i < 25; i++) s[i] = _mm256_setzero_si256();
+    
+    for (j = 0; j < maxBlocks; j++) { // messages that are already finished absorb zero blocks
+        for (n = 0; n < 4; n++) {
+            if (j < blocks[n]) _BRKeccakBlock(x[n], data[n], dataLen[n], j, 0x01);
+            else memset(x[n], 0, sizeof(x[n]));
+        }
+        
+        for (i = 0; i < 17; i++) {
+            s[i] = _mm256_xor_si256(s[i], _mm256_set_epi64x((long long)le64(x[3][i]), (long long)le64(x[2][i]),
+                                                            (long long)le64(x[1][i]), (long long)le64(x[0][i])));
+        }
+        
+        _BRKeccakF1600x4(s);
+        
+        for (i = 0; i < 4; i++) {
+            _mm256_storeu_si256((__m256i *)lanes, s[i]);
+            
+            for (n = 0; n < 4; n++) {
+                if (j + 1 != blocks[n]) continue;
+                lanes[n] = le64(lanes[n]); // endian swap
+                memcpy(&md32s[32*n + 8*i], &lanes[n], sizeof(uint64_t)); // write to md
+            }
+        }
+    }
+    
+    mem_clean(x, sizeof(x));
+    mem_clean(lanes, sizeof(lanes));
+    mem_clean(s, sizeof(s));
+}
+#endif
+
+// keccak-256 of count independent messages, the ith digest is written to md32s + 32*i
+// on x86-64 cpus with AVX2 the messages are hashed four at a time
+void BRKeccak256Batch(void *md32s, const void *data[], const size_t dataLen[], size_t count)
+{
+    size_t i = 0;
+    
+    assert(md32s != NULL || count == 0);
+    assert(data != NULL || count == 0);
+    assert(dataLen != NULL || count == 0);
+    
+#if defined(BR_KECCAK_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        for (; i + 4 <= count; i += 4) _BRKeccak256x4((uint8_t *)md32s + 32*i, &data[i], &dataLen[i]);
+    }
+#endif
+    for (; i < count; i++) BRKeccak256((uint8_t *)md32s + 32*i, data[i], dataLen[i]);
+}
+
 // basic md5 functions
 #define F(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
 #define G(x, y, z) ((y) ^ ((z) & ((x) ^ (y))))
@@ -561,6 +971,32 @@ void BRMD5(void *md16, const void *data, size_t dataLen)
     mem_clean(buf, sizeof(buf));
 }
 
+void BRMD5Init(BRMD5Context *ctx)
+{
+    static const uint32_t h[] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+
+    assert(ctx != NULL);
+    memcpy(ctx->h, h, sizeof(h));
+    ctx->len = 0;
+}
+
+void BRMD5Update(BRMD5Context *ctx, const void *data, size_t dataLen)
+{
+    assert(ctx != NULL);
+    assert(data != NULL || dataLen == 0);
+    _hashUpdate(_BRMD5Compress, ctx->h, ctx->x, 64, ctx->len, data, dataLen);
+}
+
+void BRMD5Final(BRMD5Context *ctx, void *md16)
+{
+    assert(ctx != NULL);
+    assert(md16 != NULL);
+    _hashFinal(_BRMD5Compress, ctx->h, ctx->x, 64, ctx->len, 0);
+    for (size_t i = 0; i < 4; i++) ctx->h[i] = le32(ctx->h[i]); // endian swap
+    memcpy(md16, ctx->h, 16); // write to md
+    mem_clean(ctx, sizeof(*ctx));
+}
+
 #define C1 0xcc9e2d51
 #define C2 0x1b873593
 
@@ -628,15 +1064,108 @@ uint64_t BRSip64(const void *key16, const void *data, size_t dataLen)
     return le64(x);
 }
 
+// initializes ctx for incremental hashing with hash, returns false if hash isn't one of BRSHA1, BRSHA224, BRSHA256,
+// BRSHA384, BRSHA512, BRRMD160, BRSHA3_256, BRKeccak256 or BRMD5
+int BRHashInit(BRHashContext *ctx, void (*hash)(void *, const void *, size_t))
+{
+    assert(ctx != NULL);
+    ctx->hash = hash;
+    
+    if (hash == BRSHA1) BRSHA1Init(&ctx->u.sha1);
+    else if (hash == BRSHA224) BRSHA224Init(&ctx->u.sha256);
+    else if (hash == BRSHA256) BRSHA256Init(&ctx->u.sha256);
+    else if (hash == BRSHA384) BRSHA384Init(&ctx->u.sha512);
+    else if (hash == BRSHA512) BRSHA512Init(&ctx->u.sha512);
+    else if (hash == BRRMD160) BRRMD160Init(&ctx->u.rmd160);
+    else if (hash == BRSHA3_256) BRSHA3_256Init(&ctx->u.keccak);
+    else if (hash == BRKeccak256) BRKeccak256Init(&ctx->u.keccak);
+    else if (hash == BRMD5) BRMD5Init(&ctx->u.md5);
+    else ctx->hash = NULL;
+    
+    return (ctx->hash != NULL);
+}
+
+void BRHashUpdate(BRHashContext *ctx, const void *data, size_t dataLen)
+{
+    assert(ctx != NULL && ctx->hash != NULL);
+    
+    if (ctx->hash == BRSHA1) BRSHA1Update(&ctx->u.sha1, data, dataLen);
+    else if (ctx->hash == BRSHA224 || ctx->hash == BRSHA256) BRSHA256Update(&ctx->u.sha256, data, dataLen);
+    else if (ctx->hash == BRSHA384 || ctx->hash == BRSHA512) BRSHA512Update(&ctx->u.sha512, data, dataLen);
+    else if (ctx->hash == BRRMD160) BRRMD160Update(&ctx->u.rmd160, data, dataLen);
+    else if (ctx->hash == BRSHA3_256 || ctx->hash == BRKeccak256) BRKeccakUpdate(&ctx->u.keccak, data, dataLen);
+    else if (ctx->hash == BRMD5) BRMD5Update(&ctx->u.md5, data, dataLen);
+}
+
+// writes the digest of all data passed to BRHashUpdate() to md and wipes ctx
+void BRHashFinal(BRHashContext *ctx, void *md)
+{
+    assert(ctx != NULL && ctx->hash != NULL);
+    
+    if (ctx->hash == BRSHA1) BRSHA1Final(&ctx->u.sha1, md);
+    else if (ctx->hash == BRSHA224 || ctx->hash == BRSHA256) BRSHA256Final(&ctx->u.sha256, md);
+    else if (ctx->hash == BRSHA384 || ctx->hash == BRSHA512) BRSHA512Final(&ctx->u.sha512, md);
+    else if (ctx->hash == BRRMD160) BRRMD160Final(&ctx->u.rmd160, md);
+    else if (ctx->hash == BRSHA3_256 || ctx->hash == BRKeccak256) BRKeccakFinal(&ctx->u.keccak, md);
+    else if (ctx->hash == BRMD5) BRMD5Final(&ctx->u.md5, md);
+    
+    ctx->hash = NULL;
+}
+
+// initializes ctx with the inner and outer hash states after the key blocks, so that a copy of ctx can be reused to
+// mac any number of messages without rehashing the key, returns false if hash has no incremental context
+int BRHMACInit(BRHMACContext *ctx, void (*hash)(void *, const void *, size_t), size_t hashLen, const void *key,
+               size_t keyLen)
+{
+    size_t i, blockLen = (hashLen > 32) ? 128 : 64;
+    uint64_t k[64/sizeof(uint64_t)], pad[128/sizeof(uint64_t)];
+    
+    assert(ctx != NULL);
+    assert(hash != NULL);
+    assert(hashLen > 0 && (hashLen % 4) == 0);
+    assert(key != NULL || keyLen == 0);
+    
+    if (hashLen > sizeof(k) || ! BRHashInit(&ctx->inner, hash) || ! BRHashInit(&ctx->outer, hash)) return 0;
+    ctx->hashLen = hashLen;
+    if (keyLen > blockLen) hash(k, key, keyLen), key = k, keyLen = hashLen;
+    memset(pad, 0, blockLen);
+    memcpy(pad, key, keyLen);
+    for (i = 0; i < blockLen/sizeof(uint64_t); i++) pad[i] ^= 0x3636363636363636;
+    BRHashUpdate(&ctx->inner, pad, blockLen);
+    for (i = 0; i < blockLen/sizeof(uint64_t); i++) pad[i] ^= 0x3636363636363636 ^ 0x5c5c5c5c5c5c5c5c;
+    BRHashUpdate(&ctx->outer, pad, blockLen);
+    mem_clean(k, sizeof(k));
+    mem_clean(pad, sizeof(pad));
+    return 1;
+}
+
+void BRHMACUpdate(BRHMACContext *ctx, const void *data, size_t dataLen)
+{
+    assert(ctx != NULL);
+    BRHashUpdate(&ctx->inner, data, dataLen);
+}
+
+// writes the mac of all data passed to BRHMACUpdate() to mac and wipes ctx
+void BRHMACFinal(BRHMACContext *ctx, void *mac)
+{
+    uint64_t md[64/sizeof(uint64_t)];
+    
+    assert(ctx != NULL);
+    assert(mac != NULL);
+    BRHashFinal(&ctx->inner, md);
+    BRHashUpdate(&ctx->outer, md, ctx->hashLen);
+    BRHashFinal(&ctx->outer, mac);
+    mem_clean(md, sizeof(md));
+    mem_clean(ctx, sizeof(*ctx));
+}
+
 // HMAC(key, data) = hash((key xor opad) || hash((key xor ipad) || data))
 // opad = 0x5c5c5c...5c5c
 // ipad = 0x363636...3636
 void BRHMAC(void *mac, void (*hash)(void *, const void *, size_t), size_t hashLen, const void *key, size_t keyLen,
             const void *data, size_t dataLen)
 {
-    size_t i, blockLen = (hashLen > 32) ? 128 : 64;
-    uint8_t k[hashLen];
-    uint64_t kipad[(blockLen + dataLen)/sizeof(uint64_t) + 1], kopad[(blockLen + hashLen)/sizeof(uint64_t) + 1];
+    BRHMACContext ctx;
     
     assert(mac != NULL);
     assert(hash != NULL);
@@ -644,6 +1173,16 @@ void BRHMAC(void *mac, void (*hash)(void *, const void *, size_t), size_t hashLe
     assert(key != NULL || keyLen == 0);
     assert(data != NULL || dataLen == 0);
     
+    if (BRHMACInit(&ctx, hash, hashLen, key, keyLen)) { // hash data in place rather than copying it
+        BRHMACUpdate(&ctx, data, dataLen);
+        BRHMACFinal(&ctx, mac);
+        return;
+    }
+
+    size_t i, blockLen = (hashLen > 32) ? 128 : 64;
+    uint8_t k[hashLen];
+    uint64_t kipad[(blockLen + dataLen)/sizeof(uint64_t) + 1], kopad[(blockLen + hashLen)/sizeof(uint64_t) + 1];
+    
     if (keyLen > blockLen) hash(k, key, keyLen), key = k, keyLen = sizeof(k);
     memset(kipad, 0, blockLen);
     memcpy(kipad, key, keyLen);
@@ -1109,6 +1648,8 @@ void BRPBKDF2(void *dk, size_t dkLen, void (*hash)(void *, const void *, size_t)
 {
     uint8_t s[saltLen + sizeof(uint32_t)];
     uint32_t i, j, U[hashLen/sizeof(uint32_t)], T[hashLen/sizeof(uint32_t)];
+    BRHMACContext key, ctx;
+    int midstate;
     
     assert(dk != NULL || dkLen == 0);
     assert(hash != NULL);
@@ -1118,15 +1659,30 @@ void BRPBKDF2(void *dk, size_t dkLen, void (*hash)(void *, const void *, size_t)
     assert(rounds > 0);
     
     memcpy(s, salt, saltLen);
+    // the key blocks are hashed once, so each round costs one inner and one outer compression instead of four
+    midstate = BRHMACInit(&key, hash, hashLen, pw, pwLen);
     
     for (i = 0; i < (dkLen + hashLen - 1)/hashLen; i++) {
         j = be32(i + 1);
         memcpy(s + saltLen, &j, sizeof(j));
-        BRHMAC(U, hash, hashLen, pw, pwLen, s, sizeof(s)); // U1 = hmac_hash(pw, salt || be32(i))
+        
+        if (midstate) { // U1 = hmac_hash(pw, salt || be32(i))
+            ctx = key;
+            BRHMACUpdate(&ctx, s, sizeof(s));
+            BRHMACFinal(&ctx, U);
+        }
+        else BRHMAC(U, hash, hashLen, pw, pwLen, s, sizeof(s));
+        
         memcpy(T, U, sizeof(U));
         
         for (unsigned r = 1; r < rounds; r++) {
-            BRHMAC(U, hash, hashLen, pw, pwLen, U, sizeof(U)); // Urounds = hmac_hash(pw, Urounds-1)
+            if (midstate) { // Urounds = hmac_hash(pw, Urounds-1)
+                ctx = key;
+                BRHMACUpdate(&ctx, U, sizeof(U));
+                BRHMACFinal(&ctx, U);
+            }
+            else BRHMAC(U, hash, hashLen, pw, pwLen, U, sizeof(U));
+            
             for (j = 0; j < hashLen/sizeof(uint32_t); j++) T[j] ^= U[j]; // Ti = U1 ^ U2 ^ ... ^ Urounds
         }
         
@@ -1137,8 +1693,10 @@ void BRPBKDF2(void *dk, size_t dkLen, void (*hash)(void *, const void *, size_t)
     mem_clean(s, sizeof(s));
     mem_clean(U, sizeof(U));
     mem_clean(T, sizeof(T));
+    mem_clean(&key, sizeof(key));
 }
 
+#if !defined(__SSE2__)
 // salsa20/8 stream cipher: http://cr.yp.to/snuffle.html
 static void _salsa20_8(uint32_t b[16])
 {
@@ -1176,15 +1734,163 @@ static void _blockmix_salsa8(uint64_t *dest, const uint64_t *src, uint64_t *b, u
         memcpy(&dest[i*4 + r*8], b, 64);
     }
 }
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+
+#define ROL128(a, b) _mm_or_si128(_mm_slli_epi32((a), (b)), _mm_srli_epi32((a), 32 - (b)))
+
+// salsa20/8 block words in the order their diagonals are loaded into vectors, so a column round is four vector ops and
+// a row round only needs the lanes rotated
+static const uint8_t _salsaDiagonal[16] = { 0, 5, 10, 15, 4, 9, 14, 3, 8, 13, 2, 7, 12, 1, 6, 11 };
+
+// salsa20/8 on a block stored in diagonal order
+static void _salsa20_8_sse2(__m128i b[4])
+{
+    __m128i a = b[0], x = b[1], c = b[2], d = b[3];
+    
+    for (unsigned i = 0; i < 8; i += 2) {
+        // operate on columns
+        x = _mm_xor_si128(x, ROL128(_mm_add_epi32(a, d), 7));
+        c = _mm_xor_si128(c, ROL128(_mm_add_epi32(x, a), 9));
+        d = _mm_xor_si128(d, ROL128(_mm_add_epi32(c, x), 13));
+        a = _mm_xor_si128(a, ROL128(_mm_add_epi32(d, c), 18));
+        
+        // operate on rows
+        x = _mm_shuffle_epi32(x, 0x93), c = _mm_shuffle_epi32(c, 0x4e), d = _mm_shuffle_epi32(d, 0x39);
+        d = _mm_xor_si128(d, ROL128(_mm_add_epi32(a, x), 7));
+        c = _mm_xor_si128(c, ROL128(_mm_add_epi32(d, a), 9));
+        x = _mm_xor_si128(x, ROL128(_mm_add_epi32(c, d), 13));
+        a = _mm_xor_si128(a, ROL128(_mm_add_epi32(x, c), 18));
+        x = _mm_shuffle_epi32(x, 0x39), c = _mm_shuffle_epi32(c, 0x4e), d = _mm_shuffle_epi32(d, 0x93);
+    }
+    
+    b[0] = _mm_add_epi32(b[0], a), b[1] = _mm_add_epi32(b[1], x);
+    b[2] = _mm_add_epi32(b[2], c), b[3] = _mm_add_epi32(b[3], d);
+}
+
+static void _blockmix_salsa8_sse2(__m128i *dest, const __m128i *src, __m128i *b, unsigned r)
+{
+    for (unsigned j = 0; j < 4; j++) b[j] = src[(2*r - 1)*4 + j];
+    
+    for (unsigned i = 0; i < 2*r; i += 2) {
+        for (unsigned j = 0; j < 4; j++) b[j] = _mm_xor_si128(b[j], src[i*4 + j]);
+        _salsa20_8_sse2(b);
+        for (unsigned j = 0; j < 4; j++) dest[i*2 + j] = b[j];
+        for (unsigned j = 0; j < 4; j++) b[j] = _mm_xor_si128(b[j], src[i*4 + 4 + j]);
+        _salsa20_8_sse2(b);
+        for (unsigned j = 0; j < 4; j++) dest[i*2 + r*4 + j] = b[j];
+    }
+}
+
+// scrypt ROMix of the 32*r little endian words of one lane in b, v is 128*r*n bytes of scratch memory
+static void _scrypt_romix(uint32_t *b, unsigned n, unsigned r, void *v)
+{
+    __m128i x[8*r], y[8*r], z[4], *w = v;
+    uint32_t m, *xw = (uint32_t *)x;
+    
+    for (unsigned j = 0; j < 32*r; j++) xw[j] = le32(b[(j & ~15) + _salsaDiagonal[j & 15]]);
+    
+    for (unsigned j = 0; j < n; j += 2) {
+        for (unsigned k = 0; k < 8*r; k++) _mm_storeu_si128(&w[j*(8*r) + k], x[k]);
+        _blockmix_salsa8_sse2(y, x, z, r);
+        for (unsigned k = 0; k < 8*r; k++) _mm_storeu_si128(&w[(j + 1)*(8*r) + k], y[k]);
+        _blockmix_salsa8_sse2(x, y, z, r);
+    }
+    
+    for (unsigned j = 0; j < n; j += 2) {
+        m = (uint32_t)_mm_cvtsi128_si32(x[(2*r - 1)*4]) & (n - 1); // word 0 of the last block leads its diagonal
+        for (unsigned k = 0; k < 8*r; k++) x[k] = _mm_xor_si128(x[k], _mm_loadu_si128(&w[m*(8*r) + k]));
+        _blockmix_salsa8_sse2(y, x, z, r);
+        m = (uint32_t)_mm_cvtsi128_si32(y[(2*r - 1)*4]) & (n - 1);
+        for (unsigned k = 0; k < 8*r; k++) y[k] = _mm_xor_si128(y[k], _mm_loadu_si128(&w[m*(8*r) + k]));
+        _blockmix_salsa8_sse2(x, y, z, r);
+    }
+    
+    for (unsigned j = 0; j < 32*r; j++) b[(j & ~15) + _salsaDiagonal[j & 15]] = le32(xw[j]);
+    mem_clean(x, sizeof(x));
+    mem_clean(y, sizeof(y));
+    mem_clean(z, sizeof(z));
+}
+#else
+// scrypt ROMix of the 32*r little endian words of one lane in b, v is 128*r*n bytes of scratch memory
+static void _scrypt_romix(uint32_t *b, unsigned n, unsigned r, void *v)
+{
+    uint64_t x[16*r], y[16*r], z[8], *w = v, m;
+    
+    for (unsigned j = 0; j < 32*r; j++) ((uint32_t *)x)[j] = le32(b[j]);
+    
+    for (unsigned j = 0; j < n; j += 2) {
+        memcpy(&w[j*(16*r)], x, 128*r);
+        _blockmix_salsa8(y, x, z, r);
+        memcpy(&w[(j + 1)*(16*r)], y, 128*r);
+        _blockmix_salsa8(x, y, z, r);
+    }
+    
+    for (unsigned j = 0; j < n; j += 2) {
+        m = le64(x[(2*r - 1)*8]) & (n - 1);
+        for (unsigned k = 0; k < 16*r; k++) x[k] ^= w[m*(16*r) + k];
+        _blockmix_salsa8(y, x, z, r);
+        m = le64(y[(2*r - 1)*8]) & (n - 1);
+        for (unsigned k = 0; k < 16*r; k++) y[k] ^= w[m*(16*r) + k];
+        _blockmix_salsa8(x, y, z, r);
+    }
+    
+    for (unsigned j = 0; j < 32*r; j++) b[j] = le32(((uint32_t *)x)[j]);
+    mem_clean(x, sizeof(x));
+    mem_clean(y, sizeof(y));
+    mem_clean(z, sizeof(z));
+}
+#endif
+
+typedef struct {
+    uint32_t *b;
+    unsigned n, r, p, next;
+    pthread_mutex_t lock;
+} BRScryptJob;
+
+// runs ROMix on the next unclaimed lane of job until none are left, with scratch memory of its own
+static void *_scrypt_thread(void *info)
+{
+    BRScryptJob *job = info;
+    void *v = malloc(128*job->r*job->n);
+    unsigned i;
+    
+    assert(v != NULL);
+    
+    for (;;) {
+        pthread_mutex_lock(&job->lock);
+        i = job->next;
+        if (i < job->p) job->next++;
+        pthread_mutex_unlock(&job->lock);
+        if (i >= job->p) break;
+        _scrypt_romix(&job->b[i*32*job->r], job->n, job->r, v);
+    }
+    
+    mem_clean(v, 128*job->r*job->n);
+    free(v);
+    return NULL;
+}
 
 // scrypt key derivation: http://www.tarsnap.com/scrypt.html
 void BRScrypt(void *dk, size_t dkLen, const void *pw, size_t pwLen, const void *salt, size_t saltLen,
               unsigned n, unsigned r, unsigned p)
 {
-    uint64_t x[16*r], y[16*r], z[8], *v = malloc(128*r*n), m;
+    BRScryptParallel(dk, dkLen, pw, pwLen, salt, saltLen, n, r, p, 1);
+}
+
+// same as BRScrypt(), with the p lanes computed on up to threadCount threads at once, or one per cpu if threadCount is
+// 0, each thread needs its own 128*r*n bytes of memory
+void BRScryptParallel(void *dk, size_t dkLen, const void *pw, size_t pwLen, const void *salt, size_t saltLen,
+                      unsigned n, unsigned r, unsigned p, size_t threadCount)
+{
     uint32_t b[32*r*p];
+    BRScryptJob job = { b, n, r, p, 0 };
+    pthread_t threads[SCRYPT_MAX_THREADS];
+    size_t i, started = 0;
+    long cpus;
     
-    assert(v != NULL);
     assert(dk != NULL || dkLen == 0);
     assert(pw != NULL || pwLen == 0);
     assert(salt != NULL || saltLen == 0);
@@ -1192,35 +1898,23 @@ void BRScrypt(void *dk, size_t dkLen, const void *pw, size_t pwLen, const void *
     assert(r > 0);
     assert(p > 0);
     
+    if (threadCount == 0) {
+        cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threadCount = (cpus > 0) ? (size_t)cpus : 1;
+    }
+    
+    if (threadCount > p) threadCount = p;
+    if (threadCount > SCRYPT_MAX_THREADS) threadCount = SCRYPT_MAX_THREADS;
     BRPBKDF2(b, sizeof(b), BRSHA256, 256/8, pw, pwLen, salt, saltLen, 1);
+    pthread_mutex_init(&job.lock, NULL);
     
-    for (int i = 0; i < p; i++) {
-        for (unsigned j = 0; j < 32*r; j++) ((uint32_t *)x)[j] = le32(b[i*32*r + j]);
-        
-        for (unsigned j = 0; j < n; j += 2) {
-            memcpy(&v[j*(16*r)], x, 128*r);
-            _blockmix_salsa8(y, x, z, r);
-            memcpy(&v[(j + 1)*(16*r)], y, 128*r);
-            _blockmix_salsa8(x, y, z, r);
-        }
-        
-        for (unsigned j = 0; j < n; j += 2) {
-            m = le64(x[(2*r - 1)*8]) & (n - 1);
-            for (unsigned k = 0; k < 16*r; k++) x[k] ^= v[m*(16*r) + k];
-            _blockmix_salsa8(y, x, z, r);
-            m = le64(y[(2*r - 1)*8]) & (n - 1);
-            for (unsigned k = 0; k < 16*r; k++) y[k] ^= v[m*(16*r) + k];
-            _blockmix_salsa8(x, y, z, r);
-        }
-        
-        for (unsigned j = 0; j < 32*r; j++) b[i*32*r + j] = le32(((uint32_t *)x)[j]);
+    for (i = 1; i < threadCount; i++) {
+        if (pthread_create(&threads[started], NULL, _scrypt_thread, &job) == 0) started++;
     }
     
+    _scrypt_thread(&job);
+    for (i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    pthread_mutex_destroy(&job.lock);
     BRPBKDF2(dk, dkLen, BRSHA256, 256/8, pw, pwLen, b, sizeof(b), 1);
     mem_clean(b, sizeof(b));
-    mem_clean(x, sizeof(x));
-    mem_clean(y, sizeof(y));
-    mem_clean(z, sizeof(z));
-    mem_clean(v, 128*r*n);
-    free(v);
 }
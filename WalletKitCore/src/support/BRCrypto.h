@@ -60,6 +60,13 @@ void BRSHA3_256(void *md32, const void *data, size_t dataLen);
 // keccak-256: https://keccak.team/files/Keccak-submission-3.pdf
 void BRKeccak256(void *md32, const void *data, size_t dataLen);
 
+// keccak-256 of count independent messages, the ith digest is written to md32s + 32*i
+// on x86-64 cpus with AVX2 the messages are hashed four at a time
+void BRKeccak256Batch(void *md32s, const void *data[], const size_t dataLen[], size_t count);
+
+// keccak-f[1600] permutation of the 25 lane keccak state, lanes in host byte order
+void BRKeccakF1600(uint64_t state[25]);
+
 // md5 - for non-cryptographic use only
 void BRMD5(void *md16, const void *data, size_t dataLen);
 
@@ -68,10 +75,88 @@ uint32_t BRMurmur3_32(const void *data, size_t dataLen, uint32_t seed);
 
 // sipHash-64: https://131002.net/siphash
 uint64_t BRSip64(const void *key16, const void *data, size_t dataLen);
+
+// incremental hashing: call Init, then Update any number of times, then Final, which writes the digest and wipes the
+// context, a context may be copied to hash several messages that share a prefix
+typedef struct { uint32_t h[5], x[80]; uint64_t len; } BRSHA1Context;
+
+void BRSHA1Init(BRSHA1Context *ctx);
+void BRSHA1Update(BRSHA1Context *ctx, const void *data, size_t dataLen);
+void BRSHA1Final(BRSHA1Context *ctx, void *md20);
+
+// sha-256 context, also used for sha-224
+typedef struct { uint32_t h[8], x[16]; uint64_t len; size_t mdLen; } BRSHA256Context;
+
+void BRSHA224Init(BRSHA256Context *ctx);
+void BRSHA256Init(BRSHA256Context *ctx);
+void BRSHA256Update(BRSHA256Context *ctx, const void *data, size_t dataLen);
+void BRSHA256Final(BRSHA256Context *ctx, void *md); // writes 32 bytes, or 28 for sha-224
+
+// sha-512 context, also used for sha-384
+typedef struct { uint64_t h[8], x[16]; uint64_t len; size_t mdLen; } BRSHA512Context;
+
+void BRSHA384Init(BRSHA512Context *ctx);
+void BRSHA512Init(BRSHA512Context *ctx);
+void BRSHA512Update(BRSHA512Context *ctx, const void *data, size_t dataLen);
+void BRSHA512Final(BRSHA512Context *ctx, void *md); // writes 64 bytes, or 48 for sha-384
+
+typedef struct { uint32_t h[5], x[16]; uint64_t len; } BRRMD160Context;
+
+void BRRMD160Init(BRRMD160Context *ctx);
+void BRRMD160Update(BRRMD160Context *ctx, const void *data, size_t dataLen);
+void BRRMD160Final(BRRMD160Context *ctx, void *md20);
+
+// sha3-256 and keccak-256 context
+typedef struct { uint64_t s[25], x[17]; uint64_t len; uint8_t pad; } BRKeccakContext;
+
+void BRSHA3_256Init(BRKeccakContext *ctx);
+void BRKeccak256Init(BRKeccakContext *ctx);
+void BRKeccakUpdate(BRKeccakContext *ctx, const void *data, size_t dataLen);
+void BRKeccakFinal(BRKeccakContext *ctx, void *md32);
+
+typedef struct { uint32_t h[4], x[16]; uint64_t len; } BRMD5Context;
+
+void BRMD5Init(BRMD5Context *ctx);
+void BRMD5Update(BRMD5Context *ctx, const void *data, size_t dataLen);
+void BRMD5Final(BRMD5Context *ctx, void *md16);
+
+// context for any of the hashes above, selected by the one-shot hash function
+typedef struct {
+    void (*hash)(void *, const void *, size_t);
+    union {
+        BRSHA1Context sha1;
+        BRSHA256Context sha256;
+        BRSHA512Context sha512;
+        BRRMD160Context rmd160;
+        BRKeccakContext keccak;
+        BRMD5Context md5;
+    } u;
+} BRHashContext;
+
+// initializes ctx for incremental hashing with hash, returns false if hash isn't one of BRSHA1, BRSHA224, BRSHA256,
+// BRSHA384, BRSHA512, BRRMD160, BRSHA3_256, BRKeccak256 or BRMD5
+int BRHashInit(BRHashContext *ctx, void (*hash)(void *, const void *, size_t));
+
+void BRHashUpdate(BRHashContext *ctx, const void *data, size_t dataLen);
+
+// writes the digest of all data passed to BRHashUpdate() to md and wipes ctx
+void BRHashFinal(BRHashContext *ctx, void *md);
     
 void BRHMAC(void *mac, void (*hash)(void *, const void *, size_t), size_t hashLen, const void *key, size_t keyLen,
             const void *data, size_t dataLen);
 
+typedef struct { BRHashContext inner, outer; size_t hashLen; } BRHMACContext;
+
+// initializes ctx with the inner and outer hash states after the key blocks, so that a copy of ctx can be reused to
+// mac any number of messages without rehashing the key, returns false if hash has no incremental context
+int BRHMACInit(BRHMACContext *ctx, void (*hash)(void *, const void *, size_t), size_t hashLen, const void *key,
+               size_t keyLen);
+
+void BRHMACUpdate(BRHMACContext *ctx, const void *data, size_t dataLen);
+
+// writes the mac of all data passed to BRHMACUpdate() to mac and wipes ctx
+void BRHMACFinal(BRHMACContext *ctx, void *mac);
+
 // hmac-drbg with no prediction resistance or additional input
 // K and V must point to buffers of size hashLen, and ps (personalization string) may be NULL
 // to generate additional drbg output, use K and V from the previous call, and set seed, nonce and ps to NULL
@@ -108,6 +193,11 @@ void BRPBKDF2(void *dk, size_t dkLen, void (*hash)(void *, const void *, size_t)
 void BRScrypt(void *dk, size_t dkLen, const void *pw, size_t pwLen, const void *salt, size_t saltLen,
               unsigned n, unsigned r, unsigned p);
 
+// same as BRScrypt(), with the p lanes computed on up to threadCount threads at once, or one per cpu if threadCount is
+// 0, each thread needs its own 128*r*n bytes of memory
+void BRScryptParallel(void *dk, size_t dkLen, const void *pw, size_t pwLen, const void *salt, size_t saltLen,
+                      unsigned n, unsigned r, unsigned p, size_t threadCount);
+
 // zeros out memory in a way that can't be optimized out by the compiler
 inline static void mem_clean(void *ptr, size_t len)
 {
@@ -60,6 +60,9 @@ typedef char FileServiceSQL[1024];
 #define FILE_SERVICE_SDB_QUERY_ALL_ENTITY     \
 "SELECT Hash, Data FROM Entity WHERE Type = ?;"
 
+#define FILE_SERVICE_SDB_QUERY_ALL_HASH     \
+"SELECT Hash FROM Entity WHERE Type = ?;"
+
 #define FILE_SERVICE_SDB_UPDATE_ENTITY     \
 "UPDATE Entity SET Data = ? WHERE Type = ? AND Hash = ?;"
 
@@ -111,6 +114,11 @@ fileServiceFailedSDB (BRFileService fs,
                       int releaseLock,
                       sqlite3_status_code code);
 
+#if !defined(NEUTER_FILE_SERVICE)
+static void
+fileServiceWriteBehindStop (BRFileService fs);
+#endif
+
 /// Return 0 on success, -1 otherwise
 static int directoryMake (const char *path) {
     struct stat dirStat;
@@ -176,6 +184,14 @@ fileServiceEntityTypeAddHandler (BRFileServiceEntityType *entityType,
         *existingHandler = *handler;
 }
 
+/// A write queued for write-behind; see 'MARK: - Write Behind'
+typedef struct BRFileServiceJournalEntryRecord BRFileServiceJournalEntry;
+
+#if !defined(NEUTER_FILE_SERVICE)
+static void
+fileServiceJournalRelease (BRArrayOf(BRFileServiceJournalEntry *) entries);
+#endif
+
 ///
 ///
 ///
@@ -189,11 +205,25 @@ struct BRFileServiceRecord {
     sqlite3_stmt *sdbInsertStmt;
     sqlite3_stmt *sdbSelectStmt;
     sqlite3_stmt *sdbSelectAllStmt;
+    sqlite3_stmt *sdbSelectAllHashStmt;
     sqlite3_stmt *sdbUpdateStmt;
     sqlite3_stmt *sdbDeleteStmt;
     sqlite3_stmt *sdbDeleteAllTypeStmt;
     sqlite3_stmt *sdbDeleteAllStmt;
     bool  sdbClosed;
+
+    // Write-behind: writes queue in `journal` and `writer` commits them in groups.
+    bool writeBehind;
+    pthread_t writer;
+    pthread_mutex_t journalLock;
+    pthread_cond_t  journalCond;            // wakes `writer`: full journal, flush or stop
+    pthread_cond_t  journalCommittedCond;   // wakes flushers: `journalCommitted` advanced
+    BRArrayOf(BRFileServiceJournalEntry *) journal;  // in order
+    BRSet *journalIndex;                    // the SAVE and REMOVE entries in `journal`
+    uint64_t journalQueued;                 // count of writes ever queued ...
+    uint64_t journalCommitted;              // ... and of those committed
+    bool journalFlush;
+    bool journalStop;
 #endif
 
     BRArrayOf(BRFileServiceEntityType) entityTypes;
@@ -257,6 +287,12 @@ fileServiceCreate (const char *basePath,
 
     pthread_mutex_init_brd (&fs->lock, PTHREAD_MUTEX_NORMAL);
 
+#if !defined(NEUTER_FILE_SERVICE)
+    pthread_mutex_init_brd (&fs->journalLock, PTHREAD_MUTEX_NORMAL);
+    pthread_cond_init (&fs->journalCond, NULL);
+    pthread_cond_init (&fs->journalCommittedCond, NULL);
+#endif
+
     // Set the error handler - early
     fileServiceSetErrorHandler (fs, context, handler);
 
@@ -318,6 +354,14 @@ fileServiceCreate (const char *basePath,
             { .sdb = { status }}
         });
 
+    // Create the SQLITE "Select Entity Hash' Statement
+    status = sqlite3_prepare_v2 (fs->sdb, FILE_SERVICE_SDB_QUERY_ALL_HASH, -1, &fs->sdbSelectAllHashStmt, NULL);
+    if (SQLITE_OK != status)
+        return fileServiceCreateReturnError (fs, 1, (BRFileServiceError) {
+            FILE_SERVICE_SDB,
+            { .sdb = { status }}
+        });
+
     status = sqlite3_prepare_v2 (fs->sdb, FILE_SERVICE_SDB_UPDATE_ENTITY, -1, &fs->sdbUpdateStmt, NULL);
     if (SQLITE_OK != status)
         return fileServiceCreateReturnError (fs, 1, (BRFileServiceError) {
@@ -377,6 +421,7 @@ _fileServiceCloseInternal (BRFileService fs) {
     _fileServiceFinalizeStmt (fs, &fs->sdbInsertStmt);
     _fileServiceFinalizeStmt (fs, &fs->sdbSelectStmt);
     _fileServiceFinalizeStmt (fs, &fs->sdbSelectAllStmt);
+    _fileServiceFinalizeStmt (fs, &fs->sdbSelectAllHashStmt);
     _fileServiceFinalizeStmt (fs, &fs->sdbUpdateStmt);
     _fileServiceFinalizeStmt (fs, &fs->sdbDeleteStmt);
     _fileServiceFinalizeStmt (fs, &fs->sdbDeleteAllTypeStmt);
@@ -390,6 +435,8 @@ _fileServiceCloseInternal (BRFileService fs) {
 extern void
 fileServiceClose (BRFileService fs) {
 #if !defined(NEUTER_FILE_SERVICE)
+    fileServiceWriteBehindStop (fs);
+
     pthread_mutex_lock (&fs->lock);
     _fileServiceCloseInternal(fs);
     pthread_mutex_unlock (&fs->lock);
@@ -400,10 +447,19 @@ fileServiceClose (BRFileService fs) {
 // careful with fields that might not yet exist.
 extern void
 fileServiceRelease (BRFileService fs) {
+#if !defined(NEUTER_FILE_SERVICE)
+    fileServiceWriteBehindStop (fs);
+#endif
+
     pthread_mutex_lock (&fs->lock);
 
 #if !defined(NEUTER_FILE_SERVICE)
     _fileServiceCloseInternal(fs);
+
+    if (NULL != fs->journal) {
+        fileServiceJournalRelease (fs->journal);
+        BRSetFree (fs->journalIndex);
+    }
 #endif
 
     if (NULL != fs->entityTypes) {
@@ -420,6 +476,12 @@ fileServiceRelease (BRFileService fs) {
     pthread_mutex_unlock (&fs->lock);
     pthread_mutex_destroy(&fs->lock);
 
+#if !defined(NEUTER_FILE_SERVICE)
+    pthread_cond_destroy  (&fs->journalCommittedCond);
+    pthread_cond_destroy  (&fs->journalCond);
+    pthread_mutex_destroy (&fs->journalLock);
+#endif
+
     free (fs);
 }
 
@@ -542,23 +604,13 @@ fileServiceFailedEntity(BRFileService fs,
 
 /// MARK: - Save
 
-static int
-_fileServiceSave (BRFileService fs,
-                  const char *type,  /* block, peers, transactions, logs, ... */
-                  const void *entity,
-                  int needLock) {     /* BRMerkleBlock*, BRTransaction, BREthereumTransaction, ... */
-
-    BRFileServiceEntityType *entityType = fileServiceLookupType (fs, type);
-    if (NULL == entityType) { fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type"); return 0; };
-
-    BRFileServiceEntityHandler *handler = fileServiceEntityTypeLookupHandler(entityType, entityType->currentVersion);
-    if (NULL == handler) { fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type handler"); return 0; };
-
 #if !defined(NEUTER_FILE_SERVICE)
-    // Get then hex-encode the identifer
-    UInt256 identifier = handler->identifier (handler->context, fs, entity);
-    const char *hash = u256hex(identifier);
-
+// Return the `Data` column for `entity`: the hex-encoded entity bytes, extended with the current header format.
+static char *
+_fileServiceEncode (BRFileService fs,
+                    BRFileServiceEntityType *entityType,
+                    BRFileServiceEntityHandler *handler,
+                    const void *entity) {
     // Get the entity bytes
     uint32_t entityBytesCount;
     uint8_t *entityBytes = handler->writer (handler->context, fs, entity, &entityBytesCount);
@@ -589,6 +641,102 @@ _fileServiceSave (BRFileService fs,
     hexEncode (data, dataCount, bytes, bytesCount);
     free (bytes);
 
+    return data;
+}
+
+// Insert, or replace, the row for {type, hash}.  The caller holds the lock.
+static sqlite3_status_code
+_fileServiceInsert (BRFileService fs,
+                    const char *type,
+                    const char *hash,
+                    const char *data) {
+    sqlite3_status_code status;
+
+    sqlite3_reset (fs->sdbInsertStmt);
+    sqlite3_clear_bindings(fs->sdbInsertStmt);
+
+    status = sqlite3_bind_text (fs->sdbInsertStmt, 1, type, -1, SQLITE_STATIC);
+    if (SQLITE_OK != status) return status;
+
+    status = sqlite3_bind_text (fs->sdbInsertStmt, 2, hash, -1, SQLITE_STATIC);
+    if (SQLITE_OK != status) return status;
+
+    status = sqlite3_bind_text (fs->sdbInsertStmt, 3, data, -1, SQLITE_STATIC);
+    if (SQLITE_OK != status) return status;
+
+    status = sqlite3_step (fs->sdbInsertStmt);
+
+    // Ensure the 'implicit DB transaction' is committed.
+    sqlite3_reset (fs->sdbInsertStmt);
+
+    return (SQLITE_DONE == status ? SQLITE_OK : status);
+}
+
+// Delete the row for {type, hash}, if there is one.  The caller holds the lock.
+static sqlite3_status_code
+_fileServiceDelete (BRFileService fs,
+                    const char *type,
+                    const char *hash) {
+    sqlite3_status_code status;
+
+    sqlite3_reset (fs->sdbDeleteStmt);
+    sqlite3_clear_bindings (fs->sdbDeleteStmt);
+
+    status = sqlite3_bind_text (fs->sdbDeleteStmt, 1, type, -1, SQLITE_STATIC);
+    if (SQLITE_OK != status) return status;
+
+    status = sqlite3_bind_text (fs->sdbDeleteStmt, 2, hash, -1, SQLITE_STATIC);
+    if (SQLITE_OK != status) return status;
+
+    status = sqlite3_step (fs->sdbDeleteStmt);
+
+    // Ensure the 'implicit DB transaction' is committed.
+    sqlite3_reset (fs->sdbDeleteStmt);
+
+    return (SQLITE_DONE == status ? SQLITE_OK : status);
+}
+
+// Delete every row of `type`.  The caller holds the lock.
+static sqlite3_status_code
+_fileServiceDeleteType (BRFileService fs,
+                        const char *type) {
+    sqlite3_status_code status;
+
+    sqlite3_reset (fs->sdbDeleteAllTypeStmt);
+    sqlite3_clear_bindings (fs->sdbDeleteAllTypeStmt);
+
+    status = sqlite3_bind_text (fs->sdbDeleteAllTypeStmt, 1, type, -1, SQLITE_STATIC);
+    if (SQLITE_OK != status) return status;
+
+    status = sqlite3_step (fs->sdbDeleteAllTypeStmt);
+
+    // Ensure the 'implicit DB transaction' is committed.
+    sqlite3_reset (fs->sdbDeleteAllTypeStmt);
+
+    return (SQLITE_DONE == status ? SQLITE_OK : status);
+}
+#endif // !defined(NEUTER_FILE_SERVICE)
+
+static int
+_fileServiceSave (BRFileService fs,
+                  const char *type,  /* block, peers, transactions, logs, ... */
+                  const void *entity,
+                  int needLock) {     /* BRMerkleBlock*, BRTransaction, BREthereumTransaction, ... */
+
+    BRFileServiceEntityType *entityType = fileServiceLookupType (fs, type);
+    if (NULL == entityType) { fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type"); return 0; };
+
+    BRFileServiceEntityHandler *handler = fileServiceEntityTypeLookupHandler(entityType, entityType->currentVersion);
+    if (NULL == handler) { fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type handler"); return 0; };
+
+#if !defined(NEUTER_FILE_SERVICE)
+    // Get then hex-encode the identifer
+    UInt256 identifier = handler->identifier (handler->context, fs, entity);
+    const char *hash = u256hex(identifier);
+
+    // Get the entity data
+    char *data = _fileServiceEncode (fs, entityType, handler, entity);
+
     // Fill out the SQL statement
     sqlite3_status_code status;
 
@@ -596,51 +744,542 @@ _fileServiceSave (BRFileService fs,
         pthread_mutex_lock (&fs->lock);
 
     if (fs->sdbClosed)
-        return fileServiceFailedImpl (fs, needLock, NULL, NULL, "closed");
+        return fileServiceFailedImpl (fs, needLock, data, NULL, "closed");
 
-    sqlite3_reset (fs->sdbInsertStmt);
-    sqlite3_clear_bindings(fs->sdbInsertStmt);
-
-    status = sqlite3_bind_text (fs->sdbInsertStmt, 1, type, -1, SQLITE_STATIC);
+    status = _fileServiceInsert (fs, type, hash, data);
     if (SQLITE_OK != status) {
         free (data);
         return fileServiceFailedSDB (fs, needLock, status);
     }
 
-    status = sqlite3_bind_text (fs->sdbInsertStmt, 2, hash, -1, SQLITE_STATIC);
-    if (SQLITE_OK != status) {
-        free (data);
-        return fileServiceFailedSDB (fs, needLock, status);
+    if (needLock)
+        pthread_mutex_unlock (&fs->lock);
+
+    free (data);
+#endif // !defined(NEUTER_FILE_SERVICE)
+
+    return 1;
+}
+
+#if !defined(NEUTER_FILE_SERVICE)
+/// MARK: - Replace Records
+
+///
+/// An entity to be written by fileServiceReplace(), with its hex-encoded identifier and data.
+///
+typedef struct {
+    char hash[65];
+    char *data;
+    size_t index;   // position in `entities`, so that the last of any duplicates is the one written
+    int stored;     // true if the DB already holds `data` for `hash`
+} BRFileServiceReplaceRecord;
+
+static int
+fileServiceReplaceRecordCompare (const void *r1, const void *r2) {
+    const BRFileServiceReplaceRecord *record1 = r1, *record2 = r2;
+    int order = strcmp (record1->hash, record2->hash);
+    return (0 != order ? order : (record1->index < record2->index ? -1 : (record1->index > record2->index ? 1 : 0)));
+}
+
+static int
+fileServiceReplaceRecordHashCompare (const void *hash, const void *r) {
+    return strcmp (hash, ((const BRFileServiceReplaceRecord *) r)->hash);
+}
+
+static void
+fileServiceReplaceRecordsRelease (BRFileServiceReplaceRecord *records,
+                                  size_t recordsCount) {
+    for (size_t index = 0; index < recordsCount; index++)
+        free (records[index].data);
+    free (records);
+}
+
+// Encode `entities` as records sorted by hash, keeping only the last of any entities sharing an
+// identifier, as writing each in turn would have.
+static BRFileServiceReplaceRecord *
+_fileServiceReplaceRecordsCreate (BRFileService fs,
+                                  BRFileServiceEntityType *entityType,
+                                  BRFileServiceEntityHandler *handler,
+                                  const void **entities,
+                                  size_t entitiesCount,
+                                  size_t *recordsCount) {
+    BRFileServiceReplaceRecord *records = calloc (entitiesCount + 1, sizeof (BRFileServiceReplaceRecord));
+
+    for (size_t index = 0; index < entitiesCount; index++) {
+        UInt256 identifier = handler->identifier (handler->context, fs, entities[index]);
+        strcpy (records[index].hash, u256hex (identifier));
+        records[index].data  = _fileServiceEncode (fs, entityType, handler, entities[index]);
+        records[index].index = index;
     }
 
-    status = sqlite3_bind_text (fs->sdbInsertStmt, 3, data, -1, SQLITE_STATIC);
-    if (SQLITE_OK != status) {
-        free (data);
-        return fileServiceFailedSDB (fs, needLock, status);
+    qsort (records, entitiesCount, sizeof (BRFileServiceReplaceRecord), fileServiceReplaceRecordCompare);
+
+    *recordsCount = 0;
+    for (size_t index = 0; index < entitiesCount; index++) {
+        if (index + 1 < entitiesCount && 0 == strcmp (records[index].hash, records[index + 1].hash))
+            free (records[index].data);
+        else records[(*recordsCount)++] = records[index];
     }
 
-    status = sqlite3_step (fs->sdbInsertStmt);
-    if (SQLITE_DONE != status) {
-        free (data);
-        return fileServiceFailedSDB (fs, needLock, status);
+    return records;
+}
+
+// Make the rows of `type` match `records`: rows whose hash isn't among the records are deleted and
+// a record is inserted only if its row is missing or holds other data.  The caller holds the lock
+// and has begun a DB transaction.
+static sqlite3_status_code
+_fileServiceReplaceRecords (BRFileService fs,
+                            const char *type,
+                            BRFileServiceReplaceRecord *records,
+                            size_t recordsCount) {
+    sqlite3_status_code status;
+
+    BRArrayOf(char *) removed;
+    array_new (removed, 10);
+
+    // Match the stored rows against the records, by hash alone; the scan stays in the primary
+    // key's index and reads no Data.  A matched record is marked `stored` for now.
+    sqlite3_reset (fs->sdbSelectAllHashStmt);
+    sqlite3_clear_bindings (fs->sdbSelectAllHashStmt);
+
+    status = sqlite3_bind_text (fs->sdbSelectAllHashStmt, 1, type, -1, SQLITE_STATIC);
+    if (SQLITE_OK == status) {
+        while (SQLITE_ROW == (status = sqlite3_step (fs->sdbSelectAllHashStmt))) {
+            const char *hash = (const char *) sqlite3_column_text (fs->sdbSelectAllHashStmt, 0);
+            if (NULL == hash) continue;
+
+            BRFileServiceReplaceRecord *record = bsearch (hash, records, recordsCount,
+                                                          sizeof (BRFileServiceReplaceRecord),
+                                                          fileServiceReplaceRecordHashCompare);
+
+            if (NULL == record) array_add (removed, strdup (hash));
+            else record->stored = 1;
+        }
+        if (SQLITE_DONE == status) status = SQLITE_OK;
     }
 
     // Ensure the 'implicit DB transaction' is committed.
-    sqlite3_reset (fs->sdbInsertStmt);
+    sqlite3_reset (fs->sdbSelectAllHashStmt);
 
-    if (needLock)
-        pthread_mutex_unlock (&fs->lock);
+    // Only a matched record's row is read, to see if it already holds the record's data.
+    for (size_t index = 0; SQLITE_OK == status && index < recordsCount; index++) {
+        if (!records[index].stored) continue;
 
-    free (data);
+        sqlite3_reset (fs->sdbSelectStmt);
+        sqlite3_clear_bindings (fs->sdbSelectStmt);
+
+        status = sqlite3_bind_text (fs->sdbSelectStmt, 1, type, -1, SQLITE_STATIC);
+        if (SQLITE_OK == status)
+            status = sqlite3_bind_text (fs->sdbSelectStmt, 2, records[index].hash, -1, SQLITE_STATIC);
+        if (SQLITE_OK != status) break;
+
+        status = sqlite3_step (fs->sdbSelectStmt);
+        if (SQLITE_ROW == status) {
+            const char *data = (const char *) sqlite3_column_text (fs->sdbSelectStmt, 0);
+            records[index].stored = (NULL != data && 0 == strcmp (records[index].data, data));
+            status = SQLITE_OK;
+        }
+        else if (SQLITE_DONE == status) {
+            records[index].stored = 0;
+            status = SQLITE_OK;
+        }
+    }
+
+    sqlite3_reset (fs->sdbSelectStmt);
+
+    // Delete the rows without a record and write the records that aren't stored.
+    for (size_t index = 0; SQLITE_OK == status && index < array_count(removed); index++)
+        status = _fileServiceDelete (fs, type, removed[index]);
+
+    for (size_t index = 0; SQLITE_OK == status && index < recordsCount; index++)
+        if (!records[index].stored)
+            status = _fileServiceInsert (fs, type, records[index].hash, records[index].data);
+
+    for (size_t index = 0; index < array_count(removed); index++)
+        free (removed[index]);
+    array_free (removed);
+
+    return status;
+}
+
+/// MARK: - Write Behind
+
+#define FILE_SERVICE_JOURNAL_INITIAL_COUNT      (256)
+#define FILE_SERVICE_JOURNAL_COMMIT_COUNT       (256)           // commit once this many entries are queued ...
+#define FILE_SERVICE_JOURNAL_COMMIT_PERIOD      { 1, 0 }        // ... or this long after the last commit
+#define FILE_SERVICE_JOURNAL_THREAD_STACK_SIZE  (512 * 1024)
+
+typedef enum {
+    FILE_SERVICE_JOURNAL_SAVE,
+    FILE_SERVICE_JOURNAL_REMOVE,
+    FILE_SERVICE_JOURNAL_REPLACE,
+    FILE_SERVICE_JOURNAL_CLEAR
+} BRFileServiceJournalOperation;
+
+///
+/// A write queued for the writer thread.  A SAVE or REMOVE is indexed by {type, hash} so that a
+/// later write of the same entity replaces it; a REPLACE or CLEAR supersedes every queued write of
+/// its type.
+///
+struct BRFileServiceJournalEntryRecord {
+    BRFileServiceJournalOperation operation;
+    char *type;
+    char hash[65];                          // SAVE, REMOVE
+    char *data;                             // SAVE
+    BRFileServiceReplaceRecord *records;    // REPLACE
+    size_t recordsCount;                    // REPLACE
+};
+
+static BRFileServiceJournalEntry *
+fileServiceJournalEntryCreate (BRFileServiceJournalOperation operation,
+                               const char *type) {
+    BRFileServiceJournalEntry *entry = calloc (1, sizeof (BRFileServiceJournalEntry));
+    entry->operation = operation;
+    entry->type = strdup (type);
+    return entry;
+}
+
+static void
+fileServiceJournalEntryRelease (BRFileServiceJournalEntry *entry) {
+    if (NULL != entry->records) fileServiceReplaceRecordsRelease (entry->records, entry->recordsCount);
+    if (NULL != entry->data) free (entry->data);
+    free (entry->type);
+    free (entry);
+}
+
+static size_t
+fileServiceJournalEntryHash (const void *e) {
+    const BRFileServiceJournalEntry *entry = e;
+    size_t hash = 0;
+    for (const char *c = entry->hash; *c; c++) hash = 31 * hash + (uint8_t) *c;
+    for (const char *c = entry->type; *c; c++) hash = 31 * hash + (uint8_t) *c;
+    return hash;
+}
+
+static int
+fileServiceJournalEntryEqual (const void *e1, const void *e2) {
+    const BRFileServiceJournalEntry *entry1 = e1, *entry2 = e2;
+    return 0 == strcmp (entry1->hash, entry2->hash) && 0 == strcmp (entry1->type, entry2->type);
+}
+
+static int
+fileServiceJournalCommitAndRelease (BRFileService fs,
+                                    BRArrayOf(BRFileServiceJournalEntry *) entries);
+
+// Queue `entry`, taking ownership of it.
+static int
+fileServiceJournalAdd (BRFileService fs,
+                       BRFileServiceJournalEntry *entry) {
+    pthread_mutex_lock (&fs->journalLock);
+
+    // Write-behind stopped after our caller looked; commit now, in order with the final batch.
+    if (!fs->writeBehind) {
+        BRArrayOf(BRFileServiceJournalEntry *) entries;
+        array_new (entries, 1);
+        array_add (entries, entry);
+        int success = fileServiceJournalCommitAndRelease (fs, entries);
+        pthread_mutex_unlock (&fs->journalLock);
+        return success;
+    }
+
+    switch (entry->operation) {
+        case FILE_SERVICE_JOURNAL_SAVE:
+        case FILE_SERVICE_JOURNAL_REMOVE: {
+            BRFileServiceJournalEntry *existing = BRSetGet (fs->journalIndex, entry);
+
+            // Coalesce with the queued write of the same entity; none of its type's REPLACE or
+            // CLEAR can follow it, so taking its place keeps the order.
+            if (NULL != existing) {
+                if (NULL != existing->data) free (existing->data);
+                existing->operation = entry->operation;
+                existing->data      = entry->data;
+                entry->data = NULL;
+                fileServiceJournalEntryRelease (entry);
+            }
+            else {
+                array_add (fs->journal, entry);
+                BRSetAdd  (fs->journalIndex, entry);
+            }
+            break;
+        }
+
+        case FILE_SERVICE_JOURNAL_REPLACE:
+        case FILE_SERVICE_JOURNAL_CLEAR: {
+            size_t count = 0;
+            for (size_t index = 0; index < array_count(fs->journal); index++) {
+                BRFileServiceJournalEntry *queued = fs->journal[index];
+                if (0 == strcmp (queued->type, entry->type)) {
+                    BRSetRemove (fs->journalIndex, queued);
+                    fileServiceJournalEntryRelease (queued);
+                }
+                else fs->journal[count++] = queued;
+            }
+            array_set_count (fs->journal, count);
+            array_add (fs->journal, entry);
+            break;
+        }
+    }
+
+    fs->journalQueued += 1;
+    if (FILE_SERVICE_JOURNAL_COMMIT_COUNT == array_count (fs->journal))
+        pthread_cond_signal (&fs->journalCond);
+
+    pthread_mutex_unlock (&fs->journalLock);
+    return 1;
+}
+
+// Write `entries`, in order, in one DB transaction.
+static int
+fileServiceJournalCommit (BRFileService fs,
+                          BRArrayOf(BRFileServiceJournalEntry *) entries) {
+    sqlite3_status_code status;
+
+    pthread_mutex_lock (&fs->lock);
+    if (fs->sdbClosed)
+        return fileServiceFailedImpl (fs, 1, NULL, NULL, "closed");
+
+    status = sqlite3_exec (fs->sdb, "BEGIN", NULL, NULL, NULL);
+    if (SQLITE_OK != status)
+        return fileServiceFailedSDB (fs, 1, status);
+
+    for (size_t index = 0; SQLITE_OK == status && index < array_count(entries); index++) {
+        BRFileServiceJournalEntry *entry = entries[index];
+        switch (entry->operation) {
+            case FILE_SERVICE_JOURNAL_SAVE:
+                status = _fileServiceInsert (fs, entry->type, entry->hash, entry->data);
+                break;
+            case FILE_SERVICE_JOURNAL_REMOVE:
+                status = _fileServiceDelete (fs, entry->type, entry->hash);
+                break;
+            case FILE_SERVICE_JOURNAL_REPLACE:
+                status = _fileServiceReplaceRecords (fs, entry->type, entry->records, entry->recordsCount);
+                break;
+            case FILE_SERVICE_JOURNAL_CLEAR:
+                status = _fileServiceDeleteType (fs, entry->type);
+                break;
+        }
+    }
+
+    if (SQLITE_OK == status)
+        status = sqlite3_exec (fs->sdb, "COMMIT", NULL, NULL, NULL);
+
+    if (SQLITE_OK != status) {
+        sqlite3_exec (fs->sdb, "ROLLBACK", NULL, NULL, NULL);
+        return fileServiceFailedSDB (fs, 1, status);
+    }
+
+    pthread_mutex_unlock (&fs->lock);
+    return 1;
+}
+
+// Take every queued entry.  The caller holds the journalLock.
+static BRArrayOf(BRFileServiceJournalEntry *)
+fileServiceJournalTake (BRFileService fs) {
+    BRArrayOf(BRFileServiceJournalEntry *) entries = fs->journal;
+    array_new (fs->journal, FILE_SERVICE_JOURNAL_INITIAL_COUNT);
+    BRSetClear (fs->journalIndex);
+    return entries;
+}
+
+static void
+fileServiceJournalRelease (BRArrayOf(BRFileServiceJournalEntry *) entries) {
+    for (size_t index = 0; index < array_count(entries); index++)
+        fileServiceJournalEntryRelease (entries[index]);
+    array_free (entries);
+}
+
+// Put back the `entries` of a failed commit, ahead of those queued since and without any that a
+// later queued write supersedes.  The caller holds the journalLock.
+static void
+fileServiceJournalRequeue (BRFileService fs,
+                           BRArrayOf(BRFileServiceJournalEntry *) entries) {
+    BRArrayOf(BRFileServiceJournalEntry *) journal;
+    array_new (journal, array_count (entries) + array_count (fs->journal));
+
+    for (size_t index = 0; index < array_count(entries); index++) {
+        BRFileServiceJournalEntry *entry = entries[index];
+        bool superseded = (NULL != BRSetGet (fs->journalIndex, entry));
+
+        for (size_t later = 0; !superseded && later < array_count(fs->journal); later++)
+            superseded = ((FILE_SERVICE_JOURNAL_REPLACE == fs->journal[later]->operation ||
+                           FILE_SERVICE_JOURNAL_CLEAR   == fs->journal[later]->operation) &&
+                          0 == strcmp (fs->journal[later]->type, entry->type));
+
+        if (superseded) fileServiceJournalEntryRelease (entry);
+        else {
+            array_add (journal, entry);
+            if (FILE_SERVICE_JOURNAL_SAVE   == entry->operation ||
+                FILE_SERVICE_JOURNAL_REMOVE == entry->operation)
+                BRSetAdd (fs->journalIndex, entry);
+        }
+    }
+    array_free (entries);
+
+    array_add_array (journal, fs->journal, array_count (fs->journal));
+    array_free (fs->journal);
+    fs->journal = journal;
+}
+
+static int
+fileServiceJournalCommitAndRelease (BRFileService fs,
+                                    BRArrayOf(BRFileServiceJournalEntry *) entries) {
+    int success = (0 == array_count (entries) || fileServiceJournalCommit (fs, entries));
+    fileServiceJournalRelease (entries);
+    return success;
+}
+
+static void *
+fileServiceWriterThread (BRFileService fs) {
+    pthread_setname_brd (pthread_self(), "Core File Service");
+
+    pthread_mutex_lock (&fs->journalLock);
+    while (1) {
+        // Wait for a full journal, a flush or a stop; or for the period to pass with anything queued.
+        while (!fs->journalStop && !fs->journalFlush &&
+               array_count (fs->journal) < FILE_SERVICE_JOURNAL_COMMIT_COUNT) {
+            struct timespec period = FILE_SERVICE_JOURNAL_COMMIT_PERIOD;
+            if (ETIMEDOUT == pthread_cond_timedwait_relative_brd (&fs->journalCond, &fs->journalLock, &period) &&
+                array_count (fs->journal) > 0)
+                break;
+        }
+
+        BRArrayOf(BRFileServiceJournalEntry *) entries = fileServiceJournalTake (fs);
+        uint64_t queued = fs->journalQueued;
+        fs->journalFlush = false;
+        pthread_mutex_unlock (&fs->journalLock);
+
+        // Commit without the journalLock, so that writes queue meanwhile.
+        bool committed = (0 == array_count (entries) || fileServiceJournalCommit (fs, entries));
+
+        pthread_mutex_lock (&fs->journalLock);
+
+        // On failure, which was reported to the handler, retry the writes with the next commit.
+        // Flushers are released regardless; until then, reads miss the writes.
+        if (committed) fileServiceJournalRelease (entries);
+        else fileServiceJournalRequeue (fs, entries);
+
+        fs->journalCommitted = queued;
+        pthread_cond_broadcast (&fs->journalCommittedCond);
+
+        // On a stop, a failed commit's writes get one last try in fileServiceWriteBehindStop().
+        if (fs->journalStop && (0 == array_count (fs->journal) || !committed)) break;
+    }
+    pthread_mutex_unlock (&fs->journalLock);
+
+    return NULL;
+}
+
+// Commit everything queued and stop the writer thread, if running.
+static void
+fileServiceWriteBehindStop (BRFileService fs) {
+    if (!fs->writeBehind) return;
+
+    pthread_mutex_lock (&fs->journalLock);
+    fs->journalStop = true;
+    pthread_cond_signal (&fs->journalCond);
+    pthread_mutex_unlock (&fs->journalLock);
+
+    pthread_join (fs->writer, NULL);
+    fs->writer = PTHREAD_NULL;
+
+    // Anything queued after the writer's last look, or requeued by a failed commit, is written
+    // here - with the journalLock held so that a write racing this stop commits after it.  If
+    // this commit fails, the writes are lost.
+    pthread_mutex_lock (&fs->journalLock);
+    fs->writeBehind = false;
+    fs->journalStop = false;
+    fileServiceJournalCommitAndRelease (fs, fileServiceJournalTake (fs));
+    fs->journalCommitted = fs->journalQueued;
+    pthread_mutex_unlock (&fs->journalLock);
+}
+#endif // !defined(NEUTER_FILE_SERVICE)
+
+extern int
+fileServiceSetWriteBehind (BRFileService fs,
+                           bool writeBehind) {
+#if !defined(NEUTER_FILE_SERVICE)
+    if (writeBehind == fs->writeBehind) return 1;
+
+    if (!writeBehind) {
+        fileServiceWriteBehindStop (fs);
+        return 1;
+    }
+
+    if (NULL == fs->journal) {
+        array_new (fs->journal, FILE_SERVICE_JOURNAL_INITIAL_COUNT);
+        fs->journalIndex = BRSetNew (fileServiceJournalEntryHash, fileServiceJournalEntryEqual,
+                                     FILE_SERVICE_JOURNAL_INITIAL_COUNT);
+    }
+
+    // The writer commits while other threads read; with WAL, neither blocks the other and a
+    // commit only appends to the log.
+    pthread_mutex_lock (&fs->lock);
+    if (fs->sdbClosed)
+        return fileServiceFailedImpl (fs, 1, NULL, NULL, "closed");
+
+    sqlite3_status_code status = sqlite3_exec (fs->sdb, "PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL;",
+                                               NULL, NULL, NULL);
+    if (SQLITE_OK != status)
+        return fileServiceFailedSDB (fs, 1, status);
+    pthread_mutex_unlock (&fs->lock);
+
+    {
+        pthread_attr_t attr;
+        pthread_attr_init (&attr);
+        pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_JOINABLE);
+        pthread_attr_setstacksize (&attr, FILE_SERVICE_JOURNAL_THREAD_STACK_SIZE);
+
+        int error = pthread_create (&fs->writer, &attr, (ThreadRoutine) fileServiceWriterThread, fs);
+        pthread_attr_destroy (&attr);
+
+        if (0 != error) return fileServiceFailedUnix (fs, 0, NULL, NULL, error);
+    }
+
+    fs->writeBehind = true;
 #endif // !defined(NEUTER_FILE_SERVICE)
 
     return 1;
 }
 
+extern void
+fileServiceFlush (BRFileService fs) {
+#if !defined(NEUTER_FILE_SERVICE)
+    if (!fs->writeBehind) return;
+
+    pthread_mutex_lock (&fs->journalLock);
+    uint64_t queued = fs->journalQueued;
+
+    if (fs->journalCommitted < queued) {
+        fs->journalFlush = true;
+        pthread_cond_signal (&fs->journalCond);
+
+        while (fs->journalCommitted < queued)
+            pthread_cond_wait (&fs->journalCommittedCond, &fs->journalLock);
+    }
+    pthread_mutex_unlock (&fs->journalLock);
+#endif // !defined(NEUTER_FILE_SERVICE)
+}
+
 extern int
 fileServiceSave (BRFileService fs,
                  const char *type,  /* block, peers, transactions, logs, ... */
                  const void *entity) {     /* BRMerkleBlock*, BRTransaction, BREthereumTransaction, ... */
+#if !defined(NEUTER_FILE_SERVICE)
+    if (fs->writeBehind) {
+        BRFileServiceEntityType *entityType = fileServiceLookupType (fs, type);
+        if (NULL == entityType) return fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type");
+
+        BRFileServiceEntityHandler *handler = fileServiceEntityTypeLookupHandler(entityType, entityType->currentVersion);
+        if (NULL == handler) return fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type handler");
+
+        BRFileServiceJournalEntry *entry = fileServiceJournalEntryCreate (FILE_SERVICE_JOURNAL_SAVE, type);
+        strcpy (entry->hash, u256hex (handler->identifier (handler->context, fs, entity)));
+        entry->data = _fileServiceEncode (fs, entityType, handler, entity);
+
+        return fileServiceJournalAdd (fs, entry);
+    }
+#endif
+
     return _fileServiceSave (fs, type, entity, 1);
 }
 
@@ -660,6 +1299,9 @@ fileServiceLoad (BRFileService fs,
 #if !defined(NEUTER_FILE_SERVICE)
     sqlite3_status_code status;
 
+    // Read the queued writes too
+    fileServiceFlush (fs);
+
     pthread_mutex_lock (&fs->lock);
     if (fs->sdbClosed)
         return fileServiceFailedImpl (fs, 1, NULL, NULL, "closed");
@@ -794,30 +1436,22 @@ fileServiceRemoveByIdentifier (BRFileService fs,
     // Hex-Encode identifier
     const char *hash = u256hex(identifier);
 
+    if (fs->writeBehind) {
+        BRFileServiceJournalEntry *entry = fileServiceJournalEntryCreate (FILE_SERVICE_JOURNAL_REMOVE, type);
+        strcpy (entry->hash, hash);
+        return fileServiceJournalAdd (fs, entry);
+    }
+
     sqlite3_status_code status;
 
     pthread_mutex_lock (&fs->lock);
     if (fs->sdbClosed)
         return fileServiceFailedImpl (fs, 1, NULL, NULL, "closed");
 
-    sqlite3_reset (fs->sdbDeleteStmt);
-    sqlite3_clear_bindings (fs->sdbDeleteStmt);
-
-    status = sqlite3_bind_text (fs->sdbDeleteStmt, 1, type, -1, SQLITE_STATIC);
+    status = _fileServiceDelete (fs, type, hash);
     if (SQLITE_OK != status)
         return fileServiceFailedSDB (fs, 1, status);
 
-    status = sqlite3_bind_text (fs->sdbDeleteStmt, 2, hash, -1, SQLITE_STATIC);
-    if (SQLITE_OK != status)
-        return fileServiceFailedSDB (fs, 1, status);
-
-    status = sqlite3_step (fs->sdbDeleteStmt);
-    if (SQLITE_DONE != status)
-        return fileServiceFailedSDB (fs, 1, status);
-
-    // Ensure the 'implicit DB transaction' is committed.
-    sqlite3_reset (fs->sdbDeleteStmt);
-
     pthread_mutex_unlock (&fs->lock);
 #endif // !defined(NEUTER_FILE_SERVICE)
 
@@ -831,26 +1465,19 @@ fileServiceClearForType (BRFileService fs,
 #if !defined(NEUTER_FILE_SERVICE)
     const char *type = entityType->type;
 
+    if (fs->writeBehind)
+        return fileServiceJournalAdd (fs, fileServiceJournalEntryCreate (FILE_SERVICE_JOURNAL_CLEAR, type));
+
     sqlite3_status_code status;
 
     if (needLock) pthread_mutex_lock (&fs->lock);
     if (fs->sdbClosed)
         return fileServiceFailedImpl (fs, needLock, NULL, NULL, "closed");
 
-    sqlite3_reset (fs->sdbDeleteAllTypeStmt);
-    sqlite3_clear_bindings (fs->sdbDeleteAllTypeStmt);
-
-    status = sqlite3_bind_text (fs->sdbDeleteAllTypeStmt, 1, type, -1, SQLITE_STATIC);
+    status = _fileServiceDeleteType (fs, type);
     if (SQLITE_OK != status)
         return fileServiceFailedSDB (fs, needLock, status);
 
-    status = sqlite3_step (fs->sdbDeleteAllTypeStmt);
-    if (SQLITE_DONE != status)
-        return fileServiceFailedSDB (fs, needLock, status);
-
-    // Ensure the 'implicit DB transaction' is committed.
-    sqlite3_reset (fs->sdbDeleteAllTypeStmt);
-
     if (needLock) pthread_mutex_unlock (&fs->lock);
 #endif // !defined(NEUTER_FILE_SERVICE)
 
@@ -876,12 +1503,12 @@ fileServiceClearAll (BRFileService fs) {
     return success;
 }
 
-static int
-fileServiceReplaceFailed (BRFileService fs, int needUnlock) {
-    if (needUnlock) pthread_mutex_unlock (&fs->lock);
-    return 0;
-}
-
+///
+/// Replace all the entities of `type` with `entities`.  Rather than clearing `type` and writing
+/// every entity again, only the difference is written: rows whose identifier is not among
+/// `entities` are deleted, and an entity is inserted only if its row is missing or holds other
+/// data.  An unchanged entity is still serialized, to compare it, but its row isn't rewritten.
+///
 extern int
 fileServiceReplace (BRFileService fs,
                     const char *type,
@@ -891,34 +1518,54 @@ fileServiceReplace (BRFileService fs,
     if (NULL == entityType)
         return fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type");
 
+    BRFileServiceEntityHandler *handler = fileServiceEntityTypeLookupHandler(entityType, entityType->currentVersion);
+    if (NULL == handler && entitiesCount > 0)
+        return fileServiceFailedImpl (fs, 0, NULL, NULL, "missed type handler");
+
 #if !defined(NEUTER_FILE_SERVICE)
     sqlite3_status_code status;
 
+    // Encode every entity before taking the lock.
+    size_t recordsCount;
+    BRFileServiceReplaceRecord *records = _fileServiceReplaceRecordsCreate (fs, entityType, handler,
+                                                                            entities, entitiesCount,
+                                                                            &recordsCount);
+
+    if (fs->writeBehind) {
+        BRFileServiceJournalEntry *entry = fileServiceJournalEntryCreate (FILE_SERVICE_JOURNAL_REPLACE, type);
+        entry->records      = records;
+        entry->recordsCount = recordsCount;
+        return fileServiceJournalAdd (fs, entry);
+    }
+
     pthread_mutex_lock (&fs->lock);
-    if (fs->sdbClosed)
+    if (fs->sdbClosed) {
+        fileServiceReplaceRecordsRelease (records, recordsCount);
         return fileServiceFailedImpl (fs, 1, NULL, NULL, "closed");
+    }
 
     status = sqlite3_exec (fs->sdb, "BEGIN", NULL, NULL, NULL);
-    if (SQLITE_OK != status)
+    if (SQLITE_OK != status) {
+        fileServiceReplaceRecordsRelease (records, recordsCount);
         return fileServiceFailedSDB (fs, 1, status);
+    }
 
-    if (0 == fileServiceClearForType (fs, entityType, 0))
-        return fileServiceReplaceFailed (fs, 1);
+    status = _fileServiceReplaceRecords (fs, type, records, recordsCount);
+    if (SQLITE_OK == status)
+        status = sqlite3_exec (fs->sdb, "COMMIT", NULL, NULL, NULL);
 
-    for (size_t index = 0; index < entitiesCount; index++)
-        if (0 == _fileServiceSave (fs, type, entities[index], 0))
-            return fileServiceReplaceFailed (fs, 1);
+    fileServiceReplaceRecordsRelease (records, recordsCount);
 
-    status = sqlite3_exec (fs->sdb, "COMMIT", NULL, NULL, NULL);
-    if (SQLITE_OK != status)
+    if (SQLITE_OK != status) {
+        sqlite3_exec (fs->sdb, "ROLLBACK", NULL, NULL, NULL);
         return fileServiceFailedSDB (fs, 1, status);
+    }
 
     pthread_mutex_unlock (&fs->lock);
 #endif // !defined(NEUTER_FILE_SERVICE)
 
     return 1;
 }
-
 extern int
 fileServiceWipe (const char *basePath,
                  const char *currency,
@@ -932,6 +1579,14 @@ fileServiceWipe (const char *basePath,
     // Remove it.
     result  = (0 == remove (sdbPath) ? 0 : errno);
     free (sdbPath);
+
+    // ... and, if it was used with write-behind, its WAL files.
+    char *walPath = fileServiceCreateFilePath (basePath, currency, network, FILE_SERVICE_SDB_FILENAME "-wal");
+    char *shmPath = fileServiceCreateFilePath (basePath, currency, network, FILE_SERVICE_SDB_FILENAME "-shm");
+    remove (walPath);
+    remove (shmPath);
+    free (walPath);
+    free (shmPath);
 #endif
 
     return result;
@@ -111,6 +111,31 @@ fileServiceSetErrorHandler (BRFileService fs,
                             BRFileServiceContext context,
                             BRFileServiceErrorHandler handler);
 
+/**
+ * Enable, or disable, write-behind.  With write-behind, fileServiceSave(), fileServiceRemove(),
+ * fileServiceReplace() and fileServiceClear() serialize on the caller's thread, queue the write
+ * and return; a writer thread commits the queued writes, in one DB transaction, once enough are
+ * queued or a second has passed.  A queued save or remove is replaced by a later one of the same
+ * entity.  The DB is switched to WAL.
+ *
+ * Errors in a commit are reported to the error handler, from the writer thread.  fileServiceLoad()
+ * flushes before reading.  Disabling, closing and releasing flush and stop the writer thread.
+ *
+ * Call this before `fs` is used from other threads.
+ *
+ * @return true (1) if success, false (0) otherwise;
+ */
+extern int
+fileServiceSetWriteBehind (BRFileService fs,
+                           bool writeBehind);
+
+/**
+ * Wait until every write queued by write-behind, so far, is committed.  Without write-behind
+ * this returns immediately.
+ */
+extern void
+fileServiceFlush (BRFileService fs);
+
 /**
  * Load all entities of `type` adding each to `results`.  If there is an error then the
  * fileServices' error handler is invoked and 0 is returned
@@ -144,6 +169,13 @@ fileServiceRemoveByIdentifier (BRFileService fs,
                                const char *type,
                                UInt256 identifier);
 
+/**
+ * Replace all entities of `type` with `entities`.  Only the difference with the stored entities
+ * is written: stored entities whose identifier is not in `entities` are removed and an entity is
+ * saved only if it is new or its serialization has changed.
+ *
+ * @return true (1) if success, false (0) otherwise;
+ */
 extern int
 fileServiceReplace (BRFileService fs,
                     const char *type,
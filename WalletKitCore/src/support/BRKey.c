@@ -39,6 +39,9 @@
 #define USE_BASIC_CONFIG       1
 #define ENABLE_MODULE_RECOVERY 1
 
+#define KEY_LIST_MAX_THREADS     64
+#define KEY_LIST_MIN_THREAD_SIGS 4
+
 #pragma clang diagnostic push
 #pragma GCC diagnostic push
 #pragma clang diagnostic ignored "-Wconversion"
@@ -139,6 +142,30 @@ int BRSecp256k1PointMul(BRECPoint *p, const UInt256 *i)
             secp256k1_ec_pubkey_serialize(_ctx, (unsigned char *)p, &pLen, &pubkey, SECP256K1_EC_COMPRESSED));
 }
 
+// multiplies secp256k1 generator by each 256bit big endian int in i, adds the result to ec-point base and stores it in p
+// base is parsed once, and the generator multiples use the precomputed table rather than a double multiplication
+// returns the number of points written, which is less than count only if a result is invalid
+size_t BRSecp256k1PointAddList(BRECPoint p[], const BRECPoint *base, const UInt256 i[], size_t count)
+{
+    secp256k1_pubkey b, t, sum;
+    const secp256k1_pubkey *pair[] = { &b, &t };
+    size_t n, pLen;
+    
+    assert(p != NULL || count == 0);
+    assert(base != NULL);
+    assert(i != NULL || count == 0);
+    pthread_once(&_ctx_once, _ctx_init);
+    if (! secp256k1_ec_pubkey_parse(_ctx, &b, base->p, sizeof(*base))) return 0;
+    
+    for (n = 0; n < count; n++) {
+        pLen = sizeof(p[n]);
+        if (! secp256k1_ec_pubkey_create(_ctx, &t, i[n].u8) || ! secp256k1_ec_pubkey_combine(_ctx, &sum, pair, 2) ||
+            ! secp256k1_ec_pubkey_serialize(_ctx, p[n].p, &pLen, &sum, SECP256K1_EC_COMPRESSED)) break;
+    }
+    
+    return n;
+}
+
 // write a 'shared secret' for key w/ pubKey using ECDH to out32
 void BRKeyECDH(const BRKey *privKey, uint8_t *out32, BRKey *pubKey)
 {
@@ -577,6 +604,103 @@ int BRKeyRecoverPubKeyEthereum(BRKey *key, UInt256 md, const void *compactSig, s
     return r;
 }
 
+typedef struct {
+    BRKey *keys;
+    int *results;
+    const UInt256 *mds;
+    const void * const *sigs;
+    const size_t *sigLens; // NULL to recover pubKeys from 65 byte compact signatures
+    size_t count, next, done;
+    pthread_mutex_t lock;
+} BRKeyListJob;
+
+// verifies or recovers the next unclaimed signature in job until none are left
+static void *_BRKeyListThread(void *info)
+{
+    BRKeyListJob *job = info;
+    size_t i, done = 0;
+    
+    for (;;) {
+        pthread_mutex_lock(&job->lock);
+        i = job->next;
+        if (i < job->count) job->next++;
+        pthread_mutex_unlock(&job->lock);
+        if (i >= job->count) break;
+        
+        if (job->sigLens) {
+            job->results[i] = (job->sigs[i] && job->sigLens[i] > 0 &&
+                               BRKeyVerify(&job->keys[i], job->mds[i], job->sigs[i], job->sigLens[i]));
+        }
+        else job->results[i] = (job->sigs[i] && BRKeyRecoverPubKey(&job->keys[i], job->mds[i], job->sigs[i], 65));
+        
+        if (job->results[i]) done++;
+    }
+    
+    pthread_mutex_lock(&job->lock);
+    job->done += done;
+    pthread_mutex_unlock(&job->lock);
+    return NULL;
+}
+
+// runs job on the calling thread and up to threadCount - 1 others, or one per cpu if threadCount is 0
+static size_t _BRKeyListRun(BRKeyListJob *job, size_t threadCount)
+{
+    pthread_t threads[KEY_LIST_MAX_THREADS];
+    size_t i, started = 0;
+    long cpus;
+    
+    if (threadCount == 0) {
+        cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threadCount = (cpus > 0) ? (size_t)cpus : 1;
+    }
+    
+    if (threadCount > job->count/KEY_LIST_MIN_THREAD_SIGS) threadCount = job->count/KEY_LIST_MIN_THREAD_SIGS;
+    if (threadCount > KEY_LIST_MAX_THREADS) threadCount = KEY_LIST_MAX_THREADS;
+    pthread_once(&_ctx_once, _ctx_init); // the context is read only from here on, and shared by all threads
+    pthread_mutex_init(&job->lock, NULL);
+    
+    for (i = 1; i < threadCount; i++) {
+        if (pthread_create(&threads[started], NULL, _BRKeyListThread, job) == 0) started++;
+    }
+    
+    _BRKeyListThread(job);
+    for (i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    pthread_mutex_destroy(&job->lock);
+    return job->done;
+}
+
+// verifies each DER-encoded signature sigs[i] for mds[i] against keys[i] and sets results[i] to true if it was made
+// by that key, the signatures are spread across up to threadCount threads, or one per cpu if threadCount is 0
+// returns the number of signatures verified
+size_t BRKeyVerifyList(BRKey keys[], int results[], const UInt256 mds[], const void * const sigs[],
+                       const size_t sigLens[], size_t count, size_t threadCount)
+{
+    BRKeyListJob job = { keys, results, mds, sigs, sigLens, count, 0, 0 };
+    
+    assert(keys != NULL || count == 0);
+    assert(results != NULL || count == 0);
+    assert(mds != NULL || count == 0);
+    assert(sigs != NULL || count == 0);
+    assert(sigLens != NULL || count == 0);
+    return (count > 0) ? _BRKeyListRun(&job, threadCount) : 0;
+}
+
+// assigns the pubKey recovered from each 65 byte compact signature compactSigs[i] for mds[i] to keys[i] and sets
+// results[i] to true on success, the signatures are spread across up to threadCount threads, or one per cpu if
+// threadCount is 0
+// returns the number of pubKeys recovered
+size_t BRKeyRecoverPubKeyList(BRKey keys[], int results[], const UInt256 mds[], const void * const compactSigs[],
+                              size_t count, size_t threadCount)
+{
+    BRKeyListJob job = { keys, results, mds, compactSigs, NULL, count, 0, 0 };
+    
+    assert(keys != NULL || count == 0);
+    assert(results != NULL || count == 0);
+    assert(mds != NULL || count == 0);
+    assert(compactSigs != NULL || count == 0);
+    return (count > 0) ? _BRKeyListRun(&job, threadCount) : 0;
+}
+
 int BRKeySetCompressed (BRKey *key, int compressed) {
     compressed = (compressed ? 1 : 0); // as 1 or 0
 
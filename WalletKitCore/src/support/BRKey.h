@@ -63,6 +63,11 @@ int BRSecp256k1PointAdd(BRECPoint *p, const UInt256 *i);
 // returns true on success
 int BRSecp256k1PointMul(BRECPoint *p, const UInt256 *i);
 
+// multiplies secp256k1 generator by each 256bit big endian int in i, adds the result to ec-point base and stores it in p
+// base is parsed once, and the generator multiples use the precomputed table rather than a double multiplication
+// returns the number of points written, which is less than count only if a result is invalid
+size_t BRSecp256k1PointAddList(BRECPoint p[], const BRECPoint *base, const UInt256 i[], size_t count);
+
 // returns true if privKey is a valid private key
 // supported formats are wallet import format (WIF), mini private key format, or hex string
 int BRPrivKeyIsValid(BRAddressParams params, const char *privKey);
@@ -139,6 +144,19 @@ void BRKeyECDH(const BRKey *privKey, uint8_t *out32, BRKey *pubKey);
 size_t BRKeyCompactSignEthereum(const BRKey *key, void *compactSig, size_t sigLen, UInt256 md);
 int BRKeyRecoverPubKeyEthereum(BRKey *key, UInt256 md, const void *compactSig, size_t sigLen);
 
+// verifies each DER-encoded signature sigs[i] for mds[i] against keys[i] and sets results[i] to true if it was made
+// by that key, the signatures are spread across up to threadCount threads, or one per cpu if threadCount is 0
+// returns the number of signatures verified
+size_t BRKeyVerifyList(BRKey keys[], int results[], const UInt256 mds[], const void * const sigs[],
+                       const size_t sigLens[], size_t count, size_t threadCount);
+
+// assigns the pubKey recovered from each 65 byte compact signature compactSigs[i] for mds[i] to keys[i] and sets
+// results[i] to true on success, the signatures are spread across up to threadCount threads, or one per cpu if
+// threadCount is 0
+// returns the number of pubKeys recovered
+size_t BRKeyRecoverPubKeyList(BRKey keys[], int results[], const UInt256 mds[], const void * const compactSigs[],
+                              size_t count, size_t threadCount);
+
 // Set the compressed flag in `key`; this will clear the `pubKey` to allow regeneration
 // Returns true (1) if the compress flag changed; false (0) otherwise
 int BRKeySetCompressed (BRKey *key, int compressed);
@@ -0,0 +1,287 @@
+//
+//  BRKeyEd25519.c
+//  BRCore
+//
+//  Copyright © 2020 Breadwinner AG.  All rights reserved.
+//
+//  See the LICENSE file at the project root for license information.
+//  See the CONTRIBUTORS file at the project root for a list of contributors.
+
+#include "BRKeyEd25519.h"
+#include "BRCrypto.h"
+#include "BRInt.h"
+#include "BROSCompat.h"
+#include "ed25519/ed25519.h"
+#include "ed25519/ge.h"
+#include "ed25519/sc.h"
+#include "ed25519/sha512.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define ED25519_BATCH_MAX 64 // signatures combined into one multi-scalar multiplication
+
+// expands the 32 byte seed into key and computes its public key
+void BREd25519KeySetSeed(BREd25519Key *key, const void *seed32)
+{
+    assert(key != NULL);
+    assert(seed32 != NULL);
+    ed25519_create_keypair(key->pubKey, key->secret, seed32);
+}
+
+// expands the 32 byte seed into key and takes pubKey32 as its public key, for callers that already hold the public key
+// of seed and only need to sign
+void BREd25519KeySetSeedAndPubKey(BREd25519Key *key, const void *seed32, const void *pubKey32)
+{
+    assert(key != NULL);
+    assert(seed32 != NULL);
+    assert(pubKey32 != NULL);
+    sha512(seed32, 32, key->secret); // same expansion as ed25519_create_keypair(), without the base point multiply
+    key->secret[0] &= 248;
+    key->secret[31] &= 63;
+    key->secret[31] |= 64;
+    memcpy(key->pubKey, pubKey32, sizeof(key->pubKey));
+}
+
+// writes the 64 byte signature of msg by key to sig64
+void BREd25519Sign(const BREd25519Key *key, void *sig64, const void *msg, size_t msgLen)
+{
+    assert(key != NULL);
+    assert(sig64 != NULL);
+    assert(msg != NULL || msgLen == 0);
+    ed25519_sign(sig64, msg, msgLen, key->pubKey, key->secret);
+}
+
+// returns true if sig64 is a valid signature of msg by pubKey32
+int BREd25519Verify(const void *pubKey32, const void *sig64, const void *msg, size_t msgLen)
+{
+    assert(pubKey32 != NULL);
+    assert(sig64 != NULL);
+    assert(msg != NULL || msgLen == 0);
+    return ed25519_verify(sig64, msg, msgLen, pubKey32);
+}
+
+// writes the sliding window form of the 256bit little endian scalar a to r, with odd digits in [-15, 15], the same as
+// ref10 uses for its double scalar multiplication
+static void _slide(signed char r[256], const unsigned char *a)
+{
+    int i, b, k;
+
+    for (i = 0; i < 256; i++) r[i] = 1 & (a[i >> 3] >> (i & 7));
+
+    for (i = 0; i < 256; i++) {
+        if (! r[i]) continue;
+
+        for (b = 1; b <= 6 && i + b < 256; b++) {
+            if (! r[i + b]) continue;
+
+            if (r[i] + (r[i + b] << b) <= 15) {
+                r[i] += r[i + b] << b;
+                r[i + b] = 0;
+            }
+            else if (r[i] - (r[i + b] << b) >= -15) {
+                r[i] -= r[i + b] << b;
+
+                for (k = i + b; k < 256; k++) {
+                    if (! r[k]) {
+                        r[k] = 1;
+                        break;
+                    }
+
+                    r[k] = 0;
+                }
+            }
+            else break;
+        }
+    }
+}
+
+// writes the odd multiples p, 3p, ... 15p to table
+static void _oddMultiples(ge_cached table[8], const ge_p3 *p)
+{
+    ge_p1p1 t;
+    ge_p3 p2, u;
+
+    ge_p3_to_cached(&table[0], p);
+    ge_p3_dbl(&t, p);
+    ge_p1p1_to_p3(&p2, &t);
+
+    for (int i = 0; i < 7; i++) {
+        ge_add(&t, &p2, &table[i]);
+        ge_p1p1_to_p3(&u, &t);
+        ge_p3_to_cached(&table[i + 1], &u);
+    }
+}
+
+// returns true if the sum of scalars[i]*points[i], multiplied by the cofactor 8, is the identity
+// Straus' method: all the points share one chain of 256 doublings, so each extra point only costs its additions
+static int _multiScalarIsIdentity(const ge_p3 points[], unsigned char (*scalars)[32], size_t count)
+{
+    signed char (*slides)[256] = malloc(count*sizeof(*slides));
+    ge_cached (*tables)[8] = malloc(count*sizeof(*tables));
+    unsigned char bytes[32], identity[32] = { 1 };
+    ge_p1p1 t;
+    ge_p3 u;
+    ge_p2 r;
+    size_t j;
+    int i, top = -1;
+
+    assert(slides != NULL);
+    assert(tables != NULL);
+
+    for (j = 0; j < count; j++) {
+        _slide(slides[j], scalars[j]);
+        _oddMultiples(tables[j], &points[j]);
+        for (i = 255; i > top; i--) if (slides[j][i]) top = i;
+    }
+
+    ge_p2_0(&r);
+
+    for (i = top; i >= 0; i--) {
+        ge_p2_dbl(&t, &r);
+
+        for (j = 0; j < count; j++) {
+            if (slides[j][i] > 0) {
+                ge_p1p1_to_p3(&u, &t);
+                ge_add(&t, &u, &tables[j][slides[j][i]/2]);
+            }
+            else if (slides[j][i] < 0) {
+                ge_p1p1_to_p3(&u, &t);
+                ge_sub(&t, &u, &tables[j][-slides[j][i]/2]);
+            }
+        }
+
+        ge_p1p1_to_p2(&r, &t);
+    }
+
+    for (i = 0; i < 3; i++) { // multiply by the cofactor
+        ge_p2_dbl(&t, &r);
+        ge_p1p1_to_p2(&r, &t);
+    }
+
+    ge_tobytes(bytes, &r);
+    free(tables);
+    free(slides);
+    return (memcmp(bytes, identity, sizeof(identity)) == 0);
+}
+
+// returns true if 8*(sum(z[i]*s[i])*B - sum(z[i]*R[i]) - sum(z[i]*h[i]*A[i])) is the identity for the count signatures
+// listed in idx, which must have decoded to the negated points negR[i] and negA[i]
+// the weights z[i] are 128bits of a hash of every signature, key and message hash in the batch and 32 bytes from the
+// system CSPRNG, so that whoever made the signatures can neither choose for them nor predict them
+static int _BREd25519VerifyBatch(const void * const pubKeys[], const void * const msgs[], const size_t msgLens[],
+                                 const void * const sigs[], const size_t idx[], const ge_p3 negR[],
+                                 const ge_p3 negA[], size_t count)
+{
+    ge_p3 *points = malloc((2*count + 1)*sizeof(*points));
+    unsigned char (*scalars)[32] = calloc(2*count + 1, sizeof(*scalars));
+    unsigned char h[64], z[64], t[64], n[4], rnd[32], one[32] = { 1 }, zero[32] = { 0 };
+    sha512_context ctx, transcript;
+    size_t i;
+    int r;
+
+    assert(points != NULL);
+    assert(scalars != NULL);
+    sha512_init(&transcript);
+
+    for (i = 0; i < count; i++) { // h[i] = SHA512(R || A || M) mod l, as in ed25519_verify()
+        sha512_init(&ctx);
+        sha512_update(&ctx, sigs[idx[i]], 32);
+        sha512_update(&ctx, pubKeys[idx[i]], 32);
+        sha512_update(&ctx, msgs[idx[i]], msgLens[idx[i]]);
+        sha512_final(&ctx, h);
+        sc_reduce(h);
+        memcpy(scalars[2*i + 2], h, 32);
+        sha512_update(&transcript, sigs[idx[i]], 64);
+        sha512_update(&transcript, pubKeys[idx[i]], 32);
+        sha512_update(&transcript, h, 32);
+    }
+
+    arc4random_buf_brd(rnd, sizeof(rnd));
+    sha512_update(&transcript, rnd, sizeof(rnd));
+    sha512_final(&transcript, t);
+    mem_clean(rnd, sizeof(rnd));
+    ge_scalarmult_base(&points[0], one);
+
+    for (i = 0; i < count; i++) {
+        UInt32SetLE(n, (uint32_t)i);
+        sha512_init(&ctx);
+        sha512_update(&ctx, t, sizeof(t));
+        sha512_update(&ctx, n, sizeof(n));
+        sha512_final(&ctx, z);
+        memset(&z[16], 0, sizeof(z) - 16);
+        if (memcmp(z, zero, sizeof(zero)) == 0) z[0] = 1;
+
+        memcpy(scalars[2*i + 1], z, 32); // z*(-R)
+        points[2*i + 1] = negR[i];
+        memcpy(h, scalars[2*i + 2], 32);
+        sc_muladd(scalars[2*i + 2], z, h, zero); // z*h*(-A)
+        points[2*i + 2] = negA[i];
+        sc_muladd(scalars[0], z, (const unsigned char *)sigs[idx[i]] + 32, scalars[0]); // sum(z*s)*B
+    }
+
+    r = _multiScalarIsIdentity(points, scalars, 2*count + 1);
+    free(scalars);
+    free(points);
+    return r;
+}
+
+// verifies each signature sigs[i] of msgs[i] by pubKeys[i] and sets results[i] to true if it's valid, signatures are
+// checked together with a single multi-scalar multiplication, and one at a time only if that check fails
+// the combined check is the cofactored equation of rfc8032 5.1.7, so a signature crafted with small order components
+// may pass here and fail BREd25519Verify(), signatures made by BREd25519Sign() have the same result with both
+// returns the number of valid signatures
+size_t BREd25519VerifyList(const void * const pubKeys[], int results[], const void * const msgs[],
+                           const size_t msgLens[], const void * const sigs[], size_t count)
+{
+    ge_p3 negR[ED25519_BATCH_MAX], negA[ED25519_BATCH_MAX], R;
+    size_t idx[ED25519_BATCH_MAX], i, j, k, m, n, done = 0;
+    unsigned char enc[32];
+    const unsigned char *sig;
+
+    assert(pubKeys != NULL || count == 0);
+    assert(results != NULL || count == 0);
+    assert(msgs != NULL || count == 0);
+    assert(msgLens != NULL || count == 0);
+    assert(sigs != NULL || count == 0);
+
+    for (i = 0; i < count; i += n) {
+        n = (count - i < ED25519_BATCH_MAX) ? count - i : ED25519_BATCH_MAX;
+
+        for (j = i, m = 0; j < i + n; j++) { // signatures that can't be valid are left out of the batch
+            sig = sigs[j];
+            results[j] = 0;
+            if ((sig[63] & 224) != 0 || ge_frombytes_negate_vartime(&negA[m], pubKeys[j]) != 0 ||
+                ge_frombytes_negate_vartime(&negR[m], sig) != 0) continue;
+
+            // ed25519_verify() compares R bytewise with an encoded point, so it must be canonically encoded here too
+            R = negR[m];
+            fe_neg(R.X, R.X);
+            fe_neg(R.T, R.T);
+            ge_p3_tobytes(enc, &R);
+            if (memcmp(enc, sig, sizeof(enc)) != 0) continue;
+            idx[m++] = j;
+        }
+
+        // a single signature is checked on its own, a batch of one costs more than ed25519_verify()
+        if (m > 1 && _BREd25519VerifyBatch(pubKeys, msgs, msgLens, sigs, idx, negR, negA, m)) {
+            for (k = 0; k < m; k++) results[idx[k]] = 1;
+            done += m;
+        }
+        else {
+            for (k = 0; k < m; k++) {
+                results[idx[k]] = ed25519_verify(sigs[idx[k]], msgs[idx[k]], msgLens[idx[k]], pubKeys[idx[k]]);
+                if (results[idx[k]]) done++;
+            }
+        }
+    }
+
+    return done;
+}
+
+// wipes key material from key
+void BREd25519KeyClean(BREd25519Key *key)
+{
+    assert(key != NULL);
+    mem_clean(key, sizeof(*key));
+}
@@ -0,0 +1,56 @@
+//
+//  BRKeyEd25519.h
+//  BRCore
+//
+//  Copyright © 2020 Breadwinner AG.  All rights reserved.
+//
+//  See the LICENSE file at the project root for license information.
+//  See the CONTRIBUTORS file at the project root for a list of contributors.
+
+#ifndef BRKeyEd25519_h
+#define BRKeyEd25519_h
+
+#include <stddef.h>
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ed25519 signatures: https://tools.ietf.org/html/rfc8032, over the vendored ref10 implementation
+
+// a signing key with the seed already expanded, so that signing doesn't hash the seed or compute the public key again
+typedef struct {
+    uint8_t secret[64]; // clamped SHA512(seed), the signing scalar followed by the nonce prefix
+    uint8_t pubKey[32];
+} BREd25519Key;
+
+// expands the 32 byte seed into key and computes its public key
+void BREd25519KeySetSeed(BREd25519Key *key, const void *seed32);
+
+// expands the 32 byte seed into key and takes pubKey32 as its public key, for callers that already hold the public key
+// of seed and only need to sign
+void BREd25519KeySetSeedAndPubKey(BREd25519Key *key, const void *seed32, const void *pubKey32);
+
+// writes the 64 byte signature of msg by key to sig64
+void BREd25519Sign(const BREd25519Key *key, void *sig64, const void *msg, size_t msgLen);
+
+// returns true if sig64 is a valid signature of msg by pubKey32
+int BREd25519Verify(const void *pubKey32, const void *sig64, const void *msg, size_t msgLen);
+
+// verifies each signature sigs[i] of msgs[i] by pubKeys[i] and sets results[i] to true if it's valid, signatures are
+// checked together with a single multi-scalar multiplication, and one at a time only if that check fails
+// the combined check is the cofactored equation of rfc8032 5.1.7, so a signature crafted with small order components
+// may pass here and fail BREd25519Verify(), signatures made by BREd25519Sign() have the same result with both
+// returns the number of valid signatures
+size_t BREd25519VerifyList(const void * const pubKeys[], int results[], const void * const msgs[],
+                           const size_t msgLens[], const void * const sigs[], size_t count);
+
+// wipes key material from key
+void BREd25519KeyClean(BREd25519Key *key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BRKeyEd25519_h
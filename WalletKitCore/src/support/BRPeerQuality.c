@@ -0,0 +1,99 @@
+//
+//  BRPeerQuality.c
+//  BRCore
+//
+//  Copyright © 2020 Breadwinner AG.  All rights reserved.
+//
+//  See the LICENSE file at the project root for license information.
+//  See the CONTRIBUTORS file at the project root for a list of contributors.
+
+#include "BRPeerQuality.h"
+#include "BRInt.h"
+#include <math.h>
+
+// a bandwidth, in items per second, that scores halfway between no bandwidth and infinite bandwidth
+#define BANDWIDTH_SCALE     (100.0)
+
+// a latency, in milliseconds, that scores halfway between zero latency and infinite latency
+#define LATENCY_SCALE       (1000.0)
+
+// the score of an unmeasured speed - that of a peer with a latency of LATENCY_SCALE or a bandwidth of BANDWIDTH_SCALE
+#define UNKNOWN_SCORE       (0.5)
+
+// the misbehavior count is bounded so that a peer can redeem itself with enough successes
+#define MISBEHAVIOR_MAX     (100)
+
+static double _BRPeerQualityAverage(double average, double sample, int hasAverage)
+{
+    return (hasAverage) ? (1.0 - BR_PEER_QUALITY_WEIGHT)*average + BR_PEER_QUALITY_WEIGHT*sample : sample;
+}
+
+void BRPeerQualityAddLatency(BRPeerQuality *quality, double milliseconds)
+{
+    if (milliseconds < 0.0 || isnan(milliseconds)) return;
+    // a zero latency would read as 'never measured'; clamp to the smallest meaningful latency
+    if (milliseconds < 1.0) milliseconds = 1.0;
+    quality->latency = _BRPeerQualityAverage(quality->latency, milliseconds, quality->latency > 0.0);
+}
+
+void BRPeerQualityAddBandwidth(BRPeerQuality *quality, double itemsPerSecond)
+{
+    if (itemsPerSecond <= 0.0 || isnan(itemsPerSecond)) return;
+    quality->bandwidth = _BRPeerQualityAverage(quality->bandwidth, itemsPerSecond, quality->bandwidth > 0.0);
+}
+
+void BRPeerQualityAddOutcome(BRPeerQuality *quality, int success)
+{
+    quality->successRatio = _BRPeerQualityAverage(quality->successRatio, (success) ? 1.0 : 0.0, quality->outcomes > 0);
+    if (quality->outcomes < UINT32_MAX) quality->outcomes++;
+    if (success && quality->misbehavior > 0) quality->misbehavior--;
+}
+
+void BRPeerQualityAddMisbehavior(BRPeerQuality *quality)
+{
+    BRPeerQualityAddOutcome(quality, 0);
+    if (quality->misbehavior < MISBEHAVIOR_MAX) quality->misbehavior++;
+}
+
+double BRPeerQualityScore(const BRPeerQuality *quality)
+{
+    // a peer is presumed reliable until an outcome shows otherwise
+    double success = (quality->outcomes > 0) ? quality->successRatio : 1.0,
+           latency = (quality->latency > 0.0) ? LATENCY_SCALE/(LATENCY_SCALE + quality->latency) : UNKNOWN_SCORE,
+           bandwidth = (quality->bandwidth > 0.0) ? quality->bandwidth/(quality->bandwidth + BANDWIDTH_SCALE) : UNKNOWN_SCORE;
+
+    // an unreliable peer is of little use however fast it is; so success scales speed
+    return success*(latency + bandwidth)/2.0/(1.0 + quality->misbehavior);
+}
+
+int BRPeerQualityCompare(const BRPeerQuality *quality1, const BRPeerQuality *quality2)
+{
+    double score1 = BRPeerQualityScore(quality1), score2 = BRPeerQualityScore(quality2);
+    return (score1 > score2) ? -1 : ((score1 < score2) ? 1 : 0);
+}
+
+size_t BRPeerQualitySerialize(const BRPeerQuality *quality, uint8_t *buf, size_t bufLen)
+{
+    if (! buf || bufLen < BR_PEER_QUALITY_SERIALIZED_SIZE) return BR_PEER_QUALITY_SERIALIZED_SIZE;
+    UInt64SetBE(&buf[0], (uint64_t) llround(quality->latency*1000.0)); // microseconds
+    UInt32SetBE(&buf[8], (uint32_t) fmin(quality->bandwidth*1000.0 + 0.5, UINT32_MAX)); // milli-items per second
+    UInt32SetBE(&buf[12], (uint32_t) lround(quality->successRatio*1000000.0)); // parts per million
+    UInt32SetBE(&buf[16], quality->outcomes);
+    UInt32SetBE(&buf[20], quality->misbehavior);
+    return BR_PEER_QUALITY_SERIALIZED_SIZE;
+}
+
+BRPeerQuality BRPeerQualityParse(const uint8_t *buf, size_t bufLen)
+{
+    BRPeerQuality quality = BR_PEER_QUALITY_NONE;
+
+    if (buf && bufLen >= BR_PEER_QUALITY_SERIALIZED_SIZE) {
+        quality.latency = UInt64GetBE(&buf[0])/1000.0;
+        quality.bandwidth = UInt32GetBE(&buf[8])/1000.0;
+        quality.successRatio = fmin(UInt32GetBE(&buf[12])/1000000.0, 1.0);
+        quality.outcomes = UInt32GetBE(&buf[16]);
+        quality.misbehavior = UInt32GetBE(&buf[20]);
+    }
+
+    return quality;
+}
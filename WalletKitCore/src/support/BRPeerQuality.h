@@ -0,0 +1,70 @@
+//
+//  BRPeerQuality.h
+//  BRCore
+//
+//  Copyright © 2020 Breadwinner AG.  All rights reserved.
+//
+//  See the LICENSE file at the project root for license information.
+//  See the CONTRIBUTORS file at the project root for a list of contributors.
+
+#ifndef BRPeerQuality_h
+#define BRPeerQuality_h
+
+#include <stddef.h>
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The history of a remote peer's service to us - how quickly it responds, how much it provides,
+// how often our connections and requests to it succeed and how often it misbehaves.  Bitcoin
+// peers and Ethereum nodes both keep a quality and persist it, so that on a restart we bias our
+// connections toward peers that were fast and reliable rather than re-learning which they were.
+//
+// The latency, bandwidth and success ratio are exponentially weighted moving averages; the most
+// recent sample is weighted by BR_PEER_QUALITY_WEIGHT.
+typedef struct {
+    double latency;         // response time, in milliseconds; zero if never measured
+    double bandwidth;       // items (blocks, headers, etc) provided per second; zero if never measured
+    double successRatio;    // of outcomes, 1.0 for success and 0.0 for failure
+    uint32_t outcomes;      // the number of outcomes recorded; if zero, `successRatio` is unknown
+    uint32_t misbehavior;   // incremented on misbehavior; decremented on success
+} BRPeerQuality;
+
+#define BR_PEER_QUALITY_NONE   ((const BRPeerQuality) { 0.0, 0.0, 0.0, 0, 0 })
+
+#define BR_PEER_QUALITY_WEIGHT          (0.25)
+
+// the number of bytes in a serialized quality
+#define BR_PEER_QUALITY_SERIALIZED_SIZE (24)
+
+void BRPeerQualityAddLatency(BRPeerQuality *quality, double milliseconds);
+
+void BRPeerQualityAddBandwidth(BRPeerQuality *quality, double itemsPerSecond);
+
+// adds the outcome of a connection or request; a success also reduces the misbehavior score
+void BRPeerQualityAddOutcome(BRPeerQuality *quality, int success);
+
+// adds a misbehavior, such as a protocol error; a misbehavior is also a failed outcome
+void BRPeerQualityAddMisbehavior(BRPeerQuality *quality);
+
+// returns a score in [0, 1] - higher is better; a quality with no history scores between
+// historically fast and historically slow peers so that unknown peers are still tried
+double BRPeerQualityScore(const BRPeerQuality *quality);
+
+// returns -1 if quality1 is preferred (scores higher), +1 if quality2 is preferred, otherwise 0
+int BRPeerQualityCompare(const BRPeerQuality *quality1, const BRPeerQuality *quality2);
+
+// writes quality to buf and returns the number of bytes written, or the number of bytes needed if
+// buf is NULL (or bufLen too small)
+size_t BRPeerQualitySerialize(const BRPeerQuality *quality, uint8_t *buf, size_t bufLen);
+
+// returns the quality parsed from buf, or BR_PEER_QUALITY_NONE if bufLen is too small
+BRPeerQuality BRPeerQualityParse(const uint8_t *buf, size_t bufLen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BRPeerQuality_h
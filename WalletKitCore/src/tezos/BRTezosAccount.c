@@ -12,17 +12,26 @@
 #include "BRTezosAccount.h"
 #include "BRTezosAddress.h"
 #include "support/BRBIP32Sequence.h"
+#include "support/BRKeyEd25519.h"
 #include "ed25519/ed25519.h"
 
 #include "blake2/blake2b.h"
 
 #include <stdlib.h>
 #include <assert.h>
+#include <pthread.h>
+#include "support/BRCrypto.h"
+#include "support/BROSCompat.h"
 
 
 struct BRTezosAccountRecord {
     BRTezosAddress address;
     uint8_t publicKey[TEZOS_PUBLIC_KEY_SIZE];
+
+    // the signing key expanded from the seed, valid when signingKeySeedHash is the SHA256 of that seed
+    BREd25519Key signingKey;
+    UInt256 signingKeySeedHash;
+    pthread_mutex_t lock;
 };
 
 // MARK: Forward Declarations
@@ -33,9 +42,6 @@ deriveTezosPrivateKeyFromSeed (UInt512 seed, uint32_t index);
 static void
 tezosKeyGetPublicKey (BRKey key, uint8_t * publicKey);
 
-static void
-tezosKeyGetPrivateKey (BRKey key, uint8_t * privateKey);
-
 
 // MARK: - Init/Free
 
@@ -49,6 +55,7 @@ tezosAccountCreateWithSeed (UInt512 seed) {
     tezosKeyGetPublicKey(privateKey, account->publicKey);
 
     account->address = tezosAddressCreateFromKey(account->publicKey, TEZOS_PUBLIC_KEY_SIZE);
+    pthread_mutex_init_brd (&account->lock, PTHREAD_MUTEX_NORMAL);
 
     return account;
 }
@@ -61,6 +68,7 @@ tezosAccountCreateWithSerialization (uint8_t *bytes, size_t bytesCount)
     
     memcpy(account->publicKey, bytes, TEZOS_PUBLIC_KEY_SIZE);
     account->address = tezosAddressCreateFromKey(account->publicKey, TEZOS_PUBLIC_KEY_SIZE);
+    pthread_mutex_init_brd (&account->lock, PTHREAD_MUTEX_NORMAL);
     
     return account;
 }
@@ -70,40 +78,86 @@ tezosAccountFree (BRTezosAccount account)
 {
     assert (account);
     tezosAddressFree (account->address);
+    BREd25519KeyClean (&account->signingKey);
+    mem_clean (&account->signingKeySeedHash, sizeof(UInt256));
+    pthread_mutex_destroy (&account->lock);
     free (account);
 }
 
 // MARK: - Signing
 
-extern BRCryptoData
-tezosAccountSignData (BRTezosAccount account,
-                      BRCryptoData data,
-                      UInt512 seed) {
-    BRKey publicKey = tezosAccountGetPublicKey ((BRTezosAccount)account);
-    BRKey privateKey = deriveTezosPrivateKeyFromSeed(seed, 0);
-    uint8_t privateKeyBytes[64];
-    tezosKeyGetPrivateKey(privateKey, privateKeyBytes);
-    
+extern void
+tezosAccountSignDataBegin (blake2b_ctx *ctx) {
     uint8_t watermark[] = { 0x03 };
-    size_t watermarkSize = sizeof(watermark);
     
-    BRCryptoData watermarkedData = cryptoDataNew(data.size + watermarkSize);
+    blake2b_init(ctx, 32, NULL, 0);
+    blake2b_update(ctx, watermark, sizeof(watermark));
+}
+
+extern int
+tezosAccountGetSigningKey (BRTezosAccount account,
+                           UInt512 seed,
+                           BREd25519Key *key) {
+    assert (account);
+    assert (key);
     
-    memcpy(watermarkedData.bytes, watermark, watermarkSize);
-    memcpy(&watermarkedData.bytes[watermarkSize], data.bytes, data.size);
+    UInt256 seedHash;
+    BRSHA256(seedHash.u8, seed.u8, sizeof(seed));
+    
+    pthread_mutex_lock (&account->lock);
+    int valid = UInt256Eq(seedHash, account->signingKeySeedHash);
+    
+    if (!valid) {
+        // expand the key and check that the seed is this account's before caching it
+        BRKey privateKey = deriveTezosPrivateKeyFromSeed(seed, 0);
+        BREd25519Key signingKey;
+        BREd25519KeySetSeed(&signingKey, privateKey.secret.u8);
+        BRKeyClean(&privateKey);
+        
+        valid = (0 == memcmp(signingKey.pubKey, account->publicKey, TEZOS_PUBLIC_KEY_SIZE));
+        if (valid) {
+            account->signingKey = signingKey;
+            account->signingKeySeedHash = seedHash;
+        }
+        BREd25519KeyClean(&signingKey);
+    }
+    
+    if (valid) *key = account->signingKey;
+    pthread_mutex_unlock (&account->lock);
+    
+    mem_clean(&seedHash, sizeof(UInt256));
+    return valid;
+}
+
+extern BRCryptoData
+tezosAccountSignDigest (BRTezosAccount account,
+                        blake2b_ctx *ctx,
+                        UInt512 seed) {
+    BREd25519Key signingKey;
+    if (!tezosAccountGetSigningKey(account, seed, &signingKey)) return (BRCryptoData) { NULL, 0 };
     
     uint8_t hash[32];
-    blake2b(hash, sizeof(hash), NULL, 0, watermarkedData.bytes, watermarkedData.size);
+    blake2b_final(ctx, hash);
     
     BRCryptoData signature = cryptoDataNew(64);
-    ed25519_sign(signature.bytes, hash, sizeof(hash), publicKey.pubKey, privateKeyBytes);
+    BREd25519Sign(&signingKey, signature.bytes, hash, sizeof(hash));
     
-    mem_clean(privateKeyBytes, 64);
-    cryptoDataFree(watermarkedData);
+    BREd25519KeyClean(&signingKey);
     
     return signature;
 }
 
+extern BRCryptoData
+tezosAccountSignData (BRTezosAccount account,
+                      BRCryptoData data,
+                      UInt512 seed) {
+    blake2b_ctx ctx;
+    
+    tezosAccountSignDataBegin(&ctx);
+    blake2b_update(&ctx, data.bytes, data.size);
+    return tezosAccountSignDigest(account, &ctx, seed);
+}
+
 // MARK: - Accessors
 
 extern BRKey
@@ -241,9 +295,3 @@ tezosKeyGetPublicKey (BRKey key, uint8_t * publicKey) {
     ed25519_create_keypair(publicKey, privateKey, key.secret.u8);
     memset(privateKey, 0x00, 64);
 }
-
-static void
-tezosKeyGetPrivateKey (BRKey key, uint8_t * privateKey) {
-    unsigned char publicKey[32] = {0};
-    ed25519_create_keypair(publicKey, privateKey, key.secret.u8);
-}
@@ -15,8 +15,10 @@
 
 #include "support/BRKey.h"
 #include "support/BRInt.h"
+#include "support/BRKeyEd25519.h"
 #include "BRTezosBase.h"
 #include "BRTezosAddress.h"
+#include "blake2/blake2b.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -70,6 +72,45 @@ tezosAccountSignData (BRTezosAccount account,
                       BRCryptoData data,
                       UInt512 seed);
 
+/**
+ * Gets the signing key of the account.  The key is expanded from the seed once and kept by the
+ * account, so signing again with the same seed doesn't repeat the derivation.
+ *
+ * @param account
+ * @param seed - account seed
+ * @param key - set to the signing key, which the caller should wipe with BREd25519KeyClean()
+ *
+ * @return true if the key was set, false if the seed is not the account's
+*/
+extern int
+tezosAccountGetSigningKey (BRTezosAccount account,
+                           UInt512 seed,
+                           BREd25519Key *key);
+
+/**
+ * Starts the digest that tezosAccountSignData() signs, for callers that produce the message
+ * incrementally.  Add the message to `ctx` with blake2b_update() and then sign it with
+ * tezosAccountSignDigest().
+ *
+ * @param ctx - the digest context to initialize
+ */
+extern void
+tezosAccountSignDataBegin (blake2b_ctx *ctx);
+
+/**
+ * Finishes the digest started by tezosAccountSignDataBegin() and signs it.
+ *
+ * @param account
+ * @param ctx - the digest context
+ * @param seed - account seed
+ *
+ * @return signature, empty if the seed is not the account's or the signature does not verify
+*/
+extern BRCryptoData
+tezosAccountSignDigest (BRTezosAccount account,
+                        blake2b_ctx *ctx,
+                        UInt512 seed);
+
 /**
  * Get the public key for this Tezos account
  *
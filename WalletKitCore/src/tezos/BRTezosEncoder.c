@@ -16,11 +16,62 @@
 #include "ethereum/util/BRUtilMath.h"
 #include "support/BRBase58.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 
-static BRCryptoData
-encodeAddress (BRTezosAddress address) {
+#define TEZOS_WRITER_MIN_CAPACITY (128)
+
+// MARK: - Writer
+
+extern void
+tezosWriterInit (BRTezosWriter *writer, size_t capacity, blake2b_ctx *hash0, blake2b_ctx *hash1) {
+    assert (writer);
+    writer->data = cryptoDataNew (capacity < TEZOS_WRITER_MIN_CAPACITY ? TEZOS_WRITER_MIN_CAPACITY : capacity);
+    writer->size = 0;
+    writer->hashes[0] = hash0;
+    writer->hashes[1] = hash1;
+}
+
+extern void
+tezosWriterAppend (BRTezosWriter *writer, const uint8_t *bytes, size_t size) {
+    assert (writer);
+    assert (writer->data.bytes);
+
+    if (writer->size + size > writer->data.size) {
+        size_t capacity = writer->data.size;
+        while (writer->size + size > capacity) capacity *= 2;
+
+        writer->data.bytes = realloc (writer->data.bytes, capacity);
+        assert (writer->data.bytes);
+        writer->data.size = capacity;
+    }
+
+    memcpy (&writer->data.bytes[writer->size], bytes, size);
+    writer->size += size;
+
+    for (size_t i = 0; i < sizeof(writer->hashes) / sizeof(writer->hashes[0]); i++) {
+        if (NULL != writer->hashes[i]) blake2b_update (writer->hashes[i], bytes, size);
+    }
+}
+
+extern BRCryptoData
+tezosWriterTake (BRTezosWriter *writer) {
+    assert (writer);
+    BRCryptoData data = writer->data;
+    data.size = writer->size;
+
+    writer->data.bytes = NULL;
+    writer->data.size = 0;
+    writer->size = 0;
+    return data;
+}
+
+// MARK: - Encoding
+
+static void
+writeAddress (BRTezosWriter *writer, BRTezosAddress address) {
     // address bytes with 3-byte TZx prefix replaced with a 1-byte prefix
     
     assert (address);
@@ -45,22 +96,20 @@ encodeAddress (BRTezosAddress address) {
     memcpy(&encoded[0], &prefix, 1);
     memcpy(&encoded[1], &bytes[3], len-3);
     
-    return cryptoDataCopy (encoded, sizeof(encoded));
+    tezosWriterAppend (writer, encoded, sizeof(encoded));
 }
 
-static BRCryptoData
-encodePublicKey (uint8_t * pubKey) {
-    uint8_t prefix = 0x0; // ed25519
-    BRCryptoData encoded = cryptoDataNew(TEZOS_PUBLIC_KEY_SIZE + 1);
-    memcpy(encoded.bytes, &prefix, 1);
-    memcpy(&encoded.bytes[1], pubKey, TEZOS_PUBLIC_KEY_SIZE);
-    return encoded;
+static void
+writePublicKey (BRTezosWriter *writer, uint8_t * pubKey) {
+    uint8_t encoded[TEZOS_PUBLIC_KEY_SIZE + 1];
+    encoded[0] = 0x0; // ed25519
+    memcpy(&encoded[1], pubKey, TEZOS_PUBLIC_KEY_SIZE);
+    tezosWriterAppend (writer, encoded, sizeof(encoded));
 }
 
-extern BRCryptoData
-encodeZarith (int64_t value) {
+static size_t
+zarithBytes (uint8_t *result, int64_t value) {
     assert (value >= 0);
-    uint8_t result[32] = {0};
     size_t resultSize = 0;
     
     uint64_t input = (uint64_t)value;
@@ -70,36 +119,44 @@ encodeZarith (int64_t value) {
     }
     result[resultSize++] = (uint8_t)input;
     
-    return cryptoDataCopy(&result[0], resultSize);
+    return resultSize;
+}
+
+static void
+writeZarith (BRTezosWriter *writer, int64_t value) {
+    uint8_t result[32] = {0};
+    tezosWriterAppend (writer, result, zarithBytes (result, value));
 }
 
-static BRCryptoData
-encodeBool (bool value) {
-    BRCryptoData encoded = cryptoDataNew(1);
-    encoded.bytes[0] = value ? 0xff : 0x00;
-    return encoded;
+extern BRCryptoData
+encodeZarith (int64_t value) {
+    uint8_t result[32] = {0};
+    return cryptoDataCopy(&result[0], zarithBytes (result, value));
 }
 
-static BRCryptoData
-encodeOperationKind (BRTezosOperationKind kind) {
+static void
+writeBool (BRTezosWriter *writer, bool value) {
+    uint8_t encoded[1] = { value ? 0xff : 0x00 };
+    tezosWriterAppend (writer, encoded, 1);
+}
+
+static void
+writeOperationKind (BRTezosWriter *writer, BRTezosOperationKind kind) {
     uint8_t bytes[1] = { kind };
-    return cryptoDataCopy (bytes, 1);
+    tezosWriterAppend (writer, bytes, 1);
 }
 
-static BRCryptoData
-encodeBranch (BRTezosHash blockHash) {
+static void
+writeBranch (BRTezosWriter *writer, BRTezosHash blockHash) {
     // omit prefix
     size_t numPrefixBytes = 2;
     size_t branchSize = sizeof(blockHash.bytes) - numPrefixBytes;
     
-    BRCryptoData branchData = cryptoDataNew(branchSize);
-    memcpy(branchData.bytes, &blockHash.bytes[numPrefixBytes], branchSize);
-    
-    return branchData;
+    tezosWriterAppend (writer, &blockHash.bytes[numPrefixBytes], branchSize);
 }
 
-extern BRCryptoData
-tezosSerializeTransaction (BRTezosTransaction tx) {
+static void
+writeTransaction (BRTezosWriter *writer, BRTezosTransaction tx) {
     assert (tx);
     
     BRTezosOperationData opData = tezosTransactionGetOperationData(tx);
@@ -108,66 +165,64 @@ tezosSerializeTransaction (BRTezosTransaction tx) {
     BRTezosFeeBasis feeBasis = tezosTransactionGetFeeBasis(tx);
     assert(FEE_BASIS_ESTIMATE == feeBasis.type);
     
-    size_t maxFields = 9;
-    BRCryptoData fields[maxFields];
-    size_t numFields = 0;
-    fields[numFields++] = encodeOperationKind(opData.kind);
-    fields[numFields++] = encodeAddress(source);
-    fields[numFields++] = encodeZarith(tezosTransactionGetFee(tx));
-    fields[numFields++] = encodeZarith(tezosTransactionGetCounter(tx));
-    fields[numFields++] = encodeZarith(feeBasis.u.estimate.gasLimit);
-    fields[numFields++] = encodeZarith(feeBasis.u.estimate.storageLimit);
+    writeOperationKind(writer, opData.kind);
+    writeAddress(writer, source);
+    writeZarith(writer, tezosTransactionGetFee(tx));
+    writeZarith(writer, tezosTransactionGetCounter(tx));
+    writeZarith(writer, feeBasis.u.estimate.gasLimit);
+    writeZarith(writer, feeBasis.u.estimate.storageLimit);
     
     if (TEZOS_OP_TRANSACTION == opData.kind) {
-        fields[numFields++] = encodeZarith(opData.u.transaction.amount);
+        writeZarith(writer, opData.u.transaction.amount);
         //TODO:XTZ support sending to KT addresses
-        fields[numFields++] = encodeBool(false); // is originated (KT) address
-        fields[numFields++] = encodeAddress(opData.u.transaction.target);
-        fields[numFields++] = encodeBool(false); // contract execution params (0x0 for no params)
+        writeBool(writer, false); // is originated (KT) address
+        writeAddress(writer, opData.u.transaction.target);
+        writeBool(writer, false); // contract execution params (0x0 for no params)
     } else if (TEZOS_OP_DELEGATION == opData.kind) {
         if (NULL != opData.u.delegation.target) {
-            fields[numFields++] = encodeBool(true); // set delegate
-            fields[numFields++] = encodeAddress(opData.u.delegation.target);
+            writeBool(writer, true); // set delegate
+            writeAddress(writer, opData.u.delegation.target);
         } else {
-            fields[numFields++] = encodeBool(false); // remove delegate
+            writeBool(writer, false); // remove delegate
         }
     } else if (TEZOS_OP_REVEAL == opData.kind) {
-        fields[numFields++] = encodePublicKey(opData.u.reveal.publicKey);
+        writePublicKey(writer, opData.u.reveal.publicKey);
     } else {
         // unsupported
         assert(0);
     }
     
-    BRCryptoData serialized = cryptoDataConcat(fields, numFields);
-    
     tezosAddressFree (source);
     tezosTransactionFreeOperationData(opData);
-    for (int i=0; i < numFields; i++) {
-        cryptoDataFree(fields[i]);
-    }
-    
-    return serialized;
 }
 
 extern BRCryptoData
-tezosSerializeOperationList (BRTezosTransaction * tx, size_t txCount, BRTezosHash blockHash) {
-    
-    BRCryptoData fields[txCount + 1];
-    size_t numFields = 0;
+tezosSerializeTransaction (BRTezosTransaction tx) {
+    BRTezosWriter writer;
+    tezosWriterInit (&writer, TEZOS_OPERATION_MAX_BYTES, NULL, NULL);
+    writeTransaction (&writer, tx);
+    return tezosWriterTake (&writer);
+}
+
+extern size_t
+tezosSerializeOperationListTo (BRTezosWriter *writer, BRTezosTransaction * tx, size_t txCount, BRTezosHash blockHash) {
+    size_t start = writer->size;
     
     // operation list = branch + [reveal op bytes] + transaction/delegation op bytes
     
-    fields[numFields++] = encodeBranch(blockHash);
+    writeBranch(writer, blockHash);
     
     for (int i=0; i < txCount; i++) {
-        fields[numFields++] = tezosSerializeTransaction(tx[i]);
+        writeTransaction(writer, tx[i]);
     }
     
-    BRCryptoData serialized = cryptoDataConcat(fields, numFields);
-    
-    for (int i=0; i < numFields; i++) {
-        cryptoDataFree(fields[i]);
-    }
-    
-    return serialized;
+    return writer->size - start;
+}
+
+extern BRCryptoData
+tezosSerializeOperationList (BRTezosTransaction * tx, size_t txCount, BRTezosHash blockHash) {
+    BRTezosWriter writer;
+    tezosWriterInit (&writer, TEZOS_HASH_BYTES + txCount * TEZOS_OPERATION_MAX_BYTES, NULL, NULL);
+    tezosSerializeOperationListTo (&writer, tx, txCount, blockHash);
+    return tezosWriterTake (&writer);
 }
@@ -15,11 +15,37 @@
 #include <assert.h>
 #include "BRTezosBase.h"
 #include "BRTezosTransaction.h"
+#include "blake2/blake2b.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define TEZOS_OPERATION_MAX_BYTES (128) // largest encoded operation, used to size writers up front
+
+/**
+ * An output buffer for encoded bytes.  The buffer grows as needed and every byte written is
+ * also added to each non-NULL hash context, so operation hashes are computed as the bytes are
+ * encoded rather than by hashing the finished buffer again.
+ */
+typedef struct {
+    BRCryptoData data;      // data.size is the capacity
+    size_t size;            // bytes written
+    blake2b_ctx *hashes[2];
+} BRTezosWriter;
+
+extern void
+tezosWriterInit (BRTezosWriter *writer, size_t capacity, blake2b_ctx *hash0, blake2b_ctx *hash1);
+
+extern void
+tezosWriterAppend (BRTezosWriter *writer, const uint8_t *bytes, size_t size);
+
+/**
+ * Returns the bytes written, as owned data, and resets the writer.
+ */
+extern BRCryptoData
+tezosWriterTake (BRTezosWriter *writer);
+
 extern BRCryptoData
 encodeZarith (int64_t value);
 
@@ -29,6 +55,14 @@ tezosSerializeTransaction (BRTezosTransaction tx);
 extern BRCryptoData
 tezosSerializeOperationList (BRTezosTransaction * tx, size_t txCount, BRTezosHash blockHash);
 
+/**
+ * Writes the operation list of `tx` to `writer`, as tezosSerializeOperationList() encodes it.
+ *
+ * @return the number of bytes written
+ */
+extern size_t
+tezosSerializeOperationListTo (BRTezosWriter *writer, BRTezosTransaction * tx, size_t txCount, BRTezosHash blockHash);
+
 
 #ifdef __cplusplus
 }
@@ -132,32 +132,35 @@ extern void tezosTransactionFree (BRTezosTransaction transaction)
 }
 
 static void
-createTransactionHash(BRTezosTransaction tx) {
+createTransactionHash(BRTezosTransaction tx, blake2b_ctx *ctx) {
+    // ctx holds the hash of signedBytes, accumulated as they were written
     assert(tx->signedBytes.size);
     
     uint8_t hash[32];
-    blake2b(hash, sizeof(hash), NULL, 0, tx->signedBytes.bytes, tx->signedBytes.size);
+    blake2b_final(ctx, hash);
     
     uint8_t prefix[] = { 5, 116 }; // operation prefix
     memcpy(tx->hash.bytes, prefix, sizeof(prefix));
     memcpy(&(tx->hash.bytes[sizeof(prefix)]), hash, sizeof(hash));
 }
 
-static BRCryptoData
-tezosTransactionSerialize (BRTezosTransaction transaction,
-                           BRTezosAccount account,
-                           BRTezosHash lastBlockHash,
-                           bool needsReveal) {
+static void
+tezosTransactionSerializeTo (BRTezosWriter *writer,
+                             BRTezosTransaction transaction,
+                             BRTezosAccount account,
+                             BRTezosHash lastBlockHash,
+                             bool needsReveal) {
     BRTezosTransaction opList[2];
+    BRTezosTransaction reveal = NULL;
     size_t opCount = 0;
     
     // add a reveal operation to the operation list if needed
     if (needsReveal) {
         BRKey publicKey = tezosAccountGetPublicKey(account);
-        BRTezosTransaction reveal = tezosTransactionCreateReveal(transaction->source,
-                                                                 publicKey.pubKey,
-                                                                 transaction->feeBasis,
-                                                                 transaction->counter);
+        reveal = tezosTransactionCreateReveal(transaction->source,
+                                              publicKey.pubKey,
+                                              transaction->feeBasis,
+                                              transaction->counter);
         transaction->counter += 1;
         
         opList[opCount++] = reveal;
@@ -165,7 +168,9 @@ tezosTransactionSerialize (BRTezosTransaction transaction,
     
     opList[opCount++] = transaction;
     
-    return tezosSerializeOperationList(opList, opCount, lastBlockHash);
+    tezosSerializeOperationListTo(writer, opList, opCount, lastBlockHash);
+    
+    if (NULL != reveal) tezosTransactionFree(reveal);
 }
 
 extern size_t
@@ -178,18 +183,22 @@ tezosTransactionSerializeForFeeEstimation (BRTezosTransaction transaction,
     
     cryptoDataFree(transaction->signedBytes);
     
-    BRCryptoData unsignedBytes = tezosTransactionSerialize(transaction, account, lastBlockHash, needsReveal);
-    BRCryptoData signature = cryptoDataNew(TEZOS_SIGNATURE_BYTES); // empty signature
+    // the operation hash is taken as the bytes are written, with no unsigned copy to concatenate
+    blake2b_ctx operationHash;
+    blake2b_init(&operationHash, 32, NULL, 0);
+    
+    BRTezosWriter writer;
+    tezosWriterInit(&writer, TEZOS_HASH_BYTES + 2 * TEZOS_OPERATION_MAX_BYTES + TEZOS_SIGNATURE_BYTES, &operationHash, NULL);
+    tezosTransactionSerializeTo(&writer, transaction, account, lastBlockHash, needsReveal);
     
-    BRCryptoData serializedBytes = cryptoDataNew(unsignedBytes.size + signature.size);
-    memcpy(serializedBytes.bytes, unsignedBytes.bytes, unsignedBytes.size);
-    memcpy(&serializedBytes.bytes[unsignedBytes.size], signature.bytes, signature.size);
+    uint8_t signature[TEZOS_SIGNATURE_BYTES] = { 0 }; // empty signature
+    tezosWriterAppend(&writer, signature, sizeof(signature));
     
-    transaction->signedBytes = serializedBytes;
-    transaction->feeBasis.u.estimate.sizeInBytes = serializedBytes.size;
+    transaction->signedBytes = tezosWriterTake(&writer);
+    transaction->feeBasis.u.estimate.sizeInBytes = transaction->signedBytes.size;
     
     if (transaction->signedBytes.size > 0) {
-        createTransactionHash(transaction);
+        createTransactionHash(transaction, &operationHash);
     }
     
     return transaction->signedBytes.size;
@@ -206,20 +215,31 @@ tezosTransactionSerializeAndSign (BRTezosTransaction transaction,
     
     cryptoDataFree(transaction->signedBytes);
     
-    BRCryptoData unsignedBytes = tezosTransactionSerialize (transaction, account, lastBlockHash, needsReveal);
+    // the unsigned bytes feed both the signing digest and the operation hash as they are written
+    blake2b_ctx operationHash, signingHash;
+    blake2b_init(&operationHash, 32, NULL, 0);
+    tezosAccountSignDataBegin(&signingHash);
     
-    BRCryptoData signature = tezosAccountSignData(account, unsignedBytes, seed);
-    assert(TEZOS_SIGNATURE_BYTES == signature.size);
+    BRTezosWriter writer;
+    tezosWriterInit(&writer, TEZOS_HASH_BYTES + 2 * TEZOS_OPERATION_MAX_BYTES + TEZOS_SIGNATURE_BYTES, &operationHash, &signingHash);
+    tezosTransactionSerializeTo(&writer, transaction, account, lastBlockHash, needsReveal);
+    
+    BRCryptoData signature = tezosAccountSignDigest(account, &signingHash, seed);
+    if (TEZOS_SIGNATURE_BYTES != signature.size) {
+        cryptoDataFree(tezosWriterTake(&writer));
+        transaction->signedBytes = (BRCryptoData) { NULL, 0 };
+        return 0;
+    }
     
-    BRCryptoData signedBytes = cryptoDataNew(unsignedBytes.size + signature.size);
-    memcpy(signedBytes.bytes, unsignedBytes.bytes, unsignedBytes.size);
-    memcpy(&signedBytes.bytes[unsignedBytes.size], signature.bytes, signature.size);
+    writer.hashes[1] = NULL;
+    tezosWriterAppend(&writer, signature.bytes, signature.size);
+    cryptoDataFree(signature);
     
-    transaction->signedBytes = signedBytes;
-    transaction->feeBasis.u.estimate.sizeInBytes = signedBytes.size;
+    transaction->signedBytes = tezosWriterTake(&writer);
+    transaction->feeBasis.u.estimate.sizeInBytes = transaction->signedBytes.size;
     
     if (transaction->signedBytes.size > 0) {
-        createTransactionHash(transaction);
+        createTransactionHash(transaction, &operationHash);
     }
     
     return transaction->signedBytes.size;